@@ -12,26 +12,75 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "bsp_brc.h"
+#include "driver/gpio.h"
 
 /* Private defines ---------------------------------------------------- */
+#define BSP_BRC_SPEED_MAX               (100)   // Percent
+#define BSP_BRC_CMD_NONE                (UINT16_MAX)
+
+#define BSP_BRC_FG_PULSES               (1)     // FG pulses per electrical cycle, FGcycle default
+#define BSP_BRC_FG_MIN_PERIOD_US        (1000)  // Over 3 times the top speed period, shorter is noise
+#define BSP_BRC_FG_TIMEOUT_US           (100000) // Below 10 Hz or FG absent, speed read over I2C
+
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
 static const char *TAG = "bsp_brc";
 static drv10975_t m_drv10975;
+static bool m_brc_ready;                    // Driver initialised
+static SemaphoreHandle_t m_brc_lock;        // Speed command writes
+static uint16_t m_brc_cmd;                  // Requested speed command
+static uint16_t m_brc_limit = DRV10975_SPEED_CMD_MAX; // Derating limit, speed command
+static uint16_t m_brc_out = BSP_BRC_CMD_NONE;         // Last command written to the driver
+static portMUX_TYPE m_brc_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static portMUX_TYPE m_brc_fg_mux = portMUX_INITIALIZER_UNLOCKED;
+static tacho_t m_brc_fg;                    // FG edge capture, under m_brc_fg_mux
+
+static const tacho_config_t m_brc_fg_config =
+{
+  .pulses_per_cycle = BSP_BRC_FG_PULSES,
+  .min_period_us    = BSP_BRC_FG_MIN_PERIOD_US,
+  .timeout_us       = BSP_BRC_FG_TIMEOUT_US
+};
 
 /* Private function prototypes ---------------------------------------- */
+static base_status_t m_bsp_brc_apply(uint16_t cmd);
+static void m_bsp_brc_fg_isr_handler(void *arg);
+
 /* Function definitions ----------------------------------------------- */
 base_status_t bsp_brc_init(void)
 {
+  int64_t start_us = esp_timer_get_time();
+
   m_drv10975.device_address = DRV10975_I2C_ADDR;
   m_drv10975.i2c_read       = bsp_i2c_read;
   m_drv10975.i2c_write      = bsp_i2c_write;
   m_drv10975.delay_ms       = bsp_delay_ms;
   m_drv10975.gpio_write     = bsp_io_write;
 
+  bsp_i2c_register_client(m_drv10975.device_address, BSP_I2C_CLASS_MOTOR);
+
+  m_brc_lock = xSemaphoreCreateMutex();
+  CHECK(m_brc_lock != NULL, BS_ERROR);
+
   CHECK_STATUS(drv10975_init(&m_drv10975));
+  m_brc_out   = 0;                          // Init stops the motor
+  m_brc_ready = true;
+
+  // FG tachometer, the ISR service is installed by bsp_io_init()
+  tacho_init(&m_brc_fg, &m_brc_fg_config);
+
+  gpio_pad_select_gpio(IO_BRC_FG);
+  gpio_set_direction(IO_BRC_FG, GPIO_MODE_INPUT);
+  gpio_pullup_en(IO_BRC_FG);                // Open drain output
+  gpio_set_intr_type(IO_BRC_FG, GPIO_INTR_POSEDGE);
+  gpio_isr_handler_add(IO_BRC_FG, m_bsp_brc_fg_isr_handler, NULL);
+  gpio_intr_enable(IO_BRC_FG);
+
+  ESP_LOGI(TAG, "DRV10975 init %lld us, EEPROM %s", esp_timer_get_time() - start_us,
+           m_drv10975.eeprom_updated ? "programmed" : "unchanged");
 
   return BS_OK;
 }
@@ -50,11 +99,77 @@ base_status_t bsp_brc_set_motor_direction(uint8_t dir)
 
 base_status_t bsp_brc_set_motor_speed(uint8_t percent_speed)
 {
-  CHECK_STATUS(drv10975_set_motor_speed(&m_drv10975, percent_speed));
+  if (percent_speed > BSP_BRC_SPEED_MAX)
+    percent_speed = BSP_BRC_SPEED_MAX;
+
+  return m_bsp_brc_apply((uint16_t)((uint32_t)percent_speed * DRV10975_SPEED_CMD_MAX / BSP_BRC_SPEED_MAX));
+}
+
+base_status_t bsp_brc_set_speed_cmd(uint16_t cmd)
+{
+  return m_bsp_brc_apply(cmd);
+}
+
+base_status_t bsp_brc_set_derating(uint8_t limit_percent)
+{
+  uint16_t cmd;
+
+  if (limit_percent > BSP_BRC_SPEED_MAX)
+    limit_percent = BSP_BRC_SPEED_MAX;
+
+  portENTER_CRITICAL(&m_brc_mux);
+  m_brc_limit = (uint16_t)((uint32_t)limit_percent * DRV10975_SPEED_CMD_MAX / BSP_BRC_SPEED_MAX);
+  cmd         = m_brc_cmd;
+  portEXIT_CRITICAL(&m_brc_mux);
+
+  // Limit kept for the next speed request when the driver is not up yet
+  if (!m_brc_ready)
+    return BS_OK;
+
+  return m_bsp_brc_apply(cmd);
+}
+
+uint16_t bsp_brc_get_speed_limit(void)
+{
+  uint16_t limit;
+
+  portENTER_CRITICAL(&m_brc_mux);
+  limit = m_brc_limit;
+  portEXIT_CRITICAL(&m_brc_mux);
+
+  return limit;
+}
+
+base_status_t bsp_brc_read_velocity(uint32_t *velocity_mhz)
+{
+  bool measured;
+
+  CHECK(m_brc_ready, BS_ERROR);
+
+  portENTER_CRITICAL(&m_brc_fg_mux);
+  measured = tacho_read(&m_brc_fg, (uint64_t)esp_timer_get_time(), velocity_mhz);
+  portEXIT_CRITICAL(&m_brc_fg_mux);
+
+  if (measured)
+    return BS_OK;
+
+  // No FG edges, stopped, too slow or the pin not fitted
+  CHECK_STATUS(drv10975_get_motor_velocity(&m_drv10975));
+  *velocity_mhz = m_drv10975.value.velocity_mhz;
 
   return BS_OK;
 }
 
+void bsp_brc_get_fg_stats(tacho_stats_t *stats)
+{
+  if (stats == NULL)
+    return;
+
+  portENTER_CRITICAL(&m_brc_fg_mux);
+  *stats = m_brc_fg.stats;
+  portEXIT_CRITICAL(&m_brc_fg_mux);
+}
+
 base_status_t bsp_brc_get_motor_velocity(void)
 {
   CHECK_STATUS(drv10975_get_motor_velocity(&m_drv10975));
@@ -83,6 +198,25 @@ base_status_t bsp_brc_get_motor_current(void)
   return BS_OK;
 }
 
+base_status_t bsp_brc_snapshot(drv10975_snapshot_t *snap)
+{
+  CHECK(m_brc_ready, BS_ERROR);
+
+  CHECK_STATUS(drv10975_snapshot(&m_drv10975, (uint64_t)esp_timer_get_time(), snap));
+
+  return BS_OK;
+}
+
+base_status_t bsp_brc_poll_faults(drv10975_fault_t *fault)
+{
+  CHECK(m_brc_ready, BS_ERROR);
+
+  CHECK_STATUS(drv10975_poll_status(&m_drv10975));
+  *fault = m_drv10975.fault;
+
+  return BS_OK;
+}
+
 base_status_t bsp_brc_check_over_temp(void)
 {
   CHECK_STATUS(drv10975_check_over_temp(&m_drv10975));
@@ -112,4 +246,58 @@ base_status_t bsp_brc_check_motor_lock(void)
 }
 
 /* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Write a speed command under the derating limit
+ *
+ * @param[in]     cmd     Requested speed command
+ *
+ * @attention     The driver is only written when the limited command changes
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+static base_status_t m_bsp_brc_apply(uint16_t cmd)
+{
+  base_status_t status = BS_OK;
+  uint16_t out;
+
+  CHECK(m_brc_ready, BS_ERROR);
+
+  xSemaphoreTake(m_brc_lock, portMAX_DELAY);
+
+  portENTER_CRITICAL(&m_brc_mux);
+  m_brc_cmd = cmd;
+  out       = (cmd < m_brc_limit) ? cmd : m_brc_limit;
+  portEXIT_CRITICAL(&m_brc_mux);
+
+  if (out != m_brc_out)
+  {
+    status    = drv10975_set_speed_cmd(&m_drv10975, out);
+    m_brc_out = (BS_OK == status) ? out : BSP_BRC_CMD_NONE;
+  }
+
+  xSemaphoreGive(m_brc_lock);
+
+  return status;
+}
+
+/**
+ * @brief         FG rising edge, one electrical cycle of the motor
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     The timestamp is taken here, the interrupt latency is part of the jitter
+ *
+ * @return        None
+ */
+static void IRAM_ATTR m_bsp_brc_fg_isr_handler(void *arg)
+{
+  uint64_t now_us = (uint64_t)esp_timer_get_time();
+
+  portENTER_CRITICAL_ISR(&m_brc_fg_mux);
+  tacho_capture(&m_brc_fg, now_us);
+  portEXIT_CRITICAL_ISR(&m_brc_fg_mux);
+}
+
 /* End of file -------------------------------------------------------- */
\ No newline at end of file
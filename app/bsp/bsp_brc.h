@@ -20,6 +20,7 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
 #include "drv10975.h"
+#include "tacho.h"
 
 /* Public defines ----------------------------------------------------- */
 /* Public enumerate/structure ----------------------------------------- */
@@ -78,6 +79,69 @@ base_status_t bsp_brc_set_motor_direction(uint8_t dir);
  */
 base_status_t bsp_brc_set_motor_speed(uint8_t percent_speed);
 
+/**
+ * @brief         BSP brushless motor driver set the raw speed command
+ *
+ * @param[in]     cmd       Speed command, 0 to DRV10975_SPEED_CMD_MAX
+ *
+ * @attention     Capped by the derating limit, only written when the result changes
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_set_speed_cmd(uint16_t cmd);
+
+/**
+ * @brief         BSP brushless motor driver limit the motor speed
+ *
+ * @param[in]     limit_percent   Highest speed allowed, 100 removes the limit
+ *
+ * @attention     Applied at once to the running motor and to later speed requests,
+ *                which are restored when the limit is raised
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_set_derating(uint8_t limit_percent);
+
+/**
+ * @brief         BSP brushless motor driver get the derating limit
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Highest speed command allowed
+ */
+uint16_t bsp_brc_get_speed_limit(void);
+
+/**
+ * @brief         BSP brushless motor driver read the motor velocity
+ *
+ * @param[out]    velocity_mhz    Pointer to electrical frequency in millihertz
+ *
+ * @attention     From the FG period without bus traffic, one I2C read of the speed
+ *                register while FG has no recent edge
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_read_velocity(uint32_t *velocity_mhz);
+
+/**
+ * @brief         BSP brushless motor driver get the FG tachometer statistics
+ *
+ * @param[out]    stats     Pointer to statistics
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void bsp_brc_get_fg_stats(tacho_stats_t *stats);
+
 /**
  * @brief         BSP brushless motor driver get motor velocity
  *
@@ -130,6 +194,32 @@ base_status_t bsp_brc_get_motor_supply_voltage(void);
  */
 base_status_t bsp_brc_get_motor_current(void);
 
+/**
+ * @brief         BSP brushless motor driver read the motor telemetry
+ *
+ * @param[out]    snap      Pointer to snapshot, timestamped at the read
+ *
+ * @attention     One I2C read of the whole status block
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_snapshot(drv10975_snapshot_t *snap);
+
+/**
+ * @brief         BSP brushless motor driver poll the status and fault flags
+ *
+ * @param[out]    fault     Pointer to flags set, raised and cleared since the previous poll
+ *
+ * @attention     One I2C read
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_poll_faults(drv10975_fault_t *fault);
+
 /**
  * @brief         BSP brushless motor driver check device over temp
  *
@@ -0,0 +1,312 @@
+/**
+ * @file       bsp_brc_ctrl.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Board support package for the closed loop blower speed control
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "bsp_brc_ctrl.h"
+#include "speed_pi.h"
+#include "esp_timer.h"
+
+/* Private defines ---------------------------------------------------- */
+#define BSP_BRC_CTRL_PERIOD_US          (1000)  // 1 kHz loop
+#define BSP_BRC_CTRL_TASK_STACK_SIZE    (2048)
+#define BSP_BRC_CTRL_TASK_PRIORITY      (11)    // Above the I2C bus task, blocks on it for the transfers
+#define BSP_BRC_CTRL_SUPERVISE_MS       (100)   // Driver telemetry and status poll
+#define BSP_BRC_CTRL_SUPERVISE_PRIORITY (5)     // Below the I2C bus task, off the control period
+
+// Gains tuned against the rotor model, 587 mHz per command step and 250 ms time constant
+#define BSP_BRC_CTRL_KFF_Q16            (112)   // Inverse of the plant gain
+#define BSP_BRC_CTRL_KP_Q16             (560)   // Loop gain 5, settles in 200 ms
+#define BSP_BRC_CTRL_KI_Q16             (2234)  // Integral time of the rotor time constant
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "bsp_brc_ctrl";
+
+static TaskHandle_t m_ctrl_task;
+static TaskHandle_t m_ctrl_supervise_task;
+static esp_timer_handle_t m_ctrl_timer;
+static speed_pi_t m_ctrl_pi;                // Control task only
+
+static portMUX_TYPE m_ctrl_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t m_ctrl_setpoint_mhz;
+static int64_t m_ctrl_release_us;           // Time of the last timer expiry
+static bsp_brc_ctrl_stats_t m_ctrl_stats;
+static drv10975_snapshot_t m_ctrl_telemetry;  // Last supervision read
+
+static const speed_pi_config_t m_ctrl_pi_config =
+{
+  .kp_q16    = BSP_BRC_CTRL_KP_Q16,
+  .ki_q16    = BSP_BRC_CTRL_KI_Q16,
+  .kff_q16   = BSP_BRC_CTRL_KFF_Q16,
+  .period_us = BSP_BRC_CTRL_PERIOD_US,
+  .out_max   = DRV10975_SPEED_CMD_MAX
+};
+
+/* Private function prototypes ---------------------------------------- */
+static void m_bsp_brc_ctrl_timer_cb(void *arg);
+static void m_bsp_brc_ctrl_task(void *param);
+static void m_bsp_brc_ctrl_supervise_task(void *param);
+static bool m_bsp_brc_ctrl_step(uint32_t setpoint_mhz, bool *running);
+static bool m_bsp_brc_ctrl_supervise(void);
+
+/* Function definitions ----------------------------------------------- */
+base_status_t bsp_brc_ctrl_init(void)
+{
+  const esp_timer_create_args_t timer_args =
+  {
+    .callback = m_bsp_brc_ctrl_timer_cb,
+    .name     = "brc_ctrl"
+  };
+
+  speed_pi_init(&m_ctrl_pi, &m_ctrl_pi_config);
+
+  memset(&m_ctrl_stats, 0, sizeof(m_ctrl_stats));
+  m_ctrl_stats.min_interval_us = UINT32_MAX;
+
+  CHECK(pdPASS == xTaskCreate(&m_bsp_brc_ctrl_task, "BRC ctrl task", BSP_BRC_CTRL_TASK_STACK_SIZE, NULL,
+                              BSP_BRC_CTRL_TASK_PRIORITY, &m_ctrl_task), BS_ERROR);
+  CHECK(pdPASS == xTaskCreate(&m_bsp_brc_ctrl_supervise_task, "BRC supervise task", BSP_BRC_CTRL_TASK_STACK_SIZE,
+                              NULL, BSP_BRC_CTRL_SUPERVISE_PRIORITY, &m_ctrl_supervise_task), BS_ERROR);
+  CHECK(ESP_OK == esp_timer_create(&timer_args, &m_ctrl_timer), BS_ERROR);
+  CHECK(ESP_OK == esp_timer_start_periodic(m_ctrl_timer, BSP_BRC_CTRL_PERIOD_US), BS_ERROR);
+
+  ESP_LOGI(TAG, "Speed loop %d us", BSP_BRC_CTRL_PERIOD_US);
+
+  return BS_OK;
+}
+
+void bsp_brc_ctrl_set_speed(uint32_t speed_mhz)
+{
+  portENTER_CRITICAL(&m_ctrl_mux);
+  m_ctrl_setpoint_mhz = speed_mhz;
+  portEXIT_CRITICAL(&m_ctrl_mux);
+}
+
+void bsp_brc_ctrl_get_stats(bsp_brc_ctrl_stats_t *stats)
+{
+  if (stats == NULL)
+    return;
+
+  portENTER_CRITICAL(&m_ctrl_mux);
+  *stats = m_ctrl_stats;
+  portEXIT_CRITICAL(&m_ctrl_mux);
+}
+
+void bsp_brc_ctrl_get_telemetry(drv10975_snapshot_t *snap)
+{
+  if (snap == NULL)
+    return;
+
+  portENTER_CRITICAL(&m_ctrl_mux);
+  *snap = m_ctrl_telemetry;
+  portEXIT_CRITICAL(&m_ctrl_mux);
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Control period expired, releases the control task
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     Runs in the esp_timer task, its dispatch delay is part of the jitter
+ *
+ * @return        None
+ */
+static void m_bsp_brc_ctrl_timer_cb(void *arg)
+{
+  portENTER_CRITICAL(&m_ctrl_mux);
+  m_ctrl_release_us = esp_timer_get_time();
+  portEXIT_CRITICAL(&m_ctrl_mux);
+
+  xTaskNotifyGive(m_ctrl_task);
+}
+
+/**
+ * @brief         Control task, one PI step per timer release
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     Releases that came in during a cycle are skipped, not run late
+ *                back to back, the loop always works on a fresh measurement
+ *
+ * @return        None
+ */
+static void m_bsp_brc_ctrl_task(void *param)
+{
+  int64_t release_us;
+  int64_t start_us;
+  int64_t last_start_us = 0;
+  uint32_t setpoint_mhz;
+  uint32_t pending;
+  uint32_t jitter_us;
+  uint32_t exec_us;
+  uint32_t interval_us = 0;
+  bool running = false;
+  bool ok;
+
+  while (1)
+  {
+    pending  = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    start_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&m_ctrl_mux);
+    release_us   = m_ctrl_release_us;
+    setpoint_mhz = m_ctrl_setpoint_mhz;
+    portEXIT_CRITICAL(&m_ctrl_mux);
+
+    ok = m_bsp_brc_ctrl_step(setpoint_mhz, &running);
+
+    exec_us   = (uint32_t)(esp_timer_get_time() - start_us);
+    jitter_us = (uint32_t)(start_us - release_us);
+    if (last_start_us != 0)
+      interval_us = (uint32_t)(start_us - last_start_us);
+
+    portENTER_CRITICAL(&m_ctrl_mux);
+    m_ctrl_stats.cycles++;
+    m_ctrl_stats.deadline_misses += pending - 1;
+    if (jitter_us + exec_us > BSP_BRC_CTRL_PERIOD_US)
+      m_ctrl_stats.deadline_misses++;
+    if (!ok)
+      m_ctrl_stats.io_errors++;
+    if (jitter_us > m_ctrl_stats.max_jitter_us)
+      m_ctrl_stats.max_jitter_us = jitter_us;
+    if (exec_us > m_ctrl_stats.max_exec_us)
+      m_ctrl_stats.max_exec_us = exec_us;
+    if ((last_start_us != 0) && (pending == 1))
+    {
+      if (interval_us < m_ctrl_stats.min_interval_us)
+        m_ctrl_stats.min_interval_us = interval_us;
+      if (interval_us > m_ctrl_stats.max_interval_us)
+        m_ctrl_stats.max_interval_us = interval_us;
+    }
+    portEXIT_CRITICAL(&m_ctrl_mux);
+
+    last_start_us = start_us;
+  }
+}
+
+/**
+ * @brief         Supervision task, driver telemetry every 100 ms
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     The 15 byte telemetry read takes about 440 us on the bus, it runs
+ *                here so that no control cycle carries it on top of its own transfers
+ *
+ * @return        None
+ */
+static void m_bsp_brc_ctrl_supervise_task(void *param)
+{
+  TickType_t wake = xTaskGetTickCount();
+
+  while (1)
+  {
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(BSP_BRC_CTRL_SUPERVISE_MS));
+
+    if (!m_bsp_brc_ctrl_supervise())
+    {
+      portENTER_CRITICAL(&m_ctrl_mux);
+      m_ctrl_stats.io_errors++;
+      portEXIT_CRITICAL(&m_ctrl_mux);
+    }
+  }
+}
+
+/**
+ * @brief         One control cycle
+ *
+ * @param[in]     setpoint_mhz    Speed setpoint in millihertz
+ * @param[inout]  running         Loop owns the speed command
+ *
+ * @attention     A setpoint of 0 stops the motor once and leaves the command alone
+ *                afterwards, the open loop API keeps working while the loop is idle
+ *
+ * @return
+ * - true       Cycle completed
+ * - false      Bus error, the command is held
+ */
+static bool m_bsp_brc_ctrl_step(uint32_t setpoint_mhz, bool *running)
+{
+  uint32_t velocity_mhz;
+  int32_t cmd;
+
+  if (setpoint_mhz == 0)
+  {
+    if (!*running)
+      return true;
+
+    speed_pi_reset(&m_ctrl_pi);
+    if (BS_OK != bsp_brc_set_speed_cmd(0))
+      return false;
+
+    *running = false;
+    return true;
+  }
+
+  *running = true;
+
+  if (BS_OK != bsp_brc_read_velocity(&velocity_mhz))
+    return false;
+
+  // Derating from the rail guard caps the output and the integrator with it
+  speed_pi_set_limit(&m_ctrl_pi, bsp_brc_get_speed_limit());
+  cmd = speed_pi_update(&m_ctrl_pi, (int32_t)setpoint_mhz, (int32_t)velocity_mhz);
+
+  return (BS_OK == bsp_brc_set_speed_cmd((uint16_t)cmd));
+}
+
+/**
+ * @brief         Read the driver telemetry, log the status and fault changes
+ *
+ * @param[in]     None
+ *
+ * @attention     Supervision task only. Edges are taken against the previous
+ *                supervision read, other readers of the driver do not hide them
+ *
+ * @return
+ * - true       Telemetry read
+ * - false      Bus error
+ */
+static bool m_bsp_brc_ctrl_supervise(void)
+{
+  static drv10975_flags_t last;
+  drv10975_snapshot_t snap;
+  uint16_t raised;
+  uint16_t cleared;
+  uint32_t raises = 0;
+
+  if (BS_OK != bsp_brc_snapshot(&snap))
+    return false;
+
+  raised  = snap.flags.word & ~last.word;
+  cleared = last.word & ~snap.flags.word;
+  last    = snap.flags;
+
+  for (uint16_t bits = raised; bits != 0; bits &= bits - 1)
+    raises++;
+
+  portENTER_CRITICAL(&m_ctrl_mux);
+  m_ctrl_stats.fault_raises += raises;
+  m_ctrl_stats.fault_flags   = snap.flags.word;
+  m_ctrl_telemetry           = snap;
+  portEXIT_CRITICAL(&m_ctrl_mux);
+
+  // The sleep flag follows every stop and start of the motor, not worth a warning
+  if ((raised | cleared) & ~(uint16_t)(DRV10975_SLEEP << 8))
+    ESP_LOGW(TAG, "Driver flags 0x%04x, raised 0x%04x, cleared 0x%04x", snap.flags.word, raised, cleared);
+
+  return true;
+}
+
+/* End of file -------------------------------------------------------- */
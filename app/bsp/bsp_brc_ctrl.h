@@ -0,0 +1,103 @@
+/**
+ * @file       bsp_brc_ctrl.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Board support package for the closed loop blower speed control
+ * @note       A periodic timer releases the control task every 1 ms. Each cycle reads
+ *             the motor velocity, runs the PI controller and writes the speed
+ *             command. A lower priority task reads the driver telemetry block every
+ *             100 ms, status and faults included, outside the control period. The
+ *             loop is idle while the setpoint is 0.
+ * @example    bsp_brc_ctrl_init();
+ *             bsp_brc_ctrl_set_speed(150000);   // 150 Hz electrical
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __BSP_BRC_CTRL_H
+#define __BSP_BRC_CTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "bsp_brc.h"
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief BSP blower speed control timing statistics
+ */
+typedef struct
+{
+  uint32_t cycles;          // Control cycles run, idle ones included
+  uint32_t deadline_misses; // Cycles skipped or completed after the next release
+  uint32_t io_errors;       // Failed velocity reads, command writes and telemetry reads
+  uint32_t max_jitter_us;   // Timer expiry to task start
+  uint32_t max_exec_us;     // Task start to command written
+  uint32_t min_interval_us; // Task start to task start, UINT32_MAX until two cycles
+  uint32_t max_interval_us;
+  uint32_t fault_raises;    // Driver status and fault flags raised
+  uint16_t fault_flags;     // Driver flags of the last status poll, drv10975_flags_t
+}
+bsp_brc_ctrl_stats_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         BSP blower speed control init
+ *
+ * @param[in]     None
+ *
+ * @attention     Call after bsp_brc_init(), starts the control task and its timer
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_brc_ctrl_init(void);
+
+/**
+ * @brief         BSP blower speed control set the speed
+ *
+ * @param[in]     speed_mhz   Electrical frequency in millihertz, 0 stops the motor
+ *
+ * @attention     The loop owns the speed command while the setpoint is not 0
+ *
+ * @return        None
+ */
+void bsp_brc_ctrl_set_speed(uint32_t speed_mhz);
+
+/**
+ * @brief         BSP blower speed control get the timing statistics
+ *
+ * @param[out]    stats     Pointer to statistics
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void bsp_brc_ctrl_get_stats(bsp_brc_ctrl_stats_t *stats);
+
+/**
+ * @brief         BSP blower speed control get the last driver telemetry
+ *
+ * @param[out]    snap      Pointer to snapshot, timestamp 0 before the first read
+ *
+ * @attention     Refreshed every 100 ms by the supervision task
+ *
+ * @return        None
+ */
+void bsp_brc_ctrl_get_telemetry(drv10975_snapshot_t *snap);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __BSP_BRC_CTRL_H
+
+/* End of file -------------------------------------------------------- */
@@ -12,15 +12,58 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "bsp_gyro.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "nvs.h"
 
 /* Private defines ---------------------------------------------------- */
+#define BSP_GYRO_RING_LEN               (32)    // Timestamped samples buffered for the consumer
+#define BSP_GYRO_INT_TIMEOUT_MS         (1000)  // No data ready interrupt for this long is a fault
+#define BSP_GYRO_TASK_STACK_SIZE        (2048)
+#define BSP_GYRO_TASK_PRIORITY          (9)     // Below the I2C bus task
+#define BSP_GYRO_INIT_POLL_MS           (10)    // Reset complete polling period, one tick
+#define BSP_GYRO_NVS_NAMESPACE          "gyro"
+#define BSP_GYRO_NVS_KEY_BIAS           "bias_cal"
+#define BSP_GYRO_NVS_BIAS_VERSION       (1)     // Bump when gyro_bias_cal_t or the full scale changes
+#define BSP_GYRO_SAVE_INTERVAL_US       (600000000LL) // Bias saved at most every 10 minutes
+
 /* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Bias calibration as kept in NVS
+ */
+typedef struct
+{
+  uint32_t version;         // BSP_GYRO_NVS_BIAS_VERSION
+  gyro_bias_cal_t cal;
+}
+bsp_gyro_bias_blob_t;
+
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
+static const char *TAG = "bsp_gyro";
+
 static iam20380_t m_iam20380;
+static SemaphoreHandle_t m_gyro_lock;       // Driver access, acquisition task and API callers
+static QueueHandle_t m_gyro_ring;           // Timestamped samples, oldest dropped when full
+static TaskHandle_t m_gyro_task;
+static bsp_gyro_stats_t m_gyro_stats;
+static gyro_bias_t m_gyro_bias;
+static int64_t m_gyro_start_us;             // Time bsp_gyro_init() issued the reset
+static volatile bool m_gyro_ready;          // Init completed by the gyro task
+
+static portMUX_TYPE m_gyro_isr_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t m_gyro_isr_us;               // Time of the last data ready interrupt
 
 /* Private function prototypes ---------------------------------------- */
+static void m_bsp_gyro_isr_handler(void *arg);
+static void m_bsp_gyro_task(void *param);
+static base_status_t m_bsp_gyro_start(void);
+static void m_bsp_gyro_push(const iam20380_sample_t *sample);
+static void m_bsp_gyro_correct(iam20380_sample_t *sample);
+static bool m_bsp_gyro_bias_load(gyro_bias_cal_t *cal);
+static void m_bsp_gyro_bias_save(const gyro_bias_cal_t *cal);
+
 /* Function definitions ----------------------------------------------- */
 base_status_t bsp_gyro_init(void)
 {
@@ -29,37 +72,389 @@ base_status_t bsp_gyro_init(void)
   m_iam20380.i2c_read                     = bsp_i2c_read;
   m_iam20380.i2c_write                    = bsp_i2c_write;
   m_iam20380.delay_ms                     = bsp_delay_ms;
+  bsp_i2c_register_client(m_iam20380.device_address, BSP_I2C_CLASS_GYRO);
   // Configuration
   m_iam20380.config.sample_rate           = IAM20380_SAMPLE_RATE_10HZ;
   m_iam20380.config.digi_low_pass_filter  = IAM20380_DLPF4_NBW31;
   m_iam20380.config.fullscale             = IAM20380_FULLSCALE_1000_DPS;
   m_iam20380.config.low_power_mode_cfg    = (IAM20380_LP_MODE_CFG_GYRO_CYCLE | IAM20380_LP_MODE_CFG_G_AVGCFG_128X); // Enable low power mode
 
-  CHECK_STATUS(iam20380_init(&m_iam20380));
+  // Reset issued here, the gyro task completes the init while the boot goes on
+  m_gyro_start_us = esp_timer_get_time();
+  CHECK_STATUS(iam20380_init_start(&m_iam20380, (uint32_t)(m_gyro_start_us / 1000)));
+
+  // Data ready acquisition, the ISR service is installed by bsp_io_init()
+  m_gyro_lock = xSemaphoreCreateMutex();
+  m_gyro_ring = xQueueCreate(BSP_GYRO_RING_LEN, sizeof(iam20380_sample_t));
+  CHECK((m_gyro_lock != NULL) && (m_gyro_ring != NULL), BS_ERROR);
+
+  memset(&m_gyro_stats, 0, sizeof(m_gyro_stats));
+  m_gyro_stats.min_interval_us = UINT32_MAX;
+
+  CHECK(pdPASS == xTaskCreate(&m_bsp_gyro_task, "Gyro task", BSP_GYRO_TASK_STACK_SIZE, NULL, BSP_GYRO_TASK_PRIORITY, &m_gyro_task), BS_ERROR);
+
+  gpio_pad_select_gpio(IO_GYRO_INT);
+  gpio_set_direction(IO_GYRO_INT, GPIO_MODE_INPUT);
+  gpio_set_intr_type(IO_GYRO_INT, GPIO_INTR_POSEDGE);
+  gpio_isr_handler_add(IO_GYRO_INT, m_bsp_gyro_isr_handler, NULL);
+  gpio_intr_enable(IO_GYRO_INT);
 
   return BS_OK;
 }
 
 base_status_t bsp_gyro_get_raw_data(void)
 {
-  CHECK_STATUS(iam20380_get_raw_data(&m_iam20380));
+  base_status_t ret;
 
-  return BS_OK;
+  CHECK(m_gyro_ready, BS_ERROR);
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  ret = iam20380_get_raw_data(&m_iam20380);
+  xSemaphoreGive(m_gyro_lock);
+
+  return ret;
 }
 
 base_status_t bsp_gyro_get_gyro_angle(void)
 {
-  CHECK_STATUS(iam20380_get_gyro_angle(&m_iam20380));
+  base_status_t ret;
 
-  return BS_OK;
+  CHECK(m_gyro_ready, BS_ERROR);
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  ret = iam20380_get_gyro_angle(&m_iam20380);
+  xSemaphoreGive(m_gyro_lock);
+
+  return ret;
 }
 
 base_status_t bsp_gyro_get_sensitivity(void)
 {
-  CHECK_STATUS(iam20380_get_sensitivity(&m_iam20380));
+  base_status_t ret;
+
+  CHECK(m_gyro_ready, BS_ERROR);
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  ret = iam20380_get_sensitivity(&m_iam20380);
+  xSemaphoreGive(m_gyro_lock);
+
+  return ret;
+}
+
+bool bsp_gyro_is_ready(void)
+{
+  return m_gyro_ready;
+}
+
+uint32_t bsp_gyro_read_samples(iam20380_sample_t *samples, uint32_t max)
+{
+  uint32_t count = 0;
 
-  return BS_OK; 
+  if ((samples == NULL) || (m_gyro_ring == NULL))
+    return 0;
+
+  while ((count < max) && (pdTRUE == xQueueReceive(m_gyro_ring, &samples[count], 0)))
+    count++;
+
+  return count;
+}
+
+void bsp_gyro_get_bias_metrics(gyro_bias_metrics_t *metrics)
+{
+  if (metrics == NULL)
+    return;
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  *metrics = m_gyro_bias.metrics;
+  xSemaphoreGive(m_gyro_lock);
+}
+
+void bsp_gyro_get_stats(bsp_gyro_stats_t *stats)
+{
+  if (stats == NULL)
+    return;
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  *stats = m_gyro_stats;
+  xSemaphoreGive(m_gyro_lock);
 }
 
 /* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Data ready interrupt, timestamps the sample and wakes the acquisition task
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     Runs in ISR context, no bus access here
+ *
+ * @return        None
+ */
+static void IRAM_ATTR m_bsp_gyro_isr_handler(void *arg)
+{
+  BaseType_t woken = pdFALSE;
+
+  portENTER_CRITICAL_ISR(&m_gyro_isr_mux);
+  m_gyro_isr_us = esp_timer_get_time();
+  portEXIT_CRITICAL_ISR(&m_gyro_isr_mux);
+
+  vTaskNotifyGiveFromISR(m_gyro_task, &woken);
+  if (woken == pdTRUE)
+    portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief         Acquisition task, blocked until the data ready interrupt so the CPU sleeps between samples
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     A sample carries the interrupt time, not the read time, the I2C latency
+ *                does not add to the sampling jitter
+ *
+ * @return        None
+ */
+static void m_bsp_gyro_task(void *param)
+{
+  iam20380_sample_t sample;
+  gyro_bias_cal_t cal;
+  bool save;
+  int64_t last_save_us = 0;
+  int64_t last_isr_us = 0;
+  int64_t isr_us;
+  uint32_t interval_us;
+  uint32_t latency_us;
+  uint32_t pending;
+  base_status_t ret;
+
+  if (BS_OK != m_bsp_gyro_start())
+  {
+    ESP_LOGE(TAG, "Init failed");
+    vTaskDelete(NULL);
+    return;
+  }
+
+  while (1)
+  {
+    pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BSP_GYRO_INT_TIMEOUT_MS));
+
+    if (pending == 0)
+    {
+      xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+      m_gyro_stats.timeouts++;
+      xSemaphoreGive(m_gyro_lock);
+
+      ESP_LOGW(TAG, "No data ready interrupt for %d ms", BSP_GYRO_INT_TIMEOUT_MS);
+      continue;
+    }
+
+    portENTER_CRITICAL(&m_gyro_isr_mux);
+    isr_us = m_gyro_isr_us;
+    portEXIT_CRITICAL(&m_gyro_isr_mux);
+
+    xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+
+    // Interrupts that came in before the read are samples overwritten in the output registers
+    m_gyro_stats.missed += pending - 1;
+
+    ret = iam20380_read_sample(&m_iam20380, (uint64_t)isr_us, &sample);
+    if (ret == BS_OK)
+    {
+      latency_us = (uint32_t)(esp_timer_get_time() - isr_us);
+      if (latency_us > m_gyro_stats.max_latency_us)
+        m_gyro_stats.max_latency_us = latency_us;
+
+      if ((last_isr_us != 0) && (pending == 1))
+      {
+        interval_us = (uint32_t)(isr_us - last_isr_us);
+        if (interval_us < m_gyro_stats.min_interval_us)
+          m_gyro_stats.min_interval_us = interval_us;
+        if (interval_us > m_gyro_stats.max_interval_us)
+          m_gyro_stats.max_interval_us = interval_us;
+      }
+      last_isr_us = isr_us;
+
+      m_gyro_stats.samples++;
+
+      m_bsp_gyro_correct(&sample);
+    }
+    else
+    {
+      m_gyro_stats.read_errors++;
+    }
+
+    save = m_gyro_bias.dirty && ((last_save_us == 0) || (isr_us - last_save_us >= BSP_GYRO_SAVE_INTERVAL_US));
+    if (save)
+    {
+      cal                = m_gyro_bias.cal;
+      m_gyro_bias.dirty  = false;
+      last_save_us       = isr_us;
+    }
+
+    xSemaphoreGive(m_gyro_lock);
+
+    if (ret == BS_OK)
+      m_bsp_gyro_push(&sample);
+
+    if (save)
+      m_bsp_gyro_bias_save(&cal);
+  }
+}
+
+/**
+ * @brief         Complete the non blocking init and set up the bias estimator
+ *
+ * @param[in]     None
+ *
+ * @attention     Runs in the gyro task, data ready interrupts raised meanwhile are dropped
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+static base_status_t m_bsp_gyro_start(void)
+{
+  gyro_bias_cal_t cal;
+  base_status_t status;
+  bool warm;
+
+  do
+  {
+    vTaskDelay(pdMS_TO_TICKS(BSP_GYRO_INIT_POLL_MS));
+
+    xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+    status = iam20380_init_poll(&m_iam20380, (uint32_t)(esp_timer_get_time() / 1000));
+    xSemaphoreGive(m_gyro_lock);
+
+    CHECK_STATUS(status);
+  } while (m_iam20380.init_state != IAM20380_INIT_DONE);
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  status = iam20380_get_sensitivity(&m_iam20380);
+  xSemaphoreGive(m_gyro_lock);
+  CHECK_STATUS(status);
+
+  // Bias from the last run, a warm start skips the calibration
+  warm = m_bsp_gyro_bias_load(&cal);
+  gyro_bias_init(&m_gyro_bias, m_iam20380.data.sensitivity_x10, warm ? &cal : NULL);
+
+  ulTaskNotifyTake(pdTRUE, 0);
+  m_gyro_ready = true;
+
+  ESP_LOGI(TAG, "Ready %lld ms after init, bias %s start",
+           (esp_timer_get_time() - m_gyro_start_us) / 1000, warm ? "warm" : "cold");
+
+  return BS_OK;
+}
+
+/**
+ * @brief         Push a sample to the ring, dropping the oldest one when full
+ *
+ * @param[in]     sample  Pointer to sample
+ *
+ * @attention     Only called by the acquisition task
+ *
+ * @return        None
+ */
+static void m_bsp_gyro_push(const iam20380_sample_t *sample)
+{
+  iam20380_sample_t oldest;
+
+  if (pdTRUE == xQueueSend(m_gyro_ring, sample, 0))
+    return;
+
+  xQueueReceive(m_gyro_ring, &oldest, 0);
+  xQueueSend(m_gyro_ring, sample, 0);
+
+  xSemaphoreTake(m_gyro_lock, portMAX_DELAY);
+  m_gyro_stats.dropped++;
+  xSemaphoreGive(m_gyro_lock);
+}
+
+/**
+ * @brief         Feed the bias estimator with a raw sample and remove the bias from it
+ *
+ * @param[in,out] sample  Pointer to sample
+ *
+ * @attention     Called with the driver lock held, the driver bias follows the estimator
+ *
+ * @return        None
+ */
+static void m_bsp_gyro_correct(iam20380_sample_t *sample)
+{
+  int16_t rate[3] = { sample->raw.x, sample->raw.y, sample->raw.z };
+  int16_t bias[3];
+
+  gyro_bias_update(&m_gyro_bias, rate, m_iam20380.data.temp_cdeg, sample->timestamp_us);
+  gyro_bias_get(&m_gyro_bias, m_iam20380.data.temp_cdeg, bias);
+
+  m_iam20380.data.bias.x = bias[0];
+  m_iam20380.data.bias.y = bias[1];
+  m_iam20380.data.bias.z = bias[2];
+
+  sample->raw.x -= bias[0];
+  sample->raw.y -= bias[1];
+  sample->raw.z -= bias[2];
+}
+
+/**
+ * @brief         Load the bias calibration from NVS
+ *
+ * @param[out]    cal     Pointer to calibration
+ *
+ * @attention     None
+ *
+ * @return
+ * - true       Calibration loaded
+ * - false      None saved yet, or saved by another version
+ */
+static bool m_bsp_gyro_bias_load(gyro_bias_cal_t *cal)
+{
+  bsp_gyro_bias_blob_t blob;
+  nvs_handle_t handle;
+  size_t len = sizeof(blob);
+  esp_err_t err;
+
+  if (ESP_OK != nvs_open(BSP_GYRO_NVS_NAMESPACE, NVS_READONLY, &handle))
+    return false;
+
+  err = nvs_get_blob(handle, BSP_GYRO_NVS_KEY_BIAS, &blob, &len);
+  nvs_close(handle);
+
+  if ((err != ESP_OK) || (len != sizeof(blob)) || (blob.version != BSP_GYRO_NVS_BIAS_VERSION))
+    return false;
+
+  *cal = blob.cal;
+
+  return true;
+}
+
+/**
+ * @brief         Save the bias calibration to NVS
+ *
+ * @param[in]     cal     Pointer to calibration
+ *
+ * @attention     Flash write, called outside the driver lock
+ *
+ * @return        None
+ */
+static void m_bsp_gyro_bias_save(const gyro_bias_cal_t *cal)
+{
+  bsp_gyro_bias_blob_t blob = { .version = BSP_GYRO_NVS_BIAS_VERSION, .cal = *cal };
+  nvs_handle_t handle;
+  esp_err_t err;
+
+  err = nvs_open(BSP_GYRO_NVS_NAMESPACE, NVS_READWRITE, &handle);
+  if (err == ESP_OK)
+  {
+    err = nvs_set_blob(handle, BSP_GYRO_NVS_KEY_BIAS, &blob, sizeof(blob));
+    if (err == ESP_OK)
+      err = nvs_commit(handle);
+    nvs_close(handle);
+  }
+
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "Bias save failed %d", err);
+  else
+    ESP_LOGI(TAG, "Bias saved at %d cdeg", cal->temp_cdeg);
+}
+
 /* End of file -------------------------------------------------------- */
\ No newline at end of file
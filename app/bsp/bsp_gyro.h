@@ -20,9 +20,26 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
 #include "iam20380.h"
+#include "gyro_bias.h"
 
 /* Public defines ----------------------------------------------------- */
 /* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief BSP GyroScope data ready acquisition statistics
+ */
+typedef struct
+{
+  uint32_t samples;         // Samples read on a data ready interrupt
+  uint32_t missed;          // Interrupts served late, their sample was overwritten
+  uint32_t dropped;         // Samples dropped from the full ring, oldest first
+  uint32_t read_errors;     // Failed reads of the output registers
+  uint32_t timeouts;        // Seconds without any interrupt
+  uint32_t min_interval_us; // Interrupt to interrupt, UINT32_MAX until two samples
+  uint32_t max_interval_us;
+  uint32_t max_latency_us;  // Interrupt to end of the read
+}
+bsp_gyro_stats_t;
+
 /* Public macros ------------------------------------------------------ */
 /* Public variables --------------------------------------------------- */
 /* Public function prototypes ----------------------------------------- */
@@ -31,7 +48,7 @@ extern "C" {
  *
  * @param[in]     None
 
- * @attention     None
+ * @attention     Non blocking, the gyro task completes the init, see bsp_gyro_is_ready()
  *
  * @return
  * - BS_OK
@@ -78,6 +95,54 @@ base_status_t bsp_gyro_get_gyro_angle(void);
  */
 base_status_t bsp_gyro_get_sensitivity(void);
 
+/**
+ * @brief         BSP GyroScope check the init has completed
+ *
+ * @param[in]     None
+ *
+ * @attention     The other functions return BS_ERROR until then
+ *
+ * @return
+ * - true       Ready
+ * - false      Init in progress or failed
+ */
+bool bsp_gyro_is_ready(void);
+
+/**
+ * @brief         BSP GyroScope take samples from the data ready ring
+ *
+ * @param[out]    samples   Pointer to samples, oldest first
+ * @param[in]     max       Maximum number of samples
+ *
+ * @attention     Non blocking, samples are stamped with the time of their interrupt
+ *                and have the estimated bias removed
+ *
+ * @return        Number of samples taken
+ */
+uint32_t bsp_gyro_read_samples(iam20380_sample_t *samples, uint32_t max);
+
+/**
+ * @brief         BSP GyroScope get the residual drift metrics of the bias estimator
+ *
+ * @param[out]    metrics   Pointer to metrics
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void bsp_gyro_get_bias_metrics(gyro_bias_metrics_t *metrics);
+
+/**
+ * @brief         BSP GyroScope get the data ready acquisition statistics
+ *
+ * @param[out]    stats     Pointer to statistics
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void bsp_gyro_get_stats(bsp_gyro_stats_t *stats);
+
 /* -------------------------------------------------------------------------- */
 #ifdef __cplusplus
 } // extern "C"
@@ -14,7 +14,19 @@
 #include "bsp_i2c.h"
 // #include "driver/i2c.h"
 #include "sys_damos_ram.h"
+#include "bsp_i2c_trace.h"
 #include "i2c_bus.h"
+#include "audio_idf_version.h"
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0))
+#include "esp_rom_sys.h"
+#define bsp_i2c_delay_us(us)            esp_rom_delay_us(us)
+#else
+#include "rom/ets_sys.h"
+#define bsp_i2c_delay_us(us)            ets_delay_us(us)
+#endif
+#if defined(BSP_I2C_USE_SIM)
+#include "i2c_sim.h"
+#endif
 
 /* Private defines ---------------------------------------------------------- */
 #define BSP_I2C_MODE                    I2C_MODE_MASTER
@@ -22,63 +34,388 @@
 #define BSP_I2C_SCL_IO                  IO_I2C_SCL
 #define BSP_I2C_IO_PULLUP_ENABLE        GPIO_PULLUP_ENABLE
 #define BSP_I2C_CLK_SPEED               (400000)
+#define BSP_I2C_SCL_TIMEOUT             (80000) // APB cycles, 1 ms of clock stretching at 80 MHz
+
+#define BSP_I2C_RETRY_BEFORE_CLEAR      (2)     // Plain retries before the bus is cleared
+#define BSP_I2C_RETRY_BUDGET            (BSP_I2C_RETRY_BEFORE_CLEAR + 2) // Retries, one clear and one reinstall
+#define BSP_I2C_BACKOFF_US              (50)    // First retry delay, doubled on each retry
+
+// Define BSP_I2C_USE_SIM to serve all transfers from the virtual bus in components/i2c_sim
+#define BSP_I2C_SIM_OVERHEAD_US         (30)    // Command link and ISR cost of one transfer
+
+#define BSP_I2C_QUEUE_LEN               (16)    // Pending transfers per priority class
+#define BSP_I2C_MAX_CLIENTS             (8)
+#define BSP_I2C_TASK_STACK_SIZE         (3072)
+#define BSP_I2C_TASK_PRIORITY           (10)
+
+/* Private enumerate/structure ---------------------------------------------- */
+/**
+ * @brief BSP I2C asynchronous transfer request
+ */
+typedef struct
+{
+  bsp_i2c_xfer_type_t type;
+  uint8_t slave_addr;
+  uint8_t reg_addr;
+  uint8_t *data;
+  uint32_t len;
+  bsp_i2c_done_cb_t cb;
+  void *arg;
+  int64_t submit_us;        // Time the request was queued
+}
+bsp_i2c_req_t;
+
+/**
+ * @brief BSP I2C synchronous wait context
+ */
+typedef struct
+{
+  SemaphoreHandle_t done;
+  int result;
+}
+bsp_i2c_sync_t;
+
+/**
+ * @brief BSP I2C recovery step
+ */
+typedef enum
+{
+  BSP_I2C_RECOVERY_RETRY = 0,   // Retry the transfer after a backoff delay
+  BSP_I2C_RECOVERY_CLEAR,       // Clock out a stuck slave, then retry
+  BSP_I2C_RECOVERY_REINSTALL,   // Reinstall the I2C driver, then retry
+  BSP_I2C_RECOVERY_GIVE_UP      // Ladder exhausted, report the error
+}
+bsp_i2c_recovery_t;
+
+/**
+ * @brief BSP I2C client, maps a slave address to a priority class
+ */
+typedef struct
+{
+  uint8_t slave_addr;
+  bsp_i2c_class_t class;
+}
+bsp_i2c_client_t;
 
 /* Public variables --------------------------------------------------------- */
 static const char *TAG = "bsp_i2c";
+#if !defined(BSP_I2C_USE_SIM)
 static i2c_bus_handle_t m_i2c_hdl;
+#endif
 
 /* Private variables -------------------------------------------------------- */
+static QueueHandle_t m_i2c_queue[BSP_I2C_CLASS_MAX];
+static SemaphoreHandle_t m_i2c_pending;       // Counts requests queued over all classes
+static TaskHandle_t m_i2c_task;
+static bsp_i2c_client_t m_i2c_client[BSP_I2C_MAX_CLIENTS];
+static uint8_t m_i2c_client_cnt;
+static bsp_i2c_class_stats_t m_i2c_stats[BSP_I2C_CLASS_MAX];
+static bsp_i2c_dev_stats_t m_i2c_dev_stats[BSP_I2C_MAX_CLIENTS + 1];  // Last entry for unregistered addresses
+static portMUX_TYPE m_i2c_stats_mux = portMUX_INITIALIZER_UNLOCKED;    // Both stats tables, any task reads and resets
+
 /* Private function prototypes ---------------------------------------------- */
-// static inline esp_err_t bsp_i2c_init(void);
+static int m_bsp_i2c_xfer(bsp_i2c_req_t *req);
+static int m_bsp_i2c_attempt(bsp_i2c_req_t *req, uint8_t attempt);
+static bsp_i2c_dev_stats_t *m_bsp_i2c_get_dev_stats(uint8_t slave_addr);
+static esp_err_t m_bsp_i2c_bus_create(void);
+#if defined(BSP_I2C_USE_SIM)
+static uint64_t m_bsp_i2c_sim_time(void);
+#endif
+static bsp_i2c_class_t m_bsp_i2c_get_class(uint8_t slave_addr);
+static int m_bsp_i2c_submit(bsp_i2c_req_t *req, TickType_t ticks_to_wait);
+static int m_bsp_i2c_run(bsp_i2c_req_t *req);
+static void m_bsp_i2c_sync_done(int result, void *arg);
+static int m_bsp_i2c_transfer(bsp_i2c_req_t *req);
+static void m_bsp_i2c_task(void *param);
 
 /* Function definitions ----------------------------------------------------- */
 int bsp_i2c_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
 {
-  int ret = 0;
-  ret =  i2c_bus_write_bytes(m_i2c_hdl, slave_addr, &reg_addr, sizeof(reg_addr), data, len);
-  if (ret != 0)
+  bsp_i2c_req_t req =
   {
-    ESP_LOGE(TAG, "I2C error: %d. Restart i2c.", ret);
-    i2c_bus_delete(m_i2c_hdl);
-    bsp_i2c_init();
-    ret = i2c_bus_write_bytes(m_i2c_hdl, slave_addr, &reg_addr, sizeof(reg_addr), data, len);
-  }
-  return ret;
+    .type       = BSP_I2C_XFER_WRITE,
+    .slave_addr = slave_addr,
+    .reg_addr   = reg_addr,
+    .data       = data,
+    .len        = len
+  };
+
+  return m_bsp_i2c_run(&req);
 }
 
 int bsp_i2c_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
 {
-  int ret = 0;
-  ret = i2c_bus_read_bytes(m_i2c_hdl, slave_addr, &reg_addr, sizeof(reg_addr), data, len);
-  if (ret != 0)
+  bsp_i2c_req_t req =
   {
-    ESP_LOGE(TAG, "i2c 0 error: %d. Restart i2c.", ret);
-    i2c_bus_delete(m_i2c_hdl);
-    bsp_i2c_init();
-    ret = i2c_bus_read_bytes(m_i2c_hdl, slave_addr, &reg_addr, sizeof(reg_addr), data, len);
-  }
-  return ret;
+    .type       = BSP_I2C_XFER_READ,
+    .slave_addr = slave_addr,
+    .reg_addr   = reg_addr,
+    .data       = data,
+    .len        = len
+  };
+
+  return m_bsp_i2c_run(&req);
 }
 
 int bsp_i2c_write_data(uint8_t slave_addr, uint8_t *data, uint32_t len)
 {
-  int ret = 0;
-  ret = i2c_bus_write_data(m_i2c_hdl, slave_addr, data, len);
-  if (ret != 0)
+  bsp_i2c_req_t req =
+  {
+    .type       = BSP_I2C_XFER_WRITE_DATA,
+    .slave_addr = slave_addr,
+    .data       = data,
+    .len        = len
+  };
+
+  return m_bsp_i2c_run(&req);
+}
+
+int bsp_i2c_read_async(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len,
+                       bsp_i2c_done_cb_t cb, void *arg)
+{
+  bsp_i2c_req_t req =
+  {
+    .type       = BSP_I2C_XFER_READ,
+    .slave_addr = slave_addr,
+    .reg_addr   = reg_addr,
+    .data       = data,
+    .len        = len,
+    .cb         = cb,
+    .arg        = arg
+  };
+
+  return m_bsp_i2c_submit(&req, 0);
+}
+
+int bsp_i2c_write_async(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len,
+                        bsp_i2c_done_cb_t cb, void *arg)
+{
+  bsp_i2c_req_t req =
+  {
+    .type       = BSP_I2C_XFER_WRITE,
+    .slave_addr = slave_addr,
+    .reg_addr   = reg_addr,
+    .data       = data,
+    .len        = len,
+    .cb         = cb,
+    .arg        = arg
+  };
+
+  return m_bsp_i2c_submit(&req, 0);
+}
+
+int bsp_i2c_write_data_async(uint8_t slave_addr, uint8_t *data, uint32_t len,
+                             bsp_i2c_done_cb_t cb, void *arg)
+{
+  bsp_i2c_req_t req =
+  {
+    .type       = BSP_I2C_XFER_WRITE_DATA,
+    .slave_addr = slave_addr,
+    .data       = data,
+    .len        = len,
+    .cb         = cb,
+    .arg        = arg
+  };
+
+  return m_bsp_i2c_submit(&req, 0);
+}
+
+esp_err_t bsp_i2c_init(void)
+{
+  esp_err_t res = m_bsp_i2c_bus_create();
+
+  if (m_i2c_pending == NULL)
   {
-    ESP_LOGE(TAG, "i2c error: %d", ret);
-    i2c_bus_delete(m_i2c_hdl);
-    bsp_i2c_init();
-    ret = i2c_bus_write_data(m_i2c_hdl, slave_addr, data, len);
+    for (int i = 0; i < BSP_I2C_CLASS_MAX; i++)
+    {
+      m_i2c_queue[i] = xQueueCreate(BSP_I2C_QUEUE_LEN, sizeof(bsp_i2c_req_t));
+      if (m_i2c_queue[i] == NULL)
+        return ESP_ERR_NO_MEM;
+    }
+
+    m_i2c_pending = xSemaphoreCreateCounting(BSP_I2C_CLASS_MAX * BSP_I2C_QUEUE_LEN, 0);
+    if (m_i2c_pending == NULL)
+      return ESP_ERR_NO_MEM;
+
+    xTaskCreate(&m_bsp_i2c_task, "I2C bus task", BSP_I2C_TASK_STACK_SIZE, NULL, BSP_I2C_TASK_PRIORITY, &m_i2c_task);
   }
-  return ret;
+
+  return res;
+}
+
+void bsp_i2c_register_client(uint8_t slave_addr, bsp_i2c_class_t class)
+{
+  for (int i = 0; i < m_i2c_client_cnt; i++)
+  {
+    if (m_i2c_client[i].slave_addr == slave_addr)
+    {
+      m_i2c_client[i].class = class;
+      return;
+    }
+  }
+
+  if (m_i2c_client_cnt < BSP_I2C_MAX_CLIENTS)
+  {
+    m_i2c_client[m_i2c_client_cnt].slave_addr = slave_addr;
+    m_i2c_client[m_i2c_client_cnt].class      = class;
+    m_i2c_client_cnt++;
+  }
+}
+
+int bsp_i2c_get_class_stats(bsp_i2c_class_t class, bsp_i2c_class_stats_t *stats)
+{
+  if ((class >= BSP_I2C_CLASS_MAX) || (stats == NULL))
+    return 1;
+
+  portENTER_CRITICAL(&m_i2c_stats_mux);
+  *stats = m_i2c_stats[class];
+  portEXIT_CRITICAL(&m_i2c_stats_mux);
+
+  return 0;
+}
+
+void bsp_i2c_reset_class_stats(void)
+{
+  portENTER_CRITICAL(&m_i2c_stats_mux);
+  memset(m_i2c_stats, 0, sizeof(m_i2c_stats));
+  portEXIT_CRITICAL(&m_i2c_stats_mux);
+}
+
+int bsp_i2c_get_dev_stats(uint8_t slave_addr, bsp_i2c_dev_stats_t *stats)
+{
+  bsp_i2c_dev_stats_t *dev;
+
+  if (stats == NULL)
+    return 1;
+
+  dev = m_bsp_i2c_get_dev_stats(slave_addr);
+
+  portENTER_CRITICAL(&m_i2c_stats_mux);
+  *stats = *dev;
+  portEXIT_CRITICAL(&m_i2c_stats_mux);
+
+  return 0;
+}
+
+void bsp_i2c_reset_dev_stats(void)
+{
+  portENTER_CRITICAL(&m_i2c_stats_mux);
+  memset(m_i2c_dev_stats, 0, sizeof(m_i2c_dev_stats));
+  portEXIT_CRITICAL(&m_i2c_stats_mux);
+}
+
+uint32_t bsp_i2c_get_allocs_per_sec(void)
+{
+#if defined(BSP_I2C_USE_SIM)
+  return 0;     // No command links on the virtual bus
+#else
+  return i2c_bus_get_allocs_per_sec(m_i2c_hdl);
+#endif
 }
 
 /* Private function definitions--------------------------------------------------------- */
-esp_err_t bsp_i2c_init(void)
+/**
+ * @brief         Run a transfer on the bus
+ *
+ * @param[in]     req     Pointer to transfer request
+ *
+ * @attention     Only called from the bus task or before it starts
+ *
+ * @return
+ * - 0      Succes
+ * - Others Error
+ */
+static int m_bsp_i2c_xfer(bsp_i2c_req_t *req)
+{
+#if defined(BSP_I2C_USE_SIM)
+  switch (req->type)
+  {
+  case BSP_I2C_XFER_READ:
+    return i2c_sim_read(req->slave_addr, req->reg_addr, req->data, req->len);
+  case BSP_I2C_XFER_WRITE:
+    return i2c_sim_write(req->slave_addr, req->reg_addr, req->data, req->len);
+  case BSP_I2C_XFER_WRITE_DATA:
+    return i2c_sim_write_data(req->slave_addr, req->data, req->len);
+  default:
+    return 1;
+  }
+#else
+  switch (req->type)
+  {
+  case BSP_I2C_XFER_READ:
+    return i2c_bus_read_bytes(m_i2c_hdl, req->slave_addr, &req->reg_addr, sizeof(req->reg_addr), req->data, req->len);
+  case BSP_I2C_XFER_WRITE:
+    return i2c_bus_write_bytes(m_i2c_hdl, req->slave_addr, &req->reg_addr, sizeof(req->reg_addr), req->data, req->len);
+  case BSP_I2C_XFER_WRITE_DATA:
+    return i2c_bus_write_data(m_i2c_hdl, req->slave_addr, req->data, req->len);
+  default:
+    return 1;
+  }
+#endif
+}
+
+/**
+ * @brief         Run one attempt of a transfer on the bus and trace it
+ *
+ * @param[in]     req       Pointer to transfer request
+ * @param[in]     attempt   Attempt number, 0 for the first one
+ *
+ * @attention     Only called from the bus task or before it starts
+ *
+ * @return
+ * - 0      Succes
+ * - Others Error
+ */
+static int m_bsp_i2c_attempt(bsp_i2c_req_t *req, uint8_t attempt)
+{
+  int64_t start_us = esp_timer_get_time();
+  int ret;
+
+  ret = m_bsp_i2c_xfer(req);
+
+  bsp_i2c_trace_record(req->slave_addr, req->reg_addr, req->len, req->type, attempt,
+                       start_us, (uint32_t)(esp_timer_get_time() - start_us), ret);
+
+  return ret;
+}
+
+/**
+ * @brief         Get error counters of a slave address
+ *
+ * @param[in]     slave_addr    Slave address
+ *
+ * @attention     Unregistered addresses share one set of counters
+ *
+ * @return        Pointer to error counters
+ */
+static bsp_i2c_dev_stats_t *m_bsp_i2c_get_dev_stats(uint8_t slave_addr)
+{
+  for (int i = 0; i < m_i2c_client_cnt; i++)
+  {
+    if (m_i2c_client[i].slave_addr == slave_addr)
+      return &m_i2c_dev_stats[i];
+  }
+
+  return &m_i2c_dev_stats[BSP_I2C_MAX_CLIENTS];
+}
+
+/**
+ * @brief         Create the I2C bus on the board pins
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        ESP_OK
+ */
+static esp_err_t m_bsp_i2c_bus_create(void)
 {
   esp_err_t res = 0;
-  i2c_config_t es_i2c_cfg = 
+#if defined(BSP_I2C_USE_SIM)
+  i2c_sim_init(BSP_I2C_CLK_SPEED, BSP_I2C_SIM_OVERHEAD_US);
+  i2c_sim_set_time_source(m_bsp_i2c_sim_time);
+#else
+  i2c_config_t es_i2c_cfg =
   {
     .mode             = BSP_I2C_MODE,
     .sda_io_num       = BSP_I2C_SDA_IO,
@@ -88,10 +425,273 @@ esp_err_t bsp_i2c_init(void)
     .master.clk_speed = BSP_I2C_CLK_SPEED
   };
 
-  m_i2c_hdl = i2c_bus_create(I2C_NUM_0, &es_i2c_cfg);
-  i2c_set_timeout(I2C_NUM_0, 0xfffff);
+  m_i2c_hdl = i2c_bus_create_with_mode(I2C_NUM_0, &es_i2c_cfg, I2C_BUS_CMD_LINK_STATIC);
+  i2c_set_timeout(I2C_NUM_0, BSP_I2C_SCL_TIMEOUT);
+#endif
 
   return res;
 }
 
-/* End of file -------------------------------------------------------- */
\ No newline at end of file
+#if defined(BSP_I2C_USE_SIM)
+/**
+ * @brief         Time source of the virtual bus
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Time since boot in microsecond
+ */
+static uint64_t m_bsp_i2c_sim_time(void)
+{
+  return (uint64_t)esp_timer_get_time();
+}
+#endif
+
+/**
+ * @brief         Get the priority class of a slave address
+ *
+ * @param[in]     slave_addr    Slave address
+ *
+ * @attention     Unregistered addresses fall into the lowest class
+ *
+ * @return        Priority class
+ */
+static bsp_i2c_class_t m_bsp_i2c_get_class(uint8_t slave_addr)
+{
+  for (int i = 0; i < m_i2c_client_cnt; i++)
+  {
+    if (m_i2c_client[i].slave_addr == slave_addr)
+      return m_i2c_client[i].class;
+  }
+
+  return (bsp_i2c_class_t)(BSP_I2C_CLASS_MAX - 1);
+}
+
+/**
+ * @brief         Queue a transfer on the queue of its priority class
+ *
+ * @param[in]     req             Pointer to transfer request
+ * @param[in]     ticks_to_wait   Time to wait for room in the queue
+ *
+ * @attention     None
+ *
+ * @return
+ * - 0      Queued
+ * - 1      Error, bus not initialized or queue full
+ */
+static int m_bsp_i2c_submit(bsp_i2c_req_t *req, TickType_t ticks_to_wait)
+{
+  if ((m_i2c_pending == NULL) || (req->data == NULL))
+    return 1;
+
+  req->submit_us = esp_timer_get_time();
+
+  if (pdTRUE != xQueueSend(m_i2c_queue[m_bsp_i2c_get_class(req->slave_addr)], req, ticks_to_wait))
+    return 1;
+
+  xSemaphoreGive(m_i2c_pending);
+
+  return 0;
+}
+
+/**
+ * @brief         Run a transfer through the bus task and wait for its result
+ *
+ * @param[in]     req     Pointer to transfer request
+ *
+ * @attention     Runs the transfer directly before the bus task exists
+ *                and when called from the bus task itself
+ *
+ * @return
+ * - 0      Succes
+ * - Others Error
+ */
+static int m_bsp_i2c_run(bsp_i2c_req_t *req)
+{
+  StaticSemaphore_t done_buf;
+  bsp_i2c_sync_t sync;
+
+  if ((m_i2c_task == NULL) || (xTaskGetCurrentTaskHandle() == m_i2c_task))
+    return m_bsp_i2c_transfer(req);
+
+  sync.done   = xSemaphoreCreateBinaryStatic(&done_buf);
+  sync.result = 1;
+  req->cb     = m_bsp_i2c_sync_done;
+  req->arg    = &sync;
+
+  if (0 == m_bsp_i2c_submit(req, portMAX_DELAY))
+    xSemaphoreTake(sync.done, portMAX_DELAY);
+
+  vSemaphoreDelete(sync.done);
+
+  return sync.result;
+}
+
+/**
+ * @brief         Completion callback of synchronous transfers
+ *
+ * @param[in]     result  Transfer result
+ * @param[in]     arg     Pointer to synchronous wait context
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_bsp_i2c_sync_done(int result, void *arg)
+{
+  bsp_i2c_sync_t *sync = (bsp_i2c_sync_t *)arg;
+
+  sync->result = result;
+  xSemaphoreGive(sync->done);
+}
+
+/**
+ * @brief         Run one transfer on the bus, walking the recovery ladder on error
+ *
+ * @param[in]     req     Pointer to transfer request
+ *
+ * @attention     Ladder is retry with backoff, then bus clear, then one driver reinstall
+ *                as the last resort. The bus object and its lock are never recreated.
+ *                On the virtual bus the clear and reinstall steps are plain retries.
+ *
+ * @return
+ * - 0      Succes
+ * - Others Error
+ */
+static int m_bsp_i2c_transfer(bsp_i2c_req_t *req)
+{
+  bsp_i2c_dev_stats_t cnt = { .errors = 1 };  // Folded into the device counters at the end
+  bsp_i2c_dev_stats_t *dev;
+  bsp_i2c_recovery_t step;
+  uint32_t backoff_us = BSP_I2C_BACKOFF_US;
+  uint32_t recovery_us;
+  int64_t fail_us;
+  int retry;
+  int ret;
+
+  ret = m_bsp_i2c_attempt(req, 0);
+  if (ret == 0)
+    return 0;
+
+  fail_us = esp_timer_get_time();
+  step    = BSP_I2C_RECOVERY_RETRY;
+
+  for (retry = 0; (ret != 0) && (retry < BSP_I2C_RETRY_BUDGET) && (step != BSP_I2C_RECOVERY_GIVE_UP); retry++)
+  {
+    switch (step)
+    {
+    case BSP_I2C_RECOVERY_RETRY:
+      bsp_i2c_delay_us(backoff_us);
+      backoff_us <<= 1;
+      if (retry + 1 >= BSP_I2C_RETRY_BEFORE_CLEAR)
+        step = BSP_I2C_RECOVERY_CLEAR;
+      break;
+
+    case BSP_I2C_RECOVERY_CLEAR:
+#if !defined(BSP_I2C_USE_SIM)
+      cnt.bus_clears++;
+      i2c_bus_clear(m_i2c_hdl);
+#endif
+      step = BSP_I2C_RECOVERY_REINSTALL;
+      break;
+
+    case BSP_I2C_RECOVERY_REINSTALL:
+    default:
+#if !defined(BSP_I2C_USE_SIM)
+      cnt.reinstalls++;
+      i2c_bus_reinstall(m_i2c_hdl);
+      i2c_set_timeout(I2C_NUM_0, BSP_I2C_SCL_TIMEOUT);
+#endif
+      step = BSP_I2C_RECOVERY_GIVE_UP;
+      break;
+    }
+
+    cnt.retries++;
+    ret = m_bsp_i2c_attempt(req, retry + 1);
+  }
+
+  recovery_us = (uint32_t)(esp_timer_get_time() - fail_us);
+  if (ret == 0)
+    cnt.recoveries++;
+  else
+    cnt.failures++;
+
+  dev = m_bsp_i2c_get_dev_stats(req->slave_addr);
+
+  portENTER_CRITICAL(&m_i2c_stats_mux);
+  dev->errors     += cnt.errors;
+  dev->retries    += cnt.retries;
+  dev->bus_clears += cnt.bus_clears;
+  dev->reinstalls += cnt.reinstalls;
+  dev->recoveries += cnt.recoveries;
+  dev->failures   += cnt.failures;
+  if (recovery_us > dev->max_recovery_us)
+    dev->max_recovery_us = recovery_us;
+  portEXIT_CRITICAL(&m_i2c_stats_mux);
+
+  if (ret == 0)
+  {
+    ESP_LOGW(TAG, "Slave 0x%02x recovered after %d retries in %u us", req->slave_addr, retry, recovery_us);
+  }
+  else
+  {
+    ESP_LOGE(TAG, "Slave 0x%02x failed after %d retries in %u us", req->slave_addr, retry, recovery_us);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief         Bus owner task, always serves the highest priority class with work pending
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     Completion callbacks run in this task and must not block on the bus
+ *
+ * @return        None
+ */
+static void m_bsp_i2c_task(void *param)
+{
+  bsp_i2c_req_t req;
+  bsp_i2c_class_stats_t *stats;
+  int64_t start_us;
+  uint32_t wait_us;
+  uint32_t busy_us;
+  int class;
+  int ret;
+
+  while (1)
+  {
+    if (pdTRUE != xSemaphoreTake(m_i2c_pending, portMAX_DELAY))
+      continue;
+
+    for (class = 0; class < BSP_I2C_CLASS_MAX; class++)
+    {
+      if (pdTRUE == xQueueReceive(m_i2c_queue[class], &req, 0))
+        break;
+    }
+    if (class == BSP_I2C_CLASS_MAX)
+      continue;
+
+    start_us = esp_timer_get_time();
+    ret      = m_bsp_i2c_transfer(&req);
+    busy_us  = (uint32_t)(esp_timer_get_time() - start_us);
+    wait_us  = (uint32_t)(start_us - req.submit_us);
+
+    stats = &m_i2c_stats[class];
+    portENTER_CRITICAL(&m_i2c_stats_mux);
+    stats->count++;
+    stats->total_wait_us += wait_us;
+    if (wait_us > stats->max_wait_us)
+      stats->max_wait_us = wait_us;
+    if (busy_us > stats->max_busy_us)
+      stats->max_busy_us = busy_us;
+    portEXIT_CRITICAL(&m_i2c_stats_mux);
+
+    if (req.cb != NULL)
+      req.cb(ret, req.arg);
+  }
+}
+
+/* End of file -------------------------------------------------------- */
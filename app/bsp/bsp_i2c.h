@@ -24,6 +24,62 @@ extern "C" {
 
 /* Public defines ----------------------------------------------------- */
 /* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief BSP I2C transfer type
+ */
+typedef enum
+{
+  BSP_I2C_XFER_READ = 0,    // Write register address, then read data
+  BSP_I2C_XFER_WRITE,       // Write register address followed by data
+  BSP_I2C_XFER_WRITE_DATA   // Write raw data
+}
+bsp_i2c_xfer_type_t;
+
+/**
+ * @brief BSP I2C client priority class, lower value is served first
+ */
+typedef enum
+{
+  BSP_I2C_CLASS_MOTOR = 0,  // Motor control
+  BSP_I2C_CLASS_GYRO,       // Gyroscope sampling
+  BSP_I2C_CLASS_PM,         // Power monitor
+  BSP_I2C_CLASS_RTC,        // RTC and unregistered devices
+  BSP_I2C_CLASS_MAX
+}
+bsp_i2c_class_t;
+
+/**
+ * @brief BSP I2C per class bus statistics
+ */
+typedef struct
+{
+  uint32_t count;           // Transfers served
+  uint32_t max_wait_us;     // Worst case time from submission to start of transfer
+  uint64_t total_wait_us;   // Sum of wait time, divide by count for the average
+  uint32_t max_busy_us;     // Worst case transfer duration
+}
+bsp_i2c_class_stats_t;
+
+/**
+ * @brief BSP I2C per device error and recovery counters
+ */
+typedef struct
+{
+  uint32_t errors;          // Transfers that failed on the first attempt
+  uint32_t retries;         // Extra attempts over all recoveries
+  uint32_t bus_clears;      // SCL clock-out bus clears
+  uint32_t reinstalls;      // I2C driver reinstalls
+  uint32_t recoveries;      // Transfers that succeeded after a retry
+  uint32_t failures;        // Transfers that ran out of retry budget
+  uint32_t max_recovery_us; // Worst case time from first error to the end of recovery
+}
+bsp_i2c_dev_stats_t;
+
+/**
+ * @brief BSP I2C transfer completion callback, result is 0 on success
+ */
+typedef void (*bsp_i2c_done_cb_t)(int result, void *arg);
+
 /* Public macros ------------------------------------------------------ */
 /* Public variables --------------------------------------------------- */
 /* Public function prototypes ----------------------------------------- */
@@ -35,7 +91,7 @@ extern "C" {
  * @param[in]     data          Pointer to handle of data
  * @param[in]     len           Data length
  *
- * @attention     None
+ * @attention     Served by the bus task in the priority class of slave_addr
  *
  * @return
  * - 0      Succes
@@ -51,7 +107,7 @@ int bsp_i2c_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t
  * @param[in]     data          Pointer to handle of data
  * @param[in]     len           Data length
  *
- * @attention     None
+ * @attention     Served by the bus task in the priority class of slave_addr
  *
  * @return
  * - 0      Succes
@@ -66,7 +122,7 @@ int bsp_i2c_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t l
  * @param[in]     data          Pointer to handle of data
  * @param[in]     len           Data length
  *
- * @attention     None
+ * @attention     Served by the bus task in the priority class of slave_addr
  *
  * @return
  * - 0      Succes
@@ -74,17 +130,148 @@ int bsp_i2c_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t l
  */
 int bsp_i2c_write_data(uint8_t slave_addr, uint8_t *data, uint32_t len);
 
+/**
+ * @brief         Board support package I2C asynchronous read
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      Register address
+ * @param[in]     data          Pointer to handle of data
+ * @param[in]     len           Data length
+ * @param[in]     cb            Completion callback, may be NULL
+ * @param[in]     arg           Argument passed to callback
+ *
+ * @attention     Never blocks. data must stay valid until the callback runs.
+ *                The callback runs in the bus task and must not call blocking I2C functions.
+ *
+ * @return
+ * - 0      Queued
+ * - 1      Error, queue full
+ */
+int bsp_i2c_read_async(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len,
+                       bsp_i2c_done_cb_t cb, void *arg);
+
+/**
+ * @brief         Board support package I2C asynchronous write
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      Register address
+ * @param[in]     data          Pointer to handle of data
+ * @param[in]     len           Data length
+ * @param[in]     cb            Completion callback, may be NULL
+ * @param[in]     arg           Argument passed to callback
+ *
+ * @attention     Same rules as bsp_i2c_read_async()
+ *
+ * @return
+ * - 0      Queued
+ * - 1      Error, queue full
+ */
+int bsp_i2c_write_async(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len,
+                        bsp_i2c_done_cb_t cb, void *arg);
+
+/**
+ * @brief         Board support package I2C asynchronous write data
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     data          Pointer to handle of data
+ * @param[in]     len           Data length
+ * @param[in]     cb            Completion callback, may be NULL
+ * @param[in]     arg           Argument passed to callback
+ *
+ * @attention     Same rules as bsp_i2c_read_async()
+ *
+ * @return
+ * - 0      Queued
+ * - 1      Error, queue full
+ */
+int bsp_i2c_write_data_async(uint8_t slave_addr, uint8_t *data, uint32_t len,
+                             bsp_i2c_done_cb_t cb, void *arg);
+
 /**
  * @brief         Board support package I2C init
  *
  * @param[in]     None
  *
- * @attention     None
+ * @attention     Also starts the bus task serving asynchronous transfers
  *
  * @return        None
  */
 esp_err_t bsp_i2c_init(void);
 
+/**
+ * @brief         Board support package I2C register client priority class
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     class         Priority class for all transfers to this address
+ *
+ * @attention     Call before the client starts using the bus
+ *
+ * @return        None
+ */
+void bsp_i2c_register_client(uint8_t slave_addr, bsp_i2c_class_t class);
+
+/**
+ * @brief         Board support package I2C get priority class statistics
+ *
+ * @param[in]     class         Priority class
+ * @param[out]    stats         Pointer to statistics
+ *
+ * @attention     Worst case wait of a class is bounded by the longest transfer
+ *                already in progress plus all pending transfers of higher classes
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error
+ */
+int bsp_i2c_get_class_stats(bsp_i2c_class_t class, bsp_i2c_class_stats_t *stats);
+
+/**
+ * @brief         Board support package I2C reset priority class statistics
+ *
+ * @param[in]     None
+ *
+ * @attention     Safe from any task, the bus task updates under the same lock
+ *
+ * @return        None
+ */
+void bsp_i2c_reset_class_stats(void);
+
+/**
+ * @brief         Board support package I2C get device error counters
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[out]    stats         Pointer to counters
+ *
+ * @attention     Unregistered addresses share one set of counters
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error
+ */
+int bsp_i2c_get_dev_stats(uint8_t slave_addr, bsp_i2c_dev_stats_t *stats);
+
+/**
+ * @brief         Board support package I2C reset device error counters
+ *
+ * @param[in]     None
+ *
+ * @attention     Safe from any task, the bus task updates under the same lock
+ *
+ * @return        None
+ */
+void bsp_i2c_reset_dev_stats(void);
+
+/**
+ * @brief         Board support package I2C command link allocations per second
+ *
+ * @param[in]     None
+ *
+ * @attention     Rate is measured since the previous call
+ *
+ * @return        Heap allocations per second on the I2C bus, 0 when allocation free
+ */
+uint32_t bsp_i2c_get_allocs_per_sec(void);
+
 /* -------------------------------------------------------------------------- */
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,220 @@
+/**
+ * @file       bsp_i2c_trace.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-22
+ * @author     Hiep Le
+ * @brief      Board Support Package (BSP) I2C transaction trace
+ * @note       Records are written by the I2C bus owner only, so the ring needs
+ *             no lock: a slot is marked with seq 0 while it is being written and
+ *             readers drop any record whose seq changed while they copied it.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "bsp_i2c_trace.h"
+
+/* Private defines ---------------------------------------------------- */
+#define BSP_I2C_TRACE_MASK              (BSP_I2C_TRACE_LEN - 1)
+#define BSP_I2C_TRACE_HIST_BASE_US      (64)
+#define BSP_I2C_TRACE_OTHER_ADDR        (0xFF)
+#define BSP_I2C_TRACE_DUMP_RECORDS      (16)
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+#define TRACE_LOAD(p)                   __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define TRACE_STORE(p, v)               __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "bsp_i2c_trace";
+
+static bsp_i2c_trace_rec_t m_trace_ring[BSP_I2C_TRACE_LEN];
+static uint32_t m_trace_head;       // Number of records written since boot
+static bsp_i2c_trace_hist_t m_trace_hist[BSP_I2C_TRACE_MAX_DEVICES + 1];  // Last entry for devices past the table
+static uint32_t m_trace_hist_cnt;
+static bool m_trace_reset_req;      // Set by readers, cleared by the writer once it has reset
+
+/* Private function prototypes ---------------------------------------- */
+static bsp_i2c_trace_hist_t *m_bsp_i2c_trace_get_hist(uint8_t slave_addr);
+static void m_bsp_i2c_trace_clear(void);
+
+/* Function definitions ----------------------------------------------- */
+void bsp_i2c_trace_record(uint8_t slave_addr, uint8_t reg_addr, uint32_t len, uint8_t type,
+                          uint8_t attempt, int64_t start_us, uint32_t duration_us, int result)
+{
+  uint32_t seq;
+  bsp_i2c_trace_rec_t *rec;
+  bsp_i2c_trace_hist_t *hist;
+  int bin;
+
+  if (TRACE_LOAD(&m_trace_reset_req))
+  {
+    m_bsp_i2c_trace_clear();
+    TRACE_STORE(&m_trace_reset_req, false);
+  }
+
+  seq = m_trace_head + 1;
+  rec = &m_trace_ring[m_trace_head & BSP_I2C_TRACE_MASK];
+
+  TRACE_STORE(&rec->seq, 0);
+  __atomic_thread_fence(__ATOMIC_RELEASE);    // Invalidate before the fields change
+
+  rec->start_us    = (uint32_t)start_us;
+  rec->duration_us = (duration_us > UINT16_MAX) ? UINT16_MAX : (uint16_t)duration_us;
+  rec->slave_addr  = slave_addr;
+  rec->reg_addr    = reg_addr;
+  rec->len         = (len > UINT16_MAX) ? UINT16_MAX : (uint16_t)len;
+  rec->type        = type;
+  rec->attempt     = attempt;
+  rec->result      = (result == 0) ? 0 : -1;
+
+  TRACE_STORE(&rec->seq, seq);
+  TRACE_STORE(&m_trace_head, seq);
+
+  hist = m_bsp_i2c_trace_get_hist(slave_addr);
+
+  for (bin = 0; (bin < BSP_I2C_TRACE_HIST_BINS - 1) && (duration_us >= (BSP_I2C_TRACE_HIST_BASE_US << bin)); bin++)
+    ;
+
+  hist->count++;
+  hist->bin[bin]++;
+  if (result != 0)
+    hist->errors++;
+  if (attempt != 0)
+    hist->retries++;
+  if (duration_us > hist->max_us)
+    hist->max_us = duration_us;
+}
+
+uint32_t bsp_i2c_trace_read(uint32_t *seq, bsp_i2c_trace_rec_t *rec, uint32_t max)
+{
+  uint32_t head = TRACE_LOAD(&m_trace_head);
+  uint32_t next = *seq;
+  uint32_t cnt  = 0;
+  bsp_i2c_trace_rec_t *slot;
+
+  if ((next == 0) || (head - next >= BSP_I2C_TRACE_LEN))
+    next = (head > BSP_I2C_TRACE_LEN) ? (head - BSP_I2C_TRACE_LEN + 1) : 1;
+
+  for (; (next <= head) && (cnt < max); next++)
+  {
+    slot = &m_trace_ring[(next - 1) & BSP_I2C_TRACE_MASK];
+
+    if (TRACE_LOAD(&slot->seq) != next)
+      continue;
+
+    rec[cnt] = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);  // Copy done before the re-check
+
+    // Overwritten while copying
+    if (TRACE_LOAD(&slot->seq) != next)
+      continue;
+
+    rec[cnt].seq = next;
+    cnt++;
+  }
+
+  *seq = next;
+
+  return cnt;
+}
+
+uint32_t bsp_i2c_trace_get_hist(bsp_i2c_trace_hist_t *hist, uint32_t max)
+{
+  uint32_t cnt = TRACE_LOAD(&m_trace_hist_cnt);
+  uint32_t i;
+
+  for (i = 0; (i < cnt) && (i < max); i++)
+    hist[i] = m_trace_hist[i];
+
+  // Devices past the table
+  if ((i < max) && (m_trace_hist[BSP_I2C_TRACE_MAX_DEVICES].count != 0))
+    hist[i++] = m_trace_hist[BSP_I2C_TRACE_MAX_DEVICES];
+
+  return i;
+}
+
+void bsp_i2c_trace_reset(void)
+{
+  TRACE_STORE(&m_trace_reset_req, true);
+}
+
+void bsp_i2c_trace_dump(void)
+{
+  bsp_i2c_trace_hist_t hist[BSP_I2C_TRACE_MAX_DEVICES + 1];
+  bsp_i2c_trace_rec_t rec[BSP_I2C_TRACE_DUMP_RECORDS];
+  uint32_t head = TRACE_LOAD(&m_trace_head);
+  uint32_t seq;
+  uint32_t cnt;
+
+  cnt = bsp_i2c_trace_get_hist(hist, BSP_I2C_TRACE_MAX_DEVICES + 1);
+  ESP_LOGI(TAG, "addr  count  errors retries  max_us | <64 <128 <256 <512 <1k <2k <4k <8k <16k >=16k us");
+  for (uint32_t i = 0; i < cnt; i++)
+  {
+    ESP_LOGI(TAG, "0x%02x %6u %6u %6u %7u | %u %u %u %u %u %u %u %u %u %u",
+             hist[i].slave_addr, hist[i].count, hist[i].errors, hist[i].retries, hist[i].max_us,
+             hist[i].bin[0], hist[i].bin[1], hist[i].bin[2], hist[i].bin[3], hist[i].bin[4],
+             hist[i].bin[5], hist[i].bin[6], hist[i].bin[7], hist[i].bin[8], hist[i].bin[9]);
+  }
+
+  seq = (head > BSP_I2C_TRACE_DUMP_RECORDS) ? (head - BSP_I2C_TRACE_DUMP_RECORDS + 1) : 1;
+  cnt = bsp_i2c_trace_read(&seq, rec, BSP_I2C_TRACE_DUMP_RECORDS);
+  for (uint32_t i = 0; i < cnt; i++)
+  {
+    ESP_LOGI(TAG, "#%u t=%u 0x%02x reg 0x%02x len %u type %u try %u %u us %s",
+             rec[i].seq, rec[i].start_us, rec[i].slave_addr, rec[i].reg_addr, rec[i].len,
+             rec[i].type, rec[i].attempt, rec[i].duration_us, (rec[i].result == 0) ? "ok" : "fail");
+  }
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Get the histogram of a slave address, add it on first use
+ *
+ * @param[in]     slave_addr    Slave address
+ *
+ * @attention     Only called by the single writer
+ *
+ * @return        Pointer to histogram
+ */
+static bsp_i2c_trace_hist_t *m_bsp_i2c_trace_get_hist(uint8_t slave_addr)
+{
+  uint32_t cnt = m_trace_hist_cnt;
+
+  for (uint32_t i = 0; i < cnt; i++)
+  {
+    if (m_trace_hist[i].slave_addr == slave_addr)
+      return &m_trace_hist[i];
+  }
+
+  if (cnt < BSP_I2C_TRACE_MAX_DEVICES)
+  {
+    m_trace_hist[cnt].slave_addr = slave_addr;
+    TRACE_STORE(&m_trace_hist_cnt, cnt + 1);
+    return &m_trace_hist[cnt];
+  }
+
+  m_trace_hist[BSP_I2C_TRACE_MAX_DEVICES].slave_addr = BSP_I2C_TRACE_OTHER_ADDR;
+  return &m_trace_hist[BSP_I2C_TRACE_MAX_DEVICES];
+}
+
+/**
+ * @brief         Clear records and histograms
+ *
+ * @param[in]     None
+ *
+ * @attention     Only called by the single writer, on a pending reset request
+ *
+ * @return        None
+ */
+static void m_bsp_i2c_trace_clear(void)
+{
+  TRACE_STORE(&m_trace_hist_cnt, 0);
+  memset(m_trace_hist, 0, sizeof(m_trace_hist));
+  memset(m_trace_ring, 0, sizeof(m_trace_ring));
+  TRACE_STORE(&m_trace_head, 0);
+}
+
+/* End of file -------------------------------------------------------- */
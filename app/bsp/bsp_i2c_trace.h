@@ -0,0 +1,138 @@
+/**
+ * @file       bsp_i2c_trace.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-22
+ * @author     Hiep Le
+ * @brief      Board Support Package (BSP) I2C transaction trace
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __BSP_I2C_TRACE_H
+#define __BSP_I2C_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "platform_common.h"
+
+/* Public defines ----------------------------------------------------- */
+#define BSP_I2C_TRACE_LEN               (128)   // Records kept, power of 2
+#define BSP_I2C_TRACE_MAX_DEVICES       (8)     // Devices with their own histogram
+#define BSP_I2C_TRACE_HIST_BINS         (10)    // Bin n counts durations below 64 us << n, last bin is open
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief BSP I2C trace record, one per bus attempt
+ */
+typedef struct
+{
+  uint32_t seq;             // Record number since boot, 0 while the slot is being written
+  uint32_t start_us;        // Start time, low 32 bits of esp_timer
+  uint16_t duration_us;     // Attempt duration, saturated
+  uint16_t len;
+  uint8_t slave_addr;
+  uint8_t reg_addr;
+  uint8_t type;             // bsp_i2c_xfer_type_t
+  uint8_t attempt;          // 0 for the first attempt, retries count up
+  int8_t result;            // 0 on success
+}
+bsp_i2c_trace_rec_t;
+
+/**
+ * @brief BSP I2C trace latency histogram of one device
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t errors;
+  uint32_t retries;
+  uint32_t max_us;
+  uint32_t bin[BSP_I2C_TRACE_HIST_BINS];
+  uint8_t slave_addr;       // 0xFF for devices past the table
+}
+bsp_i2c_trace_hist_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Board support package I2C trace record an attempt
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      Register address
+ * @param[in]     len           Data length
+ * @param[in]     type          Transfer type
+ * @param[in]     attempt       Attempt number, 0 for the first one
+ * @param[in]     start_us      Start time
+ * @param[in]     duration_us   Duration
+ * @param[in]     result        Result, 0 on success
+ *
+ * @attention     Single writer, only called by the I2C bus owner
+ *
+ * @return        None
+ */
+void bsp_i2c_trace_record(uint8_t slave_addr, uint8_t reg_addr, uint32_t len, uint8_t type,
+                          uint8_t attempt, int64_t start_us, uint32_t duration_us, int result);
+
+/**
+ * @brief         Board support package I2C trace read records
+ *
+ * @param[in,out] seq     Sequence number of the first record wanted, updated past the last one read
+ * @param[out]    rec     Pointer to records
+ * @param[in]     max     Maximum number of records
+ *
+ * @attention     Lock free, records overwritten while being copied are dropped.
+ *                Starting from 0 returns the oldest record still in the ring.
+ *
+ * @return        Number of records copied
+ */
+uint32_t bsp_i2c_trace_read(uint32_t *seq, bsp_i2c_trace_rec_t *rec, uint32_t max);
+
+/**
+ * @brief         Board support package I2C trace get histograms
+ *
+ * @param[out]    hist    Pointer to histograms
+ * @param[in]     max     Maximum number of histograms
+ *
+ * @attention     None
+ *
+ * @return        Number of histograms copied
+ */
+uint32_t bsp_i2c_trace_get_hist(bsp_i2c_trace_hist_t *hist, uint32_t max);
+
+/**
+ * @brief         Board support package I2C trace reset records and histograms
+ *
+ * @param[in]     None
+ *
+ * @attention     Only posts the request, the I2C bus owner clears the trace
+ *                before it records the next attempt
+ *
+ * @return        None
+ */
+void bsp_i2c_trace_reset(void);
+
+/**
+ * @brief         Board support package I2C trace dump to the console
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void bsp_i2c_trace_dump(void);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __BSP_I2C_TRACE_H
+
+/* End of file -------------------------------------------------------- */
@@ -12,66 +12,397 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "bsp_pm.h"
+#include "bsp_brc.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
 
 /* Private defines ---------------------------------------------------- */
+#define BSP_PM_WAIT_POLL_MS             (10)    // Refresh poll period of the blocking calls
+
+#define BSP_PM_GUARD_TASK_STACK_SIZE    (2048)
+#define BSP_PM_GUARD_TASK_PRIORITY      (9)     // Below the I2C bus task
+#define BSP_PM_GUARD_SETTLE_US          (1100)  // REFRESH_V to readable results, 1 ms and margin
+#define BSP_PM_GUARD_DERATE_PERCENT     (50)    // Motor speed limit while a rail is tripped
+
+#define BSP_PM_NOTIFY_ALERT             (1 << 0) // Conversion complete, ALERT pin
+#define BSP_PM_NOTIFY_SETTLED           (1 << 1) // Guard refresh results readable
+
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
+static const char *TAG = "bsp_pm";
+
 static pac1934_t m_pac1934;
+static SemaphoreHandle_t m_pm_lock;         // Driver access and refresh schedule
+static bool m_pm_collect;                   // Snapshot refresh issued, results not collected
+static uint64_t m_pm_refresh_us;            // Time of the last refresh
+static bool m_pm_energy_pending;            // Accumulator REFRESH issued, energy not read, no other refresh
+
+static TaskHandle_t m_pm_guard_task;
+static esp_timer_handle_t m_pm_guard_timer;
+static pm_guard_t m_pm_guard;               // Under m_pm_lock
+
+// Rail limits by channel, 0 disables. Over current at 90 % of the 25 A full scale.
+// Brownout stays off until the rail voltages of the board are known, the application
+// sets it with bsp_pm_set_limit().
+static const pm_guard_limit_t m_pm_guard_limit[PAC1934_CHANNEL_CNT] =
+{
+  { .over_current_ma = 22500, .brownout_mv = 0 },
+  { .over_current_ma = 22500, .brownout_mv = 0 },
+  { .over_current_ma = 22500, .brownout_mv = 0 },
+  { .over_current_ma = 22500, .brownout_mv = 0 }
+};
 
 /* Private function prototypes ---------------------------------------- */
+static uint32_t m_bsp_pm_now_ms(void);
+static void m_bsp_pm_lock_when_ready(void);
+static void m_bsp_pm_alert_isr_handler(void *arg);
+static void m_bsp_pm_guard_timer_cb(void *arg);
+static void m_bsp_pm_guard_task(void *param);
+static uint8_t m_bsp_pm_unguarded(void);
+
 /* Function definitions ----------------------------------------------- */
 base_status_t bsp_pm_init(void)
 {
+  const esp_timer_create_args_t timer_args =
+  {
+    .callback = m_bsp_pm_guard_timer_cb,
+    .name     = "pm_guard"
+  };
+
+  m_pm_lock = xSemaphoreCreateMutex();
+  CHECK(m_pm_lock != NULL, BS_ERROR);
+
+  // PWRDN low keeps the chip in power down
+  gpio_pad_select_gpio(IO_PM_PWRDN);
+  gpio_set_direction(IO_PM_PWRDN, GPIO_MODE_OUTPUT);
+  gpio_set_level(IO_PM_PWRDN, 1);
+
   m_pac1934.device_address        = PAC1934_I2C_ADDR;
   m_pac1934.i2c_read              = bsp_i2c_read;
   m_pac1934.i2c_write             = bsp_i2c_write;
   m_pac1934.i2c_write_data        = bsp_i2c_write_data;
   m_pac1934.delay_ms              = bsp_delay_ms;
 
-  m_pac1934.config.sample_rate    = PAC1934_SAMPLE_RATE_8HZ;
+  bsp_i2c_register_client(m_pac1934.device_address, BSP_I2C_CLASS_PM);
+
+  m_pac1934.config.sample_rate    = PAC1934_SAMPLE_RATE_64HZ; // Guard reacts within one conversion
   m_pac1934.config.sleep_mode_bit = 0; // 1: Sleep mode, 0: Normal mode
+  m_pac1934.config.channel_dis    = 0; // All channels enabled
+  m_pac1934.config.alert_cc       = true;
 
   CHECK_STATUS(pac1934_init(&m_pac1934));
 
+  // Rail guard, woken by the conversion complete pulse on ALERT
+  pm_guard_init(&m_pm_guard, m_pm_guard_limit);
+  if (m_bsp_pm_unguarded() != 0)
+    ESP_LOGW(TAG, "Brownout check off on rails 0x%x until bsp_pm_set_limit()", m_bsp_pm_unguarded());
+
+  CHECK(ESP_OK == esp_timer_create(&timer_args, &m_pm_guard_timer), BS_ERROR);
+  CHECK(pdPASS == xTaskCreate(&m_bsp_pm_guard_task, "PM guard task", BSP_PM_GUARD_TASK_STACK_SIZE, NULL,
+                              BSP_PM_GUARD_TASK_PRIORITY, &m_pm_guard_task), BS_ERROR);
+
+  gpio_pad_select_gpio(IO_PM_ALERT);
+  gpio_set_direction(IO_PM_ALERT, GPIO_MODE_INPUT);
+  gpio_pullup_en(IO_PM_ALERT);              // Open drain, active low
+  gpio_set_intr_type(IO_PM_ALERT, GPIO_INTR_NEGEDGE);
+  gpio_isr_handler_add(IO_PM_ALERT, m_bsp_pm_alert_isr_handler, NULL);
+  gpio_intr_enable(IO_PM_ALERT);
+
   return BS_OK;
 }
 
 base_status_t bsp_pm_voltage_measurement(pac1934_channel_t channel)
 {
-  CHECK_STATUS(pac1934_voltage_measurement(&m_pac1934, channel));
+  base_status_t status;
 
-  return BS_OK;
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  status = pac1934_voltage_measurement(&m_pac1934, channel);
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
 }
 
 base_status_t bsp_pm_current_measurement(pac1934_channel_t channel)
 {
-  CHECK_STATUS(pac1934_current_measurement(&m_pac1934, channel));
+  base_status_t status;
 
-  return BS_OK;
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  status = pac1934_current_measurement(&m_pac1934, channel);
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
 }
 
 base_status_t bsp_pm_power_measurement(pac1934_channel_t channel)
 {
-  CHECK_STATUS(pac1934_power_measurement(&m_pac1934, channel));
+  base_status_t status;
 
-  return BS_OK;
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  status = pac1934_power_measurement(&m_pac1934, channel);
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
+}
+
+bool bsp_pm_snapshot_poll(pac1934_snapshot_t *snap)
+{
+  uint32_t now_ms = m_bsp_pm_now_ms();
+  bool fresh = false;
+
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+
+  if (!m_pm_energy_pending && pac1934_refresh_ready(&m_pac1934, now_ms))
+  {
+    if (m_pm_collect)
+      fresh = (BS_OK == pac1934_snapshot(&m_pac1934, m_pm_refresh_us, snap));
+
+    m_pm_collect = (BS_OK == pac1934_refresh_start(&m_pac1934, false, now_ms));
+    if (m_pm_collect)
+      m_pm_refresh_us = esp_timer_get_time();
+  }
+
+  xSemaphoreGive(m_pm_lock);
+
+  return fresh;
+}
+
+base_status_t bsp_pm_energy_measurement(pac1934_energy_t *energy)
+{
+  base_status_t status;
+
+  // Issue the REFRESH under the lock, the lock is released while it settles
+  m_bsp_pm_lock_when_ready();
+
+  status = pac1934_refresh_start(&m_pac1934, true, m_bsp_pm_now_ms());
+  if (BS_OK == status)
+  {
+    m_pm_refresh_us     = esp_timer_get_time();   // Latches the results too, a pending snapshot takes them
+    m_pm_energy_pending = true;
+  }
+
+  xSemaphoreGive(m_pm_lock);
+
+  if (BS_OK != status)
+    return status;
+
+  m_bsp_pm_lock_when_ready();
+
+  status = pac1934_energy_measurement(&m_pac1934);
+  if (BS_OK == status)
+    *energy = m_pac1934.data.energy;
+  m_pm_energy_pending = false;
+
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
+}
+
+void bsp_pm_set_limit(pac1934_channel_t channel, const pm_guard_limit_t *limit)
+{
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  pm_guard_set_limit(&m_pm_guard, channel, limit);
+  xSemaphoreGive(m_pm_lock);
+
+  if (limit->brownout_mv == 0)
+    ESP_LOGI(TAG, "Brownout check off on rail %d", channel + 1);
+}
+
+uint32_t bsp_pm_read_events(pm_guard_event_t *events, uint32_t max)
+{
+  uint32_t cnt;
+
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  cnt = pm_guard_read_log(&m_pm_guard, events, max);
+  xSemaphoreGive(m_pm_lock);
+
+  return cnt;
 }
 
 base_status_t bsp_pm_into_sleep_mode(void)
 {
-  CHECK_STATUS(pac1934_into_sleep_mode(&m_pac1934));
+  base_status_t status;
 
-  return BS_OK;
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  status = pac1934_into_sleep_mode(&m_pac1934);
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
 }
 
 base_status_t bsp_pm_into_normal_mode(void)
 {
-  CHECK_STATUS(pac1934_into_normal_mode(&m_pac1934));
+  base_status_t status;
 
-  return BS_OK;
+  xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+  status = pac1934_into_normal_mode(&m_pac1934);
+  xSemaphoreGive(m_pm_lock);
+
+  return status;
 }
 
 /* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Current time for the refresh schedule
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Time in millisecond
+ */
+static uint32_t m_bsp_pm_now_ms(void)
+{
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/**
+ * @brief         Take the lock once the refresh in progress is complete
+ *
+ * @param[in]     None
+ *
+ * @attention     Returns with the lock held, the lock is free between polls
+ *
+ * @return        None
+ */
+static void m_bsp_pm_lock_when_ready(void)
+{
+  while (1)
+  {
+    xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+    if (pac1934_refresh_ready(&m_pac1934, m_bsp_pm_now_ms()))
+      return;
+    xSemaphoreGive(m_pm_lock);
+
+    bsp_delay_ms(BSP_PM_WAIT_POLL_MS);
+  }
+}
+
+/**
+ * @brief         ALERT interrupt, end of a conversion
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void IRAM_ATTR m_bsp_pm_alert_isr_handler(void *arg)
+{
+  BaseType_t woken = pdFALSE;
+
+  xTaskNotifyFromISR(m_pm_guard_task, BSP_PM_NOTIFY_ALERT, eSetBits, &woken);
+
+  if (woken == pdTRUE)
+    portYIELD_FROM_ISR();
+}
+
+/**
+ * @brief         Guard refresh settled, the tick is too coarse for the 1 ms wait
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     Runs in the esp_timer task
+ *
+ * @return        None
+ */
+static void m_bsp_pm_guard_timer_cb(void *arg)
+{
+  xTaskNotify(m_pm_guard_task, BSP_PM_NOTIFY_SETTLED, eSetBits);
+}
+
+/**
+ * @brief         Rail guard task, checks every conversion against the limits
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     ALERT issues a REFRESH_V, the results are read 1 ms later. The motor
+ *                is derated on the first tripped conversion and restored when all
+ *                rails clear. A conversion is skipped while another refresh is pending,
+ *                including an energy REFRESH whose accumulators are not read yet.
+ *
+ * @return        None
+ */
+static void m_bsp_pm_guard_task(void *param)
+{
+  pac1934_snapshot_t snap;
+  pm_guard_event_t event = { 0 };
+  uint64_t refresh_us = 0;
+  uint32_t notify;
+  uint32_t log_cnt = 0;
+  uint8_t tripped;
+  uint8_t last = 0;
+  bool pending = false;
+  bool fresh;
+
+  while (1)
+  {
+    xTaskNotifyWait(0, UINT32_MAX, &notify, portMAX_DELAY);
+
+    if ((notify & BSP_PM_NOTIFY_ALERT) && !pending)
+    {
+      xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+      if (!m_pm_energy_pending && pac1934_refresh_ready(&m_pac1934, m_bsp_pm_now_ms()) &&
+          (BS_OK == pac1934_refresh_start(&m_pac1934, false, m_bsp_pm_now_ms())))
+      {
+        refresh_us      = esp_timer_get_time();
+        m_pm_refresh_us = refresh_us;
+        pending         = true;
+      }
+      xSemaphoreGive(m_pm_lock);
+
+      if (pending)
+        esp_timer_start_once(m_pm_guard_timer, BSP_PM_GUARD_SETTLE_US);
+    }
+
+    if (!(notify & BSP_PM_NOTIFY_SETTLED) || !pending)
+      continue;
+
+    pending = false;
+
+    xSemaphoreTake(m_pm_lock, portMAX_DELAY);
+    fresh = pac1934_refresh_ready(&m_pac1934, m_bsp_pm_now_ms()) &&
+            (BS_OK == pac1934_snapshot(&m_pac1934, refresh_us, &snap));
+    tripped = fresh ? pm_guard_update(&m_pm_guard, snap.volt_mv, snap.current_ma, snap.channel_mask, snap.timestamp_us) : last;
+    if (m_pm_guard.log_cnt != log_cnt)
+    {
+      log_cnt = m_pm_guard.log_cnt;
+      event   = m_pm_guard.log[(log_cnt - 1) % PM_GUARD_LOG_SIZE];
+    }
+    xSemaphoreGive(m_pm_lock);
+
+    if (tripped == last)
+      continue;
+
+    bsp_brc_set_derating((tripped != 0) ? BSP_PM_GUARD_DERATE_PERCENT : 100);
+    last = tripped;
+
+    ESP_LOGW(TAG, "Rails tripped 0x%x, event %u ch %u value %u, derating %s", tripped, event.type,
+             event.channel + 1, event.value, (tripped != 0) ? "on" : "off");
+  }
+}
+
+/**
+ * @brief         Channels without a brownout limit
+ *
+ * @param[in]     None
+ *
+ * @attention     Call with the lock held once the guard task runs
+ *
+ * @return        Bit n set when channel n has no brownout limit
+ */
+static uint8_t m_bsp_pm_unguarded(void)
+{
+  uint8_t mask = 0;
+
+  for (int ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+  {
+    if (m_pm_guard.limit[ch].brownout_mv == 0)
+      mask |= (1 << ch);
+  }
+
+  return mask;
+}
+
 /* End of file -------------------------------------------------------- */
\ No newline at end of file
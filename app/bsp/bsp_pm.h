@@ -20,6 +20,7 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
 #include "pac1934.h"
+#include "pm_guard.h"
 
 /* Public defines ----------------------------------------------------- */
 /* Public enumerate/structure ----------------------------------------- */
@@ -78,6 +79,59 @@ base_status_t bsp_pm_current_measurement(pac1934_channel_t channel);
  */
 base_status_t bsp_pm_power_measurement(pac1934_channel_t channel);
 
+/**
+ * @brief         BSP Multi Channel Power Monitor poll all channels
+ *
+ * @param[out]    snap      Pointer to snapshot, stamped with the time of its refresh
+ *
+ * @attention     Never waits. Collects the results of the previous refresh once they
+ *                are readable and issues the next one, call from a periodic task.
+ *
+ * @return
+ * - true       New snapshot in snap
+ * - false      Refresh in progress or bus error
+ */
+bool bsp_pm_snapshot_poll(pac1934_snapshot_t *snap);
+
+/**
+ * @brief         BSP Multi Channel Power Monitor get energy
+ *
+ * @param[out]    energy    Pointer to energy of all channels since the previous call
+ *
+ * @attention     Clears the chip accumulators, waits a few ms for the refresh without
+ *                holding the driver lock. One caller at a time.
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t bsp_pm_energy_measurement(pac1934_energy_t *energy);
+
+/**
+ * @brief         BSP Multi Channel Power Monitor set the rail limits of a channel
+ *
+ * @param[in]     channel   Multi Channel Power Monitor Channel
+ * @param[in]     limit     Pointer to limits, 0 disables a limit
+ *
+ * @attention     Checked on every conversion, a trip derates the motor. Brownout is off
+ *                by default until the rail voltages are known, logged once at init.
+ *
+ * @return        None
+ */
+void bsp_pm_set_limit(pac1934_channel_t channel, const pm_guard_limit_t *limit);
+
+/**
+ * @brief         BSP Multi Channel Power Monitor read the rail event log
+ *
+ * @param[out]    events    Pointer to events, oldest first
+ * @param[in]     max       Number of events
+ *
+ * @attention     None
+ *
+ * @return        Number of events read
+ */
+uint32_t bsp_pm_read_events(pm_guard_event_t *events, uint32_t max);
+
 /**
  * @brief         BSP Multi Channel Power Monitor into sleep mode
  *
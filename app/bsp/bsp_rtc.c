@@ -29,6 +29,8 @@ base_status_t bsp_rtc_init(void)
   m_pcf85063.i2c_read       = bsp_i2c_read;
   m_pcf85063.i2c_write      = bsp_i2c_write;
 
+  bsp_i2c_register_client(m_pcf85063.device_address, BSP_I2C_CLASS_RTC);
+
   CHECK_STATUS(pcf85063_init(&m_pcf85063));
 
   return BS_OK;
@@ -12,6 +12,7 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "drv10975.h"
+#include "fixconv.h"
 #include "bsp_io_10.h"
 
 /* Private defines ---------------------------------------------------- */
@@ -54,69 +55,113 @@
 // DRV10975 motor max speed
 #define DRV10975_MOTOR_MAX_SPEED                   (0x1FF)
 
+// DRV10975 EEPROM access
+#define DRV10975_EE_CTRL_SIDATA                    (0x40)   // Configuration registers writable
+#define DRV10975_EE_CTRL_EE_WRITE                  (0x10)   // Program configuration registers into EEPROM
+#define DRV10975_DEV_CTRL_EE_KEY                   (0xB6)   // Key required before EE_WRITE
+
+// DRV10975 configuration block, MOTOR_PARAM1 to SYS_OPT9
+#define DRV10975_CFG_CNT                           (DRV10975_REG_SYS_OPT9 - DRV10975_REG_MOTOR_PARAM1 + 1)
+
+#define DRV10975_POLL_MS                           (10)
+#define DRV10975_POWER_UP_TIMEOUT_MS               (200)
+#define DRV10975_EEPROM_TIMEOUT_MS                 (100)
+
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
 static const char *TAG = "drv10975";
 
+// DRV10975 register map
+static const regmap_field_t DRV10975_SPEED_MSB   = REGMAP_FIELD(DRV10975_REG_SPEED_CTRL2, 0, 0);
+static const regmap_field_t DRV10975_OVERRIDE    = REGMAP_FIELD(DRV10975_REG_SPEED_CTRL2, 7, 7);
+static const regmap_field_t DRV10975_EE_WRITE    = REGMAP_FIELD(DRV10975_REG_EE_CTRL, 4, 4);
+static const regmap_field_t DRV10975_CURRENT_MSB = REGMAP_FIELD(DRV10975_REG_MOTOR_CURRENT1, 2, 0);
+static const regmap_field_t DRV10975_KT_MSB      = REGMAP_FIELD(DRV10975_REG_MOTOR_KT1, 2, 0);
+static const regmap_group_t DRV10975_CFG         = REGMAP_GROUP(DRV10975_REG_MOTOR_PARAM1, DRV10975_REG_SYS_OPT9);
+static const regmap_group_t DRV10975_SPEED_CTRL  = REGMAP_GROUP(DRV10975_REG_SPEED_CTRL1, DRV10975_REG_SPEED_CTRL2);
+static const regmap_group_t DRV10975_SPEED       = REGMAP_GROUP(DRV10975_REG_MOTOR_SPEED1, DRV10975_REG_MOTOR_SPEED2);
+static const regmap_group_t DRV10975_PERIOD      = REGMAP_GROUP(DRV10975_REG_MOTOR_PERIOD1, DRV10975_REG_MOTOR_PERIOD2);
+static const regmap_group_t DRV10975_CURRENT     = REGMAP_GROUP(DRV10975_REG_MOTOR_CURRENT1, DRV10975_REG_MOTOR_CURRENT2);
+static const regmap_group_t DRV10975_MONITOR     = REGMAP_GROUP(DRV10975_REG_STATUS, DRV10975_REG_FAULT_CODE);
+
+// Configuration block, in register order from MOTOR_PARAM1
+static const uint8_t m_drv10975_cfg[DRV10975_CFG_CNT] =
+{
+  0x39,   // MOTOR_PARAM1: Set motor resistance
+  0x1E,   // MOTOR_PARAM2: Set BEMF constant
+  0x3A,   // MOTOR_PARAM3: Set LRTIME
+  0x08,   // SYS_OPT1: ISD enable
+  0x50,   // SYS_OPT2: Open loop current setting
+  0xDA,   // SYS_OPT3: Open loop accelerate setting
+  0xB8,   // SYS_OPT4: Open to closed loop threshold & Align time
+  0x10,   // SYS_OPT5: Lock detection current limit. Enabled when high
+  0x27,   // SYS_OPT6: Acceleration current limit threshold
+  0x37,   // SYS_OPT7: Closed loop accelerate
+  0x04,   // SYS_OPT8: No IPD function, Buck regulator voltage select = 3.3V
+  0x0C    // SYS_OPT9: Kt_high = 2Kt. Kt_low = 1/2Kt, Analog input expected at SPEED pin
+};
+
 /* Private function prototypes ---------------------------------------- */
-static base_status_t m_drv10975_read_reg(drv10975_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
-static base_status_t m_drv10975_write_reg(drv10975_t *me, uint8_t reg, uint8_t data);
 static uint16_t m_drv10975_modifed_map(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
 
 /* Function definitions ----------------------------------------------- */
 base_status_t drv10975_init(drv10975_t *me)
 {
-  me->delay_ms(200);
+  uint8_t cfg[DRV10975_CFG_CNT];
+  uint32_t wait_ms;
+  uint8_t tmp;
+
   if ((me == NULL) || (me->i2c_read == NULL) || (me->i2c_write == NULL) || (me->delay_ms == NULL))
     return BS_ERROR;
 
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_EE_CTRL, 0x40)); // Enable the writing to configuration register
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_MOTOR_PARAM1, 0x39)); // Set motor resistance
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_MOTOR_PARAM2, 0x1E)); // Set BEMF constant
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_MOTOR_PARAM3, 0x3A)); // Set LRTIME
-  me->delay_ms(10);
+  CHECK_STATUS(regmap_init(&me->map, TAG, me->device_address, me->i2c_read, me->i2c_write, NULL, 0));
 
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT1, 0x08)); // ISD enable
-  me->delay_ms(10);
+  me->eeprom_updated = false;
+  memset(&me->fault, 0, sizeof(me->fault));
 
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT2, 0x50)); // Open loop current setting                               
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT3, 0xDA)); // Open loop accelerate setting                              
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT4, 0xB8)); // Open to closed loop threshold & Align time                                           
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT5, 0x10)); // Lock detection current limit. Enabled when high
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT6, 0x27)); // Acceleration current limit threshold
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT7, 0x37)); // Closed loop accelerate                                              
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT8, 0x04)); // No IPD function, Buck regulator voltage select = 3.3V
-  me->delay_ms(10);
-
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SYS_OPT9, 0x0C)); // Kt_high = 2Kt. Kt_low = 1/2Kt, Analog input expected at SPEED pin
-  me->delay_ms(10);
+  // Wait for the device to power up, the configuration block read doubles as the probe
+  for (wait_ms = 0; regmap_group_read(&me->map, &DRV10975_CFG, cfg) != BS_OK; wait_ms += DRV10975_POLL_MS)
+  {
+    CHECK(wait_ms < DRV10975_POWER_UP_TIMEOUT_MS, BS_ERROR);
+    me->delay_ms(DRV10975_POLL_MS);
+  }
 
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_DEV_CTRL, 0xB6)); //                                    
-  me->delay_ms(10);
+  if (memcmp(cfg, m_drv10975_cfg, sizeof(cfg)) != 0)
+  {
+    CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_REG_EE_CTRL, DRV10975_EE_CTRL_SIDATA)); // Enable the writing to configuration register
+
+    for (uint8_t i = 0; i < DRV10975_CFG_CNT; i++)
+    {
+      if (cfg[i] != m_drv10975_cfg[i])
+      {
+        ESP_LOGI(TAG, "Config reg 0x%02x: 0x%02x -> 0x%02x", DRV10975_CFG.reg + i, cfg[i], m_drv10975_cfg[i]);
+        CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_CFG.reg + i, m_drv10975_cfg[i]));
+      }
+    }
+
+    // Verify before the block goes to EEPROM
+    CHECK_STATUS(regmap_group_read(&me->map, &DRV10975_CFG, cfg));
+    CHECK(memcmp(cfg, m_drv10975_cfg, sizeof(cfg)) == 0, BS_ERROR);
+
+    CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_REG_DEV_CTRL, DRV10975_DEV_CTRL_EE_KEY));
+    CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_REG_EE_CTRL, DRV10975_EE_CTRL_SIDATA | DRV10975_EE_CTRL_EE_WRITE)); // Program the EEPROM
+
+    // EE_WRITE clears when programming is done
+    for (wait_ms = 0; ; wait_ms += DRV10975_POLL_MS)
+    {
+      CHECK_STATUS(regmap_field_read(&me->map, &DRV10975_EE_WRITE, &tmp));
+      if (tmp == 0)
+        break;
+
+      CHECK(wait_ms < DRV10975_EEPROM_TIMEOUT_MS, BS_ERROR);
+      me->delay_ms(DRV10975_POLL_MS);
+    }
+
+    me->eeprom_updated = true;
+  }
 
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_EE_CTRL, 0x50)); //  Enable program the EEPROM                     
-  me->delay_ms(10);
-  
   CHECK_STATUS(drv10975_set_motor_speed(me, 0)); // Set motor speed = 0 
 
   return BS_OK;
@@ -138,11 +183,28 @@ base_status_t drv10975_set_motor_speed(drv10975_t *me, uint8_t percent_speed)
   me->value.speed = m_drv10975_modifed_map(percent_speed, 0, 100, 0, DRV10975_MOTOR_MAX_SPEED);
 
   tmp = (uint8_t)(me->value.speed);
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SPEED_CTRL1, tmp));
+  CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_REG_SPEED_CTRL1, tmp));
   me->delay_ms(1);
   
-  tmp = (uint8_t)(((me->value.speed >> 8) & 0x01) | 0x80);
-  CHECK_STATUS(m_drv10975_write_reg(me, DRV10975_REG_SPEED_CTRL2, tmp));
+  tmp = REGMAP_FIELD_PREP(&DRV10975_SPEED_MSB, me->value.speed >> 8) | REGMAP_FIELD_PREP(&DRV10975_OVERRIDE, 1);
+  CHECK_STATUS(regmap_write_byte(&me->map, DRV10975_REG_SPEED_CTRL2, tmp));
+
+  return BS_OK;
+}
+
+base_status_t drv10975_set_speed_cmd(drv10975_t *me, uint16_t cmd)
+{
+  uint8_t tmp[2];
+
+  if (cmd > DRV10975_SPEED_CMD_MAX)
+    cmd = DRV10975_SPEED_CMD_MAX;
+
+  me->value.speed = cmd;
+
+  // SpeedCtrl1 first, the SpeedCtrl2 write latches the command
+  tmp[0] = (uint8_t)cmd;
+  tmp[1] = REGMAP_FIELD_PREP(&DRV10975_SPEED_MSB, cmd >> 8) | REGMAP_FIELD_PREP(&DRV10975_OVERRIDE, 1);
+  CHECK_STATUS(regmap_group_write(&me->map, &DRV10975_SPEED_CTRL, tmp));
 
   return BS_OK;
 }
@@ -152,11 +214,11 @@ base_status_t drv10975_get_motor_velocity(drv10975_t *me)
   uint8_t tmp[2];
   uint16_t velocity;
 
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_MOTOR_SPEED1, tmp, sizeof(tmp)));
+  CHECK_STATUS(regmap_group_read(&me->map, &DRV10975_SPEED, tmp));
 
-  velocity = tmp[0] << 8 | tmp[1];
+  velocity = REGMAP_GROUP_BE16(&DRV10975_SPEED, tmp, DRV10975_REG_MOTOR_SPEED1);
 
-  me->value.velocity = (float)(velocity / 10.0);
+  me->value.velocity_mhz = fixconv_drv10975_velocity_mhz(velocity);
   
   return BS_OK;
 }
@@ -166,11 +228,11 @@ base_status_t drv10975_get_motor_period(drv10975_t *me)
   uint8_t tmp[2];
   uint16_t period;
 
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_MOTOR_PERIOD1, tmp, sizeof(tmp)));
+  CHECK_STATUS(regmap_group_read(&me->map, &DRV10975_PERIOD, tmp));
 
-  period = tmp[0] << 8 | tmp[1];
+  period = REGMAP_GROUP_BE16(&DRV10975_PERIOD, tmp, DRV10975_REG_MOTOR_PERIOD1);
 
-  me->value.period = (float)(period * 10.0);
+  me->value.period_us = fixconv_drv10975_period_us(period);
 
   return BS_OK;
 }
@@ -179,9 +241,9 @@ base_status_t drv10975_get_motor_supply_voltage(drv10975_t *me)
 {
   uint8_t tmp;
 
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_SUPPLY_VOLTAGE, &tmp, 1));
+  CHECK_STATUS(regmap_read(&me->map, DRV10975_REG_SUPPLY_VOLTAGE, &tmp, 1));
 
-  me->value.supply_voltage = (float)(tmp * 22.8 / 256.0);
+  me->value.supply_mv = fixconv_drv10975_supply_mv(tmp);
 
   return BS_OK;
 }
@@ -191,108 +253,97 @@ base_status_t drv10975_get_motor_current(drv10975_t *me)
   uint8_t tmp[2];
   uint16_t current;
 
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_MOTOR_CURRENT1, tmp, sizeof(tmp)));
+  CHECK_STATUS(regmap_group_read(&me->map, &DRV10975_CURRENT, tmp));
 
-  current = (((tmp[0] & 0x07) << 8) | tmp[1]);
+  current = (REGMAP_GROUP_FIELD(&DRV10975_CURRENT, tmp, &DRV10975_CURRENT_MSB) << 8) | tmp[DRV10975_REG_MOTOR_CURRENT2 - DRV10975_CURRENT.reg];
 
-  if(current >= 0x3FF)
-  {
-    me->value.current = (float)((current - 0x3FF) * 170.67);
-  }
-  else
-  {
-    me->value.current = (float)(current * 170.67);
-  }
+  me->value.current_ma = fixconv_drv10975_current_ma(current);
 
   return BS_OK;
 }
 
-base_status_t drv10975_check_over_temp(drv10975_t *me)
+base_status_t drv10975_snapshot(drv10975_t *me, uint64_t timestamp_us, drv10975_snapshot_t *snap)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_STATUS, &tmp, 1));
-
-  me->status = tmp & 0x80;
+  uint8_t tmp[DRV10975_REG_FAULT_CODE - DRV10975_REG_STATUS + 1];
+  uint16_t current;
+  uint16_t kt;
+
+  CHECK_STATUS(regmap_group_read(&me->map, &DRV10975_MONITOR, tmp));
+
+  current = (REGMAP_GROUP_FIELD(&DRV10975_MONITOR, tmp, &DRV10975_CURRENT_MSB) << 8) |
+            tmp[DRV10975_REG_MOTOR_CURRENT2 - DRV10975_MONITOR.reg];
+  kt      = (REGMAP_GROUP_FIELD(&DRV10975_MONITOR, tmp, &DRV10975_KT_MSB) << 8) |
+            tmp[DRV10975_REG_MOTOR_KT2 - DRV10975_MONITOR.reg];
+
+  snap->timestamp_us     = timestamp_us;
+  snap->flags.word       = ((uint16_t)tmp[DRV10975_REG_STATUS - DRV10975_MONITOR.reg] << 8) |
+                           tmp[DRV10975_REG_FAULT_CODE - DRV10975_MONITOR.reg];
+  snap->velocity_mhz     = fixconv_drv10975_velocity_mhz(REGMAP_GROUP_BE16(&DRV10975_MONITOR, tmp, DRV10975_REG_MOTOR_SPEED1));
+  snap->period_us        = fixconv_drv10975_period_us(REGMAP_GROUP_BE16(&DRV10975_MONITOR, tmp, DRV10975_REG_MOTOR_PERIOD1));
+  snap->kt_uv_hz         = fixconv_drv10975_kt_uv_hz(kt);
+  snap->current_ma       = fixconv_drv10975_current_ma(current);
+  snap->supply_mv        = fixconv_drv10975_supply_mv(tmp[DRV10975_REG_SUPPLY_VOLTAGE - DRV10975_MONITOR.reg]);
+  snap->speed_cmd        = (uint16_t)tmp[DRV10975_REG_SPEED_CMD - DRV10975_MONITOR.reg] << 1;
+  snap->speed_cmd_buffer = (uint16_t)tmp[DRV10975_REG_SPD_CMD_BUFFER - DRV10975_MONITOR.reg] << 1;
+  snap->ipd_position     = tmp[DRV10975_REG_IPD_POSITION - DRV10975_MONITOR.reg];
+
+  me->fault.raised.word  = snap->flags.word & ~me->fault.flags.word;
+  me->fault.cleared.word = me->fault.flags.word & ~snap->flags.word;
+  me->fault.flags        = snap->flags;
+  me->fault.polls++;
+
+  me->value.velocity_mhz = snap->velocity_mhz;
+  me->value.period_us    = snap->period_us;
+  me->value.current_ma   = snap->current_ma;
+  me->value.supply_mv    = snap->supply_mv;
 
   return BS_OK;
 }
 
-base_status_t drv10975_check_sleep_mode(drv10975_t *me)
+base_status_t drv10975_poll_status(drv10975_t *me)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_STATUS, &tmp, 1));
-
-  me->status = tmp & 0x40;
+  drv10975_snapshot_t snap;
 
-  return BS_OK;
+  return drv10975_snapshot(me, 0, &snap);
 }
 
-base_status_t drv10975_check_over_current(drv10975_t *me)
+base_status_t drv10975_check_over_temp(drv10975_t *me)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_STATUS, &tmp, 1));
+  CHECK_STATUS(drv10975_poll_status(me));
 
-  me->status = tmp & 0x20;
+  me->status = (drv10975_status_t)((me->fault.flags.word >> 8) & DRV10975_OVER_TEMP);
 
   return BS_OK;
 }
 
-base_status_t drv10975_check_motor_lock(drv10975_t *me)
+base_status_t drv10975_check_sleep_mode(drv10975_t *me)
 {
-  uint8_t tmp;
+  CHECK_STATUS(drv10975_poll_status(me));
 
-  CHECK_STATUS(m_drv10975_read_reg(me, DRV10975_REG_STATUS, &tmp, 1));
+  me->status = (drv10975_status_t)((me->fault.flags.word >> 8) & DRV10975_SLEEP);
 
-  me->status = tmp & 0x10;
-  
   return BS_OK;
 }
 
-/* Private function definitions ---------------------------------------- */
-/**
- * @brief         DRV10975 read register
- *
- * @param[in]     me      Pointer to handle of DRV10975 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
- *
- * @attention     None
- *
- * @return
- * - BS_OK
- * - BS_ERROR
- */
-static base_status_t m_drv10975_read_reg(drv10975_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
+base_status_t drv10975_check_over_current(drv10975_t *me)
 {
-  CHECK(0 == me->i2c_read(me->device_address, reg, p_data, len), BS_ERROR);
+  CHECK_STATUS(drv10975_poll_status(me));
+
+  me->status = (drv10975_status_t)((me->fault.flags.word >> 8) & DRV10975_OVER_CURRENT);
 
   return BS_OK;
 }
 
-/**
- * @brief         DRV10975 write register
- *
- * @param[in]     me      Pointer to handle of DRV10975 module.
- * @param[in]     reg     Register
- * @param[in]     data    Data to write
- *
- * @attention     None
- *
- * @return
- * - BS_OK
- * - BS_ERROR
- */
-static base_status_t m_drv10975_write_reg(drv10975_t *me, uint8_t reg, uint8_t data)
+base_status_t drv10975_check_motor_lock(drv10975_t *me)
 {
-  CHECK(0 == me->i2c_write(me->device_address, reg, &data, 1), BS_ERROR);
+  CHECK_STATUS(drv10975_poll_status(me));
+
+  me->status = (drv10975_status_t)((me->fault.flags.word >> 8) & DRV10975_MOTOR_LOCK);
 
   return BS_OK;
 }
 
+/* Private function definitions ---------------------------------------- */
 /**
  * @brief         DRV10975 map number
  *
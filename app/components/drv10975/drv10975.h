@@ -20,9 +20,11 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
  #include "bsp.h"
+ #include "regmap.h"
 
 /* Public defines ----------------------------------------------------- */
 #define DRV10975_I2C_ADDR                       (0x52 << 1) // I2C bus need 8 bits address
+#define DRV10975_SPEED_CMD_MAX                  (0x1FF)     // 9 bits speed command
 
 /* Public enumerate/structure ----------------------------------------- */
 /**
@@ -31,10 +33,10 @@ extern "C" {
 typedef struct
 {
   uint16_t speed;    
-  float period;
-  float current;
-  float supply_voltage;
-  float velocity;
+  uint32_t period_us;
+  int32_t current_ma;
+  uint32_t supply_mv;
+  uint32_t velocity_mhz;    // Electrical frequency in millihertz
 }
 drv10975_motor_value_t;
 
@@ -50,6 +52,60 @@ typedef enum
 }
 drv10975_status_t;
 
+/**
+ * @brief DRV10975 status and fault flags, STATUS in the high byte and FAULT_CODE in the low byte
+ */
+typedef union
+{
+  struct
+  {
+    uint16_t lock_current   : 1;  // FAULT_CODE Lock0: lock detection current limit
+    uint16_t abnormal_speed : 1;  // FAULT_CODE Lock1: speed abnormal
+    uint16_t abnormal_kt    : 1;  // FAULT_CODE Lock2: Kt abnormal
+    uint16_t no_motor       : 1;  // FAULT_CODE Lock3: no motor
+    uint16_t stuck_open     : 1;  // FAULT_CODE Lock4: stuck in open loop
+    uint16_t stuck_closed   : 1;  // FAULT_CODE Lock5: stuck in closed loop
+    uint16_t                : 6;
+    uint16_t motor_lock     : 1;  // STATUS MtrLck
+    uint16_t over_current   : 1;  // STATUS OverCurr
+    uint16_t sleep          : 1;  // STATUS Slp
+    uint16_t over_temp      : 1;  // STATUS OverTemp
+  }
+  bit;
+  uint16_t word;
+}
+drv10975_flags_t;
+
+/**
+ * @brief DRV10975 fault state of the last status poll
+ */
+typedef struct
+{
+  drv10975_flags_t flags;   // Flags set now
+  drv10975_flags_t raised;  // Set since the previous poll
+  drv10975_flags_t cleared; // Cleared since the previous poll
+  uint32_t polls;
+}
+drv10975_fault_t;
+
+/**
+ * @brief DRV10975 telemetry snapshot of the STATUS to FAULT_CODE block
+ */
+typedef struct
+{
+  uint64_t timestamp_us;    // Time of the read, from the caller
+  drv10975_flags_t flags;   // Status and fault flags
+  uint32_t velocity_mhz;    // Electrical frequency in millihertz
+  uint32_t period_us;       // Electrical period
+  uint32_t kt_uv_hz;        // Phase BEMF constant in microvolt per hertz
+  int32_t current_ma;
+  uint32_t supply_mv;
+  uint16_t speed_cmd;       // Command in effect, 9 bits scale
+  uint16_t speed_cmd_buffer;// Command before the acceleration limit, 9 bits scale
+  uint8_t ipd_position;     // Rotor position from the initial position detection
+}
+drv10975_snapshot_t;
+
 /**
  * @brief DRV10975 struct
  */
@@ -57,7 +113,10 @@ typedef struct
 {
   uint8_t device_address;  // I2C device address
   drv10975_status_t status; // Device status
+  drv10975_fault_t fault;   // Status and fault flags, updated by every snapshot
   drv10975_motor_value_t value; // Motor value
+  bool eeprom_updated;     // Set by init when the EEPROM had to be programmed
+  regmap_t map;            // Register map, set up by init
 
   // Read n-bytes from device's internal address <reg_addr> via I2C bus
   int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
@@ -79,7 +138,8 @@ drv10975_t;
  *
  * @param[in]     me      Pointer to handle of DRV10975 module.
  *
- * @attention     None
+ * @attention     Only the configuration registers that differ are written, and the
+ *                EEPROM is only programmed when something changed
  *
  * @return
  * - BS_OK
@@ -115,6 +175,21 @@ base_status_t drv10975_set_motor_direction(drv10975_t *me, uint8_t dir);
  */
 base_status_t drv10975_set_motor_speed(drv10975_t *me, uint8_t percent_speed);
 
+/**
+ * @brief         DRV10975 set the raw speed command
+ *
+ * @param[in]     me      Pointer to handle of DRV10975 module.
+ * @param[in]     cmd     Speed command, 0 to DRV10975_SPEED_CMD_MAX
+ *
+ * @attention     One burst write of SpeedCtrl1 and SpeedCtrl2, no delay, for the
+ *                speed control loop
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t drv10975_set_speed_cmd(drv10975_t *me, uint16_t cmd);
+
 /**
  * @brief         DRV10975 get motor velocity
  *
@@ -167,12 +242,43 @@ base_status_t drv10975_get_motor_supply_voltage(drv10975_t *me);
  */
 base_status_t drv10975_get_motor_current(drv10975_t *me);
 
+/**
+ * @brief         DRV10975 read the motor telemetry
+ *
+ * @param[in]     me            Pointer to handle of DRV10975 module.
+ * @param[in]     timestamp_us  Time of the read
+ * @param[out]    snap          Pointer to snapshot
+ *
+ * @attention     One burst read of STATUS to FAULT_CODE, converted in fixed point.
+ *                Also updates me->fault with the flags raised and cleared since the
+ *                previous read, and the speed, period, current and supply voltage in
+ *                me->value.
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t drv10975_snapshot(drv10975_t *me, uint64_t timestamp_us, drv10975_snapshot_t *snap);
+
+/**
+ * @brief         DRV10975 poll the status and fault flags
+ *
+ * @param[in]     me      Pointer to handle of DRV10975 module.
+ *
+ * @attention     A drv10975_snapshot() without the timestamp
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t drv10975_poll_status(drv10975_t *me);
+
 /**
  * @brief         DRV10975 check device over temp
  *
  * @param[in]     me      Pointer to handle of DRV10975 module.
  *
- * @attention     None
+ * @attention     Runs a full drv10975_poll_status(), prefer it to check several flags
  *
  * @return
  * - BS_OK
@@ -185,7 +291,7 @@ base_status_t drv10975_check_over_temp(drv10975_t *me);
  *
  * @param[in]     me      Pointer to handle of DRV10975 module.
  *
- * @attention     None
+ * @attention     Runs a full drv10975_poll_status(), prefer it to check several flags
  *
  * @return
  * - BS_OK
@@ -198,7 +304,7 @@ base_status_t drv10975_check_sleep_mode(drv10975_t *me);
  *
  * @param[in]     me      Pointer to handle of DRV10975 module.
  *
- * @attention     None
+ * @attention     Runs a full drv10975_poll_status(), prefer it to check several flags
  *
  * @return
  * - BS_OK
@@ -211,7 +317,7 @@ base_status_t drv10975_check_over_current(drv10975_t *me);
  *
  * @param[in]     me      Pointer to handle of DRV10975 module.
  *
- * @attention     None
+ * @attention     Runs a full drv10975_poll_status(), prefer it to check several flags
  *
  * @return
  * - BS_OK
@@ -0,0 +1,132 @@
+/**
+ * @file       fixconv.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Fixed point conversion of sensor codes to engineering units
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "fixconv.h"
+
+/* Private defines ---------------------------------------------------- */
+#define FIXCONV_PAC1934_VBUS_FSR_MV     (32000)   // VBUS full scale range
+#define FIXCONV_PAC1934_VBUS_FSR_V      (32)      // VPOWER full scale is FSC x 32 V
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+// IAM20380 millidegree per second per LSB, Q16, by FS_SEL: 1000 / 131, 65.5, 32.8, 16.4
+static const int32_t m_fixconv_gyro_q16[4] = { 500275, 1000550, 1998049, 3996098 };
+
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+int32_t fixconv_iam20380_rate_mdps(int16_t raw, uint8_t fullscale)
+{
+  return (int32_t)(((int64_t)raw * m_fixconv_gyro_q16[fullscale & 0x03] + 0x8000) >> 16);
+}
+
+void fixconv_iam20380_rate_mdps_batch(const int16_t *raw, int32_t *mdps, uint32_t count, uint8_t fullscale)
+{
+  int32_t k = m_fixconv_gyro_q16[fullscale & 0x03];
+
+  for (uint32_t i = 0; i < count; i++)
+    mdps[i] = (int32_t)(((int64_t)raw[i] * k + 0x8000) >> 16);
+}
+
+uint32_t fixconv_drv10975_velocity_mhz(uint16_t code)
+{
+  return (uint32_t)code * 100;
+}
+
+uint32_t fixconv_drv10975_period_us(uint16_t code)
+{
+  return (uint32_t)code * 10;
+}
+
+uint32_t fixconv_drv10975_supply_mv(uint8_t code)
+{
+  return ((uint32_t)code * 22800 + 128) >> 8;
+}
+
+int32_t fixconv_drv10975_current_ma(uint16_t code)
+{
+  if (code <= 0x3FF)
+    return 0;
+
+  return (int32_t)((((uint32_t)code - 0x3FF) * 3000 + 1024) >> 11);
+}
+
+uint32_t fixconv_drv10975_kt_uv_hz(uint16_t code)
+{
+  return ((uint32_t)code * 1000000 + 1090) / 2180;
+}
+
+uint32_t fixconv_pac1934_vbus_mv(uint16_t code)
+{
+  if (code >= 0x8000)
+    return ((0x10000u - code) * FIXCONV_PAC1934_VBUS_FSR_MV + 0x7FFF) / 0xFFFF;
+
+  return ((uint32_t)code * FIXCONV_PAC1934_VBUS_FSR_MV + 0x3FFF) / 0x7FFF;
+}
+
+void fixconv_pac1934_vbus_mv_batch(const uint16_t *code, uint32_t *mv, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    mv[i] = fixconv_pac1934_vbus_mv(code[i]);
+}
+
+uint32_t fixconv_pac1934_vsense_ma(uint16_t code, uint16_t fsc_ma)
+{
+  if (code >= 0x8000)
+    return ((0x10000u - code) * fsc_ma + 0x7FFF) / 0xFFFF;
+
+  return ((uint32_t)code * fsc_ma + 0x3FFF) / 0x7FFF;
+}
+
+void fixconv_pac1934_vsense_ma_batch(const uint16_t *code, uint32_t *ma, uint32_t count, uint16_t fsc_ma)
+{
+  for (uint32_t i = 0; i < count; i++)
+    ma[i] = fixconv_pac1934_vsense_ma(code[i], fsc_ma);
+}
+
+uint32_t fixconv_pac1934_vpower_mw(uint32_t code, uint16_t fsc_ma)
+{
+  uint32_t fsp_mw = (uint32_t)fsc_ma * FIXCONV_PAC1934_VBUS_FSR_V;
+
+  // Divisors 0xFFFFFFF0 and 0x7FFFFFF0 taken as 2^32 and 2^31, 4 ppb off
+  if (code >= 0x80000000u)
+    return (uint32_t)(((uint64_t)(0u - code) * fsp_mw + 0x80000000u) >> 32);
+
+  return (uint32_t)(((uint64_t)code * fsp_mw + 0x40000000u) >> 31);
+}
+
+int64_t fixconv_pac1934_energy_uj(int64_t acc, uint16_t fsc_ma, uint16_t rate_hz)
+{
+  int64_t fsp_uw = (int64_t)fsc_ma * FIXCONV_PAC1934_VBUS_FSR_MV;
+  int64_t q      = acc >> 27;                 // Whole full scale samples, floor
+  int64_t r      = acc & ((1 << 27) - 1);
+
+  // Split so the product stays in 64 bits for any 48 bits accumulator
+  return (q * fsp_uw + ((r * fsp_uw) >> 27)) / rate_hz;
+}
+
+uint8_t fixconv_bcd_to_bin(uint8_t bcd)
+{
+  return (uint8_t)((bcd >> 4) * 10 + (bcd & 0x0F));
+}
+
+uint8_t fixconv_bin_to_bcd(uint8_t bin)
+{
+  uint8_t tens = (uint8_t)((bin * 205u) >> 11);   // bin / 10 for bin < 1029
+
+  return (uint8_t)((tens << 4) | (bin - tens * 10));
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
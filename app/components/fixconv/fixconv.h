@@ -0,0 +1,216 @@
+/**
+ * @file       fixconv.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Fixed point conversion of sensor codes to engineering units
+ * @note       Integer only, the ESP32 has no double precision unit. Results are in
+ *             integer milli units, scales are Q16 or plain integer ratios that the
+ *             compiler turns into multiplications. The PAC1934 kernels keep the
+ *             sign handling of the former floating point code.
+ * @example    int32_t mdps = fixconv_iam20380_rate_mdps(raw, IAM20380_FULLSCALE_1000_DPS);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __FIXCONV_H
+#define __FIXCONV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         IAM20380 gyro code to rate
+ *
+ * @param[in]     raw         Gyro output code
+ * @param[in]     fullscale   FS_SEL, 0 = 250 dps to 3 = 2000 dps
+ *
+ * @attention     None
+ *
+ * @return        Rate in millidegree per second
+ */
+int32_t fixconv_iam20380_rate_mdps(int16_t raw, uint8_t fullscale);
+
+/**
+ * @brief         IAM20380 gyro codes to rates
+ *
+ * @param[in]     raw         Pointer to gyro output codes
+ * @param[out]    mdps        Pointer to rates in millidegree per second
+ * @param[in]     count       Number of codes
+ * @param[in]     fullscale   FS_SEL, 0 = 250 dps to 3 = 2000 dps
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void fixconv_iam20380_rate_mdps_batch(const int16_t *raw, int32_t *mdps, uint32_t count, uint8_t fullscale);
+
+/**
+ * @brief         DRV10975 MotorSpeed code to electrical frequency
+ *
+ * @param[in]     code      MotorSpeed, 0.1 Hz per LSB
+ *
+ * @attention     None
+ *
+ * @return        Frequency in millihertz
+ */
+uint32_t fixconv_drv10975_velocity_mhz(uint16_t code);
+
+/**
+ * @brief         DRV10975 MotorPeriod code to period
+ *
+ * @param[in]     code      MotorPeriod, 10 us per LSB
+ *
+ * @attention     None
+ *
+ * @return        Period in microsecond
+ */
+uint32_t fixconv_drv10975_period_us(uint16_t code);
+
+/**
+ * @brief         DRV10975 SupplyVoltage code to voltage
+ *
+ * @param[in]     code      SupplyVoltage, 22.8 V full scale
+ *
+ * @attention     None
+ *
+ * @return        Voltage in millivolt
+ */
+uint32_t fixconv_drv10975_supply_mv(uint8_t code);
+
+/**
+ * @brief         DRV10975 MotorCurrent code to current
+ *
+ * @param[in]     code      MotorCurrent, 11 bits, 0x3FF is 0 A, 3 A over 2048 LSB
+ *
+ * @attention     Codes below the offset clamp to 0
+ *
+ * @return        Current in milliampere
+ */
+int32_t fixconv_drv10975_current_ma(uint16_t code);
+
+/**
+ * @brief         DRV10975 MotorKt code to phase BEMF constant
+ *
+ * @param[in]     code      MotorKt, 11 bits, Kt = code / 2 / 1090 V/Hz
+ *
+ * @attention     None
+ *
+ * @return        BEMF constant in microvolt per hertz
+ */
+uint32_t fixconv_drv10975_kt_uv_hz(uint16_t code);
+
+/**
+ * @brief         PAC1934 VBUS code to voltage
+ *
+ * @param[in]     code      VBUS register
+ *
+ * @attention     Codes from 0x8000 are taken as negative and give their magnitude
+ *
+ * @return        Voltage in millivolt
+ */
+uint32_t fixconv_pac1934_vbus_mv(uint16_t code);
+
+/**
+ * @brief         PAC1934 VBUS codes to voltages
+ *
+ * @param[in]     code      Pointer to VBUS registers
+ * @param[out]    mv        Pointer to voltages in millivolt
+ * @param[in]     count     Number of codes
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void fixconv_pac1934_vbus_mv_batch(const uint16_t *code, uint32_t *mv, uint32_t count);
+
+/**
+ * @brief         PAC1934 VSENSE code to current
+ *
+ * @param[in]     code      VSENSE register
+ * @param[in]     fsc_ma    Full scale current in milliampere, 100 mV over the sense resistor, up to 65535
+ *
+ * @attention     Codes from 0x8000 are taken as negative and give their magnitude
+ *
+ * @return        Current in milliampere
+ */
+uint32_t fixconv_pac1934_vsense_ma(uint16_t code, uint16_t fsc_ma);
+
+/**
+ * @brief         PAC1934 VSENSE codes to currents
+ *
+ * @param[in]     code      Pointer to VSENSE registers
+ * @param[out]    ma        Pointer to currents in milliampere
+ * @param[in]     count     Number of codes
+ * @param[in]     fsc_ma    Full scale current in milliampere
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void fixconv_pac1934_vsense_ma_batch(const uint16_t *code, uint32_t *ma, uint32_t count, uint16_t fsc_ma);
+
+/**
+ * @brief         PAC1934 VPOWER code to power
+ *
+ * @param[in]     code      VPOWER register, 28 bits left aligned
+ * @param[in]     fsc_ma    Full scale current in milliampere
+ *
+ * @attention     Codes from 0x80000000 are taken as negative and give their magnitude
+ *
+ * @return        Power in milliwatt
+ */
+uint32_t fixconv_pac1934_vpower_mw(uint32_t code, uint16_t fsc_ma);
+
+/**
+ * @brief         PAC1934 VPOWER accumulator to energy
+ *
+ * @param[in]     acc       VPOWERn_ACC register, sign extended from 48 bits
+ * @param[in]     fsc_ma    Full scale current in milliampere
+ * @param[in]     rate_hz   Sample rate the accumulator ran at
+ *
+ * @attention     Bipolar accumulator, one sample at full scale is 2^27
+ *
+ * @return        Energy in microjoule
+ */
+int64_t fixconv_pac1934_energy_uj(int64_t acc, uint16_t fsc_ma, uint16_t rate_hz);
+
+/**
+ * @brief         PCF85063 BCD register to binary
+ *
+ * @param[in]     bcd       BCD value
+ *
+ * @attention     None
+ *
+ * @return        Binary value
+ */
+uint8_t fixconv_bcd_to_bin(uint8_t bcd);
+
+/**
+ * @brief         PCF85063 binary to BCD register
+ *
+ * @param[in]     bin       Binary value, 0 to 99
+ *
+ * @attention     None
+ *
+ * @return        BCD value
+ */
+uint8_t fixconv_bin_to_bcd(uint8_t bin);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __FIXCONV_H
+
+/* End of file -------------------------------------------------------- */
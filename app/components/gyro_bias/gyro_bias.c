@@ -0,0 +1,254 @@
+/**
+ * @file       gyro_bias.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-29
+ * @author     Hiep Le
+ * @brief      Gyroscope zero rate bias estimator
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "gyro_bias.h"
+
+/* Private defines ---------------------------------------------------- */
+#define GYRO_BIAS_MAX_GAP_US            (1000000) // Longer sample gaps restart the stillness
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+#define ABS(_x)                         (((_x) < 0) ? -(_x) : (_x))
+
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+/* Private function prototypes ---------------------------------------- */
+static int32_t m_gyro_bias_model_q8(const gyro_bias_t *me, int axis, int16_t temp_cdeg);
+static int32_t m_gyro_bias_q8_to_mdps(const gyro_bias_t *me, int32_t q8);
+static int32_t m_gyro_bias_mdps_to_q8(const gyro_bias_t *me, int32_t mdps);
+static void m_gyro_bias_window_restart(gyro_bias_t *me);
+static void m_gyro_bias_window_done(gyro_bias_t *me);
+
+/* Function definitions ----------------------------------------------- */
+void gyro_bias_init(gyro_bias_t *me, uint16_t sensitivity_x10, const gyro_bias_cal_t *cal)
+{
+  memset(me, 0, sizeof(*me));
+  me->sensitivity_x10 = sensitivity_x10;
+
+  if (cal != NULL)
+  {
+    me->cal           = *cal;
+    me->valid         = true;
+    me->ref_temp_cdeg = cal->temp_cdeg;
+    memcpy(me->ref_q8, cal->bias_q8, sizeof(me->ref_q8));
+    memcpy(me->saved_q8, cal->bias_q8, sizeof(me->saved_q8));
+  }
+}
+
+bool gyro_bias_update(gyro_bias_t *me, const int16_t rate[3], int16_t temp_cdeg, uint64_t timestamp_us)
+{
+  int32_t still_q8;
+  int32_t ref_q8;
+  uint32_t dt_us;
+  bool cold;
+
+  if ((me->last_us == 0) || (timestamp_us <= me->last_us) || (timestamp_us - me->last_us > GYRO_BIAS_MAX_GAP_US))
+  {
+    me->last_us  = timestamp_us;
+    me->still_us = 0;
+    m_gyro_bias_window_restart(me);
+    return false;
+  }
+
+  dt_us       = (uint32_t)(timestamp_us - me->last_us);
+  me->last_us = timestamp_us;
+
+  // A stale model hides every still window, learn it again as on a cold start
+  if (me->valid && !me->relearn)
+  {
+    me->idle_us += dt_us;
+    if (me->idle_us >= GYRO_BIAS_RELEARN_US)
+    {
+      me->relearn = true;
+      me->metrics.relearns++;
+      me->still_us = 0;
+      m_gyro_bias_window_restart(me);
+    }
+  }
+
+  // Still when every axis is close to the model, or to zero before the first estimate
+  cold     = !me->valid || me->relearn;
+  still_q8 = m_gyro_bias_mdps_to_q8(me, cold ? GYRO_BIAS_STILL_MDPS + GYRO_BIAS_MAX_BIAS_MDPS : GYRO_BIAS_STILL_MDPS);
+  for (int i = 0; i < 3; i++)
+  {
+    ref_q8 = cold ? 0 : m_gyro_bias_model_q8(me, i, temp_cdeg);
+    if (ABS(((int32_t)rate[i] << 8) - ref_q8) > still_q8)
+    {
+      me->still_us = 0;
+      m_gyro_bias_window_restart(me);
+      return false;
+    }
+  }
+
+  if (me->still_us < GYRO_BIAS_SETTLE_US)
+  {
+    me->still_us += dt_us;
+    return false;
+  }
+
+  for (int i = 0; i < 3; i++)
+    me->sum[i] += rate[i];
+  me->temp_sum += temp_cdeg;
+  me->window_cnt++;
+  me->window_us += dt_us;
+
+  if (me->window_us < GYRO_BIAS_WINDOW_US)
+    return false;
+
+  m_gyro_bias_window_done(me);
+  m_gyro_bias_window_restart(me);
+
+  return true;
+}
+
+void gyro_bias_get(const gyro_bias_t *me, int16_t temp_cdeg, int16_t bias[3])
+{
+  for (int i = 0; i < 3; i++)
+    bias[i] = me->valid ? (int16_t)((m_gyro_bias_model_q8(me, i, temp_cdeg) + 128) >> 8) : 0;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Gyro bias model of one axis at a temperature
+ *
+ * @param[in]     me            Pointer to handle of gyro bias estimator
+ * @param[in]     axis          Axis
+ * @param[in]     temp_cdeg     Temperature in centidegree Celsius
+ *
+ * @attention     None
+ *
+ * @return        Bias in counts, Q8
+ */
+static int32_t m_gyro_bias_model_q8(const gyro_bias_t *me, int axis, int16_t temp_cdeg)
+{
+  return me->cal.bias_q8[axis] + (me->cal.slope_q8[axis] * ((int32_t)temp_cdeg - me->cal.temp_cdeg)) / 100;
+}
+
+/**
+ * @brief         Gyro bias convert counts to a rate
+ *
+ * @param[in]     me        Pointer to handle of gyro bias estimator
+ * @param[in]     q8        Counts, Q8
+ *
+ * @attention     None
+ *
+ * @return        Rate in millidegree per second
+ */
+static int32_t m_gyro_bias_q8_to_mdps(const gyro_bias_t *me, int32_t q8)
+{
+  return (int32_t)(((int64_t)q8 * 10000) / ((int32_t)me->sensitivity_x10 * 256));
+}
+
+/**
+ * @brief         Gyro bias convert a rate to counts
+ *
+ * @param[in]     me        Pointer to handle of gyro bias estimator
+ * @param[in]     mdps      Rate in millidegree per second
+ *
+ * @attention     None
+ *
+ * @return        Counts, Q8
+ */
+static int32_t m_gyro_bias_mdps_to_q8(const gyro_bias_t *me, int32_t mdps)
+{
+  return (int32_t)(((int64_t)mdps * me->sensitivity_x10 * 256) / 10000);
+}
+
+/**
+ * @brief         Gyro bias clear the window sums
+ *
+ * @param[in]     me        Pointer to handle of gyro bias estimator
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_gyro_bias_window_restart(gyro_bias_t *me)
+{
+  memset(me->sum, 0, sizeof(me->sum));
+  me->temp_sum   = 0;
+  me->window_us  = 0;
+  me->window_cnt = 0;
+}
+
+/**
+ * @brief         Gyro bias update the model from a complete still window
+ *
+ * @param[in]     me        Pointer to handle of gyro bias estimator
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_gyro_bias_window_done(gyro_bias_t *me)
+{
+  int16_t temp_cdeg = (int16_t)(me->temp_sum / me->window_cnt);
+  int32_t ref_cdeg  = (int32_t)temp_cdeg - me->ref_temp_cdeg;
+  bool cold         = !me->valid || me->relearn;
+  bool slope        = !cold && (ABS(ref_cdeg) >= GYRO_BIAS_SLOPE_MIN_CDEG);
+  int32_t mean_q8;
+  int32_t model_q8;
+  int32_t residual;
+  bool moved = false;
+
+  me->metrics.windows++;
+  me->metrics.temp_cdeg = temp_cdeg;
+
+  for (int i = 0; i < 3; i++)
+  {
+    mean_q8 = (int32_t)(((int64_t)me->sum[i] * 256) / me->window_cnt);
+
+    if (cold)
+    {
+      me->cal.bias_q8[i] = mean_q8;   // First estimate or relearn, taken as is
+      me->ref_q8[i]      = mean_q8;
+      continue;
+    }
+
+    // Residual of the model, then the bias follows it at this temperature
+    model_q8 = m_gyro_bias_model_q8(me, i, temp_cdeg);
+    residual = m_gyro_bias_q8_to_mdps(me, mean_q8 - model_q8);
+    me->metrics.residual_mdps[i] = residual;
+    if (ABS(residual) > me->metrics.max_residual_mdps)
+      me->metrics.max_residual_mdps = ABS(residual);
+
+    me->cal.bias_q8[i] = model_q8 + ((mean_q8 - model_q8) >> GYRO_BIAS_FILTER_SHIFT);
+
+    // Slope from the bias tracked across the temperature span
+    if (slope)
+    {
+      me->cal.slope_q8[i] += ((((me->cal.bias_q8[i] - me->ref_q8[i]) * 100) / ref_cdeg) - me->cal.slope_q8[i]) >> GYRO_BIAS_SLOPE_SHIFT;
+      me->ref_q8[i]        = me->cal.bias_q8[i];
+    }
+
+    if (ABS(m_gyro_bias_q8_to_mdps(me, me->cal.bias_q8[i] - me->saved_q8[i])) >= GYRO_BIAS_SAVE_MDPS)
+      moved = true;
+  }
+
+  me->cal.temp_cdeg = temp_cdeg;
+  if (cold || slope)
+    me->ref_temp_cdeg = temp_cdeg;
+
+  if (cold || moved || slope)
+  {
+    memcpy(me->saved_q8, me->cal.bias_q8, sizeof(me->saved_q8));
+    me->dirty = true;
+  }
+
+  me->valid   = true;
+  me->relearn = false;
+  me->idle_us = 0;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,153 @@
+/**
+ * @file       gyro_bias.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-29
+ * @author     Hiep Le
+ * @brief      Gyroscope zero rate bias estimator
+ * @note       Integer only and platform agnostic. The bias is measured over windows
+ *             in which the sensor is still and is modelled as linear in temperature:
+ *
+ *               bias(T) = bias + slope * (T - temp)
+ *
+ *             Each still window pulls the bias toward its measurement and moves the
+ *             anchor to its temperature. Once the temperature has moved far enough
+ *             the change of the tracked bias gives the slope, which carries the model
+ *             between still windows. The residual of each window against the model is
+ *             kept as the drift metric.
+ * @example    gyro_bias_init(&bias, 328, saved ? &cal : NULL);
+ *
+ *             for each gyro sample:
+ *               gyro_bias_update(&bias, rate, temp_cdeg, timestamp_us);
+ *               gyro_bias_get(&bias, temp_cdeg, offset);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __GYRO_BIAS_H
+#define __GYRO_BIAS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define GYRO_BIAS_STILL_MDPS            (2000)    // Rate against the model under this on all axes is still
+#define GYRO_BIAS_MAX_BIAS_MDPS         (5000)    // Zero rate offset allowed before the first estimate
+#define GYRO_BIAS_SETTLE_US             (2000000) // Stillness before a window starts
+#define GYRO_BIAS_WINDOW_US             (1000000) // Still window length
+#define GYRO_BIAS_FILTER_SHIFT          (2)       // Bias update, 1/4 of the window error
+#define GYRO_BIAS_SLOPE_SHIFT           (1)       // Slope update, 1/2 of the measured error
+#define GYRO_BIAS_SLOPE_MIN_CDEG        (100)     // Temperature span to measure the slope
+#define GYRO_BIAS_SAVE_MDPS             (100)     // Bias change worth saving
+#define GYRO_BIAS_RELEARN_US            (300000000) // No still window for this long, the model is learned again
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Gyro bias calibration, the part worth keeping across power cycles
+ */
+typedef struct
+{
+  int32_t bias_q8[3];       // Bias in counts at <temp_cdeg>, Q8
+  int32_t slope_q8[3];      // Bias change in counts per degree Celsius, Q8
+  int16_t temp_cdeg;        // Model anchor temperature in centidegree Celsius
+}
+gyro_bias_cal_t;
+
+/**
+ * @brief Gyro bias drift metrics
+ */
+typedef struct
+{
+  uint32_t windows;         // Still windows measured
+  uint32_t relearns;        // Fallbacks to the cold start threshold
+  int32_t residual_mdps[3]; // Last window against the model before its update
+  int32_t max_residual_mdps;// Largest residual on any axis since init
+  int16_t temp_cdeg;        // Temperature of the last window
+}
+gyro_bias_metrics_t;
+
+/**
+ * @brief Gyro bias estimator
+ */
+typedef struct
+{
+  uint16_t sensitivity_x10; // Gyro counts per degree per second, times 10
+  gyro_bias_cal_t cal;
+  bool valid;               // Calibration loaded or measured
+  bool dirty;               // Calibration moved since the caller last saved it, cleared by the caller
+  bool relearn;             // Model too far off to see a still window, next window taken as is
+
+  uint32_t still_us;        // Time the sensor has been still
+  uint32_t idle_us;         // Time since the last still window
+  uint64_t last_us;         // Timestamp of the previous sample, 0 before the first one
+  int32_t sum[3];           // Window sums in counts
+  int32_t temp_sum;         // Window sum of the temperature
+  uint32_t window_us;
+  uint16_t window_cnt;
+
+  int32_t ref_q8[3];        // Bias at the last slope measurement
+  int16_t ref_temp_cdeg;    // Temperature of the last slope measurement
+  int32_t saved_q8[3];      // Bias when last flagged dirty
+  gyro_bias_metrics_t metrics;
+}
+gyro_bias_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Gyro bias init
+ *
+ * @param[in]     me                Pointer to handle of gyro bias estimator
+ * @param[in]     sensitivity_x10   Gyro counts per degree per second, times 10
+ * @param[in]     cal               Pointer to a saved calibration, NULL for a cold start
+ *
+ * @attention     A saved calibration is used at once, no recalibration on a warm start.
+ *                If no still window is seen for GYRO_BIAS_RELEARN_US the stillness test
+ *                falls back to the cold start threshold and the next window replaces the bias.
+ *
+ * @return        None
+ */
+void gyro_bias_init(gyro_bias_t *me, uint16_t sensitivity_x10, const gyro_bias_cal_t *cal);
+
+/**
+ * @brief         Gyro bias feed one raw gyro sample
+ *
+ * @param[in]     me            Pointer to handle of gyro bias estimator
+ * @param[in]     rate          Raw gyro X, Y, Z in counts
+ * @param[in]     temp_cdeg     Sensor temperature in centidegree Celsius
+ * @param[in]     timestamp_us  Sample time in microsecond
+ *
+ * @attention     Samples must come in time order
+ *
+ * @return
+ * - true       A still window completed and updated the calibration
+ * - false      Otherwise
+ */
+bool gyro_bias_update(gyro_bias_t *me, const int16_t rate[3], int16_t temp_cdeg, uint64_t timestamp_us);
+
+/**
+ * @brief         Gyro bias get the bias at a temperature
+ *
+ * @param[in]     me            Pointer to handle of gyro bias estimator
+ * @param[in]     temp_cdeg     Sensor temperature in centidegree Celsius
+ * @param[out]    bias          Bias X, Y, Z in counts, 0 while not valid
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void gyro_bias_get(const gyro_bias_t *me, int16_t temp_cdeg, int16_t bias[3]);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __GYRO_BIAS_H
+
+/* End of file -------------------------------------------------------- */
@@ -25,14 +25,83 @@
 #include <stdio.h>
 #include "esp_log.h"
 #include "driver/i2c.h"
+#include "driver/gpio.h"
 #include "i2c_bus.h"
 #include "audio_mutex.h"
 #include "audio_mem.h"
+#include "audio_idf_version.h"
+#include "esp_timer.h"
 
 #define ESP_INTR_FLG_DEFAULT  (0)
 #define ESP_I2C_MASTER_BUF_LEN  (0)
 #define I2C_ACK_CHECK_EN 1
 
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0))
+#include "esp_rom_sys.h"
+#define i2c_bus_delay_us(us)  esp_rom_delay_us(us)
+#else
+#include "rom/ets_sys.h"
+#define i2c_bus_delay_us(us)  ets_delay_us(us)
+#endif
+
+#define I2C_BUS_CLEAR_CLOCKS       (9)     /*!< Enough to finish any byte a slave is sending */
+#define I2C_BUS_CLEAR_HALF_PERIOD  (5)     /*!< us, 100 kHz bit-banged clock */
+
+#if (ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0))
+#define I2C_BUS_STATIC_LINK_SUPPORTED 1
+// Largest link built here is the combined register read: two START/address/payload groups plus STOP
+#define I2C_BUS_CMD_LINK_BUF_LEN  I2C_LINK_RECOMMENDED_SIZE(2)
+#else
+#define I2C_BUS_STATIC_LINK_SUPPORTED 0
+#endif
+
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+/*
+ * Before v4.4 the driver has no static links and allocates every command of a link from
+ * the heap. Static mode there builds one link per transaction shape when the bus is
+ * created and reuses it, patching the address bytes, buffers and lengths in place before
+ * each transaction. The types below mirror the private command link of that driver; the
+ * mirror is checked against a probe link at create time and the bus falls back to heap
+ * links if it does not match.
+ */
+typedef struct {
+    uint8_t byte_num;        /*!<Bytes of the command, consumed by the ISR */
+    uint8_t ack_en;
+    uint8_t ack_exp;
+    uint8_t ack_val;
+    uint8_t *data;           /*!<Payload, NULL for a single byte in byte_cmd, advanced by the ISR */
+    uint8_t byte_cmd;
+    i2c_opmode_t op_code;
+} i2c_bus_cmd_t;
+
+typedef struct i2c_bus_cmd_node {
+    i2c_bus_cmd_t cmd;
+    struct i2c_bus_cmd_node *next;
+} i2c_bus_cmd_node_t;
+
+typedef struct {
+    i2c_bus_cmd_node_t *head;
+    i2c_bus_cmd_node_t *cur;
+    i2c_bus_cmd_node_t *free;
+} i2c_bus_cmd_desc_t;
+
+typedef enum {
+    I2C_BUS_LINK_WRITE_DATA = 0, /*!<START, addr+W, data, STOP */
+    I2C_BUS_LINK_WRITE_REG,      /*!<START, addr+W, reg, data, STOP */
+    I2C_BUS_LINK_READ_ONE,       /*!<START, addr+W, reg, START, addr+R, byte NACK, STOP */
+    I2C_BUS_LINK_READ_MANY,      /*!<Same, the bytes before the last ACKed */
+    I2C_BUS_LINK_MAX,
+} i2c_bus_link_shape_t;
+
+#define I2C_BUS_LINK_NODES_MAX   (8)
+#define I2C_BUS_LINK_CHUNK_MAX   (0xFF)  /*!< Longest payload of one command, the driver splits longer ones */
+
+typedef struct {
+    i2c_cmd_handle_t handle;
+    i2c_bus_cmd_node_t *node[I2C_BUS_LINK_NODES_MAX];
+} i2c_bus_link_t;
+#endif
+
 #define I2C_BUS_CHECK(a, str, ret)  if(!(a)) {                               \
     ESP_LOGE(TAG, "%s:%d (%s):%s", __FILE__, __LINE__, __FUNCTION__, str);   \
     return (ret);                                                            \
@@ -41,6 +110,15 @@
 typedef struct {
     i2c_config_t i2c_conf;   /*!<I2C bus parameters*/
     i2c_port_t i2c_port;     /*!<I2C port number */
+    i2c_bus_cmd_link_mode_t link_mode; /*!<Command link allocation mode */
+    uint32_t alloc_count;    /*!<Heap allocated command links since creation */
+    uint32_t rate_count;     /*!<alloc_count at the start of the rate window */
+    int64_t rate_stamp_us;   /*!<Start of the rate window */
+#if I2C_BUS_STATIC_LINK_SUPPORTED
+    uint8_t cmd_buf[I2C_BUS_CMD_LINK_BUF_LEN]; /*!<Command link storage for static mode */
+#else
+    i2c_bus_link_t link[I2C_BUS_LINK_MAX];     /*!<Reused links for static mode */
+#endif
 } i2c_bus_t;
 
 static const char *TAG = "I2C_BUS";
@@ -49,7 +127,187 @@ static i2c_bus_t *i2c_bus[I2C_NUM_MAX];
 
 static xSemaphoreHandle _busLock;
 
+static i2c_cmd_handle_t i2c_bus_cmd_link_get(i2c_bus_t *p_bus)
+{
+#if I2C_BUS_STATIC_LINK_SUPPORTED
+    if (p_bus->link_mode == I2C_BUS_CMD_LINK_STATIC) {
+        return i2c_cmd_link_create_static(p_bus->cmd_buf, sizeof(p_bus->cmd_buf));
+    }
+#endif
+    p_bus->alloc_count++;
+    return i2c_cmd_link_create();
+}
+
+static void i2c_bus_cmd_link_put(i2c_bus_t *p_bus, i2c_cmd_handle_t cmd)
+{
+#if I2C_BUS_STATIC_LINK_SUPPORTED
+    if (p_bus->link_mode == I2C_BUS_CMD_LINK_STATIC) {
+        i2c_cmd_link_delete_static(cmd);
+        return;
+    }
+#else
+    for (int i = 0; i < I2C_BUS_LINK_MAX; i++) {
+        if (cmd == p_bus->link[i].handle) {
+            return;
+        }
+    }
+#endif
+    i2c_cmd_link_delete(cmd);
+}
+
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+static int i2c_bus_link_walk(i2c_cmd_handle_t cmd, i2c_bus_cmd_node_t **node)
+{
+    i2c_bus_cmd_desc_t *desc = (i2c_bus_cmd_desc_t *) cmd;
+    i2c_bus_cmd_node_t *it = desc->head;
+    int cnt = 0;
+
+    while ((it != NULL) && (cnt < I2C_BUS_LINK_NODES_MAX)) {
+        node[cnt++] = it;
+        if (it->next == NULL) {
+            break;
+        }
+        it = it->next;
+    }
+    if ((it == NULL) || (it->next != NULL) || (desc->cur != it)) {
+        return -1;
+    }
+    return cnt;
+}
+
+static bool i2c_bus_link_layout_ok(void)
+{
+    uint8_t buf[3] = { 0 };
+    i2c_bus_cmd_node_t *node[I2C_BUS_LINK_NODES_MAX];
+    bool ok = false;
+
+    // Probe link with a known shape, every field the reuse patches must be where the mirror says
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    if (cmd == NULL) {
+        return false;
+    }
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, 0x5A, I2C_ACK_CHECK_EN);
+    i2c_master_write(cmd, buf, sizeof(buf), I2C_ACK_CHECK_EN);
+    i2c_master_stop(cmd);
+    if (i2c_bus_link_walk(cmd, node) == 4) {
+        ok = (node[0]->cmd.op_code == I2C_CMD_RESTART)
+             && (node[1]->cmd.op_code == I2C_CMD_WRITE) && (node[1]->cmd.data == NULL)
+             && (node[1]->cmd.byte_cmd == 0x5A) && (node[1]->cmd.byte_num == 1)
+             && (node[2]->cmd.op_code == I2C_CMD_WRITE) && (node[2]->cmd.data == buf)
+             && (node[2]->cmd.byte_num == sizeof(buf))
+             && (node[3]->cmd.op_code == I2C_CMD_STOP);
+    }
+    i2c_cmd_link_delete(cmd);
+    return ok;
+}
+
+static void i2c_bus_link_free(i2c_bus_t *p_bus)
+{
+    for (int i = 0; i < I2C_BUS_LINK_MAX; i++) {
+        if (p_bus->link[i].handle) {
+            i2c_cmd_link_delete(p_bus->link[i].handle);
+            p_bus->link[i].handle = NULL;
+        }
+    }
+}
+
+static bool i2c_bus_link_build(i2c_bus_t *p_bus)
+{
+    static uint8_t dummy[2];
+    static const int nodes[I2C_BUS_LINK_MAX] = { 4, 5, 7, 8 };
+
+    if (!i2c_bus_link_layout_ok()) {
+        return false;
+    }
+    for (int i = 0; i < I2C_BUS_LINK_MAX; i++) {
+        i2c_cmd_handle_t cmd = i2c_bus_cmd_link_get(p_bus);
+        if (cmd == NULL) {
+            i2c_bus_link_free(p_bus);
+            return false;
+        }
+        p_bus->link[i].handle = cmd;
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, 0, I2C_ACK_CHECK_EN);
+        if (i != I2C_BUS_LINK_WRITE_DATA) {
+            i2c_master_write(cmd, dummy, 1, I2C_ACK_CHECK_EN);
+        }
+        if ((i == I2C_BUS_LINK_WRITE_DATA) || (i == I2C_BUS_LINK_WRITE_REG)) {
+            i2c_master_write(cmd, dummy, 1, I2C_ACK_CHECK_EN);
+        } else {
+            i2c_master_start(cmd);
+            i2c_master_write_byte(cmd, 0x01, I2C_ACK_CHECK_EN);
+            i2c_master_read(cmd, dummy, (i == I2C_BUS_LINK_READ_ONE) ? 1 : 2, I2C_MASTER_LAST_NACK);
+        }
+        i2c_master_stop(cmd);
+        if (i2c_bus_link_walk(cmd, p_bus->link[i].node) != nodes[i]) {
+            i2c_bus_link_free(p_bus);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void i2c_bus_link_set(i2c_bus_cmd_node_t *node, uint8_t *data, int len)
+{
+    node->cmd.data = data;
+    node->cmd.byte_num = (uint8_t) len;
+}
+
+static void i2c_bus_link_set_byte(i2c_bus_cmd_node_t *node, uint8_t byte)
+{
+    node->cmd.data = NULL;
+    node->cmd.byte_cmd = byte;
+    node->cmd.byte_num = 1;
+}
+#endif
+
+/*
+ * Reused link of the given shape with this transaction patched in, NULL when the bus builds
+ * links per transaction or a length does not fit one command. Called under the bus lock.
+ */
+static i2c_cmd_handle_t i2c_bus_link_prepare(i2c_bus_t *p_bus, int addr, uint8_t *reg, int reglen, uint8_t *data, int datalen, bool read)
+{
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+    i2c_bus_link_t *link;
+
+    if ((p_bus->link_mode != I2C_BUS_CMD_LINK_STATIC) || (datalen <= 0) || (datalen > I2C_BUS_LINK_CHUNK_MAX)
+        || (reglen < 0) || (reglen > I2C_BUS_LINK_CHUNK_MAX) || ((reglen == 0) && read)) {
+        return NULL;
+    }
+    if (!read) {
+        link = &p_bus->link[(reglen == 0) ? I2C_BUS_LINK_WRITE_DATA : I2C_BUS_LINK_WRITE_REG];
+        i2c_bus_link_set_byte(link->node[1], addr);
+        if (reglen == 0) {
+            i2c_bus_link_set(link->node[2], data, datalen);
+        } else {
+            i2c_bus_link_set(link->node[2], reg, reglen);
+            i2c_bus_link_set(link->node[3], data, datalen);
+        }
+        return link->handle;
+    }
+    link = &p_bus->link[(datalen == 1) ? I2C_BUS_LINK_READ_ONE : I2C_BUS_LINK_READ_MANY];
+    i2c_bus_link_set_byte(link->node[1], addr);
+    i2c_bus_link_set(link->node[2], reg, reglen);
+    i2c_bus_link_set_byte(link->node[4], addr | 0x01);
+    if (datalen == 1) {
+        i2c_bus_link_set(link->node[5], data, 1);
+    } else {
+        i2c_bus_link_set(link->node[5], data, datalen - 1);
+        i2c_bus_link_set(link->node[6], data + datalen - 1, 1);
+    }
+    return link->handle;
+#else
+    return NULL;
+#endif
+}
+
 i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf)
+{
+    return i2c_bus_create_with_mode(port, conf, I2C_BUS_CMD_LINK_DYNAMIC);
+}
+
+i2c_bus_handle_t i2c_bus_create_with_mode(i2c_port_t port, i2c_config_t *conf, i2c_bus_cmd_link_mode_t mode)
 {
     I2C_BUS_CHECK(port < I2C_NUM_MAX, "I2C port error", NULL);
     I2C_BUS_CHECK(conf != NULL, "Configuration not initialized", NULL);
@@ -60,6 +318,14 @@ i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf)
     i2c_bus[port] = (i2c_bus_t *) audio_calloc(1, sizeof(i2c_bus_t));
     i2c_bus[port]->i2c_conf = *conf;
     i2c_bus[port]->i2c_port = port;
+    i2c_bus[port]->link_mode = mode;
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+    if ((mode == I2C_BUS_CMD_LINK_STATIC) && !i2c_bus_link_build(i2c_bus[port])) {
+        ESP_LOGW(TAG, "Command link layout not recognised, using heap links");
+        i2c_bus[port]->link_mode = I2C_BUS_CMD_LINK_DYNAMIC;
+    }
+#endif
+    i2c_bus[port]->rate_stamp_us = esp_timer_get_time();
     esp_err_t ret = i2c_param_config(i2c_bus[port]->i2c_port, &i2c_bus[port]->i2c_conf);
     if (ret != ESP_OK) {
         goto error;
@@ -76,7 +342,11 @@ i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf)
 
 error:
     if (i2c_bus[port]) {
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+        i2c_bus_link_free(i2c_bus[port]);
+#endif
         audio_free(i2c_bus[port]);
+        i2c_bus[port] = NULL;
     }
     return NULL;
 }
@@ -89,14 +359,17 @@ esp_err_t i2c_bus_write_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int
     I2C_BUS_CHECK(data != NULL, "Not initialized input data pointer", ESP_FAIL);
     esp_err_t ret = ESP_OK;
     mutex_lock(_busLock);
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    ret |= i2c_master_start(cmd);
-    ret |= i2c_master_write_byte(cmd, addr, 1);
-    ret |= i2c_master_write(cmd, reg, regLen, I2C_ACK_CHECK_EN);
-    ret |= i2c_master_write(cmd, data, datalen, I2C_ACK_CHECK_EN);
-    ret |= i2c_master_stop(cmd);
+    i2c_cmd_handle_t cmd = i2c_bus_link_prepare(p_bus, addr, reg, regLen, data, datalen, false);
+    if (cmd == NULL) {
+        cmd = i2c_bus_cmd_link_get(p_bus);
+        ret |= i2c_master_start(cmd);
+        ret |= i2c_master_write_byte(cmd, addr, 1);
+        ret |= i2c_master_write(cmd, reg, regLen, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_write(cmd, data, datalen, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_stop(cmd);
+    }
     ret |= i2c_master_cmd_begin(p_bus->i2c_port, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_bus_cmd_link_put(p_bus, cmd);
     mutex_unlock(_busLock);
     I2C_BUS_CHECK(ret == 0, "I2C Bus WriteReg Error", ESP_FAIL);
     return ret;
@@ -110,13 +383,16 @@ esp_err_t i2c_bus_write_data(i2c_bus_handle_t bus, int addr, uint8_t *data, int
     I2C_BUS_CHECK(data != NULL, "Not initialized input data pointer", ESP_FAIL);
     esp_err_t ret = ESP_OK;
     mutex_lock(_busLock);
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    ret |= i2c_master_start(cmd);
-    ret |= i2c_master_write_byte(cmd, addr, 1);
-    ret |= i2c_master_write(cmd, data, datalen, I2C_ACK_CHECK_EN);
-    ret |= i2c_master_stop(cmd);
+    i2c_cmd_handle_t cmd = i2c_bus_link_prepare(p_bus, addr, NULL, 0, data, datalen, false);
+    if (cmd == NULL) {
+        cmd = i2c_bus_cmd_link_get(p_bus);
+        ret |= i2c_master_start(cmd);
+        ret |= i2c_master_write_byte(cmd, addr, 1);
+        ret |= i2c_master_write(cmd, data, datalen, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_stop(cmd);
+    }
     ret |= i2c_master_cmd_begin(p_bus->i2c_port, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_bus_cmd_link_put(p_bus, cmd);
     mutex_unlock(_busLock);
     I2C_BUS_CHECK(ret == 0, "I2C Bus WriteReg Error", ESP_FAIL);
     return ret;
@@ -128,32 +404,112 @@ esp_err_t i2c_bus_read_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int r
     i2c_bus_t *p_bus = (i2c_bus_t *) bus;
     I2C_BUS_CHECK(p_bus->i2c_port < I2C_NUM_MAX, "I2C port error", ESP_FAIL);
     I2C_BUS_CHECK(outdata != NULL, "Not initialized output data buffer pointer", ESP_FAIL);
+    I2C_BUS_CHECK(datalen > 0, "Invalid read length", ESP_FAIL);
     esp_err_t ret = ESP_OK;
     mutex_lock(_busLock);
-    i2c_cmd_handle_t cmd;
-    cmd = i2c_cmd_link_create();
-    ret |= i2c_master_start(cmd);
-    ret |= i2c_master_write_byte(cmd, addr, I2C_ACK_CHECK_EN);
-    ret |= i2c_master_write(cmd, reg, reglen, I2C_ACK_CHECK_EN);
-    ret |= i2c_master_stop(cmd);
+    // Register address write and data read share one transaction: START, addr+W, reg,
+    // repeated START, addr+R, data, STOP. The bus is never released between the two phases.
+    i2c_cmd_handle_t cmd = i2c_bus_link_prepare(p_bus, addr, reg, reglen, outdata, datalen, true);
+    if (cmd == NULL) {
+        cmd = i2c_bus_cmd_link_get(p_bus);
+        ret |= i2c_master_start(cmd);
+        ret |= i2c_master_write_byte(cmd, addr, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_write(cmd, reg, reglen, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_start(cmd);
+        ret |= i2c_master_write_byte(cmd, addr | 0x01, I2C_ACK_CHECK_EN);
+        ret |= i2c_master_read(cmd, outdata, datalen, I2C_MASTER_LAST_NACK);
+        ret |= i2c_master_stop(cmd);
+    }
     ret |= i2c_master_cmd_begin(p_bus->i2c_port, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    i2c_bus_cmd_link_put(p_bus, cmd);
+
+    mutex_unlock(_busLock);
+    I2C_BUS_CHECK(ret == 0, "I2C Bus ReadReg Error", ESP_FAIL);
+    return ret;
+}
+
+uint32_t i2c_bus_get_alloc_count(i2c_bus_handle_t bus)
+{
+    I2C_BUS_CHECK(bus != NULL, "Handle error", 0);
+    i2c_bus_t *p_bus = (i2c_bus_t *) bus;
+
+    return p_bus->alloc_count;
+}
+
+uint32_t i2c_bus_get_allocs_per_sec(i2c_bus_handle_t bus)
+{
+    I2C_BUS_CHECK(bus != NULL, "Handle error", 0);
+    i2c_bus_t *p_bus = (i2c_bus_t *) bus;
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - p_bus->rate_stamp_us;
+    uint32_t count = p_bus->alloc_count;
+
+    if (elapsed <= 0) {
+        return 0;
+    }
+    uint32_t rate = (uint32_t)(((uint64_t)(count - p_bus->rate_count) * 1000000ULL) / (uint64_t)elapsed);
+    p_bus->rate_count = count;
+    p_bus->rate_stamp_us = now;
+    return rate;
+}
+
+esp_err_t i2c_bus_clear(i2c_bus_handle_t bus)
+{
+    I2C_BUS_CHECK(bus != NULL, "Handle error", ESP_FAIL);
+    i2c_bus_t *p_bus = (i2c_bus_t *) bus;
+    int sda_io = p_bus->i2c_conf.sda_io_num;
+    int scl_io = p_bus->i2c_conf.scl_io_num;
+    esp_err_t ret = ESP_OK;
 
-    cmd = i2c_cmd_link_create();
-    ret |= i2c_master_start(cmd);
-    ret |= i2c_master_write_byte(cmd, addr | 0x01, I2C_ACK_CHECK_EN);
+    mutex_lock(_busLock);
+    gpio_set_level(sda_io, 1);
+    gpio_set_level(scl_io, 1);
+    gpio_set_direction(scl_io, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_direction(sda_io, GPIO_MODE_INPUT_OUTPUT_OD);
 
-    for (int i = 0; i < datalen - 1; i++) {
-        ret |= i2c_master_read_byte(cmd, &outdata[i], 0);
+    // A slave interrupted in a read keeps driving SDA low, clock it until it lets go
+    for (int i = 0; (i < I2C_BUS_CLEAR_CLOCKS) && (gpio_get_level(sda_io) == 0); i++) {
+        gpio_set_level(scl_io, 0);
+        i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_PERIOD);
+        gpio_set_level(scl_io, 1);
+        i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_PERIOD);
     }
-    ret |= i2c_master_read_byte(cmd, &outdata[datalen - 1], 1);
 
-    ret = i2c_master_stop(cmd);
-    ret = i2c_master_cmd_begin(p_bus->i2c_port, cmd, 1000 / portTICK_RATE_MS);
-    i2c_cmd_link_delete(cmd);
+    // STOP condition, SDA rising while SCL is high
+    gpio_set_level(scl_io, 0);
+    gpio_set_level(sda_io, 0);
+    i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_PERIOD);
+    gpio_set_level(scl_io, 1);
+    i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_PERIOD);
+    gpio_set_level(sda_io, 1);
+    i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_PERIOD);
+
+    if ((gpio_get_level(sda_io) == 0) || (gpio_get_level(scl_io) == 0)) {
+        ret = ESP_FAIL;
+    }
 
+    i2c_set_pin(p_bus->i2c_port, sda_io, scl_io, p_bus->i2c_conf.sda_pullup_en, p_bus->i2c_conf.scl_pullup_en, p_bus->i2c_conf.mode);
+    i2c_reset_tx_fifo(p_bus->i2c_port);
+    i2c_reset_rx_fifo(p_bus->i2c_port);
     mutex_unlock(_busLock);
-    I2C_BUS_CHECK(ret == 0, "I2C Bus ReadReg Error", ESP_FAIL);
+
+    I2C_BUS_CHECK(ret == ESP_OK, "I2C bus still held low after clear", ESP_FAIL);
+    return ret;
+}
+
+esp_err_t i2c_bus_reinstall(i2c_bus_handle_t bus)
+{
+    I2C_BUS_CHECK(bus != NULL, "Handle error", ESP_FAIL);
+    i2c_bus_t *p_bus = (i2c_bus_t *) bus;
+    esp_err_t ret = ESP_OK;
+
+    mutex_lock(_busLock);
+    i2c_driver_delete(p_bus->i2c_port);
+    ret |= i2c_param_config(p_bus->i2c_port, &p_bus->i2c_conf);
+    ret |= i2c_driver_install(p_bus->i2c_port, p_bus->i2c_conf.mode, ESP_I2C_MASTER_BUF_LEN, ESP_I2C_MASTER_BUF_LEN, ESP_INTR_FLG_DEFAULT);
+    mutex_unlock(_busLock);
+
+    I2C_BUS_CHECK(ret == ESP_OK, "I2C driver reinstall error", ESP_FAIL);
     return ret;
 }
 
@@ -163,6 +519,9 @@ esp_err_t i2c_bus_delete(i2c_bus_handle_t bus)
     i2c_bus_t *p_bus = (i2c_bus_t *) bus;
     i2c_driver_delete(p_bus->i2c_port);
     i2c_bus[p_bus->i2c_port] = NULL;
+#if !I2C_BUS_STATIC_LINK_SUPPORTED
+    i2c_bus_link_free(p_bus);
+#endif
     audio_free(p_bus);
     mutex_destroy(_busLock);
 
@@ -32,9 +32,19 @@ extern "C" {
 
 typedef void *i2c_bus_handle_t;
 
+/**
+ * @brief Command link allocation mode of an I2C bus
+ */
+typedef enum {
+    I2C_BUS_CMD_LINK_DYNAMIC = 0,  /*!< Allocate every command link from the heap */
+    I2C_BUS_CMD_LINK_STATIC,       /*!< Command links owned by the bus, no heap use in steady state */
+} i2c_bus_cmd_link_mode_t;
+
 /**
  * @brief Create and init I2C bus and return a I2C bus handle
  *
+ *        Command links are allocated from the heap for every transaction.
+ *
  * @param port       I2C port number
  * @param conf       Pointer to I2C parameters
  *
@@ -43,6 +53,25 @@ typedef void *i2c_bus_handle_t;
  */
 i2c_bus_handle_t i2c_bus_create(i2c_port_t port, i2c_config_t *conf);
 
+/**
+ * @brief Create and init I2C bus with the given command link mode
+ *
+ *        In I2C_BUS_CMD_LINK_STATIC mode steady state bus traffic does no heap allocation.
+ *        From ESP-IDF v4.4 every transaction is built in a buffer embedded in the bus
+ *        object. Older releases have no static links; the bus builds one link per
+ *        transaction shape here and reuses it. Payloads over 255 bytes still take a heap
+ *        link, and the bus falls back to heap links if the driver's link layout is not
+ *        the one it knows.
+ *
+ * @param port       I2C port number
+ * @param conf       Pointer to I2C parameters
+ * @param mode       Command link allocation mode
+ *
+ * @return
+ *     - I2C bus handle
+ */
+i2c_bus_handle_t i2c_bus_create_with_mode(i2c_port_t port, i2c_config_t *conf, i2c_bus_cmd_link_mode_t mode);
+
 /**
  * @brief Write bytes to I2C bus
  *
@@ -76,6 +105,9 @@ esp_err_t i2c_bus_write_data(i2c_bus_handle_t bus, int addr, uint8_t *data, int
 /**
  * @brief Read bytes to I2C bus
  *
+ *        The register write and the data read are issued as a single transaction
+ *        joined by a repeated START.
+ *
  * @param bus        I2C bus handle
  * @param addr       The address of the device
  * @param reg        The register of the device
@@ -89,6 +121,55 @@ esp_err_t i2c_bus_write_data(i2c_bus_handle_t bus, int addr, uint8_t *data, int
  */
 esp_err_t i2c_bus_read_bytes(i2c_bus_handle_t bus, int addr, uint8_t *reg, int reglen, uint8_t *outdata, int datalen);
 
+/**
+ * @brief Get the number of heap allocated command links since the bus was created
+ *
+ * @param bus        I2C bus handle
+ *
+ * @return
+ *     - Allocation count
+ */
+uint32_t i2c_bus_get_alloc_count(i2c_bus_handle_t bus);
+
+/**
+ * @brief Get the command link allocation rate since the previous call
+ *
+ * @param bus        I2C bus handle
+ *
+ * @return
+ *     - Allocations per second, 0 when the bus runs allocation free
+ */
+uint32_t i2c_bus_get_allocs_per_sec(i2c_bus_handle_t bus);
+
+/**
+ * @brief Free a bus held by a stuck slave
+ *
+ *        Clocks SCL as GPIO until SDA is released (at most 9 clocks), sends a STOP,
+ *        then hands the pins back to the I2C controller and resets its FIFOs.
+ *        The bus object, driver and lock are kept.
+ *
+ * @param bus        I2C bus handle
+ *
+ * @return
+ *     - ESP_OK Success, both lines are high
+ *     - ESP_FAIL Fail, a line is still held low
+ */
+esp_err_t i2c_bus_clear(i2c_bus_handle_t bus);
+
+/**
+ * @brief Reinstall the I2C driver of the bus with its original configuration
+ *
+ *        Unlike i2c_bus_delete() and i2c_bus_create(), the bus object and its lock are kept,
+ *        so the handle stays valid for other tasks.
+ *
+ * @param bus        I2C bus handle
+ *
+ * @return
+ *     - ESP_OK Success
+ *     - ESP_FAIL Fail
+ */
+esp_err_t i2c_bus_reinstall(i2c_bus_handle_t bus);
+
 /**
  * @brief Delete and release the I2C bus object
  *
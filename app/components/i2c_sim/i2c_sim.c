@@ -0,0 +1,268 @@
+/**
+ * @file       i2c_sim.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      Virtual I2C bus with register models of PAC1934, IAM20380, DRV10975 and PCF85063
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "i2c_sim_dev.h"
+
+/* Private defines ---------------------------------------------------- */
+#define I2C_SIM_DEV_CNT                 (4)
+#define I2C_SIM_BITS_PER_BYTE           (9)     // 8 data bits and ACK
+#define I2C_SIM_DEFAULT_CLK_SPEED       (400000)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief I2C simulator device slot
+ */
+typedef struct
+{
+  const i2c_sim_dev_t *dev;
+  uint32_t inject_errors;
+  i2c_sim_stats_t stats;
+}
+i2c_sim_slot_t;
+
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static i2c_sim_slot_t m_sim_slot[I2C_SIM_DEV_CNT] =
+{
+  { .dev = &i2c_sim_pac1934_dev  },
+  { .dev = &i2c_sim_iam20380_dev },
+  { .dev = &i2c_sim_drv10975_dev },
+  { .dev = &i2c_sim_pcf85063_dev }
+};
+
+static uint32_t m_sim_clk_speed = I2C_SIM_DEFAULT_CLK_SPEED;
+static uint32_t m_sim_overhead_us;
+static uint64_t m_sim_time_us;
+static i2c_sim_time_fn_t m_sim_time_fn;
+
+/* Private function prototypes ---------------------------------------- */
+static i2c_sim_slot_t *m_i2c_sim_get_slot(uint8_t slave_addr);
+static uint64_t m_i2c_sim_bus_time(uint32_t bytes, uint32_t conditions);
+static int m_i2c_sim_begin(i2c_sim_slot_t *slot, uint32_t bytes, uint32_t conditions);
+
+/* Function definitions ----------------------------------------------- */
+void i2c_sim_init(uint32_t clk_speed, uint32_t overhead_us)
+{
+  m_sim_clk_speed   = (clk_speed != 0) ? clk_speed : I2C_SIM_DEFAULT_CLK_SPEED;
+  m_sim_overhead_us = overhead_us;
+  m_sim_time_us     = 0;
+
+  i2c_sim_reset_stats();
+
+  for (int i = 0; i < I2C_SIM_DEV_CNT; i++)
+    m_sim_slot[i].inject_errors = 0;
+
+  i2c_sim_power_cycle();
+}
+
+void i2c_sim_power_cycle(void)
+{
+  uint64_t now_us = i2c_sim_get_time_us();
+
+  for (int i = 0; i < I2C_SIM_DEV_CNT; i++)
+    m_sim_slot[i].dev->reset(now_us);
+}
+
+void i2c_sim_set_time_source(i2c_sim_time_fn_t fn)
+{
+  m_sim_time_fn = fn;
+}
+
+int i2c_sim_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+  i2c_sim_slot_t *slot = m_i2c_sim_get_slot(slave_addr);
+
+  // START, address, register, repeated START, address, data, STOP
+  if (m_i2c_sim_begin(slot, 3 + len, 3) != 0)
+    return 1;
+
+  slot->stats.reads++;
+
+  return slot->dev->read(reg_addr, data, len, i2c_sim_get_time_us());
+}
+
+int i2c_sim_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+  i2c_sim_slot_t *slot = m_i2c_sim_get_slot(slave_addr);
+
+  // START, address, register, data, STOP
+  if (m_i2c_sim_begin(slot, 2 + len, 2) != 0)
+    return 1;
+
+  slot->stats.writes++;
+
+  return slot->dev->write(reg_addr, data, len, i2c_sim_get_time_us());
+}
+
+int i2c_sim_write_data(uint8_t slave_addr, uint8_t *data, uint32_t len)
+{
+  i2c_sim_slot_t *slot = m_i2c_sim_get_slot(slave_addr);
+
+  if ((data == NULL) || (len == 0))
+    return 1;
+
+  // START, address, data, STOP
+  if (m_i2c_sim_begin(slot, 1 + len, 2) != 0)
+    return 1;
+
+  slot->stats.writes++;
+
+  return slot->dev->write(data[0], &data[1], len - 1, i2c_sim_get_time_us());
+}
+
+void i2c_sim_delay_ms(uint32_t ms)
+{
+  i2c_sim_advance_us((uint64_t)ms * 1000);
+}
+
+void i2c_sim_advance_us(uint64_t us)
+{
+  m_sim_time_us += us;
+}
+
+uint64_t i2c_sim_get_time_us(void)
+{
+  if (m_sim_time_fn != NULL)
+    return m_sim_time_fn();
+
+  return m_sim_time_us;
+}
+
+void i2c_sim_inject_error(uint8_t slave_addr, uint32_t count)
+{
+  i2c_sim_slot_t *slot = m_i2c_sim_get_slot(slave_addr);
+
+  if (slot != NULL)
+    slot->inject_errors = count;
+}
+
+int i2c_sim_get_stats(uint8_t slave_addr, i2c_sim_stats_t *stats)
+{
+  i2c_sim_slot_t *slot;
+
+  if (stats == NULL)
+    return 1;
+
+  if (slave_addr == I2C_SIM_ADDR_ALL)
+  {
+    memset(stats, 0, sizeof(i2c_sim_stats_t));
+    for (int i = 0; i < I2C_SIM_DEV_CNT; i++)
+    {
+      stats->reads  += m_sim_slot[i].stats.reads;
+      stats->writes += m_sim_slot[i].stats.writes;
+      stats->bytes  += m_sim_slot[i].stats.bytes;
+      stats->errors += m_sim_slot[i].stats.errors;
+      stats->bus_us += m_sim_slot[i].stats.bus_us;
+    }
+
+    return 0;
+  }
+
+  slot = m_i2c_sim_get_slot(slave_addr);
+  if (slot == NULL)
+    return 1;
+
+  *stats = slot->stats;
+
+  return 0;
+}
+
+void i2c_sim_reset_stats(void)
+{
+  for (int i = 0; i < I2C_SIM_DEV_CNT; i++)
+    memset(&m_sim_slot[i].stats, 0, sizeof(i2c_sim_stats_t));
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Get the device slot of a slave address
+ *
+ * @param[in]     slave_addr    Slave address, 8 bits form
+ *
+ * @attention     None
+ *
+ * @return        Pointer to slot, NULL when no device answers
+ */
+static i2c_sim_slot_t *m_i2c_sim_get_slot(uint8_t slave_addr)
+{
+  for (int i = 0; i < I2C_SIM_DEV_CNT; i++)
+  {
+    if (m_sim_slot[i].dev->slave_addr == (slave_addr & 0xFE))
+      return &m_sim_slot[i];
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief         Time a transaction takes on the bus
+ *
+ * @param[in]     bytes         Bytes on the wire, address bytes included
+ * @param[in]     conditions    START, repeated START and STOP conditions
+ *
+ * @attention     A condition is counted as one SCL period
+ *
+ * @return        Time in microsecond, software overhead included
+ */
+static uint64_t m_i2c_sim_bus_time(uint32_t bytes, uint32_t conditions)
+{
+  uint64_t bits = (uint64_t)bytes * I2C_SIM_BITS_PER_BYTE + conditions;
+
+  return ((bits * 1000000) + m_sim_clk_speed - 1) / m_sim_clk_speed + m_sim_overhead_us;
+}
+
+/**
+ * @brief         Account a transaction and decide if the device ACKs it
+ *
+ * @param[in]     slot          Device slot, NULL when no device answers
+ * @param[in]     bytes         Bytes on the wire, address bytes included
+ * @param[in]     conditions    START, repeated START and STOP conditions
+ *
+ * @attention     A NACKed transaction costs the address byte only
+ *
+ * @return
+ * - 0      ACK
+ * - 1      NACK
+ */
+static int m_i2c_sim_begin(i2c_sim_slot_t *slot, uint32_t bytes, uint32_t conditions)
+{
+  uint64_t bus_us;
+
+  if (slot == NULL)
+  {
+    i2c_sim_advance_us(m_i2c_sim_bus_time(1, 2));
+    return 1;
+  }
+
+  if (slot->inject_errors > 0)
+  {
+    slot->inject_errors--;
+    bus_us = m_i2c_sim_bus_time(1, 2);
+    slot->stats.errors++;
+    slot->stats.bytes  += 1;
+    slot->stats.bus_us += bus_us;
+    i2c_sim_advance_us(bus_us);
+    return 1;
+  }
+
+  bus_us = m_i2c_sim_bus_time(bytes, conditions);
+  slot->stats.bytes  += bytes;
+  slot->stats.bus_us += bus_us;
+  i2c_sim_advance_us(bus_us);
+
+  return 0;
+}
+
+/* End of file -------------------------------------------------------- */
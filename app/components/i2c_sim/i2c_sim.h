@@ -0,0 +1,305 @@
+/**
+ * @file       i2c_sim.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      Virtual I2C bus with register models of PAC1934, IAM20380, DRV10975 and PCF85063
+ * @note       Plain C, no ESP-IDF dependency. The transfer functions have the same
+ *             signatures as the driver I2C hooks, so they can be plugged into
+ *             pac1934_t, iam20380_t, drv10975_t and pcf85063_t directly.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __I2C_SIM_H
+#define __I2C_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define I2C_SIM_ADDR_ALL                (0x00)  // Select all devices in i2c_sim_get_stats()
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief I2C simulator transaction statistics
+ */
+typedef struct
+{
+  uint32_t reads;           // Register read transactions
+  uint32_t writes;          // Register and raw write transactions
+  uint32_t bytes;           // Bytes on the wire, address and register bytes included
+  uint32_t errors;          // NACKed transactions
+  uint64_t bus_us;          // Time spent on the bus, software overhead included
+}
+i2c_sim_stats_t;
+
+/**
+ * @brief I2C simulator time source, returns microseconds
+ */
+typedef uint64_t (*i2c_sim_time_fn_t)(void);
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         I2C simulator init, power up all device models
+ *
+ * @param[in]     clk_speed     SCL frequency in Hz used by the timing model
+ * @param[in]     overhead_us   Fixed software cost added to every transaction
+ *
+ * @attention     Resets the virtual clock and the statistics
+ *
+ * @return        None
+ */
+void i2c_sim_init(uint32_t clk_speed, uint32_t overhead_us);
+
+/**
+ * @brief         I2C simulator power cycle all device models
+ *
+ * @param[in]     None
+ *
+ * @attention     DRV10975 EEPROM content survives, as on the real chip
+ *
+ * @return        None
+ */
+void i2c_sim_power_cycle(void);
+
+/**
+ * @brief         I2C simulator use an external time source instead of the virtual clock
+ *
+ * @param[in]     fn      Time source, NULL to go back to the virtual clock
+ *
+ * @attention     With an external time source, i2c_sim_delay_ms() and bus time
+ *                no longer move the clock
+ *
+ * @return        None
+ */
+void i2c_sim_set_time_source(i2c_sim_time_fn_t fn);
+
+/**
+ * @brief         I2C simulator read register, same contract as bsp_i2c_read()
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      Register address
+ * @param[in]     data          Pointer to handle of data
+ * @param[in]     len           Data length
+ *
+ * @attention     None
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error, no device at slave_addr or injected error
+ */
+int i2c_sim_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         I2C simulator write register, same contract as bsp_i2c_write()
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      Register address
+ * @param[in]     data          Pointer to handle of data
+ * @param[in]     len           Data length
+ *
+ * @attention     None
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error, no device at slave_addr or injected error
+ */
+int i2c_sim_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         I2C simulator write raw data, same contract as bsp_i2c_write_data()
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     data          Pointer to handle of data, first byte is the register pointer
+ * @param[in]     len           Data length
+ *
+ * @attention     None
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error, no device at slave_addr or injected error
+ */
+int i2c_sim_write_data(uint8_t slave_addr, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         I2C simulator delay, moves the virtual clock
+ *
+ * @param[in]     ms      Delay in milisecond
+ *
+ * @attention     Plug into the delay_ms hook of the drivers
+ *
+ * @return        None
+ */
+void i2c_sim_delay_ms(uint32_t ms);
+
+/**
+ * @brief         I2C simulator move the virtual clock
+ *
+ * @param[in]     us      Time in microsecond
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_advance_us(uint64_t us);
+
+/**
+ * @brief         I2C simulator get current time
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Time in microsecond
+ */
+uint64_t i2c_sim_get_time_us(void);
+
+/**
+ * @brief         I2C simulator make the next transactions to a device fail
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     count         Number of transactions to NACK
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_inject_error(uint8_t slave_addr, uint32_t count);
+
+/**
+ * @brief         I2C simulator get transaction statistics
+ *
+ * @param[in]     slave_addr    Slave address, I2C_SIM_ADDR_ALL for the whole bus
+ * @param[out]    stats         Pointer to statistics
+ *
+ * @attention     None
+ *
+ * @return
+ * - 0      Succes
+ * - 1      Error, unknown device
+ */
+int i2c_sim_get_stats(uint8_t slave_addr, i2c_sim_stats_t *stats);
+
+/**
+ * @brief         I2C simulator reset transaction statistics
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_reset_stats(void);
+
+/**
+ * @brief         PAC1934 model set channel input
+ *
+ * @param[in]     channel       Channel 0 to 3
+ * @param[in]     vbus_mv       Bus voltage in mV, 0 to 32000
+ * @param[in]     current_ma    Load current in mA, -25000 to 25000 (100 mV over 4 mOhm)
+ *
+ * @attention     Register codes follow the NEG_PWR setting latched by the last REFRESH
+ *
+ * @return        None
+ */
+void i2c_sim_pac1934_set_channel(uint8_t channel, uint32_t vbus_mv, int32_t current_ma);
+
+/**
+ * @brief         IAM20380 model set angular rate
+ *
+ * @param[in]     x_mdps        X axis rate in milli degree per second
+ * @param[in]     y_mdps        Y axis rate in milli degree per second
+ * @param[in]     z_mdps        Z axis rate in milli degree per second
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_iam20380_set_rate(int32_t x_mdps, int32_t y_mdps, int32_t z_mdps);
+
+/**
+ * @brief         IAM20380 model set zero rate offset
+ *
+ * @param[in]     x_lsb         X axis offset in LSB
+ * @param[in]     y_lsb         Y axis offset in LSB
+ * @param[in]     z_lsb         Z axis offset in LSB
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_iam20380_set_bias(int16_t x_lsb, int16_t y_lsb, int16_t z_lsb);
+
+/**
+ * @brief         IAM20380 model set die temperature
+ *
+ * @param[in]     centi_deg     Temperature in 0.01 degree Celsius
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_iam20380_set_temp(int32_t centi_deg);
+
+/**
+ * @brief         DRV10975 model set supply voltage
+ *
+ * @param[in]     mv            Supply voltage in mV
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void i2c_sim_drv10975_set_supply(uint32_t mv);
+
+/**
+ * @brief         DRV10975 model set the load on the rotor
+ *
+ * @param[in]     percent       Share of the speed lost at any command, 0 to 100
+ *
+ * @attention     Steady state error of an open loop speed command
+ *
+ * @return        None
+ */
+void i2c_sim_drv10975_set_load(uint8_t percent);
+
+/**
+ * @brief         DRV10975 model raise faults
+ *
+ * @param[in]     status        STATUS register fault bits
+ * @param[in]     fault_code    FAULT_CODE register bits
+ *
+ * @attention     A motor lock stops the rotor model
+ *
+ * @return        None
+ */
+void i2c_sim_drv10975_set_fault(uint8_t status, uint8_t fault_code);
+
+/**
+ * @brief         DRV10975 model get EEPROM program cycles
+ *
+ * @param[in]     None
+ *
+ * @attention     Counted since i2c_sim_init()
+ *
+ * @return        Number of EEPROM program cycles
+ */
+uint32_t i2c_sim_drv10975_get_eeprom_writes(void);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __I2C_SIM_H
+
+/* End of file -------------------------------------------------------- */
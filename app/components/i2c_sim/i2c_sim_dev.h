@@ -0,0 +1,66 @@
+/**
+ * @file       i2c_sim_dev.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      Device model interface of the virtual I2C bus
+ * @note       Only included by the simulator sources
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __I2C_SIM_DEV_H
+#define __I2C_SIM_DEV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "i2c_sim.h"
+
+/* Public defines ----------------------------------------------------- */
+#define I2C_SIM_PAC1934_ADDR            (0x11 << 1)
+#define I2C_SIM_IAM20380_ADDR           (0x68 << 1)
+#define I2C_SIM_DRV10975_ADDR           (0x52 << 1)
+#define I2C_SIM_PCF85063_ADDR           (0x51 << 1)
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief I2C simulator device model
+ *
+ *        All four chips use the first written byte as register pointer,
+ *        so a model only sees register reads and writes. A write with len 0
+ *        only sets the pointer, PAC1934 uses it as command.
+ */
+typedef struct
+{
+  uint8_t slave_addr;
+  const char *name;
+
+  // Power on reset of the model
+  void (*reset) (uint64_t now_us);
+
+  // Read len bytes starting at reg, return 0 on ACK
+  int (*read) (uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us);
+
+  // Write len bytes starting at reg, return 0 on ACK
+  int (*write) (uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us);
+}
+i2c_sim_dev_t;
+
+/* Public variables --------------------------------------------------- */
+extern const i2c_sim_dev_t i2c_sim_pac1934_dev;
+extern const i2c_sim_dev_t i2c_sim_iam20380_dev;
+extern const i2c_sim_dev_t i2c_sim_drv10975_dev;
+extern const i2c_sim_dev_t i2c_sim_pcf85063_dev;
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __I2C_SIM_DEV_H
+
+/* End of file -------------------------------------------------------- */
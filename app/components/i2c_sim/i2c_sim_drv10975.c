@@ -0,0 +1,315 @@
+/**
+ * @file       i2c_sim_drv10975.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      DRV10975 register model for the virtual I2C bus
+ * @note       Models EEPROM access control and programming, the I2C speed
+ *             command and a first order rotor that reports speed, period, Kt,
+ *             current and supply voltage. A load setting takes a share of the
+ *             speed, as the blower does against the mask pressure.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "i2c_sim_dev.h"
+
+/* Private defines ---------------------------------------------------- */
+#define DRV10975_REG_SPEED_CTRL1                   (0X00)
+#define DRV10975_REG_SPEED_CTRL2                   (0X01)
+#define DRV10975_REG_DEV_CTRL                      (0X02)
+#define DRV10975_REG_EE_CTRL                       (0X03)
+#define DRV10975_REG_STATUS                        (0X10)
+#define DRV10975_REG_MOTOR_SPEED1                  (0X11)
+#define DRV10975_REG_MOTOR_PERIOD1                 (0X13)
+#define DRV10975_REG_MOTOR_KT1                     (0X15)
+#define DRV10975_REG_MOTOR_CURRENT1                (0X17)
+#define DRV10975_REG_IPD_POSITION                  (0X19)
+#define DRV10975_REG_SUPPLY_VOLTAGE                (0X1A)
+#define DRV10975_REG_SPEED_CMD                     (0X1B)
+#define DRV10975_REG_SPD_CMD_BUFFER                (0X1C)
+#define DRV10975_REG_FAULT_CODE                    (0X1E)
+#define DRV10975_REG_MOTOR_PARAM1                  (0X20)
+#define DRV10975_REG_SYS_OPT9                      (0X2B)
+#define DRV10975_REG_CNT                           (0X30)
+
+#define DRV10975_EE_CTRL_SIDATA                    (0x40)   // Config registers writable
+#define DRV10975_EE_CTRL_EE_WRITE                  (0x10)   // Program config registers into EEPROM
+#define DRV10975_DEV_CTRL_EE_KEY                   (0xB6)
+#define DRV10975_SPEED_CTRL2_OVERRIDE              (0x80)
+#define DRV10975_STATUS_SLEEP                      (0x40)
+#define DRV10975_STATUS_MOTOR_LOCK                 (0x10)
+
+#define DRV10975_CFG_CNT                           (DRV10975_REG_SYS_OPT9 - DRV10975_REG_MOTOR_PARAM1 + 1)
+#define DRV10975_SPEED_CMD_MAX                     (511)
+#define DRV10975_MAX_SPEED_DHZ                     (3000)   // Electrical speed at full command, 0.1 Hz
+#define DRV10975_TAU_US                            (250000) // Rotor time constant
+#define DRV10975_ZERO_CURRENT_CODE                 (0x3FF)  // MotorCurrent of 0 A
+#define DRV10975_IDLE_CURRENT_CODE                 (20)     // Above the zero code
+#define DRV10975_FULL_CURRENT_CODE                 (600)
+#define DRV10975_KT_CODE                           (436)    // MotorKt, 200 mV/Hz
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief DRV10975 model state
+ */
+typedef struct
+{
+  uint8_t reg[DRV10975_REG_CNT];
+  uint8_t eeprom[DRV10975_CFG_CNT];
+  uint32_t eeprom_writes;
+
+  uint64_t update_us;
+  uint32_t speed_dhz;           // Rotor speed, 0.1 Hz
+  uint32_t speed_frac;          // Sub 0.1 Hz remainder of the rotor model
+  uint32_t supply_mv;
+  uint8_t load_percent;         // Speed lost to the blower load at a given command
+  uint8_t fault_status;
+  uint8_t fault_code;
+}
+drv10975_model_t;
+
+/* Private macros ----------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static drv10975_model_t m_drv =
+{
+  .supply_mv = 12000
+};
+
+/* Private function prototypes ---------------------------------------- */
+static void m_drv10975_reset(uint64_t now_us);
+static int m_drv10975_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us);
+static int m_drv10975_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us);
+static uint32_t m_drv10975_speed_cmd(void);
+static void m_drv10975_update(uint64_t now_us);
+static void m_drv10975_publish(void);
+
+/* Public variables --------------------------------------------------- */
+const i2c_sim_dev_t i2c_sim_drv10975_dev =
+{
+  .slave_addr = I2C_SIM_DRV10975_ADDR,
+  .name       = "drv10975",
+  .reset      = m_drv10975_reset,
+  .read       = m_drv10975_read,
+  .write      = m_drv10975_write
+};
+
+/* Function definitions ----------------------------------------------- */
+void i2c_sim_drv10975_set_supply(uint32_t mv)
+{
+  m_drv10975_update(i2c_sim_get_time_us());
+
+  m_drv.supply_mv = mv;
+}
+
+void i2c_sim_drv10975_set_load(uint8_t percent)
+{
+  m_drv10975_update(i2c_sim_get_time_us());
+
+  m_drv.load_percent = (percent > 100) ? 100 : percent;
+}
+
+void i2c_sim_drv10975_set_fault(uint8_t status, uint8_t fault_code)
+{
+  m_drv10975_update(i2c_sim_get_time_us());
+
+  m_drv.fault_status = status;
+  m_drv.fault_code   = fault_code;
+}
+
+uint32_t i2c_sim_drv10975_get_eeprom_writes(void)
+{
+  return m_drv.eeprom_writes;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         DRV10975 model power on reset, config registers load from EEPROM
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     EEPROM, supply and faults are kept
+ *
+ * @return        None
+ */
+static void m_drv10975_reset(uint64_t now_us)
+{
+  memset(m_drv.reg, 0, sizeof(m_drv.reg));
+  memcpy(&m_drv.reg[DRV10975_REG_MOTOR_PARAM1], m_drv.eeprom, DRV10975_CFG_CNT);
+
+  m_drv.update_us  = now_us;
+  m_drv.speed_dhz  = 0;
+  m_drv.speed_frac = 0;
+}
+
+/**
+ * @brief         DRV10975 model read
+ *
+ * @param[in]     reg     First register
+ * @param[out]    data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        0
+ */
+static int m_drv10975_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_drv10975_update(now_us);
+
+  for (uint32_t i = 0; i < len; i++, reg++)
+    data[i] = (reg < DRV10975_REG_CNT) ? m_drv.reg[reg] : 0x00;
+
+  return 0;
+}
+
+/**
+ * @brief         DRV10975 model write
+ *
+ * @param[in]     reg     First register
+ * @param[in]     data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Config registers are only writable with SIDATA set,
+ *                EEPROM is only programmed with the access key in DEV_CTRL
+ *
+ * @return        0
+ */
+static int m_drv10975_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_drv10975_update(now_us);
+
+  for (uint32_t i = 0; i < len; i++, reg++)
+  {
+    if (reg <= DRV10975_REG_EE_CTRL)
+    {
+      m_drv.reg[reg] = data[i];
+
+      if ((reg == DRV10975_REG_EE_CTRL) && (data[i] & DRV10975_EE_CTRL_EE_WRITE) &&
+          (m_drv.reg[DRV10975_REG_DEV_CTRL] == DRV10975_DEV_CTRL_EE_KEY))
+      {
+        memcpy(m_drv.eeprom, &m_drv.reg[DRV10975_REG_MOTOR_PARAM1], DRV10975_CFG_CNT);
+        m_drv.eeprom_writes++;
+        m_drv.reg[reg] &= ~DRV10975_EE_CTRL_EE_WRITE;
+      }
+    }
+    else if ((reg >= DRV10975_REG_MOTOR_PARAM1) && (reg <= DRV10975_REG_SYS_OPT9))
+    {
+      if (m_drv.reg[DRV10975_REG_EE_CTRL] & DRV10975_EE_CTRL_SIDATA)
+        m_drv.reg[reg] = data[i];
+    }
+    // Status registers are read only
+  }
+
+  m_drv10975_publish();
+
+  return 0;
+}
+
+/**
+ * @brief         DRV10975 model speed command in effect
+ *
+ * @param[in]     None
+ *
+ * @attention     Without OverRide the SPEED pin drives the motor, modelled as stopped
+ *
+ * @return        Speed command 0 to 511
+ */
+static uint32_t m_drv10975_speed_cmd(void)
+{
+  if (!(m_drv.reg[DRV10975_REG_SPEED_CTRL2] & DRV10975_SPEED_CTRL2_OVERRIDE))
+    return 0;
+
+  return ((m_drv.reg[DRV10975_REG_SPEED_CTRL2] & 0x01) << 8) | m_drv.reg[DRV10975_REG_SPEED_CTRL1];
+}
+
+/**
+ * @brief         DRV10975 model run the rotor up to now
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     First order lag, integrated in 1 ms steps
+ *
+ * @return        None
+ */
+static void m_drv10975_update(uint64_t now_us)
+{
+  uint32_t target;
+  int64_t speed;
+  int64_t delta;
+
+  if (m_drv.fault_status & DRV10975_STATUS_MOTOR_LOCK)
+    target = 0;
+  else
+    target = (m_drv10975_speed_cmd() * DRV10975_MAX_SPEED_DHZ * (100 - m_drv.load_percent)) / (DRV10975_SPEED_CMD_MAX * 100);
+
+  while (m_drv.update_us + 1000 <= now_us)
+  {
+    m_drv.update_us += 1000;
+
+    // speed += (target - speed) * dt / tau, in 1/1000 of 0.1 Hz
+    speed = (int64_t)m_drv.speed_dhz * 1000 + m_drv.speed_frac;
+    delta = ((int64_t)target * 1000 - speed) * 1000 / DRV10975_TAU_US;
+
+    if (delta == 0)
+    {
+      // Settled, nothing moves until the next command
+      m_drv.speed_dhz  = target;
+      m_drv.speed_frac = 0;
+      m_drv.update_us  = now_us;
+      break;
+    }
+
+    speed           += delta;
+    m_drv.speed_dhz  = (uint32_t)(speed / 1000);
+    m_drv.speed_frac = (uint32_t)(speed % 1000);
+  }
+
+  m_drv10975_publish();
+}
+
+/**
+ * @brief         DRV10975 model load status registers from the rotor state
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_drv10975_publish(void)
+{
+  uint32_t cmd     = m_drv10975_speed_cmd();
+  uint32_t period  = (m_drv.speed_dhz != 0) ? (100000 * 10 / m_drv.speed_dhz) : 0xFFFF;  // 10 us units
+  uint32_t current = DRV10975_ZERO_CURRENT_CODE + DRV10975_IDLE_CURRENT_CODE +
+                     ((DRV10975_FULL_CURRENT_CODE - DRV10975_IDLE_CURRENT_CODE) * m_drv.speed_dhz) / DRV10975_MAX_SPEED_DHZ;
+  uint32_t supply  = (m_drv.supply_mv * 256) / 22800;
+
+  if (period > 0xFFFF)
+    period = 0xFFFF;
+  if (supply > 0xFF)
+    supply = 0xFF;
+  if (m_drv.speed_dhz == 0)
+    current = DRV10975_ZERO_CURRENT_CODE;
+
+  m_drv.reg[DRV10975_REG_STATUS]            = m_drv.fault_status | ((cmd == 0) ? DRV10975_STATUS_SLEEP : 0);
+  m_drv.reg[DRV10975_REG_MOTOR_SPEED1]      = (uint8_t)(m_drv.speed_dhz >> 8);
+  m_drv.reg[DRV10975_REG_MOTOR_SPEED1 + 1]  = (uint8_t)(m_drv.speed_dhz);
+  m_drv.reg[DRV10975_REG_MOTOR_PERIOD1]     = (uint8_t)(period >> 8);
+  m_drv.reg[DRV10975_REG_MOTOR_PERIOD1 + 1] = (uint8_t)(period);
+  m_drv.reg[DRV10975_REG_MOTOR_KT1]         = (uint8_t)(DRV10975_KT_CODE >> 8);
+  m_drv.reg[DRV10975_REG_MOTOR_KT1 + 1]     = (uint8_t)(DRV10975_KT_CODE);
+  m_drv.reg[DRV10975_REG_MOTOR_CURRENT1]    = (uint8_t)((current >> 8) & 0x07);
+  m_drv.reg[DRV10975_REG_MOTOR_CURRENT1 + 1]= (uint8_t)(current);
+  m_drv.reg[DRV10975_REG_SUPPLY_VOLTAGE]    = (uint8_t)supply;
+  m_drv.reg[DRV10975_REG_SPEED_CMD]         = (uint8_t)(cmd >> 1);
+  m_drv.reg[DRV10975_REG_SPD_CMD_BUFFER]    = (uint8_t)(cmd >> 1);
+  m_drv.reg[DRV10975_REG_FAULT_CODE]        = m_drv.fault_code;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,429 @@
+/**
+ * @file       i2c_sim_iam20380.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      IAM20380 register model for the virtual I2C bus
+ * @note       Models the sample clock (1 kHz / (1 + SMPLRT_DIV)), data ready flag,
+ *             512 bytes FIFO with overflow, device reset time and sleep.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "i2c_sim_dev.h"
+
+/* Private defines ---------------------------------------------------- */
+#define IAM20380_REG_SMPLRT_DIV                  (0X19)
+#define IAM20380_REG_CONFIG                      (0X1A)
+#define IAM20380_REG_GYRO_CONFIG                 (0X1B)
+#define IAM20380_REG_FIFO_EN                     (0X23)
+#define IAM20380_REG_INT_STATUS                  (0X3A)
+#define IAM20380_REG_TEMP_OUT_H                  (0X41)
+#define IAM20380_REG_GYRO_XOUT_H                 (0X43)
+#define IAM20380_REG_USER_CTRL                   (0X6A)
+#define IAM20380_REG_PWR_MGMT_1                  (0X6B)
+#define IAM20380_REG_FIFO_COUNTH                 (0X72)
+#define IAM20380_REG_FIFO_COUNTL                 (0X73)
+#define IAM20380_REG_FIFO_R_W                    (0X74)
+#define IAM20380_REG_WHO_AM_I                    (0X75)
+#define IAM20380_REG_CNT                         (0X80)
+
+#define IAM20380_PWR_MGMT_1_RESET                (0x80)
+#define IAM20380_PWR_MGMT_1_SLEEP                (0x40)
+#define IAM20380_USER_CTRL_FIFO_EN               (0x40)
+#define IAM20380_USER_CTRL_FIFO_RST              (0x04)
+#define IAM20380_CONFIG_FIFO_MODE                (0x40)   // Stop writing when full
+#define IAM20380_FIFO_EN_TEMP                    (0x80)
+#define IAM20380_FIFO_EN_XG                      (0x40)
+#define IAM20380_FIFO_EN_YG                      (0x20)
+#define IAM20380_FIFO_EN_ZG                      (0x10)
+#define IAM20380_INT_DATA_RDY                    (0x01)
+#define IAM20380_INT_FIFO_OFLOW                  (0x10)
+
+#define IAM20380_FIFO_SIZE                       (512)
+#define IAM20380_INTERNAL_RATE_HZ                (1000)
+#define IAM20380_RESET_US                        (100000)   // Registers unusable until the reset completes
+#define IAM20380_TEMP_SENSITIVITY                (32680)    // LSB per 100 degree C
+#define IAM20380_TEMP_OFFSET_CENTI               (2500)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief IAM20380 model state
+ */
+typedef struct
+{
+  uint8_t reg[IAM20380_REG_CNT];
+  uint64_t reset_done_us;
+  uint64_t sample_us;
+
+  uint8_t fifo[IAM20380_FIFO_SIZE];
+  uint16_t fifo_head;
+  uint16_t fifo_cnt;
+
+  int32_t rate_mdps[3];
+  int16_t bias_lsb[3];
+  int32_t temp_centi;
+}
+iam20380_model_t;
+
+/* Private macros ----------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static iam20380_model_t m_iam;
+
+// LSB per 1000 dps for each GYRO_CONFIG full scale
+static const uint32_t m_iam_sensitivity[4] = { 131000, 65500, 32800, 16400 };
+
+/* Private function prototypes ---------------------------------------- */
+static void m_iam20380_reset(uint64_t now_us);
+static int m_iam20380_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us);
+static int m_iam20380_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us);
+static void m_iam20380_defaults(void);
+static void m_iam20380_update(uint64_t now_us);
+static void m_iam20380_sample(void);
+static void m_iam20380_fifo_push(uint8_t byte);
+static uint8_t m_iam20380_fifo_pop(void);
+static void m_iam20380_put16(uint8_t reg, int32_t value);
+
+/* Public variables --------------------------------------------------- */
+const i2c_sim_dev_t i2c_sim_iam20380_dev =
+{
+  .slave_addr = I2C_SIM_IAM20380_ADDR,
+  .name       = "iam20380",
+  .reset      = m_iam20380_reset,
+  .read       = m_iam20380_read,
+  .write      = m_iam20380_write
+};
+
+/* Function definitions ----------------------------------------------- */
+void i2c_sim_iam20380_set_rate(int32_t x_mdps, int32_t y_mdps, int32_t z_mdps)
+{
+  m_iam20380_update(i2c_sim_get_time_us());
+
+  m_iam.rate_mdps[0] = x_mdps;
+  m_iam.rate_mdps[1] = y_mdps;
+  m_iam.rate_mdps[2] = z_mdps;
+}
+
+void i2c_sim_iam20380_set_bias(int16_t x_lsb, int16_t y_lsb, int16_t z_lsb)
+{
+  m_iam20380_update(i2c_sim_get_time_us());
+
+  m_iam.bias_lsb[0] = x_lsb;
+  m_iam.bias_lsb[1] = y_lsb;
+  m_iam.bias_lsb[2] = z_lsb;
+}
+
+void i2c_sim_iam20380_set_temp(int32_t centi_deg)
+{
+  m_iam20380_update(i2c_sim_get_time_us());
+
+  m_iam.temp_centi = centi_deg;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         IAM20380 model power on reset
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Rate, bias and temperature inputs are kept
+ *
+ * @return        None
+ */
+static void m_iam20380_reset(uint64_t now_us)
+{
+  m_iam20380_defaults();
+  m_iam.reset_done_us = now_us;
+  m_iam.sample_us     = now_us;
+}
+
+/**
+ * @brief         IAM20380 model read, auto increments except on FIFO_R_W
+ *
+ * @param[in]     reg     First register
+ * @param[out]    data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Reading INT_STATUS clears it
+ *
+ * @return        0
+ */
+static int m_iam20380_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_iam20380_update(now_us);
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    if (reg == IAM20380_REG_FIFO_R_W)
+    {
+      data[i] = m_iam20380_fifo_pop();
+      continue;
+    }
+
+    if (reg == IAM20380_REG_FIFO_COUNTH)
+    {
+      // Count is latched when the high byte is read
+      m_iam.reg[IAM20380_REG_FIFO_COUNTH] = (uint8_t)(m_iam.fifo_cnt >> 8);
+      m_iam.reg[IAM20380_REG_FIFO_COUNTL] = (uint8_t)(m_iam.fifo_cnt);
+    }
+
+    data[i] = (reg < IAM20380_REG_CNT) ? m_iam.reg[reg] : 0x00;
+
+    if (reg == IAM20380_REG_INT_STATUS)
+      m_iam.reg[reg] = 0;
+
+    reg++;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         IAM20380 model write
+ *
+ * @param[in]     reg     First register
+ * @param[in]     data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Writes are ignored while a device reset is in progress
+ *
+ * @return        0
+ */
+static int m_iam20380_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_iam20380_update(now_us);
+
+  if (now_us < m_iam.reset_done_us)
+    return 0;
+
+  for (uint32_t i = 0; i < len; i++, reg++)
+  {
+    if (reg >= IAM20380_REG_CNT)
+      break;
+
+    switch (reg)
+    {
+    case IAM20380_REG_PWR_MGMT_1:
+      if (data[i] & IAM20380_PWR_MGMT_1_RESET)
+      {
+        m_iam20380_defaults();
+        m_iam.reg[reg]     |= IAM20380_PWR_MGMT_1_RESET;
+        m_iam.reset_done_us = now_us + IAM20380_RESET_US;
+        m_iam.sample_us     = m_iam.reset_done_us;
+        return 0;
+      }
+      m_iam.reg[reg] = data[i];
+      break;
+
+    case IAM20380_REG_USER_CTRL:
+      if (data[i] & IAM20380_USER_CTRL_FIFO_RST)
+      {
+        m_iam.fifo_head = 0;
+        m_iam.fifo_cnt  = 0;
+      }
+      m_iam.reg[reg] = data[i] & ~IAM20380_USER_CTRL_FIFO_RST;
+      break;
+
+    case IAM20380_REG_FIFO_R_W:
+      m_iam20380_fifo_push(data[i]);
+      reg--;
+      break;
+
+    case IAM20380_REG_WHO_AM_I:
+    case IAM20380_REG_INT_STATUS:
+    case IAM20380_REG_FIFO_COUNTH:
+    case IAM20380_REG_FIFO_COUNTL:
+      break;  // Read only
+
+    default:
+      if ((reg >= IAM20380_REG_TEMP_OUT_H) && (reg < IAM20380_REG_GYRO_XOUT_H + 6))
+        break;  // Read only
+      m_iam.reg[reg] = data[i];
+      break;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         IAM20380 model load register reset values
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_iam20380_defaults(void)
+{
+  memset(m_iam.reg, 0, sizeof(m_iam.reg));
+  m_iam.reg[IAM20380_REG_PWR_MGMT_1] = IAM20380_PWR_MGMT_1_SLEEP;
+  m_iam.reg[IAM20380_REG_WHO_AM_I]   = 0xB5;
+  m_iam.fifo_head = 0;
+  m_iam.fifo_cnt  = 0;
+}
+
+/**
+ * @brief         IAM20380 model run the sample clock up to now
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_iam20380_update(uint64_t now_us)
+{
+  uint32_t period_us;
+  uint64_t samples;
+
+  if (now_us < m_iam.reset_done_us)
+    return;
+
+  m_iam.reg[IAM20380_REG_PWR_MGMT_1] &= ~IAM20380_PWR_MGMT_1_RESET;
+
+  period_us = (1000000 / IAM20380_INTERNAL_RATE_HZ) * (1 + m_iam.reg[IAM20380_REG_SMPLRT_DIV]);
+  if (now_us < m_iam.sample_us + period_us)
+    return;
+
+  samples          = (now_us - m_iam.sample_us) / period_us;
+  m_iam.sample_us += samples * period_us;
+
+  if (m_iam.reg[IAM20380_REG_PWR_MGMT_1] & IAM20380_PWR_MGMT_1_SLEEP)
+    return;
+
+  // Older samples than a full FIFO are lost anyway
+  if (samples > IAM20380_FIFO_SIZE)
+  {
+    if ((m_iam.reg[IAM20380_REG_USER_CTRL] & IAM20380_USER_CTRL_FIFO_EN) && (m_iam.reg[IAM20380_REG_FIFO_EN] != 0))
+      m_iam.reg[IAM20380_REG_INT_STATUS] |= IAM20380_INT_FIFO_OFLOW;
+    samples = IAM20380_FIFO_SIZE;
+  }
+
+  while (samples--)
+    m_iam20380_sample();
+}
+
+/**
+ * @brief         IAM20380 model take one sample
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_iam20380_sample(void)
+{
+  uint32_t sens = m_iam_sensitivity[(m_iam.reg[IAM20380_REG_GYRO_CONFIG] >> 3) & 0x03];
+  uint8_t fifo_en;
+  int32_t temp;
+
+  temp = ((m_iam.temp_centi - IAM20380_TEMP_OFFSET_CENTI) * IAM20380_TEMP_SENSITIVITY) / 10000;
+  m_iam20380_put16(IAM20380_REG_TEMP_OUT_H, temp);
+
+  for (int axis = 0; axis < 3; axis++)
+  {
+    int64_t lsb = ((int64_t)m_iam.rate_mdps[axis] * sens) / 1000000 + m_iam.bias_lsb[axis];
+    m_iam20380_put16(IAM20380_REG_GYRO_XOUT_H + 2 * axis, (int32_t)lsb);
+  }
+
+  m_iam.reg[IAM20380_REG_INT_STATUS] |= IAM20380_INT_DATA_RDY;
+
+  if (!(m_iam.reg[IAM20380_REG_USER_CTRL] & IAM20380_USER_CTRL_FIFO_EN))
+    return;
+
+  fifo_en = m_iam.reg[IAM20380_REG_FIFO_EN];
+  if (fifo_en & IAM20380_FIFO_EN_TEMP)
+  {
+    m_iam20380_fifo_push(m_iam.reg[IAM20380_REG_TEMP_OUT_H]);
+    m_iam20380_fifo_push(m_iam.reg[IAM20380_REG_TEMP_OUT_H + 1]);
+  }
+
+  for (int axis = 0; axis < 3; axis++)
+  {
+    if (fifo_en & (IAM20380_FIFO_EN_XG >> axis))
+    {
+      m_iam20380_fifo_push(m_iam.reg[IAM20380_REG_GYRO_XOUT_H + 2 * axis]);
+      m_iam20380_fifo_push(m_iam.reg[IAM20380_REG_GYRO_XOUT_H + 2 * axis + 1]);
+    }
+  }
+}
+
+/**
+ * @brief         IAM20380 model push a byte into the FIFO
+ *
+ * @param[in]     byte    Byte
+ *
+ * @attention     When full, drops the oldest byte or the new one depending on FIFO_MODE
+ *
+ * @return        None
+ */
+static void m_iam20380_fifo_push(uint8_t byte)
+{
+  if (m_iam.fifo_cnt == IAM20380_FIFO_SIZE)
+  {
+    m_iam.reg[IAM20380_REG_INT_STATUS] |= IAM20380_INT_FIFO_OFLOW;
+
+    if (m_iam.reg[IAM20380_REG_CONFIG] & IAM20380_CONFIG_FIFO_MODE)
+      return;
+
+    m_iam.fifo_head = (m_iam.fifo_head + 1) % IAM20380_FIFO_SIZE;
+    m_iam.fifo_cnt--;
+  }
+
+  m_iam.fifo[(m_iam.fifo_head + m_iam.fifo_cnt) % IAM20380_FIFO_SIZE] = byte;
+  m_iam.fifo_cnt++;
+}
+
+/**
+ * @brief         IAM20380 model pop a byte from the FIFO
+ *
+ * @param[in]     None
+ *
+ * @attention     An empty FIFO reads 0xFF
+ *
+ * @return        Byte
+ */
+static uint8_t m_iam20380_fifo_pop(void)
+{
+  uint8_t byte;
+
+  if (m_iam.fifo_cnt == 0)
+    return 0xFF;
+
+  byte            = m_iam.fifo[m_iam.fifo_head];
+  m_iam.fifo_head = (m_iam.fifo_head + 1) % IAM20380_FIFO_SIZE;
+  m_iam.fifo_cnt--;
+
+  return byte;
+}
+
+/**
+ * @brief         IAM20380 model store a saturated 16 bits big endian value
+ *
+ * @param[in]     reg     High byte register
+ * @param[in]     value   Value
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_iam20380_put16(uint8_t reg, int32_t value)
+{
+  if (value > 32767)
+    value = 32767;
+  if (value < -32768)
+    value = -32768;
+
+  m_iam.reg[reg]     = (uint8_t)((uint16_t)value >> 8);
+  m_iam.reg[reg + 1] = (uint8_t)((uint16_t)value);
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,566 @@
+/**
+ * @file       i2c_sim_pac1934.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      PAC1934 register model for the virtual I2C bus
+ * @note       Models REFRESH/REFRESH_V snapshots with the 1 ms settle time,
+ *             48 bits accumulators, ACT/LAT control copies and channel skipping
+ *             on block reads.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "i2c_sim_dev.h"
+
+/* Private defines ---------------------------------------------------- */
+#define PAC1934_REG_REFRESH               (0x00)
+#define PAC1934_REG_PAC_CTRL              (0x01)
+#define PAC1934_REG_ACC_COUNT             (0x02)
+#define PAC1934_REG_VPOWER1_ACC           (0x03)
+#define PAC1934_REG_VBUS1                 (0x07)
+#define PAC1934_REG_VSENSE1               (0x0B)
+#define PAC1934_REG_VBUS1_AVG             (0x0F)
+#define PAC1934_REG_VSENSE1_AVG           (0x13)
+#define PAC1934_REG_VPOWER1               (0x17)
+#define PAC1934_REG_VPOWER4               (0x1A)
+#define PAC1934_REG_CHANNEL_DIS           (0x1C)
+#define PAC1934_REG_NEG_PWR               (0x1D)
+#define PAC1934_REG_REFRESH_G             (0X1E)
+#define PAC1934_REG_REFRESH_V             (0X1F)
+#define PAC1934_REG_SLOW                  (0X20)
+#define PAC1934_REG_CTRL_ACT              (0X21)
+#define PAC1934_REG_CHANNEL_DIS_ACT       (0X22)
+#define PAC1934_REG_NEG_PWR_ACT           (0X23)
+#define PAC1934_REG_CTRL_LAT              (0X24)
+#define PAC1934_REG_CHANNEL_DIS_LAT       (0X25)
+#define PAC1934_REG_NEG_PWR_LAT           (0X26)
+#define PAC1934_REG_LAST                  (0X26)
+#define PAC1934_REG_PRODUCT_ID            (0XFD)
+#define PAC1934_REG_MANU_ID               (0XFE)
+#define PAC1934_REG_REV_ID                (0XFF)
+
+#define PAC1934_CHANNEL_CNT               (4)
+#define PAC1934_SETTLE_US                 (1000)      // Registers update 1 ms after a refresh
+#define PAC1934_ACC_COUNT_MAX             (0xFFFFFF)
+#define PAC1934_ACC_MASK                  (0xFFFFFFFFFFFFULL)
+
+#define PAC1934_CTRL_SLEEP                (0x20)
+#define PAC1934_CHANNEL_DIS_NO_SKIP       (0x02)
+
+#define PAC1934_VBUS_FSR_MV               (32000)
+#define PAC1934_CURRENT_FSR_MA            (25000)     // 100 mV over 4 mOhm
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief PAC1934 readable snapshot, loaded by a refresh
+ */
+typedef struct
+{
+  uint32_t acc_count;
+  uint64_t vpower_acc[PAC1934_CHANNEL_CNT];
+  uint16_t vbus[PAC1934_CHANNEL_CNT];
+  uint16_t vsense[PAC1934_CHANNEL_CNT];
+  uint32_t vpower[PAC1934_CHANNEL_CNT];
+  uint8_t ctrl_act;
+  uint8_t channel_dis_act;
+  uint8_t neg_pwr_act;
+}
+pac1934_snapshot_t;
+
+/**
+ * @brief PAC1934 model state
+ */
+typedef struct
+{
+  // Control registers as written
+  uint8_t ctrl;
+  uint8_t channel_dis;
+  uint8_t neg_pwr;
+  uint8_t slow;
+  uint8_t ctrl_lat;
+  uint8_t channel_dis_lat;
+  uint8_t neg_pwr_lat;
+
+  // Analog inputs
+  uint32_t vbus_mv[PAC1934_CHANNEL_CNT];
+  int32_t current_ma[PAC1934_CHANNEL_CNT];
+
+  // Live accumulators
+  uint64_t sample_us;
+  uint32_t acc_count;
+  uint64_t vpower_acc[PAC1934_CHANNEL_CNT];
+
+  // Register view, pending one becomes visible after the settle time
+  pac1934_snapshot_t view;
+  pac1934_snapshot_t pending;
+  uint64_t pending_us;
+  bool has_pending;
+}
+pac1934_model_t;
+
+/* Private macros ----------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static pac1934_model_t m_pac;
+static const uint16_t m_pac_sps[4] = { 1024, 256, 64, 8 };
+
+/* Private function prototypes ---------------------------------------- */
+static void m_pac1934_reset(uint64_t now_us);
+static int m_pac1934_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us);
+static int m_pac1934_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us);
+static void m_pac1934_update(uint64_t now_us);
+static void m_pac1934_refresh(uint64_t now_us, bool reset_acc);
+static uint16_t m_pac1934_vbus(int ch);
+static uint16_t m_pac1934_vsense(int ch);
+static uint32_t m_pac1934_vpower(int ch);
+static uint8_t m_pac1934_reg_size(uint8_t reg);
+static int m_pac1934_reg_channel(uint8_t reg);
+static uint8_t m_pac1934_next_reg(uint8_t reg);
+static uint64_t m_pac1934_reg_value(uint8_t reg);
+
+/* Public variables --------------------------------------------------- */
+const i2c_sim_dev_t i2c_sim_pac1934_dev =
+{
+  .slave_addr = I2C_SIM_PAC1934_ADDR,
+  .name       = "pac1934",
+  .reset      = m_pac1934_reset,
+  .read       = m_pac1934_read,
+  .write      = m_pac1934_write
+};
+
+/* Function definitions ----------------------------------------------- */
+void i2c_sim_pac1934_set_channel(uint8_t channel, uint32_t vbus_mv, int32_t current_ma)
+{
+  if (channel >= PAC1934_CHANNEL_CNT)
+    return;
+
+  if (vbus_mv > PAC1934_VBUS_FSR_MV)
+    vbus_mv = PAC1934_VBUS_FSR_MV;
+  if (current_ma > PAC1934_CURRENT_FSR_MA)
+    current_ma = PAC1934_CURRENT_FSR_MA;
+  if (current_ma < -PAC1934_CURRENT_FSR_MA)
+    current_ma = -PAC1934_CURRENT_FSR_MA;
+
+  // Accumulate up to now with the old inputs first
+  m_pac1934_update(i2c_sim_get_time_us());
+
+  m_pac.vbus_mv[channel]    = vbus_mv;
+  m_pac.current_ma[channel] = current_ma;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         PAC1934 model power on reset
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Analog inputs are kept
+ *
+ * @return        None
+ */
+static void m_pac1934_reset(uint64_t now_us)
+{
+  uint32_t vbus_mv[PAC1934_CHANNEL_CNT];
+  int32_t current_ma[PAC1934_CHANNEL_CNT];
+
+  memcpy(vbus_mv, m_pac.vbus_mv, sizeof(vbus_mv));
+  memcpy(current_ma, m_pac.current_ma, sizeof(current_ma));
+
+  memset(&m_pac, 0, sizeof(m_pac));
+  m_pac.slow      = 0x14;   // POR defaults of SLOW register
+  m_pac.sample_us = now_us;
+
+  memcpy(m_pac.vbus_mv, vbus_mv, sizeof(vbus_mv));
+  memcpy(m_pac.current_ma, current_ma, sizeof(current_ma));
+}
+
+/**
+ * @brief         PAC1934 model read, auto increments over registers of any width
+ *
+ * @param[in]     reg     First register
+ * @param[out]    data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Bytes past the last register read 0x00
+ *
+ * @return        0
+ */
+static int m_pac1934_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  uint64_t value;
+  uint8_t size;
+  uint32_t i = 0;
+
+  m_pac1934_update(now_us);
+
+  while (i < len)
+  {
+    size = m_pac1934_reg_size(reg);
+    if (size == 0)
+    {
+      // Past the register map, or a command register with nothing to read
+      if (reg > PAC1934_REG_LAST && reg < PAC1934_REG_PRODUCT_ID)
+      {
+        data[i++] = 0x00;
+        continue;
+      }
+      reg = m_pac1934_next_reg(reg);
+      continue;
+    }
+
+    value = m_pac1934_reg_value(reg);
+    for (int b = size - 1; (b >= 0) && (i < len); b--)
+      data[i++] = (uint8_t)(value >> (8 * b));
+
+    reg = m_pac1934_next_reg(reg);
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         PAC1934 model write
+ *
+ * @param[in]     reg     First register
+ * @param[in]     data    Pointer to data
+ * @param[in]     len     Data length, 0 for a command
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        0
+ */
+static int m_pac1934_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_pac1934_update(now_us);
+
+  switch (reg)
+  {
+  case PAC1934_REG_REFRESH:
+  case PAC1934_REG_REFRESH_G:
+    m_pac1934_refresh(now_us, true);
+    return 0;
+  case PAC1934_REG_REFRESH_V:
+    m_pac1934_refresh(now_us, false);
+    return 0;
+  default:
+    break;
+  }
+
+  for (uint32_t i = 0; i < len; i++, reg++)
+  {
+    switch (reg)
+    {
+    case PAC1934_REG_PAC_CTRL:    m_pac.ctrl        = data[i]; break;
+    case PAC1934_REG_CHANNEL_DIS: m_pac.channel_dis = data[i]; break;
+    case PAC1934_REG_NEG_PWR:     m_pac.neg_pwr     = data[i]; break;
+    case PAC1934_REG_SLOW:        m_pac.slow        = data[i]; break;
+    default: break;   // Read only
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         PAC1934 model run the converter up to now
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_pac1934_update(uint64_t now_us)
+{
+  uint8_t ctrl_act = m_pac.view.ctrl_act;
+  uint32_t sps     = m_pac_sps[(ctrl_act >> 6) & 0x03];
+  uint64_t samples;
+
+  if (m_pac.has_pending && (now_us >= m_pac.pending_us))
+  {
+    m_pac.view        = m_pac.pending;
+    m_pac.has_pending = false;
+  }
+
+  if (now_us <= m_pac.sample_us)
+    return;
+
+  samples = ((now_us - m_pac.sample_us) * sps) / 1000000;
+  if (samples == 0)
+    return;
+
+  m_pac.sample_us += (samples * 1000000) / sps;
+
+  if (ctrl_act & PAC1934_CTRL_SLEEP)
+    return;
+
+  if (m_pac.acc_count + samples > PAC1934_ACC_COUNT_MAX)
+    samples = PAC1934_ACC_COUNT_MAX - m_pac.acc_count;
+
+  m_pac.acc_count += (uint32_t)samples;
+
+  for (int ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+  {
+    if (m_pac.view.channel_dis_act & (0x80 >> ch))
+      continue;
+
+    // 28 bits power samples, sign extended when bipolar
+    m_pac.vpower_acc[ch] = (m_pac.vpower_acc[ch] + samples * (uint64_t)((int64_t)(int32_t)m_pac1934_vpower(ch) >> 4)) & PAC1934_ACC_MASK;
+  }
+}
+
+/**
+ * @brief         PAC1934 model refresh, latch the results and the control registers
+ *
+ * @param[in]     now_us      Current time
+ * @param[in]     reset_acc   Reset accumulators (REFRESH), keep them (REFRESH_V)
+ *
+ * @attention     Results become readable after the settle time
+ *
+ * @return        None
+ */
+static void m_pac1934_refresh(uint64_t now_us, bool reset_acc)
+{
+  pac1934_snapshot_t *snap = &m_pac.pending;
+
+  snap->acc_count = m_pac.acc_count;
+  for (int ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+  {
+    snap->vpower_acc[ch] = m_pac.vpower_acc[ch];
+    snap->vbus[ch]       = m_pac1934_vbus(ch);
+    snap->vsense[ch]     = m_pac1934_vsense(ch);
+    snap->vpower[ch]     = m_pac1934_vpower(ch);
+  }
+
+  m_pac.ctrl_lat        = m_pac.view.ctrl_act;
+  m_pac.channel_dis_lat = m_pac.view.channel_dis_act;
+  m_pac.neg_pwr_lat     = m_pac.view.neg_pwr_act;
+
+  if (reset_acc)
+  {
+    snap->ctrl_act        = m_pac.ctrl;
+    snap->channel_dis_act = m_pac.channel_dis;
+    snap->neg_pwr_act     = m_pac.neg_pwr;
+
+    m_pac.acc_count = 0;
+    memset(m_pac.vpower_acc, 0, sizeof(m_pac.vpower_acc));
+  }
+  else
+  {
+    snap->ctrl_act        = m_pac.view.ctrl_act;
+    snap->channel_dis_act = m_pac.view.channel_dis_act;
+    snap->neg_pwr_act     = m_pac.view.neg_pwr_act;
+  }
+
+  // Control registers take effect at once, results after the settle time
+  m_pac.view.ctrl_act        = snap->ctrl_act;
+  m_pac.view.channel_dis_act = snap->channel_dis_act;
+  m_pac.view.neg_pwr_act     = snap->neg_pwr_act;
+  m_pac.pending_us           = now_us + PAC1934_SETTLE_US;
+  m_pac.has_pending          = true;
+}
+
+/**
+ * @brief         PAC1934 model bus voltage code of a channel
+ *
+ * @param[in]     ch      Channel
+ *
+ * @attention     Bipolar (BIDV) halves the resolution, full scale stays 32 V
+ *
+ * @return        VBUS register value
+ */
+static uint16_t m_pac1934_vbus(int ch)
+{
+  if (m_pac.view.neg_pwr_act & (0x08 >> ch))
+    return (uint16_t)(((uint64_t)m_pac.vbus_mv[ch] * 0x7FFF) / PAC1934_VBUS_FSR_MV);
+
+  return (uint16_t)(((uint64_t)m_pac.vbus_mv[ch] * 0xFFFF) / PAC1934_VBUS_FSR_MV);
+}
+
+/**
+ * @brief         PAC1934 model sense voltage code of a channel
+ *
+ * @param[in]     ch      Channel
+ *
+ * @attention     Bipolar (BIDI) is two's complement, unipolar clamps reverse current to 0
+ *
+ * @return        VSENSE register value
+ */
+static uint16_t m_pac1934_vsense(int ch)
+{
+  int32_t ma = m_pac.current_ma[ch];
+
+  if (m_pac.view.neg_pwr_act & (0x80 >> ch))
+    return (uint16_t)(int16_t)(((int64_t)ma * 0x7FFF) / PAC1934_CURRENT_FSR_MA);
+
+  if (ma < 0)
+    ma = 0;
+
+  return (uint16_t)(((uint64_t)ma * 0xFFFF) / PAC1934_CURRENT_FSR_MA);
+}
+
+/**
+ * @brief         PAC1934 model instantaneous power of a channel
+ *
+ * @param[in]     ch      Channel
+ *
+ * @attention     28 bits result, left aligned in 32 bits as in the VPOWER registers.
+ *                Signed, and shifted to keep the full scale, when any input is bipolar.
+ *
+ * @return        Power register value
+ */
+static uint32_t m_pac1934_vpower(int ch)
+{
+  uint8_t neg = m_pac.view.neg_pwr_act;
+  uint16_t vbus   = m_pac1934_vbus(ch);
+  uint16_t vsense = m_pac1934_vsense(ch);
+  int64_t power;
+
+  if (!(neg & ((0x80 >> ch) | (0x08 >> ch))))
+    return ((uint32_t)vbus * vsense) & 0xFFFFFFF0;
+
+  power = (int64_t)vbus * (int16_t)vsense;
+  if (!(neg & (0x80 >> ch)))
+    power = (int64_t)vbus * vsense / 2;
+  if (!(neg & (0x08 >> ch)))
+    power = power / 2;
+
+  return (uint32_t)(int32_t)(power * 2) & 0xFFFFFFF0;
+}
+
+/**
+ * @brief         PAC1934 model register width
+ *
+ * @param[in]     reg     Register
+ *
+ * @attention     None
+ *
+ * @return        Width in bytes, 0 for command and reserved registers
+ */
+static uint8_t m_pac1934_reg_size(uint8_t reg)
+{
+  if (reg == PAC1934_REG_ACC_COUNT)
+    return 3;
+  if ((reg >= PAC1934_REG_VPOWER1_ACC) && (reg < PAC1934_REG_VBUS1))
+    return 6;
+  if ((reg >= PAC1934_REG_VBUS1) && (reg < PAC1934_REG_VPOWER1))
+    return 2;
+  if ((reg >= PAC1934_REG_VPOWER1) && (reg <= PAC1934_REG_VPOWER4))
+    return 4;
+
+  switch (reg)
+  {
+  case PAC1934_REG_PAC_CTRL:
+  case PAC1934_REG_CHANNEL_DIS:
+  case PAC1934_REG_NEG_PWR:
+  case PAC1934_REG_SLOW:
+  case PAC1934_REG_CTRL_ACT:
+  case PAC1934_REG_CHANNEL_DIS_ACT:
+  case PAC1934_REG_NEG_PWR_ACT:
+  case PAC1934_REG_CTRL_LAT:
+  case PAC1934_REG_CHANNEL_DIS_LAT:
+  case PAC1934_REG_NEG_PWR_LAT:
+  case PAC1934_REG_PRODUCT_ID:
+  case PAC1934_REG_MANU_ID:
+  case PAC1934_REG_REV_ID:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief         PAC1934 model channel of a result register
+ *
+ * @param[in]     reg     Register
+ *
+ * @attention     None
+ *
+ * @return        Channel 0 to 3, -1 when the register is not per channel
+ */
+static int m_pac1934_reg_channel(uint8_t reg)
+{
+  if ((reg < PAC1934_REG_VPOWER1_ACC) || (reg > PAC1934_REG_VPOWER4))
+    return -1;
+
+  return (reg - PAC1934_REG_VPOWER1_ACC) % PAC1934_CHANNEL_CNT;
+}
+
+/**
+ * @brief         PAC1934 model next register of a block read
+ *
+ * @param[in]     reg     Current register
+ *
+ * @attention     Registers of disabled channels are skipped unless NO_SKIP is set
+ *
+ * @return        Next register
+ */
+static uint8_t m_pac1934_next_reg(uint8_t reg)
+{
+  uint8_t dis = m_pac.view.channel_dis_act;
+  int ch;
+
+  do
+  {
+    reg++;
+    ch = m_pac1934_reg_channel(reg);
+  } while ((ch >= 0) && !(dis & PAC1934_CHANNEL_DIS_NO_SKIP) && (dis & (0x80 >> ch)));
+
+  return reg;
+}
+
+/**
+ * @brief         PAC1934 model register value
+ *
+ * @param[in]     reg     Register
+ *
+ * @attention     None
+ *
+ * @return        Register value, right aligned
+ */
+static uint64_t m_pac1934_reg_value(uint8_t reg)
+{
+  pac1934_snapshot_t *v = &m_pac.view;
+  int ch = m_pac1934_reg_channel(reg);
+
+  if (ch >= 0)
+  {
+    if (reg < PAC1934_REG_VBUS1)
+      return v->vpower_acc[ch];
+    if (reg < PAC1934_REG_VSENSE1)
+      return v->vbus[ch];
+    if (reg < PAC1934_REG_VBUS1_AVG)
+      return v->vsense[ch];
+    if (reg < PAC1934_REG_VSENSE1_AVG)
+      return v->vbus[ch];     // Inputs are steady, rolling average equals the last sample
+    if (reg < PAC1934_REG_VPOWER1)
+      return v->vsense[ch];
+    return v->vpower[ch];
+  }
+
+  switch (reg)
+  {
+  case PAC1934_REG_ACC_COUNT:       return v->acc_count;
+  case PAC1934_REG_PAC_CTRL:        return m_pac.ctrl;
+  case PAC1934_REG_CHANNEL_DIS:     return m_pac.channel_dis;
+  case PAC1934_REG_NEG_PWR:         return m_pac.neg_pwr;
+  case PAC1934_REG_SLOW:            return m_pac.slow;
+  case PAC1934_REG_CTRL_ACT:        return v->ctrl_act;
+  case PAC1934_REG_CHANNEL_DIS_ACT: return v->channel_dis_act;
+  case PAC1934_REG_NEG_PWR_ACT:     return v->neg_pwr_act;
+  case PAC1934_REG_CTRL_LAT:        return m_pac.ctrl_lat;
+  case PAC1934_REG_CHANNEL_DIS_LAT: return m_pac.channel_dis_lat;
+  case PAC1934_REG_NEG_PWR_LAT:     return m_pac.neg_pwr_lat;
+  case PAC1934_REG_PRODUCT_ID:      return 0x5B;
+  case PAC1934_REG_MANU_ID:         return 0x5D;
+  case PAC1934_REG_REV_ID:          return 0x03;
+  default:                          return 0;
+  }
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,288 @@
+/**
+ * @file       i2c_sim_pcf85063.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-20
+ * @author     Hiep Le
+ * @brief      PCF85063 register model for the virtual I2C bus
+ * @note       Models the BCD calendar running from the bus clock, the STOP bit,
+ *             the OS flag and the software reset command.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "i2c_sim_dev.h"
+
+/* Private defines ---------------------------------------------------- */
+#define PCF85063_REG_CONTROL_1        (0X00)
+#define PCF85063_REG_SECONDS          (0X04)
+#define PCF85063_REG_MINUTES          (0X05)
+#define PCF85063_REG_HOURS            (0X06)
+#define PCF85063_REG_DAYS             (0X07)
+#define PCF85063_REG_WEEKDAYS         (0X08)
+#define PCF85063_REG_MONTHS           (0X09)
+#define PCF85063_REG_YEARS            (0X0A)
+#define PCF85063_REG_CNT              (0X12)
+
+#define PCF85063_CONTROL_1_STOP       (0x20)
+#define PCF85063_SOFTWARE_RESET       (0x58)
+#define PCF85063_SECONDS_OS           (0x80)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief PCF85063 model state
+ */
+typedef struct
+{
+  uint8_t reg[PCF85063_REG_CNT];
+  uint64_t second_us;           // Time of the last whole second tick
+}
+pcf85063_model_t;
+
+/* Private macros ----------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static pcf85063_model_t m_rtc;
+static const uint8_t m_rtc_days_in_month[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+/* Private function prototypes ---------------------------------------- */
+static void m_pcf85063_reset(uint64_t now_us);
+static int m_pcf85063_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us);
+static int m_pcf85063_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us);
+static void m_pcf85063_update(uint64_t now_us);
+static void m_pcf85063_add_seconds(uint64_t seconds);
+static uint8_t m_pcf85063_days_in_month(uint8_t month, uint8_t year);
+static uint8_t m_pcf85063_bin_to_bcd(uint8_t val);
+static uint8_t m_pcf85063_bcd_to_bin(uint8_t val);
+
+/* Public variables --------------------------------------------------- */
+const i2c_sim_dev_t i2c_sim_pcf85063_dev =
+{
+  .slave_addr = I2C_SIM_PCF85063_ADDR,
+  .name       = "pcf85063",
+  .reset      = m_pcf85063_reset,
+  .read       = m_pcf85063_read,
+  .write      = m_pcf85063_write
+};
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         PCF85063 model power on reset, clock starts at 2021-01-01 00:00:00
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     OS flag is set until the time is written
+ *
+ * @return        None
+ */
+static void m_pcf85063_reset(uint64_t now_us)
+{
+  memset(m_rtc.reg, 0, sizeof(m_rtc.reg));
+
+  m_rtc.reg[PCF85063_REG_SECONDS]  = PCF85063_SECONDS_OS;
+  m_rtc.reg[PCF85063_REG_DAYS]     = 0x01;
+  m_rtc.reg[PCF85063_REG_WEEKDAYS] = 0x05;  // Friday
+  m_rtc.reg[PCF85063_REG_MONTHS]   = 0x01;
+  m_rtc.reg[PCF85063_REG_YEARS]    = 0x21;
+  m_rtc.second_us = now_us;
+}
+
+/**
+ * @brief         PCF85063 model read, address wraps after the last register
+ *
+ * @param[in]     reg     First register
+ * @param[out]    data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        0
+ */
+static int m_pcf85063_read(uint8_t reg, uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_pcf85063_update(now_us);
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    data[i] = (reg < PCF85063_REG_CNT) ? m_rtc.reg[reg] : 0x00;
+    reg     = (reg + 1) % PCF85063_REG_CNT;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         PCF85063 model write
+ *
+ * @param[in]     reg     First register
+ * @param[in]     data    Pointer to data
+ * @param[in]     len     Data length
+ * @param[in]     now_us  Current time
+ *
+ * @attention     Writing a time register restarts the sub second prescaler
+ *
+ * @return        0
+ */
+static int m_pcf85063_write(uint8_t reg, const uint8_t *data, uint32_t len, uint64_t now_us)
+{
+  m_pcf85063_update(now_us);
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    if (reg >= PCF85063_REG_CNT)
+      break;
+
+    if ((reg == PCF85063_REG_CONTROL_1) && (data[i] == PCF85063_SOFTWARE_RESET))
+    {
+      m_pcf85063_reset(now_us);
+      return 0;
+    }
+
+    // Leaving STOP, or setting the time, restarts the prescaler
+    if (((reg == PCF85063_REG_CONTROL_1) && (m_rtc.reg[reg] & PCF85063_CONTROL_1_STOP) && !(data[i] & PCF85063_CONTROL_1_STOP)) ||
+        ((reg >= PCF85063_REG_SECONDS) && (reg <= PCF85063_REG_YEARS)))
+      m_rtc.second_us = now_us;
+
+    m_rtc.reg[reg] = data[i];
+    reg = (reg + 1) % PCF85063_REG_CNT;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         PCF85063 model run the calendar up to now
+ *
+ * @param[in]     now_us  Current time
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_pcf85063_update(uint64_t now_us)
+{
+  uint64_t seconds;
+
+  if (m_rtc.reg[PCF85063_REG_CONTROL_1] & PCF85063_CONTROL_1_STOP)
+  {
+    m_rtc.second_us = now_us;
+    return;
+  }
+
+  if (now_us < m_rtc.second_us + 1000000)
+    return;
+
+  seconds          = (now_us - m_rtc.second_us) / 1000000;
+  m_rtc.second_us += seconds * 1000000;
+
+  m_pcf85063_add_seconds(seconds);
+}
+
+/**
+ * @brief         PCF85063 model move the calendar forward
+ *
+ * @param[in]     seconds   Seconds elapsed
+ *
+ * @attention     Leap years are every 4 years, as on the chip
+ *
+ * @return        None
+ */
+static void m_pcf85063_add_seconds(uint64_t seconds)
+{
+  uint8_t *r = m_rtc.reg;
+  uint64_t total;
+  uint32_t days;
+  uint8_t mday, wday, month, year;
+
+  total  = seconds + m_pcf85063_bcd_to_bin(r[PCF85063_REG_SECONDS] & 0x7F);
+  total += (uint64_t)m_pcf85063_bcd_to_bin(r[PCF85063_REG_MINUTES] & 0x7F) * 60;
+  total += (uint64_t)m_pcf85063_bcd_to_bin(r[PCF85063_REG_HOURS] & 0x3F) * 3600;
+
+  days  = (uint32_t)(total / 86400);
+  total = total % 86400;
+
+  r[PCF85063_REG_SECONDS] = (r[PCF85063_REG_SECONDS] & PCF85063_SECONDS_OS) | m_pcf85063_bin_to_bcd(total % 60);
+  r[PCF85063_REG_MINUTES] = m_pcf85063_bin_to_bcd((total / 60) % 60);
+  r[PCF85063_REG_HOURS]   = m_pcf85063_bin_to_bcd(total / 3600);
+
+  if (days == 0)
+    return;
+
+  mday  = m_pcf85063_bcd_to_bin(r[PCF85063_REG_DAYS] & 0x3F);
+  wday  = r[PCF85063_REG_WEEKDAYS] & 0x07;
+  month = m_pcf85063_bcd_to_bin(r[PCF85063_REG_MONTHS] & 0x1F);
+  year  = m_pcf85063_bcd_to_bin(r[PCF85063_REG_YEARS]);
+
+  wday = (uint8_t)((wday + days) % 7);
+
+  while (days--)
+  {
+    if (++mday > m_pcf85063_days_in_month(month, year))
+    {
+      mday = 1;
+      if (++month > 12)
+      {
+        month = 1;
+        year  = (year + 1) % 100;
+      }
+    }
+  }
+
+  r[PCF85063_REG_DAYS]     = m_pcf85063_bin_to_bcd(mday);
+  r[PCF85063_REG_WEEKDAYS] = wday;
+  r[PCF85063_REG_MONTHS]   = m_pcf85063_bin_to_bcd(month);
+  r[PCF85063_REG_YEARS]    = m_pcf85063_bin_to_bcd(year);
+}
+
+/**
+ * @brief         PCF85063 model days in a month
+ *
+ * @param[in]     month   Month 1 to 12
+ * @param[in]     year    Year 0 to 99
+ *
+ * @attention     None
+ *
+ * @return        Days in month
+ */
+static uint8_t m_pcf85063_days_in_month(uint8_t month, uint8_t year)
+{
+  if ((month < 1) || (month > 12))
+    return 31;
+
+  if ((month == 2) && ((year % 4) == 0))
+    return 29;
+
+  return m_rtc_days_in_month[month - 1];
+}
+
+/**
+ * @brief         Binary to BCD converter
+ *
+ * @param[in]     val     Binary value
+ *
+ * @attention     None
+ *
+ * @return        BCD value
+ */
+static uint8_t m_pcf85063_bin_to_bcd(uint8_t val)
+{
+  return (((val / 10) << 4) + (val % 10));
+}
+
+/**
+ * @brief         BCD to Binary converter
+ *
+ * @param[in]     val     BCD value
+ *
+ * @attention     None
+ *
+ * @return        Binary value
+ */
+static uint8_t m_pcf85063_bcd_to_bin(uint8_t val)
+{
+  return ((val & 0x0F) + (val >> 4) * 10);
+}
+
+/* End of file -------------------------------------------------------- */
@@ -12,6 +12,7 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "iam20380.h"
+#include "fixconv.h"
 
 /* Private defines ---------------------------------------------------- */
 // IAM20380 registers
@@ -50,88 +51,135 @@
 #define IAM20380_REG_FIFO_R_W                    (0X74)
 #define IAM20380_REG_WHO_AM_I                    (0X75)
 
+// IAM20380 init
+#define IAM20380_POLL_MS                         (5)      // Reset complete polling period
+#define IAM20380_RESET_TIMEOUT_MS                (200)
+
 // IAM20380 identifier value
 #define IAM20380_VALUE_IDENTIFIER                (0xB5)
 
+// IAM20380 temperature, 326.8 LSB per degree Celsius, 0 at 25 degree Celsius
+#define IAM20380_TEMP_CDEG(_raw)                 ((int16_t)(((int32_t)(_raw) * 1000) / 3268 + 2500))
+
+// IAM20380 interrupt pin config
+#define IAM20380_INT_PIN_CFG_RD_CLEAR            (0x10)   // Interrupt status cleared by any read
+
+// IAM20380 FIFO
+#define IAM20380_FIFO_EN_GYRO                    (0x70)   // XG, YG and ZG into the FIFO
+#define IAM20380_FIFO_BURST_SAMPLES              (32)     // Samples per burst read
+
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
 static const char *TAG = "IAM20380";
 
+// IAM20380 register map
+static const regmap_field_t IAM20380_FS_SEL     = REGMAP_FIELD(IAM20380_REG_GYRO_CONFIG, 4, 3);
+static const regmap_field_t IAM20380_DEVICE_RESET = REGMAP_FIELD(IAM20380_REG_PWR_MGMT_1, 7, 7);
+static const regmap_field_t IAM20380_DATA_RDY   = REGMAP_FIELD(IAM20380_REG_INT_STATUS, 0, 0);
+static const regmap_group_t IAM20380_GYRO_OUT   = REGMAP_GROUP(IAM20380_REG_GYRO_XOUT_H, IAM20380_REG_GYRO_ZOUT_L);
+static const regmap_group_t IAM20380_SENS_OUT   = REGMAP_GROUP(IAM20380_REG_TEMP_OUT_H, IAM20380_REG_GYRO_ZOUT_L);
+static const regmap_field_t IAM20380_FIFO_OFLOW = REGMAP_FIELD(IAM20380_REG_INT_STATUS, 4, 4);
+static const regmap_field_t IAM20380_USER_FIFO  = REGMAP_FIELD(IAM20380_REG_USER_CTRL, 6, 6);
+static const regmap_field_t IAM20380_FIFO_RST   = REGMAP_FIELD(IAM20380_REG_USER_CTRL, 2, 2);
+static const regmap_field_t IAM20380_FIFO_COUNT = REGMAP_FIELD(IAM20380_REG_FIFO_COUNTH, 4, 0);
+static const regmap_group_t IAM20380_FIFO_CNT   = REGMAP_GROUP(IAM20380_REG_FIFO_COUNTH, IAM20380_REG_FIFO_COUNTL);
+
+static const reg_shadow_def_t m_iam20380_shadow_def[] =
+{
+  { IAM20380_REG_GYRO_CONFIG, 0xFF }
+};
+
 /* Private function prototypes ---------------------------------------- */
-static base_status_t m_iam20380_read_reg(iam20380_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
-static base_status_t m_iam20380_write_reg(iam20380_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
+static base_status_t m_iam20380_fifo_reset(iam20380_t *me);
+static base_status_t m_iam20380_reset(iam20380_t *me, uint32_t now_ms);
+static base_status_t m_iam20380_init_wait(iam20380_t *me);
+static base_status_t m_iam20380_write_config(iam20380_t *me);
+static uint32_t m_iam20380_period_us(const iam20380_t *me);
+static void m_iam20380_integrate(int32_t *angle_mdeg, int32_t *rem_ndeg, int32_t rate_mdps, uint32_t period_us);
 
 /* Function definitions ----------------------------------------------- */
 base_status_t iam20380_init(iam20380_t *me)
+{
+  CHECK_STATUS(iam20380_init_start(me, 0));
+
+  return m_iam20380_init_wait(me);
+}
+
+base_status_t iam20380_config(iam20380_t *me)
+{
+  CHECK_STATUS(m_iam20380_reset(me, 0));
+
+  return m_iam20380_init_wait(me);
+}
+
+base_status_t iam20380_init_start(iam20380_t *me, uint32_t now_ms)
 {
   uint8_t identifier;
 
   if ((me == NULL) || (me->i2c_read == NULL) || (me->i2c_write == NULL) || (me->delay_ms == NULL))
     return BS_ERROR_PARAMS;
 
-  CHECK_STATUS(m_iam20380_read_reg(me, IAM20380_REG_WHO_AM_I, &identifier, 1)); // IAM20380 check identity
+  me->init_state = IAM20380_INIT_IDLE;
+
+  CHECK_STATUS(regmap_init(&me->map, TAG, me->device_address, me->i2c_read, me->i2c_write,
+                           m_iam20380_shadow_def, sizeof(m_iam20380_shadow_def) / sizeof(m_iam20380_shadow_def[0])));
+
+  CHECK_STATUS(regmap_read(&me->map, IAM20380_REG_WHO_AM_I, &identifier, 1)); // IAM20380 check identity
 
   CHECK(IAM20380_VALUE_IDENTIFIER == identifier, BS_ERROR); 
 
-  CHECK_STATUS(iam20380_config(me)); // IAM20380 config
-  return BS_OK;
+  return m_iam20380_reset(me, now_ms);
 }
 
-base_status_t iam20380_config(iam20380_t *me)
+base_status_t iam20380_init_poll(iam20380_t *me, uint32_t now_ms)
 {
-  uint8_t tmp;
-  
-  tmp = 0x80;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_PWR_MGMT_1, &tmp, 1)); // Reset chip, disable sleep mode, disable low power mode
-  me->delay_ms(1000);
-
-  tmp = 0x01;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_PWR_MGMT_1, &tmp, 1)); // Auto select clock
-  me->delay_ms(50);
-  
-  tmp = 0x00;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_PWR_MGMT_2, &tmp, 1)); // Enable x - y - z axis
-  me->delay_ms(50);
-
-  tmp = me->config.sample_rate;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_SMPLRT_DIV, &tmp, 1)); // Set sample rate 
-  me->delay_ms(50);
-
-  tmp = me->config.digi_low_pass_filter;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_CONFIG, &tmp, 1)); // Set digital low pass filter
-  me->delay_ms(50);
-
-  tmp = (me->config.fullscale << 3) & 0x18;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_GYRO_CONFIG, &tmp, 1)); // Set fulscale 
-  me->delay_ms(50);
-
-  tmp = me->config.low_power_mode_cfg;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_LP_MODE_CFG, &tmp, 1)); // Set up low power mode  
-  me->delay_ms(50);
-
-  tmp = 0x01;
-  CHECK_STATUS(m_iam20380_write_reg(me, IAM20380_REG_INT_ENABLE, &tmp, 1));  // Enable interrupt when data is ready
-  me->delay_ms(50);
+  uint8_t pwr;
+
+  if (me->init_state == IAM20380_INIT_DONE)
+    return BS_OK;
+
+  if (me->init_state != IAM20380_INIT_RESET)
+    return BS_ERROR;
+
+  // The device may not answer until the reset completes, a failed read is not an error yet
+  if ((BS_OK == regmap_read(&me->map, IAM20380_REG_PWR_MGMT_1, &pwr, 1)) && !REGMAP_FIELD_GET(&IAM20380_DEVICE_RESET, pwr))
+  {
+    if (BS_OK != m_iam20380_write_config(me))
+    {
+      me->init_state = IAM20380_INIT_FAILED;
+      return BS_ERROR;
+    }
+
+    me->init_state = IAM20380_INIT_DONE;
+    return BS_OK;
+  }
+
+  if (now_ms - me->init_start_ms >= IAM20380_RESET_TIMEOUT_MS)
+  {
+    ESP_LOGE(TAG, "Reset timeout");
+    me->init_state = IAM20380_INIT_FAILED;
+    return BS_ERROR;
+  }
 
   return BS_OK;
 }
 
 base_status_t iam20380_get_raw_data(iam20380_t *me)
 { 
-  uint8_t data[6];
+  uint8_t data[IAM20380_REG_GYRO_ZOUT_L - IAM20380_REG_GYRO_XOUT_H + 1];
   uint8_t status;
 
-  CHECK_STATUS(m_iam20380_read_reg(me, IAM20380_REG_INT_STATUS, &status, 1));
+  CHECK_STATUS(regmap_field_read(&me->map, &IAM20380_DATA_RDY, &status));
 
-  if (status & 0x01)
+  if (status)
   {
-    CHECK_STATUS(m_iam20380_read_reg(me, IAM20380_REG_GYRO_XOUT_H, data, sizeof(data)));
+    CHECK_STATUS(regmap_group_read(&me->map, &IAM20380_GYRO_OUT, data));
 
-    me->data.raw_data.x = ((data[0] << 8) | data[1]);
-    me->data.raw_data.y = ((data[2] << 8) | data[3]);
-    me->data.raw_data.z = ((data[4] << 8) | data[5]);
+    me->data.raw_data.x = REGMAP_GROUP_BE16(&IAM20380_GYRO_OUT, data, IAM20380_REG_GYRO_XOUT_H);
+    me->data.raw_data.y = REGMAP_GROUP_BE16(&IAM20380_GYRO_OUT, data, IAM20380_REG_GYRO_YOUT_H);
+    me->data.raw_data.z = REGMAP_GROUP_BE16(&IAM20380_GYRO_OUT, data, IAM20380_REG_GYRO_ZOUT_H);
   }
   else
   {
@@ -141,14 +189,41 @@ base_status_t iam20380_get_raw_data(iam20380_t *me)
   return BS_OK;
 }
 
+base_status_t iam20380_read_sample(iam20380_t *me, uint64_t timestamp_us, iam20380_sample_t *sample)
+{
+  uint8_t data[IAM20380_REG_GYRO_ZOUT_L - IAM20380_REG_TEMP_OUT_H + 1];
+  int16_t temp;
+
+  CHECK_STATUS(regmap_group_read(&me->map, &IAM20380_SENS_OUT, data)); // Temperature comes free in the same burst
+
+  me->data.raw_data.x = REGMAP_GROUP_BE16(&IAM20380_SENS_OUT, data, IAM20380_REG_GYRO_XOUT_H);
+  me->data.raw_data.y = REGMAP_GROUP_BE16(&IAM20380_SENS_OUT, data, IAM20380_REG_GYRO_YOUT_H);
+  me->data.raw_data.z = REGMAP_GROUP_BE16(&IAM20380_SENS_OUT, data, IAM20380_REG_GYRO_ZOUT_H);
+
+  temp = (int16_t)REGMAP_GROUP_BE16(&IAM20380_SENS_OUT, data, IAM20380_REG_TEMP_OUT_H);
+  me->data.temp_cdeg = IAM20380_TEMP_CDEG(temp);
+
+  sample->raw          = me->data.raw_data;
+  sample->timestamp_us = timestamp_us;
+
+  return BS_OK;
+}
+
 base_status_t iam20380_get_gyro_angle(iam20380_t *me)
 {
+  uint32_t period_us;
+
   CHECK_STATUS(iam20380_get_sensitivity(me));
   CHECK_STATUS(iam20380_get_raw_data(me));
 
-  me->data.angle.x = (float)(me->data.raw_data.x) / me->data.sensitivity;
-  me->data.angle.y = (float)(me->data.raw_data.y) / me->data.sensitivity;
-  me->data.angle.z = (float)(me->data.raw_data.z) / me->data.sensitivity;
+  me->data.rate.x = fixconv_iam20380_rate_mdps(me->data.raw_data.x, me->config.fullscale) - fixconv_iam20380_rate_mdps(me->data.bias.x, me->config.fullscale);
+  me->data.rate.y = fixconv_iam20380_rate_mdps(me->data.raw_data.y, me->config.fullscale) - fixconv_iam20380_rate_mdps(me->data.bias.y, me->config.fullscale);
+  me->data.rate.z = fixconv_iam20380_rate_mdps(me->data.raw_data.z, me->config.fullscale) - fixconv_iam20380_rate_mdps(me->data.bias.z, me->config.fullscale);
+
+  period_us = m_iam20380_period_us(me);
+  m_iam20380_integrate(&me->data.angle.x, &me->data.angle_ndeg.x, me->data.rate.x, period_us);
+  m_iam20380_integrate(&me->data.angle.y, &me->data.angle_ndeg.y, me->data.rate.y, period_us);
+  m_iam20380_integrate(&me->data.angle.z, &me->data.angle_ndeg.z, me->data.rate.z, period_us);
 
   return BS_OK;
 }
@@ -157,60 +232,257 @@ base_status_t iam20380_get_sensitivity(iam20380_t *me)
 {
   uint8_t tmp;
 
-  CHECK_STATUS(m_iam20380_read_reg(me, IAM20380_REG_GYRO_CONFIG, &tmp, 1));
-  me->config.fullscale = (tmp & 0x18) >> 3;
+  CHECK_STATUS(regmap_field_read(&me->map, &IAM20380_FS_SEL, &tmp));
+  me->config.fullscale = tmp;
 
   switch (me->config.fullscale)
   {
-    case IAM20380_FULLSCALE_250_DPS : me->data.sensitivity = 131.0; break;
-    case IAM20380_FULLSCALE_500_DPS : me->data.sensitivity = 65.5;  break;
-    case IAM20380_FULLSCALE_1000_DPS: me->data.sensitivity = 32.8;  break;
-    case IAM20380_FULLSCALE_2000_DPS: me->data.sensitivity = 16.4;  break;
+    case IAM20380_FULLSCALE_250_DPS : me->data.sensitivity_x10 = 1310; break;
+    case IAM20380_FULLSCALE_500_DPS : me->data.sensitivity_x10 = 655;  break;
+    case IAM20380_FULLSCALE_1000_DPS: me->data.sensitivity_x10 = 328;  break;
+    case IAM20380_FULLSCALE_2000_DPS: me->data.sensitivity_x10 = 164;  break;
     default : break;
   }
 
   return BS_OK;
 }
 
+base_status_t iam20380_fifo_enable(iam20380_t *me, bool enable)
+{
+  me->fifo.enabled = false;
+
+  if (!enable)
+  {
+    CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_USER_CTRL, 0x00));
+    CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_FIFO_EN, 0x00));
+
+    return BS_OK;
+  }
+
+  me->fifo.period_us = m_iam20380_period_us(me);
+  me->fifo.samples   = 0;
+  me->fifo.bursts    = 0;
+  me->fifo.overflows = 0;
+
+  CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_FIFO_EN, IAM20380_FIFO_EN_GYRO));
+  CHECK_STATUS(m_iam20380_fifo_reset(me));
+
+  me->fifo.enabled = true;
+
+  return BS_OK;
+}
+
+base_status_t iam20380_fifo_read(iam20380_t *me, uint64_t now_us, iam20380_sample_t *samples, uint16_t max, uint16_t *count)
+{
+  uint8_t buf[IAM20380_FIFO_BURST_SAMPLES * IAM20380_FIFO_FRAME_SIZE];
+  uint8_t tmp[IAM20380_REG_FIFO_COUNTL - IAM20380_REG_FIFO_COUNTH + 1];
+  uint64_t first_us, expect_us;
+  uint16_t avail, n, burst;
+  uint8_t status;
+
+  *count = 0;
+
+  CHECK(me->fifo.enabled, BS_ERROR);
+
+  CHECK_STATUS(regmap_read(&me->map, IAM20380_REG_INT_STATUS, &status, 1));
+  if (REGMAP_FIELD_GET(&IAM20380_FIFO_OFLOW, status))
+  {
+    me->fifo.overflows++;
+    return m_iam20380_fifo_reset(me);
+  }
+
+  CHECK_STATUS(regmap_group_read(&me->map, &IAM20380_FIFO_CNT, tmp));
+  avail = ((REGMAP_GROUP_FIELD(&IAM20380_FIFO_CNT, tmp, &IAM20380_FIFO_COUNT) << 8) | tmp[IAM20380_REG_FIFO_COUNTL - IAM20380_FIFO_CNT.reg]) / IAM20380_FIFO_FRAME_SIZE;
+  if (avail == 0)
+    return BS_OK;
+
+  // The newest sample in the FIFO is less than one period old
+  expect_us = me->fifo.last_us + (uint64_t)avail * me->fifo.period_us;
+  if ((me->fifo.last_us != 0) && (expect_us <= now_us) && (now_us - expect_us < me->fifo.period_us))
+    first_us = me->fifo.last_us + me->fifo.period_us;
+  else
+    first_us = now_us - (uint64_t)(avail - 1) * me->fifo.period_us;
+
+  n = (avail < max) ? avail : max;
+  if (n == 0)
+    return BS_OK;
+
+  for (uint16_t done = 0; done < n; done += burst)
+  {
+    burst = ((n - done) < IAM20380_FIFO_BURST_SAMPLES) ? (n - done) : IAM20380_FIFO_BURST_SAMPLES;
+
+    CHECK_STATUS(regmap_read_fifo(&me->map, IAM20380_REG_FIFO_R_W, buf, burst * IAM20380_FIFO_FRAME_SIZE));
+    me->fifo.bursts++;
+
+    for (uint16_t i = 0; i < burst; i++)
+    {
+      uint8_t *frame = &buf[i * IAM20380_FIFO_FRAME_SIZE];
+      iam20380_sample_t *sample = &samples[done + i];
+
+      sample->raw.x        = (frame[0] << 8) | frame[1];
+      sample->raw.y        = (frame[2] << 8) | frame[3];
+      sample->raw.z        = (frame[4] << 8) | frame[5];
+      sample->timestamp_us = first_us + (uint64_t)(done + i) * me->fifo.period_us;
+    }
+  }
+
+  me->data.raw_data   = samples[n - 1].raw;
+  me->fifo.last_us    = samples[n - 1].timestamp_us;
+  me->fifo.samples   += n;
+  *count              = n;
+
+  return BS_OK;
+}
+
 /* Private function definitions ---------------------------------------- */
 /**
- * @brief         IAM20380 read register
+ * @brief         IAM20380 output data period
  *
  * @param[in]     me      Pointer to handle of IAM20380 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
  *
- * @attention     None
+ * @attention     Internal sample rate is 8 kHz with the filter bypassed, 1 kHz otherwise
+ *
+ * @return        Period in microsecond
+ */
+static uint32_t m_iam20380_period_us(const iam20380_t *me)
+{
+  uint32_t rate_hz;
+
+  if ((me->config.digi_low_pass_filter == IAM20380_DLPF0_NBW307) || (me->config.digi_low_pass_filter == IAM20380_DLPF7_NBW3451))
+    rate_hz = 8000;
+  else
+    rate_hz = 1000;
+
+  return (1000000 / rate_hz) * (1 + me->config.sample_rate);
+}
+
+/**
+ * @brief         IAM20380 add one period of rate to an angle
+ *
+ * @param[in]     angle_mdeg    Pointer to angle in millidegree
+ * @param[in]     rem_ndeg      Pointer to remainder in nanodegree, under a millidegree
+ * @param[in]     rate_mdps     Rate in millidegree per second
+ * @param[in]     period_us     Period in microsecond
+ *
+ * @attention     The remainder carries over so the angle does not drift on truncation
+ *
+ * @return        None
+ */
+static void m_iam20380_integrate(int32_t *angle_mdeg, int32_t *rem_ndeg, int32_t rate_mdps, uint32_t period_us)
+{
+  int64_t ndeg = (int64_t)rate_mdps * period_us + *rem_ndeg;
+
+  *angle_mdeg += (int32_t)(ndeg / 1000000);
+  *rem_ndeg    = (int32_t)(ndeg % 1000000);
+}
+
+/**
+ * @brief         IAM20380 reset and enable the FIFO
+ *
+ * @param[in]     me      Pointer to handle of IAM20380 module.
+ *
+ * @attention     The sample timeline restarts with the next drain
  *
  * @return
  * - BS_OK
  * - BS_ERROR
  */
-static base_status_t m_iam20380_read_reg(iam20380_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
+static base_status_t m_iam20380_fifo_reset(iam20380_t *me)
 {
-  CHECK(0 == me->i2c_read(me->device_address, reg, p_data, len), BS_ERROR);
+  uint8_t tmp = REGMAP_FIELD_PREP(&IAM20380_USER_FIFO, 1) | REGMAP_FIELD_PREP(&IAM20380_FIFO_RST, 1);
+
+  me->fifo.last_us = 0;
+
+  CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_USER_CTRL, tmp));
 
   return BS_OK;
 }
 
 /**
- * @brief         IAM20380 write register
+ * @brief         IAM20380 start a device reset
  *
- * @param[in]     me      Pointer to handle of IAM20380 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
+ * @param[in]     me        Pointer to handle of IAM20380 module.
+ * @param[in]     now_ms    Current time in millisecond
  *
- * @attention     None
+ * @attention     The configuration is written by iam20380_init_poll() once the reset completes
  *
  * @return
  * - BS_OK
  * - BS_ERROR
  */
-static base_status_t m_iam20380_write_reg(iam20380_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
+static base_status_t m_iam20380_reset(iam20380_t *me, uint32_t now_ms)
 {
-  CHECK(0 == me->i2c_write(me->device_address, reg, p_data, len), BS_ERROR);
+  me->init_state = IAM20380_INIT_FAILED;
+
+  CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_PWR_MGMT_1, 0x80)); // Reset chip
+  reg_shadow_invalidate(&me->map.shadow); // Registers back to their reset values
+
+  me->init_start_ms = now_ms;
+  me->init_state    = IAM20380_INIT_RESET;
+
+  return BS_OK;
+}
+
+/**
+ * @brief         IAM20380 poll the init until it completes
+ *
+ * @param[in]     me        Pointer to handle of IAM20380 module.
+ *
+ * @attention     Blocking, time counted in polling periods
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+static base_status_t m_iam20380_init_wait(iam20380_t *me)
+{
+  uint32_t elapsed_ms = 0;
+
+  while (1)
+  {
+    CHECK_STATUS(iam20380_init_poll(me, elapsed_ms));
+    if (me->init_state == IAM20380_INIT_DONE)
+      return BS_OK;
+
+    me->delay_ms(IAM20380_POLL_MS);
+    elapsed_ms += IAM20380_POLL_MS;
+  }
+}
+
+/**
+ * @brief         IAM20380 write the configuration after a reset
+ *
+ * @param[in]     me        Pointer to handle of IAM20380 module.
+ *
+ * @attention     Four bursts, the device leaves sleep with the last one
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+static base_status_t m_iam20380_write_config(iam20380_t *me)
+{
+  uint8_t rate[] =
+  {
+    me->config.sample_rate,                                   // SMPLRT_DIV
+    me->config.digi_low_pass_filter,                          // CONFIG
+    REGMAP_FIELD_PREP(&IAM20380_FS_SEL, me->config.fullscale) // GYRO_CONFIG
+  };
+  uint8_t irq[] =
+  {
+    IAM20380_INT_PIN_CFG_RD_CLEAR,                            // INT_PIN_CFG, 50 us pulse, status cleared by any read
+    0x01                                                      // INT_ENABLE, data ready
+  };
+  uint8_t pwr[] =
+  {
+    0x01,                                                     // PWR_MGMT_1, auto select clock, no sleep
+    0x00                                                      // PWR_MGMT_2, x - y - z axis enabled
+  };
+
+  CHECK_STATUS(regmap_write(&me->map, IAM20380_REG_SMPLRT_DIV, rate, sizeof(rate)));
+  CHECK_STATUS(regmap_write_byte(&me->map, IAM20380_REG_LP_MODE_CFG, me->config.low_power_mode_cfg));
+  CHECK_STATUS(regmap_write(&me->map, IAM20380_REG_INT_PIN_CFG, irq, sizeof(irq)));
+  CHECK_STATUS(regmap_write(&me->map, IAM20380_REG_PWR_MGMT_1, pwr, sizeof(pwr)));
 
   return BS_OK;
 }
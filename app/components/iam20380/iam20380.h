@@ -20,9 +20,12 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
  #include "bsp.h"
+ #include "regmap.h"
 
 /* Public defines ----------------------------------------------------- */
 #define IAM20380_I2C_ADDR                       (0x68 << 1) // I2C bus need 8 bits address
+#define IAM20380_FIFO_SIZE                      (512)       // FIFO size in bytes
+#define IAM20380_FIFO_FRAME_SIZE                (6)         // Gyro X, Y, Z per sample, big endian
 
 /* Public enumerate/structure ----------------------------------------- */
 /**
@@ -110,13 +113,24 @@ typedef struct
 iam20380_raw_data_t;
 
 /**
- * @brief IAM20380 angle
+ * @brief IAM20380 rate in millidegree per second
  */
 typedef struct
 {
-  float x;
-  float y;
-  float z;
+  int32_t x;
+  int32_t y;
+  int32_t z;
+}
+iam20380_rate_t;
+
+/**
+ * @brief IAM20380 angle in millidegree
+ */
+typedef struct
+{
+  int32_t x;
+  int32_t y;
+  int32_t z;
 }
 iam20380_angle_t;
 
@@ -126,11 +140,51 @@ iam20380_angle_t;
 typedef struct
 {
   iam20380_raw_data_t raw_data;
-  iam20380_angle_t angle;
-  float sensitivity;
+  iam20380_raw_data_t bias; // Zero rate offset in counts, removed by iam20380_get_gyro_angle()
+  iam20380_rate_t rate;     // Bias corrected rate, fixed point
+  iam20380_angle_t angle;   // Rate integrated over the sample period
+  iam20380_rate_t angle_ndeg; // Angle under a millidegree, in nanodegree, carried to the next step
+  uint16_t sensitivity_x10; // Counts per degree per second, times 10
+  int16_t temp_cdeg;        // Temperature in centidegree Celsius, updated by iam20380_read_sample()
 }
 iam20380_data_t;
 
+/**
+ * @brief IAM20380 timestamped sample
+ */
+typedef struct
+{
+  iam20380_raw_data_t raw;
+  uint64_t timestamp_us;
+}
+iam20380_sample_t;
+
+/**
+ * @brief IAM20380 FIFO state
+ */
+typedef struct
+{
+  bool enabled;
+  uint32_t period_us;       // Sample period from the sample rate divider and the filter
+  uint64_t last_us;         // Timestamp of the newest sample drained, 0 when unknown
+  uint32_t samples;         // Samples drained
+  uint32_t bursts;          // Burst reads of the FIFO data register
+  uint32_t overflows;       // Overflows, each one resets the FIFO and loses its content
+}
+iam20380_fifo_t;
+
+/**
+ * @brief IAM20380 init state
+ */
+typedef enum
+{
+    IAM20380_INIT_IDLE = 0
+  , IAM20380_INIT_RESET     // Waiting for the device reset to complete
+  , IAM20380_INIT_DONE
+  , IAM20380_INIT_FAILED
+}
+iam20380_init_state_t;
+
 /**
  * @brief IAM20380 sensor struct
  */
@@ -139,6 +193,10 @@ typedef struct
   uint8_t device_address;  // I2C device address
   iam20380_data_t data;
   iam20380_config_t config;
+  iam20380_fifo_t fifo;
+  regmap_t map;            // Register map, set up by init
+  iam20380_init_state_t init_state;
+  uint32_t init_start_ms;  // Time the reset was issued
 
   // Read n-bytes from device's internal address <reg_addr> via I2C bus
   int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
@@ -170,7 +228,7 @@ base_status_t iam20380_init(iam20380_t *me);
  *
  * @param[in]     me      Pointer to handle of IAM20380 module.
  *
- * @attention     None
+ * @attention     Resets the device and blocks until the configuration is written
  *
  * @return
  * - BS_OK
@@ -178,6 +236,36 @@ base_status_t iam20380_init(iam20380_t *me);
  */
 base_status_t iam20380_config(iam20380_t *me);
 
+/**
+ * @brief         IAM20380 start a non blocking init
+ *
+ * @param[in]     me      Pointer to handle of IAM20380 module.
+ * @param[in]     now_ms  Current time in millisecond
+ *
+ * @attention     Checks the identity and issues the device reset, then call
+ *                iam20380_init_poll() until init_state is IAM20380_INIT_DONE
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR_PARAMS
+ * - BS_ERROR
+ */
+base_status_t iam20380_init_start(iam20380_t *me, uint32_t now_ms);
+
+/**
+ * @brief         IAM20380 advance the non blocking init
+ *
+ * @param[in]     me      Pointer to handle of IAM20380 module.
+ * @param[in]     now_ms  Current time in millisecond
+ *
+ * @attention     Once the reset completes the configuration is written in four bursts
+ *
+ * @return
+ * - BS_OK        In progress or done
+ * - BS_ERROR     Reset timeout or bus error, init_state is IAM20380_INIT_FAILED
+ */
+base_status_t iam20380_init_poll(iam20380_t *me, uint32_t now_ms);
+
 /**
  * @brief         IAM20380 read raw data
  *
@@ -190,11 +278,27 @@ base_status_t iam20380_config(iam20380_t *me);
  */
 base_status_t iam20380_get_raw_data(iam20380_t *me);
 
+/**
+ * @brief         IAM20380 read one sample without checking the data ready status
+ *
+ * @param[in]     me            Pointer to handle of IAM20380 module.
+ * @param[in]     timestamp_us  Time of the data ready interrupt in microsecond
+ * @param[out]    sample        Pointer to sample
+ *
+ * @attention     For the data ready interrupt path, a single burst of the temperature and
+ *                gyro output registers
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t iam20380_read_sample(iam20380_t *me, uint64_t timestamp_us, iam20380_sample_t *sample);
+
 /**
  * @brief         IAM20380 calculate gyro angle
  *
  * @param[in]     me            Pointer to handle of IAM20380 module.
- * @attention     None
+ * @attention     Call once per sample period, the angle adds the rate over one period
  *
  * @return
  * - BS_OK
@@ -214,6 +318,40 @@ base_status_t iam20380_get_gyro_angle(iam20380_t *me);
  */
 base_status_t iam20380_get_sensitivity(iam20380_t *me);
 
+/**
+ * @brief         IAM20380 enable or disable the FIFO acquisition mode
+ *
+ * @param[in]     me            Pointer to handle of IAM20380 module.
+ * @param[in]     enable        Enable
+ *
+ * @attention     Call after iam20380_config(), the FIFO is reset on enable
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t iam20380_fifo_enable(iam20380_t *me, bool enable);
+
+/**
+ * @brief         IAM20380 drain samples from the FIFO
+ *
+ * @param[in]     me            Pointer to handle of IAM20380 module.
+ * @param[in]     now_us        Current time in microsecond
+ * @param[out]    samples       Pointer to samples, oldest first
+ * @param[in]     max           Maximum number of samples
+ * @param[out]    count         Number of samples read
+ *
+ * @attention     Samples are timestamped one period apart, continuing from the previous
+ *                drain while the sample count agrees with now_us, re-anchored on now_us
+ *                otherwise. After an overflow the FIFO is reset, fifo.overflows counts
+ *                up and no sample is returned.
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t iam20380_fifo_read(iam20380_t *me, uint64_t now_us, iam20380_sample_t *samples, uint16_t max, uint16_t *count);
+
 /* -------------------------------------------------------------------------- */
 #ifdef __cplusplus
 } // extern "C"
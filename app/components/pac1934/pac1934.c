@@ -12,6 +12,7 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "pac1934.h"
+#include "fixconv.h"
 
 /* Private defines ---------------------------------------------------- */
 // PAC1934 resgisters
@@ -66,8 +67,22 @@
 // PAC1934 revision ID
 #define PAC1934_REV_ID_IDENTIFIER         (0x03) 
 
-// PAC1934 fullscale range
-#define FULLSCALE_RANGE                   (0.1f)
+// PAC1934 fullscale range, 100 mV over the 4 mOhm sense resistor
+#define PAC1934_FSR_MV                    (100)
+#define PAC1934_RSENSE_MOHM               (4)
+#define PAC1934_FSC_MA                    (PAC1934_FSR_MV * 1000 / PAC1934_RSENSE_MOHM)
+
+// PAC1934 accumulator block, ACC_COUNT then VPOWER1_ACC to VPOWER4_ACC
+#define PAC1934_ACC_COUNT_LEN             (3)
+#define PAC1934_VPOWER_ACC_LEN            (6)
+#define PAC1934_ACC_LEN                   (PAC1934_ACC_COUNT_LEN + PAC1934_CHANNEL_CNT * PAC1934_VPOWER_ACC_LEN)
+// PAC1934 measurement block, VBUS1 to VPOWER4, bytes per enabled channel
+#define PAC1934_VBUS_LEN                  (2)
+#define PAC1934_VSENSE_LEN                (2)
+#define PAC1934_VPOWER_LEN                (4)
+#define PAC1934_SNAPSHOT_CH_LEN           (2 * PAC1934_VBUS_LEN + 2 * PAC1934_VSENSE_LEN + PAC1934_VPOWER_LEN)
+
+#define PAC1934_REFRESH_WAIT_MS           (1)     // Registers readable 1 ms after REFRESH
 
 /* Private enumerate/structure ---------------------------------------- */
 /* Private macros ----------------------------------------------------- */
@@ -75,28 +90,42 @@
 /* Private variables -------------------------------------------------- */
 static const char *TAG = "pac1934";
 
+// PAC1934 register map
+static const regmap_field_t PAC1934_SAMPLE_RATE = REGMAP_FIELD(PAC1934_REG_PAC_CTRL, 7, 6);
+static const regmap_field_t PAC1934_SLEEP       = REGMAP_FIELD(PAC1934_REG_PAC_CTRL, 5, 5);
+static const regmap_field_t PAC1934_ALERT_PIN   = REGMAP_FIELD(PAC1934_REG_PAC_CTRL, 3, 3);
+static const regmap_field_t PAC1934_ALERT_CC    = REGMAP_FIELD(PAC1934_REG_PAC_CTRL, 2, 2);
+static const regmap_group_t PAC1934_ID          = REGMAP_GROUP(PAC1934_REG_PRODUCT_ID, PAC1934_REG_REV_ID);
+
+// Samples per second by sample rate setting
+static const uint16_t m_pac1934_rate_hz[] = { 1024, 256, 64, 8 };
+
+static const reg_shadow_def_t m_pac1934_shadow_def[] =
+{
+  { PAC1934_REG_PAC_CTRL, 0xFE }  // OVF status bit is set by the chip
+};
+
 /* Private function prototypes ---------------------------------------- */
-static base_status_t m_pac1934_read_reg(pac1934_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
-static base_status_t m_pac1934_write_reg(pac1934_t *me, uint8_t reg, uint8_t data);
-static base_status_t m_pac1934_refresh(pac1934_t *me);
-static base_status_t m_pac1934_refresh_v(pac1934_t *me);
+static base_status_t m_pac1934_refresh(pac1934_t *me, bool reset_acc, uint32_t wait_ms);
+static uint32_t m_pac1934_settle_ms(pac1934_t *me);
+static uint8_t m_pac1934_enabled_channels(pac1934_t *me, uint8_t *channel);
 
 /* Function definitions ----------------------------------------------- */
 base_status_t pac1934_init(pac1934_t *me)
 {
-  uint8_t identifier;
+  uint8_t identifier[PAC1934_REG_REV_ID - PAC1934_REG_PRODUCT_ID + 1];
 
   if ((me == NULL) || (me->i2c_read == NULL) || (me->i2c_write == NULL) || (me->delay_ms == NULL))
     return BS_ERROR_PARAMS;
 
-  CHECK_STATUS(m_pac1934_read_reg(me, PAC1934_REG_REV_ID, &identifier, 1)); // PAC1934 check revision ID
-  CHECK(PAC1934_REV_ID_IDENTIFIER == identifier, BS_ERROR); 
+  CHECK_STATUS(regmap_init(&me->map, TAG, me->device_address, me->i2c_read, me->i2c_write,
+                           m_pac1934_shadow_def, sizeof(m_pac1934_shadow_def) / sizeof(m_pac1934_shadow_def[0])));
 
-  CHECK_STATUS(m_pac1934_read_reg(me, PAC1934_REG_MANU_ID, &identifier, 1)); // PAC1934 check manufacturer ID
-  CHECK(PAC1934_MANU_ID_IDENTIFIER == identifier, BS_ERROR); 
+  CHECK_STATUS(regmap_group_read(&me->map, &PAC1934_ID, identifier)); // PAC1934 product, manufacturer and revision ID in one burst
 
-  CHECK_STATUS(m_pac1934_read_reg(me, PAC1934_REG_PRODUCT_ID, &identifier, 1)); // PAC1934 check product ID
-  CHECK(PAC1934_PRODUCT_ID_IDENTIFIER == identifier, BS_ERROR); 
+  CHECK(PAC1934_REV_ID_IDENTIFIER == identifier[PAC1934_REG_REV_ID - PAC1934_ID.reg], BS_ERROR); 
+  CHECK(PAC1934_MANU_ID_IDENTIFIER == identifier[PAC1934_REG_MANU_ID - PAC1934_ID.reg], BS_ERROR); 
+  CHECK(PAC1934_PRODUCT_ID_IDENTIFIER == identifier[PAC1934_REG_PRODUCT_ID - PAC1934_ID.reg], BS_ERROR); 
 
   CHECK_STATUS(pac1934_config(me));
 
@@ -107,43 +136,72 @@ base_status_t pac1934_config(pac1934_t *me)
 {
   uint8_t tmp;
 
-  CHECK_STATUS(m_pac1934_refresh(me));
-
-  tmp = ((me->config.sample_rate << 6) | (me->config.sleep_mode_bit << 5)); // set sample rate and config sleep mode
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_PAC_CTRL, tmp)); 
+  tmp = REGMAP_FIELD_PREP(&PAC1934_SAMPLE_RATE, me->config.sample_rate) |
+        REGMAP_FIELD_PREP(&PAC1934_SLEEP, me->config.sleep_mode_bit) | // set sample rate and config sleep mode
+        REGMAP_FIELD_PREP(&PAC1934_ALERT_PIN, me->config.alert_cc) |    // ALERT/SLOW pin as ALERT output
+        REGMAP_FIELD_PREP(&PAC1934_ALERT_CC, me->config.alert_cc);
+  CHECK_STATUS(regmap_write_byte(&me->map, PAC1934_REG_PAC_CTRL, tmp)); 
   
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_NEG_PWR, 0xFF));
+  CHECK_STATUS(regmap_write_byte(&me->map, PAC1934_REG_NEG_PWR, 0xFF));
+
+  tmp = 0;
+  for (uint8_t ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+  {
+    if (me->config.channel_dis & (1 << ch))
+      tmp |= 0x80 >> ch;    // CH1_OFF is bit 7, NO_SKIP left clear
+  }
+  CHECK_STATUS(regmap_write_byte(&me->map, PAC1934_REG_CHANNEL_DIS, tmp));
+
+  CHECK_STATUS(regmap_write_byte(&me->map, PAC1934_REG_SLOW, 0x80));
+
+  // New control values take effect at the refresh, results after one conversion
+  CHECK_STATUS(m_pac1934_refresh(me, true, m_pac1934_settle_ms(me)));
 
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_CHANNEL_DIS, 0x00));
+  return BS_OK;
+}
+
+base_status_t pac1934_refresh_start(pac1934_t *me, bool reset_acc, uint32_t now_ms)
+{
+  CHECK(!me->refresh_pending, BS_ERROR);
 
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_SLOW, 0x80));
+  CHECK_STATUS(m_pac1934_refresh(me, reset_acc, PAC1934_REFRESH_WAIT_MS));
 
-  CHECK_STATUS(m_pac1934_refresh(me));
+  me->refresh_ms      = now_ms;
+  me->refresh_stamped = true;
 
   return BS_OK;
 }
 
+bool pac1934_refresh_ready(pac1934_t *me, uint32_t now_ms)
+{
+  if (!me->refresh_pending)
+    return true;
+
+  if (!me->refresh_stamped)
+  {
+    me->refresh_ms      = now_ms;
+    me->refresh_stamped = true;
+    return false;
+  }
+
+  if ((uint32_t)(now_ms - me->refresh_ms) < me->refresh_wait_ms)
+    return false;
+
+  me->refresh_pending = false;
+
+  return true;
+}
+
 base_status_t pac1934_voltage_measurement(pac1934_t *me, pac1934_channel_t channel)
 {
   uint8_t   register_addr;
   uint8_t   tmp_vbus[2];
-  uint16_t  vbus;
 
   register_addr = channel + PAC1934_REG_VBUS1;   // Vpower registers addresses begin with 0x07.
 
-  CHECK_STATUS(m_pac1934_read_reg(me, register_addr, tmp_vbus, sizeof(tmp_vbus)));
-
-  vbus =  (tmp_vbus[0] << 8) | tmp_vbus[1];
+  CHECK_STATUS(regmap_read(&me->map, register_addr, tmp_vbus, sizeof(tmp_vbus)));
 
-  if(vbus >= 0x8000)
-  {
-    vbus          = ((0xFFFF) - (vbus)) + 1;           // Two's complement
-    me->data.volt = (double)((vbus * 32) / (0xFFFF));  // 0xFFFF is the biggest 28 bit-number to be written.
-  }
-  else
-  {
-    me->data.volt = (double)((vbus * 32) / (0x7FFF));  // 0x7FFF is the biggest 27 bit-number to be written.
-  }
+  me->data.volt_mv = fixconv_pac1934_vbus_mv((tmp_vbus[0] << 8) | tmp_vbus[1]);
 
   return BS_OK;
 }
@@ -152,33 +210,12 @@ base_status_t pac1934_current_measurement(pac1934_t *me, pac1934_channel_t chann
 {
   uint8_t   register_addr;
   uint8_t   tmp_vsense[2];
-  uint16_t  vsense;
-  double    d_vsense;
-  double    imax;
-  double    rsense;
-  double    fullscalecurrent;
 
   register_addr = channel + PAC1934_REG_VSENSE1;   // Vpower registers addresses begin with 0x0B.
 
-  CHECK_STATUS(m_pac1934_read_reg(me, register_addr, tmp_vsense, sizeof(tmp_vsense)));
-
-  vsense = (tmp_vsense[0] << 8) | tmp_vsense[1];
-
-  imax             = (double)(FULLSCALE_RANGE) / (0.004);       // 0.004 : Rsense internal resistor value and 0.1 = 100mV full scale current value.
-  rsense           = (FULLSCALE_RANGE) / (imax);                // I max : maximum current to be measured.
-  fullscalecurrent = (FULLSCALE_RANGE) / rsense;
+  CHECK_STATUS(regmap_read(&me->map, register_addr, tmp_vsense, sizeof(tmp_vsense)));
 
-  if(vsense >= 0x8000)  // 0x8000 is the smallest negative number that could be written.
-  {
-    vsense           = ((0xFFFF) - (vsense)) + 1;               // Two's complement
-    d_vsense         = (double)vsense;
-    me->data.current = (fullscalecurrent * d_vsense) / (0xFFFF);
-  }
-  else
-  {
-    d_vsense         = (double)vsense;
-    me->data.current = (fullscalecurrent * d_vsense) / (0x7FFF);
-  }
+  me->data.current_ma = fixconv_pac1934_vsense_ma((tmp_vsense[0] << 8) | tmp_vsense[1], PAC1934_FSC_MA);
 
   return BS_OK;
 }
@@ -188,143 +225,172 @@ base_status_t pac1934_power_measurement(pac1934_t *me, pac1934_channel_t channel
   uint8_t   register_addr;
   uint8_t   tmp_vpower[4];
   uint32_t  vpower;
-  double    d_vpower;
-  double    imax;
-  double    rsense;
-  double    fullscalerangepower; 
-  double    proppower;
 
   register_addr = channel + PAC1934_REG_VPOWER1;   // Vpower registers addresses begin with 0x17.
 
-  CHECK_STATUS(m_pac1934_read_reg(me, register_addr, tmp_vpower, sizeof(tmp_vpower)));
+  CHECK_STATUS(regmap_read(&me->map, register_addr, tmp_vpower, sizeof(tmp_vpower)));
 
-  vpower = ((tmp_vpower[0] << 24) | (tmp_vpower[1] << 16) | (tmp_vpower[2] << 8) | tmp_vpower[3]);
+  vpower = (((uint32_t)tmp_vpower[0] << 24) | (tmp_vpower[1] << 16) | (tmp_vpower[2] << 8) | tmp_vpower[3]);
 
-  imax                = (double)(FULLSCALE_RANGE) / (0.004);
-  rsense              = (FULLSCALE_RANGE) / (imax);
-  fullscalerangepower = (double)(((FULLSCALE_RANGE) / (rsense)) * 32);
-  
-  if(vpower >= 0x80000000)
+  me->data.power_mw = fixconv_pac1934_vpower_mw(vpower, PAC1934_FSC_MA);
+
+  return BS_OK;
+}
+
+base_status_t pac1934_snapshot(pac1934_t *me, uint64_t timestamp_us, pac1934_snapshot_t *snap)
+{
+  uint8_t   tmp_block[PAC1934_CHANNEL_CNT * PAC1934_SNAPSHOT_CH_LEN];
+  uint8_t   channel[PAC1934_CHANNEL_CNT];
+  uint8_t   cnt;
+  uint8_t   *p;
+
+  cnt = m_pac1934_enabled_channels(me, channel);
+  CHECK(cnt != 0, BS_ERROR_PARAMS);
+
+  CHECK_STATUS(regmap_read(&me->map, PAC1934_REG_VBUS1, tmp_block, cnt * PAC1934_SNAPSHOT_CH_LEN));
+
+  memset(snap, 0, sizeof(*snap));
+  snap->timestamp_us = timestamp_us;
+
+  // Each register bank holds the enabled channels only, in channel order
+  p = tmp_block;
+  for (uint8_t i = 0; i < cnt; i++, p += PAC1934_VBUS_LEN)
   {
-    vpower              = ((0xFFFFFFFF) - (vpower)) + 1;
-    d_vpower            = (double)vpower;
-    proppower           = (d_vpower / (0xFFFFFFF0));
-    me->data.power      = fullscalerangepower * proppower;
+    snap->channel_mask       |= 1 << channel[i];
+    snap->volt_mv[channel[i]] = fixconv_pac1934_vbus_mv((p[0] << 8) | p[1]);
   }
-  else
+
+  for (uint8_t i = 0; i < cnt; i++, p += PAC1934_VSENSE_LEN)
+    snap->current_ma[channel[i]] = fixconv_pac1934_vsense_ma((p[0] << 8) | p[1], PAC1934_FSC_MA);
+
+  p += cnt * (PAC1934_VBUS_LEN + PAC1934_VSENSE_LEN);   // VBUSn_AVG and VSENSEn_AVG not used
+
+  for (uint8_t i = 0; i < cnt; i++, p += PAC1934_VPOWER_LEN)
   {
-    d_vpower            = (double)vpower;
-    proppower           = (d_vpower / 0x7FFFFFF0);
-    me->data.power      = fullscalerangepower * proppower;
+    snap->power_mw[channel[i]] = fixconv_pac1934_vpower_mw(((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3],
+                                                           PAC1934_FSC_MA);
   }
 
   return BS_OK;
 }
 
-base_status_t pac1934_into_sleep_mode(pac1934_t *me)
+base_status_t pac1934_energy_measurement(pac1934_t *me)
 {
-  uint8_t tmp;
+  uint8_t   tmp_acc[PAC1934_ACC_LEN];
+  uint8_t   channel[PAC1934_CHANNEL_CNT];
+  uint8_t   cnt;
+  uint8_t   *p;
+  int64_t   acc;
+
+  cnt = m_pac1934_enabled_channels(me, channel);
+  CHECK(cnt != 0, BS_ERROR_PARAMS);
+
+  // The chip steps through the accumulators of the enabled channels in one block read
+  CHECK_STATUS(regmap_read(&me->map, PAC1934_REG_ACC_COUNT, tmp_acc,
+                           PAC1934_ACC_COUNT_LEN + cnt * PAC1934_VPOWER_ACC_LEN));
+
+  memset(&me->data.energy, 0, sizeof(me->data.energy));
+  me->data.energy.acc_count = ((uint32_t)tmp_acc[0] << 16) | (tmp_acc[1] << 8) | tmp_acc[2];
+
+  p = &tmp_acc[PAC1934_ACC_COUNT_LEN];
+  for (uint8_t i = 0; i < cnt; i++)
+  {
+    acc = 0;
+    for (uint8_t j = 0; j < PAC1934_VPOWER_ACC_LEN; j++)
+      acc = (acc << 8) | *p++;
+
+    acc = (int64_t)((uint64_t)acc << 16) >> 16;   // Bipolar, sign extend from 48 bits
 
-  CHECK_STATUS(m_pac1934_read_reg(me, PAC1934_REG_PAC_CTRL, &tmp, 1));
-  tmp |= 0x20; 
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_PAC_CTRL, tmp)); 
-  CHECK_STATUS(m_pac1934_refresh_v(me));
+    me->data.energy.energy_uj[channel[i]] = fixconv_pac1934_energy_uj(acc, PAC1934_FSC_MA,
+                                                                      m_pac1934_rate_hz[me->config.sample_rate & 0x03]);
+  }
 
   return BS_OK;
 }
 
-base_status_t pac1934_into_normal_mode(pac1934_t *me)
+base_status_t pac1934_into_sleep_mode(pac1934_t *me)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_pac1934_read_reg(me, PAC1934_REG_PAC_CTRL, &tmp, 1));
-  tmp &= 0xDF; 
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_PAC_CTRL, tmp)); 
-  CHECK_STATUS(m_pac1934_refresh_v(me));
+  CHECK_STATUS(regmap_field_write(&me->map, &PAC1934_SLEEP, 1));
+  CHECK_STATUS(m_pac1934_refresh(me, false, m_pac1934_settle_ms(me)));
 
   return BS_OK;
 }
 
-/* Private function definitions ---------------------------------------- */
-/**
- * @brief         PAC1934 read register
- *
- * @param[in]     me      Pointer to handle of PAC1934 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
- *
- * @attention     None
- *
- * @return
- * - BS_OK
- * - BS_ERROR
- */
-static base_status_t m_pac1934_read_reg(pac1934_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
+base_status_t pac1934_into_normal_mode(pac1934_t *me)
 {
-  CHECK(0 == me->i2c_read(me->device_address, reg, p_data, len), BS_ERROR);
+  CHECK_STATUS(regmap_field_write(&me->map, &PAC1934_SLEEP, 0));
+  CHECK_STATUS(m_pac1934_refresh(me, false, m_pac1934_settle_ms(me)));
 
   return BS_OK;
 }
 
+/* Private function definitions ---------------------------------------- */
 /**
- * @brief         PAC1934 write register
+ * @brief         PAC1934 issue a refresh
  *
- * @param[in]     me      Pointer to handle of PAC1934 module.
- * @param[in]     reg     Register
- * @param[in]     data    Data
+ * @param[in]     me          Pointer to handle of PAC1934 module.
+ * @param[in]     reset_acc   true: REFRESH, false: REFRESH_V
+ * @param[in]     wait_ms     Time from the refresh to readable results
  *
- * @attention     None
+ * @attention     Leaves the refresh unstamped, pac1934_refresh_start() stamps it
  *
  * @return
  * - BS_OK
  * - BS_ERROR
  */
-static base_status_t m_pac1934_write_reg(pac1934_t *me, uint8_t reg, uint8_t data)
+static base_status_t m_pac1934_refresh(pac1934_t *me, bool reset_acc, uint32_t wait_ms)
 {
-  CHECK(0 == me->i2c_write(me->device_address, reg, &data, 1), BS_ERROR);
+  uint8_t data = 0;
+
+  if (reset_acc)
+    CHECK(0 == me->i2c_write_data(me->device_address, &data, 1), BS_ERROR);
+  else
+    CHECK_STATUS(regmap_write_byte(&me->map, PAC1934_REG_REFRESH_V, 0x00));
+
+  me->refresh_pending = true;
+  me->refresh_stamped = false;
+  me->refresh_wait_ms = wait_ms;
 
   return BS_OK;
 }
 
 /**
- * @brief         PAC1934 refesh
+ * @brief         PAC1934 time for new control values to reach the results
  *
  * @param[in]     me      Pointer to handle of PAC1934 module.
  *
- * @attention     None
+ * @attention     One conversion period at the configured sample rate
  *
- * @return
- * - BS_OK
- * - BS_ERROR
+ * @return        Time in millisecond
  */
-static base_status_t m_pac1934_refresh(pac1934_t *me)
+static uint32_t m_pac1934_settle_ms(pac1934_t *me)
 {
-  uint8_t data = 0;
-
-  CHECK(0 == me->i2c_write_data(me->device_address, &data, 1), BS_ERROR);
-  me->delay_ms(100);
+  uint16_t rate_hz = m_pac1934_rate_hz[me->config.sample_rate & 0x03];
 
-  return BS_OK;
+  return (1000 + rate_hz - 1) / rate_hz + PAC1934_REFRESH_WAIT_MS;
 }
 
 /**
- * @brief         PAC1934 refesh V
+ * @brief         PAC1934 list the enabled channels
  *
- * @param[in]     me      Pointer to handle of PAC1934 module.
+ * @param[in]     me        Pointer to handle of PAC1934 module.
+ * @param[out]    channel   Pointer to PAC1934_CHANNEL_CNT channels, in channel order
  *
- * @attention     None
+ * @attention     Block reads of the result registers skip the disabled channels
  *
- * @return
- * - BS_OK
- * - BS_ERROR
+ * @return        Number of enabled channels
  */
-static base_status_t m_pac1934_refresh_v(pac1934_t *me)
+static uint8_t m_pac1934_enabled_channels(pac1934_t *me, uint8_t *channel)
 {
-  CHECK_STATUS(m_pac1934_write_reg(me, PAC1934_REG_REFRESH_V, 0x00));
-  me->delay_ms(100);
+  uint8_t cnt = 0;
 
-  return BS_OK;
+  for (uint8_t ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+  {
+    if (!(me->config.channel_dis & (1 << ch)))
+      channel[cnt++] = ch;
+  }
+
+  return cnt;
 }
 
 /* End of file -------------------------------------------------------- */
\ No newline at end of file
@@ -20,6 +20,7 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
  #include "bsp.h"
+ #include "regmap.h"
 
 /* Public defines ----------------------------------------------------- */
 #define PAC1934_I2C_ADDR                       (0x11 << 1) // I2C bus need 8 bits address
@@ -46,21 +47,45 @@ typedef enum
   ,PAC1934_CHANNEL_2
   ,PAC1934_CHANNEL_3
   ,PAC1934_CHANNEL_4
+  ,PAC1934_CHANNEL_CNT
 }
 pac1934_channel_t;
 
+/**
+ * @brief PAC1934 energy accumulated by the chip between two energy reads
+ */
+typedef struct
+{
+  uint32_t acc_count;                         // Power samples accumulated
+  int64_t energy_uj[PAC1934_CHANNEL_CNT];     // Energy in microjoule, negative when the current flows back
+}
+pac1934_energy_t;
+
 /**
  * @brief PAC1934 data
  */
 typedef struct
 {
-  double volt;
-  double current;
-  double power;
-  double energy;
+  uint32_t volt_mv;
+  uint32_t current_ma;
+  uint32_t power_mw;
+  pac1934_energy_t energy;
 }
 pac1934_data_t;
 
+/**
+ * @brief PAC1934 snapshot of all enabled channels
+ */
+typedef struct
+{
+  uint64_t timestamp_us;                      // Time of the read, given by the caller
+  uint8_t channel_mask;                       // Bit n set when channel n + 1 is in the snapshot
+  uint16_t volt_mv[PAC1934_CHANNEL_CNT];
+  uint16_t current_ma[PAC1934_CHANNEL_CNT];
+  uint32_t power_mw[PAC1934_CHANNEL_CNT];
+}
+pac1934_snapshot_t;
+
 /**
  * @brief PAC1934 config
  */
@@ -68,6 +93,8 @@ typedef struct
 {
   pac1934_sample_rate_t sample_rate;
   bool sleep_mode_bit;
+  uint8_t channel_dis;      // Bit n disables channel n + 1
+  bool alert_cc;            // ALERT pin pulses low at the end of each conversion
 }
 pac1934_config_t;
 
@@ -80,6 +107,12 @@ typedef struct
 
   pac1934_data_t data;     // PAC1934 data
   pac1934_config_t config; // PAC1934 config
+  regmap_t map;            // Register map, set up by init
+
+  bool refresh_pending;    // Refresh issued, results not readable yet
+  bool refresh_stamped;    // refresh_ms valid, a config change leaves it to the first poll
+  uint32_t refresh_ms;     // Time the refresh was issued
+  uint32_t refresh_wait_ms;// Time from the refresh to readable results
 
   // Read n-bytes from device's internal address <reg_addr> via I2C bus
   int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
@@ -122,6 +155,37 @@ base_status_t pac1934_init(pac1934_t *me);
  */
 base_status_t pac1934_config(pac1934_t *me);
 
+/**
+ * @brief         PAC1934 start a refresh
+ *
+ * @param[in]     me          Pointer to handle of PAC1934 module.
+ * @param[in]     reset_acc   true: REFRESH, latch and clear the accumulators
+ *                            false: REFRESH_V, accumulators keep running
+ * @param[in]     now_ms      Current time in millisecond
+ *
+ * @attention     Does not wait, poll pac1934_refresh_ready() before reading the results
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR     Bus error or previous refresh not complete
+ */
+base_status_t pac1934_refresh_start(pac1934_t *me, bool reset_acc, uint32_t now_ms);
+
+/**
+ * @brief         PAC1934 check the last refresh is complete
+ *
+ * @param[in]     me          Pointer to handle of PAC1934 module.
+ * @param[in]     now_ms      Current time in millisecond
+ *
+ * @attention     No bus access. After pac1934_config() or a mode change the wait
+ *                includes one conversion period and starts at the first poll.
+ *
+ * @return
+ * - true       Results readable, a new refresh may start
+ * - false      Refresh in progress
+ */
+bool pac1934_refresh_ready(pac1934_t *me, uint32_t now_ms);
+
 /**
  * @brief         PAC1934 measure voltage
  *
@@ -164,6 +228,37 @@ base_status_t pac1934_current_measurement(pac1934_t *me, pac1934_channel_t chann
  */
 base_status_t pac1934_power_measurement(pac1934_t *me, pac1934_channel_t channel);
 
+/**
+ * @brief         PAC1934 read voltage, current and power of all enabled channels
+ *
+ * @param[in]     me            Pointer to handle of PAC1934 module.
+ * @param[in]     timestamp_us  Time of the read
+ * @param[out]    snap          Pointer to snapshot
+ *
+ * @attention     One block read of VBUS1 to VPOWER4, the chip skips the disabled
+ *                channels. Values are the ones latched by the last refresh.
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t pac1934_snapshot(pac1934_t *me, uint64_t timestamp_us, pac1934_snapshot_t *snap);
+
+/**
+ * @brief         PAC1934 measure energy
+ *
+ * @param[in]     me      Pointer to handle of PAC1934 module.
+ *
+ * @attention     Reads the accumulators latched by the last refresh with reset_acc, every
+ *                channel gets the energy between the last two of them. Refresh at low
+ *                rate, the 24 bits sample counter lasts 24 days at 8 Hz.
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t pac1934_energy_measurement(pac1934_t *me);
+
 /**
  * @brief         PAC1934 into sleep mode
  *
@@ -12,6 +12,7 @@
 
 /* Includes ----------------------------------------------------------- */
 #include "pcf85063.h"
+#include "fixconv.h"
 
 /* Private defines ---------------------------------------------------- */
 #define PCF85063_REG_CONTROL_1        (0X00)
@@ -38,12 +39,17 @@
 /* Public variables --------------------------------------------------- */
 /* Private variables -------------------------------------------------- */
 static const char *TAG = "PCF85063";
-/* Private function prototypes ---------------------------------------- */
-static uint8_t m_pcf85063_bin_to_bcd(uint8_t val);
-static uint8_t m_pcf85063_bcd_to_bin(uint8_t val);
-static base_status_t m_pcf85063_write_reg(pcf85063_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
-static base_status_t m_pcf85063_read_reg(pcf85063_t *me, uint8_t reg, uint8_t *p_data, uint32_t len);
 
+// PCF85063 register map
+static const regmap_field_t PCF85063_STOP   = REGMAP_FIELD(PCF85063_REG_CONTROL_1, 5, 5);
+static const regmap_group_t PCF85063_TIME   = REGMAP_GROUP(PCF85063_REG_SECONDS, PCF85063_REG_YEARS);
+
+static const reg_shadow_def_t m_pcf85063_shadow_def[] =
+{
+  { PCF85063_REG_CONTROL_1, 0xFF }
+};
+
+/* Private function prototypes ---------------------------------------- */
 /* Function definitions ----------------------------------------------- */
 base_status_t pcf85063_init(pcf85063_t *me)
 {
@@ -52,9 +58,12 @@ base_status_t pcf85063_init(pcf85063_t *me)
   if ((me == NULL) || (me->i2c_read == NULL) || (me->i2c_write == NULL))
     return BS_ERROR;
 
-  CHECK_STATUS(m_pcf85063_read_reg(me, PCF85063_REG_DAYS, &days, 1)); // Read data at time days register
+  CHECK_STATUS(regmap_init(&me->map, TAG, me->device_address, me->i2c_read, me->i2c_write,
+                           m_pcf85063_shadow_def, sizeof(m_pcf85063_shadow_def) / sizeof(m_pcf85063_shadow_def[0])));
 
-  days = m_pcf85063_bcd_to_bin(days & 0x3F);
+  CHECK_STATUS(regmap_read(&me->map, PCF85063_REG_DAYS, &days, 1)); // Read data at time days register
+
+  days = fixconv_bcd_to_bin(days & 0x3F);
 
   if ((days < 1) || (days > 31))  // Check days value
     return BS_ERROR;
@@ -64,26 +73,14 @@ base_status_t pcf85063_init(pcf85063_t *me)
 
 base_status_t pcf85063_stop_clock(pcf85063_t *me)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_pcf85063_read_reg(me, PCF85063_REG_CONTROL_1, &tmp, 1));
-
-  tmp |= 0x20;
-
-  CHECK_STATUS(m_pcf85063_write_reg(me, PCF85063_REG_CONTROL_1, &tmp, 1));
+  CHECK_STATUS(regmap_field_write(&me->map, &PCF85063_STOP, 1));
 
   return BS_OK;
 }
 
 base_status_t pcf85063_start_clock(pcf85063_t *me)
 {
-  uint8_t tmp;
-
-  CHECK_STATUS(m_pcf85063_read_reg(me, PCF85063_REG_CONTROL_1, &tmp, 1));
-
-  tmp &= ~0x20;
-
-  CHECK_STATUS(m_pcf85063_write_reg(me, PCF85063_REG_CONTROL_1, &tmp, 1));
+  CHECK_STATUS(regmap_field_write(&me->map, &PCF85063_STOP, 0));
 
   return BS_OK;
 }
@@ -100,15 +97,15 @@ base_status_t pcf85063_set_time(pcf85063_t *me, uint64_t epoch_time)
 
   CHECK_STATUS(pcf85063_stop_clock(me)); // Stop RTC
 
-  tmp[0] = m_pcf85063_bin_to_bcd(htime->tm_sec) & 0x7F;
-  tmp[1] = m_pcf85063_bin_to_bcd(htime->tm_min);
-  tmp[2] = m_pcf85063_bin_to_bcd(htime->tm_hour);
-  tmp[3] = m_pcf85063_bin_to_bcd(htime->tm_mday);
+  tmp[0] = fixconv_bin_to_bcd(htime->tm_sec) & 0x7F;
+  tmp[1] = fixconv_bin_to_bcd(htime->tm_min);
+  tmp[2] = fixconv_bin_to_bcd(htime->tm_hour);
+  tmp[3] = fixconv_bin_to_bcd(htime->tm_mday);
   tmp[4] =                      (htime->tm_wday & 0x07);
-  tmp[5] = m_pcf85063_bin_to_bcd(htime->tm_mon + 1);
-  tmp[6] = m_pcf85063_bin_to_bcd(htime->tm_year - 100);
+  tmp[5] = fixconv_bin_to_bcd(htime->tm_mon + 1);
+  tmp[6] = fixconv_bin_to_bcd(htime->tm_year - 100);
 
-  CHECK_STATUS(m_pcf85063_write_reg(me, PCF85063_REG_SECONDS, tmp, sizeof(tmp)));
+  CHECK_STATUS(regmap_group_write(&me->map, &PCF85063_TIME, tmp));
 
   CHECK_STATUS(pcf85063_start_clock(me)); // Start RTC
 
@@ -120,15 +117,16 @@ base_status_t pcf85063_get_time(pcf85063_t *me, uint64_t *epoch_time)
   uint8_t tmp[7];
   struct tm htime;
   
-  CHECK_STATUS(m_pcf85063_read_reg(me, PCF85063_REG_SECONDS, tmp, sizeof(tmp)));
+  CHECK_STATUS(regmap_group_read(&me->map, &PCF85063_TIME, tmp));
 
-  htime.tm_sec  = m_pcf85063_bcd_to_bin(tmp[0] & 0x7F);
-  htime.tm_min  = m_pcf85063_bcd_to_bin(tmp[1] & 0x7F);
-  htime.tm_hour = m_pcf85063_bcd_to_bin(tmp[2] & 0x3F);        // RTC hr 0-23
-  htime.tm_mday = m_pcf85063_bcd_to_bin(tmp[3] & 0x3F);
+  htime.tm_sec  = fixconv_bcd_to_bin(tmp[0] & 0x7F);
+  htime.tm_min  = fixconv_bcd_to_bin(tmp[1] & 0x7F);
+  htime.tm_hour = fixconv_bcd_to_bin(tmp[2] & 0x3F);        // RTC hr 0-23
+  htime.tm_mday = fixconv_bcd_to_bin(tmp[3] & 0x3F);
   htime.tm_wday =                      (tmp[4] & 0x07);
-  htime.tm_mon  = m_pcf85063_bcd_to_bin(tmp[5] & 0x1F) - 1;    // RTC mn 1-12
-  htime.tm_year = m_pcf85063_bcd_to_bin(tmp[6] & 0xFF) + 100;  // Adjust for 1900 base of rtc_time
+  htime.tm_mon  = fixconv_bcd_to_bin(tmp[5] & 0x1F) - 1;    // RTC mn 1-12
+  htime.tm_year = fixconv_bcd_to_bin(tmp[6] & 0xFF) + 100;  // Adjust for 1900 base of rtc_time
+  htime.tm_isdst = -1;                                      // Let mktime() work out DST
 
   *epoch_time = (uint64_t)(mktime(&htime));
 
@@ -136,74 +134,4 @@ base_status_t pcf85063_get_time(pcf85063_t *me, uint64_t *epoch_time)
 }
 
 /* Private function definitions ---------------------------------------- */
-/**
- * @brief         Binary to BCD converter
- *
- * @param[in]     val     Binary value
- *
- * @attention     None
- * 
- * @return        BCD value
- */
-static uint8_t m_pcf85063_bin_to_bcd(uint8_t val)
-{
-  return (((val / 10) << 4) + (val % 10));
-}
-
-/**
- * @brief         BCD to Binary converter
- *
- * @param[in]     val     BCD value
- *
- * @attention     None
- * 
- * @return        Binary value
- */
-static uint8_t m_pcf85063_bcd_to_bin(uint8_t val)
-{
-  return ((val & 0x0F) + (val >> 4) * 10);
-}
-
-/**
- * @brief         PCF85063 write register
- *
- * @param[in]     me      Pointer to handle of DRV10975 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
- *
- * @attention     None
- *
- * @return
- * - BS_OK
- * - BS_ERROR
- */
-static base_status_t m_pcf85063_write_reg(pcf85063_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
-{
-  CHECK(0 == me->i2c_write(me->device_address, reg, p_data, len), BS_ERROR);
-
-  return BS_OK;
-}
-
-/**
- * @brief         PCF85063 read register
- *
- * @param[in]     me      Pointer to handle of DRV10975 module.
- * @param[in]     reg     Register
- * @param[in]     p_data  Pointer to handle of data
- * @param[in]     len     Data length
- *
- * @attention     None
- *
- * @return
- * - BS_OK
- * - BS_ERROR
- */
-static base_status_t m_pcf85063_read_reg(pcf85063_t *me, uint8_t reg, uint8_t *p_data, uint32_t len)
-{
-  CHECK(0 == me->i2c_read(me->device_address, reg, p_data, len), BS_ERROR);
-
-  return BS_OK;
-}
-
 /* End of file -------------------------------------------------------- */
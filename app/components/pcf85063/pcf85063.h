@@ -20,6 +20,7 @@ extern "C" {
 
 /* Includes ----------------------------------------------------------- */
 #include "bsp.h"
+#include "regmap.h"
 #include <time.h>
 
 /* Private defines ---------------------------------------------------- */
@@ -35,6 +36,7 @@ extern "C" {
 typedef struct
 {
   uint8_t device_address; // I2C device address
+  regmap_t map;           // Register map, set up by init
 
   // Read n-bytes from device's internal address <reg_addr> via I2C bus
   int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
@@ -0,0 +1,151 @@
+/**
+ * @file       pm_guard.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Power rail guard, over current and brownout limits with an event log
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <stddef.h>
+#include <string.h>
+#include "pm_guard.h"
+
+/* Private defines ---------------------------------------------------- */
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+/* Private function prototypes ---------------------------------------- */
+static void m_pm_guard_log(pm_guard_t *me, pm_guard_event_type_t type, uint8_t channel,
+                           uint16_t value, uint64_t timestamp_us);
+
+/* Function definitions ----------------------------------------------- */
+void pm_guard_init(pm_guard_t *me, const pm_guard_limit_t *limit)
+{
+  memset(me, 0, sizeof(*me));
+
+  if (limit != NULL)
+    memcpy(me->limit, limit, sizeof(me->limit));
+}
+
+void pm_guard_set_limit(pm_guard_t *me, uint8_t channel, const pm_guard_limit_t *limit)
+{
+  if (channel < PM_GUARD_CHANNEL_CNT)
+    me->limit[channel] = *limit;
+}
+
+uint8_t pm_guard_update(pm_guard_t *me, const uint16_t *volt_mv, const uint16_t *current_ma,
+                        uint8_t channel_mask, uint64_t timestamp_us)
+{
+  const pm_guard_limit_t *lim;
+  uint32_t clear;
+  uint8_t bit;
+
+  for (uint8_t ch = 0; ch < PM_GUARD_CHANNEL_CNT; ch++)
+  {
+    bit = 1 << ch;
+    lim = &me->limit[ch];
+
+    if (!(channel_mask & bit))
+      continue;
+
+    // Over current, clears under the limit less the margin
+    if (lim->over_current_ma == 0)
+    {
+      me->over_current &= ~bit;
+    }
+    else if (!(me->over_current & bit))
+    {
+      if (current_ma[ch] >= lim->over_current_ma)
+      {
+        me->over_current |= bit;
+        m_pm_guard_log(me, PM_GUARD_EVENT_OVER_CURRENT, ch, current_ma[ch], timestamp_us);
+      }
+    }
+    else
+    {
+      clear = (uint32_t)lim->over_current_ma * (1000 - PM_GUARD_CLEAR_PERMILLE) / 1000;
+      if (current_ma[ch] < clear)
+      {
+        me->over_current &= ~bit;
+        m_pm_guard_log(me, PM_GUARD_EVENT_OVER_CURRENT_CLEAR, ch, current_ma[ch], timestamp_us);
+      }
+    }
+
+    // Brownout, clears over the limit plus the margin
+    if (lim->brownout_mv == 0)
+    {
+      me->brownout &= ~bit;
+    }
+    else if (!(me->brownout & bit))
+    {
+      if (volt_mv[ch] <= lim->brownout_mv)
+      {
+        me->brownout |= bit;
+        m_pm_guard_log(me, PM_GUARD_EVENT_BROWNOUT, ch, volt_mv[ch], timestamp_us);
+      }
+    }
+    else
+    {
+      clear = (uint32_t)lim->brownout_mv * (1000 + PM_GUARD_CLEAR_PERMILLE) / 1000;
+      if (volt_mv[ch] > clear)
+      {
+        me->brownout &= ~bit;
+        m_pm_guard_log(me, PM_GUARD_EVENT_BROWNOUT_CLEAR, ch, volt_mv[ch], timestamp_us);
+      }
+    }
+  }
+
+  return me->over_current | me->brownout;
+}
+
+uint32_t pm_guard_read_log(pm_guard_t *me, pm_guard_event_t *events, uint32_t max)
+{
+  uint32_t cnt   = (me->log_cnt < PM_GUARD_LOG_SIZE) ? me->log_cnt : PM_GUARD_LOG_SIZE;
+  uint32_t first = me->log_cnt - cnt;
+
+  if (cnt > max)
+  {
+    first += cnt - max;
+    cnt    = max;
+  }
+
+  for (uint32_t i = 0; i < cnt; i++)
+    events[i] = me->log[(first + i) % PM_GUARD_LOG_SIZE];
+
+  return cnt;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Power rail guard add an event to the log
+ *
+ * @param[in]     me            Pointer to handle of guard
+ * @param[in]     type          Event type
+ * @param[in]     channel       Channel
+ * @param[in]     value         Current or voltage
+ * @param[in]     timestamp_us  Conversion time
+ *
+ * @attention     Overwrites the oldest event when full
+ *
+ * @return        None
+ */
+static void m_pm_guard_log(pm_guard_t *me, pm_guard_event_type_t type, uint8_t channel,
+                           uint16_t value, uint64_t timestamp_us)
+{
+  pm_guard_event_t *ev = &me->log[me->log_cnt % PM_GUARD_LOG_SIZE];
+
+  ev->timestamp_us = timestamp_us;
+  ev->type         = (uint8_t)type;
+  ev->channel      = channel;
+  ev->value        = value;
+
+  me->log_cnt++;
+}
+
+/* End of file -------------------------------------------------------- */
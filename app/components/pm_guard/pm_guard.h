@@ -0,0 +1,149 @@
+/**
+ * @file       pm_guard.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Power rail guard, over current and brownout limits with an event log
+ * @note       Integer only and platform agnostic. The PAC1934 has no threshold
+ *             registers, so the limits are checked in software on every conversion.
+ *             A rail trips when a limit is crossed and clears once it is back past
+ *             the limit by PM_GUARD_CLEAR_PERMILLE. Trips and clears go to the log.
+ * @example    pm_guard_init(&guard, limits);
+ *
+ *             for each conversion:
+ *               if (pm_guard_update(&guard, volt_mv, current_ma, mask, timestamp_us) != 0)
+ *                 derate the motor
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __PM_GUARD_H
+#define __PM_GUARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define PM_GUARD_CHANNEL_CNT            (4)
+#define PM_GUARD_LOG_SIZE               (16)    // Events kept, oldest overwritten
+#define PM_GUARD_CLEAR_PERMILLE         (50)    // Margin past the limit before a trip clears
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Power rail guard event type
+ */
+typedef enum
+{
+    PM_GUARD_EVENT_OVER_CURRENT = 0
+  , PM_GUARD_EVENT_OVER_CURRENT_CLEAR
+  , PM_GUARD_EVENT_BROWNOUT
+  , PM_GUARD_EVENT_BROWNOUT_CLEAR
+}
+pm_guard_event_type_t;
+
+/**
+ * @brief Power rail guard limits of one channel
+ */
+typedef struct
+{
+  uint16_t over_current_ma; // Trip at or above, 0 disables
+  uint16_t brownout_mv;     // Trip at or below, 0 disables
+}
+pm_guard_limit_t;
+
+/**
+ * @brief Power rail guard event
+ */
+typedef struct
+{
+  uint64_t timestamp_us;    // Conversion time
+  uint8_t type;             // pm_guard_event_type_t
+  uint8_t channel;
+  uint16_t value;           // Current in mA or voltage in mV that caused the event
+}
+pm_guard_event_t;
+
+/**
+ * @brief Power rail guard
+ */
+typedef struct
+{
+  pm_guard_limit_t limit[PM_GUARD_CHANNEL_CNT];
+  uint8_t over_current;     // Bit n set while channel n is over current
+  uint8_t brownout;         // Bit n set while channel n is in brownout
+
+  pm_guard_event_t log[PM_GUARD_LOG_SIZE];
+  uint32_t log_cnt;         // Events since init, the log holds the last PM_GUARD_LOG_SIZE
+}
+pm_guard_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Power rail guard init
+ *
+ * @param[in]     me        Pointer to handle of guard
+ * @param[in]     limit     Pointer to PM_GUARD_CHANNEL_CNT limits, NULL for none
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void pm_guard_init(pm_guard_t *me, const pm_guard_limit_t *limit);
+
+/**
+ * @brief         Power rail guard set the limits of a channel
+ *
+ * @param[in]     me        Pointer to handle of guard
+ * @param[in]     channel   Channel
+ * @param[in]     limit     Pointer to limits
+ *
+ * @attention     The trip state of the channel is kept until the next update
+ *
+ * @return        None
+ */
+void pm_guard_set_limit(pm_guard_t *me, uint8_t channel, const pm_guard_limit_t *limit);
+
+/**
+ * @brief         Power rail guard check one conversion
+ *
+ * @param[in]     me            Pointer to handle of guard
+ * @param[in]     volt_mv       Pointer to PM_GUARD_CHANNEL_CNT voltages
+ * @param[in]     current_ma    Pointer to PM_GUARD_CHANNEL_CNT currents
+ * @param[in]     channel_mask  Bit n set when channel n was measured
+ * @param[in]     timestamp_us  Conversion time
+ *
+ * @attention     Channels not measured keep their state
+ *
+ * @return        Mask of the channels tripped, over current or brownout
+ */
+uint8_t pm_guard_update(pm_guard_t *me, const uint16_t *volt_mv, const uint16_t *current_ma,
+                        uint8_t channel_mask, uint64_t timestamp_us);
+
+/**
+ * @brief         Power rail guard read the event log
+ *
+ * @param[in]     me        Pointer to handle of guard
+ * @param[out]    events    Pointer to events, oldest first
+ * @param[in]     max       Number of events
+ *
+ * @attention     None
+ *
+ * @return        Number of events read
+ */
+uint32_t pm_guard_read_log(pm_guard_t *me, pm_guard_event_t *events, uint32_t max);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __PM_GUARD_H
+
+/* End of file -------------------------------------------------------- */
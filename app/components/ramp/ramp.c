@@ -0,0 +1,130 @@
+/**
+ * @file       ramp.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Linear ramp in fixed ticks and piecewise linear curve lookup
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "ramp.h"
+
+/* Private defines ---------------------------------------------------- */
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+void ramp_init(ramp_t *me, const ramp_config_t *config, int32_t start)
+{
+  me->config      = *config;
+  me->value       = start;
+  me->target      = start;
+  me->duration_ms = 0;
+  me->elapsed_ms  = 0;
+  me->inc         = 0;
+  me->rem_sign    = 0;
+  me->rem         = 0;
+  me->err         = 0;
+  me->ticks       = 0;
+  me->ticks_left  = 0;
+
+  if (me->config.tick_ms == 0)
+    me->config.tick_ms = 1;
+}
+
+void ramp_retarget(ramp_t *me, int32_t target, uint32_t duration_ms)
+{
+  uint32_t left_ms = (duration_ms > me->elapsed_ms) ? (duration_ms - me->elapsed_ms) : 0;
+  int64_t delta    = (int64_t)target - me->value;
+  int64_t rem;
+
+  if (left_ms < me->config.min_ms)
+    left_ms = me->config.min_ms;
+
+  me->target      = target;
+  me->duration_ms = duration_ms;
+  me->ticks       = left_ms / me->config.tick_ms;
+  if (me->ticks == 0)
+    me->ticks = 1;
+
+  // delta = inc * ticks + rem, the remainder is spread one unit at a time
+  me->inc      = (int32_t)(delta / me->ticks);
+  rem          = delta - (int64_t)me->inc * me->ticks;
+  me->rem_sign = (rem < 0) ? -1 : 1;
+  me->rem      = (uint32_t)((rem < 0) ? -rem : rem);
+  me->err      = 0;
+
+  me->ticks_left = (delta != 0) ? me->ticks : 0;
+}
+
+int32_t ramp_step(ramp_t *me)
+{
+  me->elapsed_ms += me->config.tick_ms;
+
+  if (me->ticks_left == 0)
+    return me->value;
+
+  me->value += me->inc;
+  me->err   += me->rem;
+  if (me->err >= me->ticks)
+  {
+    me->err   -= me->ticks;
+    me->value += me->rem_sign;
+  }
+
+  me->ticks_left--;
+
+  return me->value;
+}
+
+bool ramp_done(const ramp_t *me)
+{
+  return (me->ticks_left == 0);
+}
+
+bool ramp_curve_init(ramp_curve_t *me, const ramp_point_t *point, uint8_t cnt)
+{
+  if ((cnt < 2) || (cnt > RAMP_CURVE_MAX_POINTS))
+    return false;
+
+  for (uint8_t i = 0; i < cnt; i++)
+  {
+    if ((i > 0) && (point[i].x <= point[i - 1].x))
+      return false;
+
+    me->point[i] = point[i];
+  }
+
+  for (uint8_t i = 0; i + 1 < cnt; i++)
+  {
+    me->slope_q16[i] = (((int64_t)point[i + 1].y - point[i].y) << 16) / ((int64_t)point[i + 1].x - point[i].x);
+  }
+  me->slope_q16[cnt - 1] = 0;
+  me->cnt                = cnt;
+
+  return true;
+}
+
+int32_t ramp_curve_eval(const ramp_curve_t *me, int32_t x)
+{
+  uint8_t i;
+
+  if (x <= me->point[0].x)
+    return me->point[0].y;
+  if (x >= me->point[me->cnt - 1].x)
+    return me->point[me->cnt - 1].y;
+
+  for (i = 0; x >= me->point[i + 1].x; i++)
+    ;
+
+  return me->point[i].y + (int32_t)((((int64_t)x - me->point[i].x) * me->slope_q16[i] + 0x8000) >> 16);
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
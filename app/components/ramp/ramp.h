@@ -0,0 +1,176 @@
+/**
+ * @file       ramp.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Linear ramp in fixed ticks and piecewise linear curve lookup
+ * @note       Integer only and platform agnostic. A ramp is planned once into a
+ *             per tick increment and a remainder spread over the ticks, so a step
+ *             is two additions and the ramp ends exactly on the target. A new
+ *             target or duration replans from the current value over the time
+ *             left, never shorter than config.min_ms, so a change mid-ramp does not
+ *             jump. The curve keeps the segment slopes computed at init.
+ * @example    ramp_init(&ramp, &cfg, start_q16);
+ *             ramp_retarget(&ramp, target_q16, duration_ms);
+ *
+ *             every tick:
+ *               speed = ramp_curve_eval(&curve, ramp_step(&ramp));
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __RAMP_H
+#define __RAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define RAMP_CURVE_MAX_POINTS           (8)
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Ramp config
+ */
+typedef struct
+{
+  uint32_t tick_ms;         // Time between two steps
+  uint32_t min_ms;          // Shortest replan, limits the slew of a late change
+}
+ramp_config_t;
+
+/**
+ * @brief Ramp
+ */
+typedef struct
+{
+  ramp_config_t config;
+  int32_t value;            // Current value
+  int32_t target;
+  uint32_t duration_ms;     // Ramp time from ramp_init()
+  uint32_t elapsed_ms;      // Time stepped since ramp_init()
+
+  // Plan from the last retarget
+  int32_t inc;              // Added every tick
+  int32_t rem_sign;         // One more unit in this direction, rem times over the plan
+  uint32_t rem;
+  uint32_t err;
+  uint32_t ticks;           // Ticks of the plan
+  uint32_t ticks_left;
+}
+ramp_t;
+
+/**
+ * @brief Curve point
+ */
+typedef struct
+{
+  int32_t x;                // Increasing along the table
+  int32_t y;
+}
+ramp_point_t;
+
+/**
+ * @brief Piecewise linear curve
+ */
+typedef struct
+{
+  ramp_point_t point[RAMP_CURVE_MAX_POINTS];
+  int64_t slope_q16[RAMP_CURVE_MAX_POINTS]; // Segment from point i to i + 1
+  uint8_t cnt;
+}
+ramp_curve_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Ramp init
+ *
+ * @param[in]     me        Pointer to handle of ramp
+ * @param[in]     config    Pointer to config
+ * @param[in]     start     Start value, also the target until ramp_retarget()
+ *
+ * @attention     Restarts the elapsed time
+ *
+ * @return        None
+ */
+void ramp_init(ramp_t *me, const ramp_config_t *config, int32_t start);
+
+/**
+ * @brief         Ramp set the target and the ramp time
+ *
+ * @param[in]     me            Pointer to handle of ramp
+ * @param[in]     target        Value at the end of the ramp
+ * @param[in]     duration_ms   Ramp time counted from ramp_init()
+ *
+ * @attention     Plans from the current value over the time left
+ *
+ * @return        None
+ */
+void ramp_retarget(ramp_t *me, int32_t target, uint32_t duration_ms);
+
+/**
+ * @brief         Ramp step one tick
+ *
+ * @param[in]     me        Pointer to handle of ramp
+ *
+ * @attention     None
+ *
+ * @return        Value after the step
+ */
+int32_t ramp_step(ramp_t *me);
+
+/**
+ * @brief         Ramp check the end
+ *
+ * @param[in]     me        Pointer to handle of ramp
+ *
+ * @attention     None
+ *
+ * @return
+ * - true       Value on the target
+ * - false      Ramping
+ */
+bool ramp_done(const ramp_t *me);
+
+/**
+ * @brief         Curve init
+ *
+ * @param[in]     me        Pointer to handle of curve
+ * @param[in]     point     Pointer to points, x increasing
+ * @param[in]     cnt       Number of points, 2 to RAMP_CURVE_MAX_POINTS
+ *
+ * @attention     None
+ *
+ * @return
+ * - true       Curve ready
+ * - false      Bad table
+ */
+bool ramp_curve_init(ramp_curve_t *me, const ramp_point_t *point, uint8_t cnt);
+
+/**
+ * @brief         Curve evaluate
+ *
+ * @param[in]     me        Pointer to handle of curve
+ * @param[in]     x         Input
+ *
+ * @attention     Clamped to the end points outside the table
+ *
+ * @return        Output
+ */
+int32_t ramp_curve_eval(const ramp_curve_t *me, int32_t x);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __RAMP_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,138 @@
+/**
+ * @file       reg_shadow.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-23
+ * @author     Hiep Le
+ * @brief      Shadow cache of device configuration registers
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <stddef.h>
+#include "esp_log.h"
+#include "reg_shadow.h"
+
+/* Private defines ---------------------------------------------------- */
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "reg_shadow";
+
+/* Private function prototypes ---------------------------------------- */
+static reg_shadow_entry_t *m_reg_shadow_find(reg_shadow_t *me, uint8_t reg);
+
+/* Function definitions ----------------------------------------------- */
+void reg_shadow_init(reg_shadow_t *me, const char *name, const reg_shadow_def_t *def, uint8_t count)
+{
+  if (count > REG_SHADOW_MAX_REGS)
+    count = REG_SHADOW_MAX_REGS;
+
+  me->name            = name;
+  me->count           = count;
+  me->validate_period = REG_SHADOW_VALIDATE_PERIOD;
+  me->validate_cnt    = 0;
+  me->hits            = 0;
+  me->misses          = 0;
+  me->mismatches      = 0;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    me->entry[i].reg   = def[i].reg;
+    me->entry[i].mask  = def[i].mask;
+    me->entry[i].value = 0;
+    me->entry[i].valid = false;
+  }
+}
+
+bool reg_shadow_get(reg_shadow_t *me, uint8_t reg, uint8_t *value)
+{
+  reg_shadow_entry_t *entry = m_reg_shadow_find(me, reg);
+
+  if (entry == NULL)
+    return false;
+
+  if (!entry->valid)
+  {
+    me->misses++;
+    return false;
+  }
+
+  // Validation mode, let the caller read the chip back
+  if ((me->validate_period != 0) && (++me->validate_cnt >= me->validate_period))
+  {
+    me->validate_cnt = 0;
+    me->misses++;
+    return false;
+  }
+
+  *value = entry->value;
+  me->hits++;
+
+  return true;
+}
+
+bool reg_shadow_load(reg_shadow_t *me, uint8_t reg, uint8_t value)
+{
+  reg_shadow_entry_t *entry = m_reg_shadow_find(me, reg);
+  bool match = true;
+
+  if (entry == NULL)
+    return true;
+
+  if (entry->valid && (((entry->value ^ value) & entry->mask) != 0))
+  {
+    me->mismatches++;
+    match = false;
+    ESP_LOGW(TAG, "%s reg 0x%02x shadow 0x%02x chip 0x%02x", me->name, reg, entry->value, value);
+  }
+
+  entry->value = value;
+  entry->valid = true;
+
+  return match;
+}
+
+void reg_shadow_store(reg_shadow_t *me, uint8_t reg, uint8_t value)
+{
+  reg_shadow_entry_t *entry = m_reg_shadow_find(me, reg);
+
+  if (entry == NULL)
+    return;
+
+  entry->value = value;
+  entry->valid = true;
+}
+
+void reg_shadow_invalidate(reg_shadow_t *me)
+{
+  for (uint8_t i = 0; i < me->count; i++)
+    me->entry[i].valid = false;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Register shadow find the entry of a register
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ * @param[in]     reg       Register address
+ *
+ * @attention     None
+ *
+ * @return        Pointer to entry, NULL if the register is not shadowed
+ */
+static reg_shadow_entry_t *m_reg_shadow_find(reg_shadow_t *me, uint8_t reg)
+{
+  for (uint8_t i = 0; i < me->count; i++)
+  {
+    if (me->entry[i].reg == reg)
+      return &me->entry[i];
+  }
+
+  return NULL;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,153 @@
+/**
+ * @file       reg_shadow.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-23
+ * @author     Hiep Le
+ * @brief      Shadow cache of device configuration registers
+ * @note       Keeps the last value written to the registers the firmware owns, so a
+ *             read-modify-write becomes a single write. In validation mode every
+ *             n-th lookup misses on purpose, the driver reads the chip back and the
+ *             shadow counts and logs any difference.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __REG_SHADOW_H
+#define __REG_SHADOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define REG_SHADOW_MAX_REGS             (8)     // Registers per device
+
+// Lookups between two chip read backs, 0 disables the validation mode
+#ifndef REG_SHADOW_VALIDATE_PERIOD
+#define REG_SHADOW_VALIDATE_PERIOD      (0)
+#endif
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Register shadow definition
+ */
+typedef struct
+{
+  uint8_t reg;              // Register address
+  uint8_t mask;             // Bits owned by the firmware, status bits excluded
+}
+reg_shadow_def_t;
+
+/**
+ * @brief Register shadow entry
+ */
+typedef struct
+{
+  uint8_t reg;
+  uint8_t mask;
+  uint8_t value;
+  bool valid;
+}
+reg_shadow_entry_t;
+
+/**
+ * @brief Register shadow of one device
+ */
+typedef struct
+{
+  const char *name;         // Device name used in logs
+  reg_shadow_entry_t entry[REG_SHADOW_MAX_REGS];
+  uint8_t count;
+  uint16_t validate_period;
+  uint16_t validate_cnt;
+
+  uint32_t hits;            // Lookups served from the shadow
+  uint32_t misses;          // Shadowed register lookups read from the chip, validation included
+  uint32_t mismatches;      // Chip values found different from the shadow
+}
+reg_shadow_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Register shadow init
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ * @param[in]     name      Device name used in logs
+ * @param[in]     def       Pointer to register definitions
+ * @param[in]     count     Number of registers, up to REG_SHADOW_MAX_REGS
+ *
+ * @attention     All entries start invalid, the first lookup reads the chip
+ *
+ * @return        None
+ */
+void reg_shadow_init(reg_shadow_t *me, const char *name, const reg_shadow_def_t *def, uint8_t count);
+
+/**
+ * @brief         Register shadow lookup
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ * @param[in]     reg       Register address
+ * @param[out]    value     Pointer to value
+ *
+ * @attention     On a miss the caller reads the chip and passes the value to reg_shadow_load()
+ *
+ * @return
+ * - true       Value served from the shadow
+ * - false      Register not shadowed, not valid yet or due for validation
+ */
+bool reg_shadow_get(reg_shadow_t *me, uint8_t reg, uint8_t *value);
+
+/**
+ * @brief         Register shadow load a value read from the chip
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ * @param[in]     reg       Register address
+ * @param[in]     value     Value read from the chip
+ *
+ * @attention     The chip value always replaces the shadow
+ *
+ * @return
+ * - true       Shadow was invalid or matched the chip on the owned bits
+ * - false      Mismatch
+ */
+bool reg_shadow_load(reg_shadow_t *me, uint8_t reg, uint8_t value);
+
+/**
+ * @brief         Register shadow store a value written to the chip
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ * @param[in]     reg       Register address
+ * @param[in]     value     Value written to the chip
+ *
+ * @attention     Registers not in the shadow are ignored
+ *
+ * @return        None
+ */
+void reg_shadow_store(reg_shadow_t *me, uint8_t reg, uint8_t value);
+
+/**
+ * @brief         Register shadow invalidate all entries
+ *
+ * @param[in]     me        Pointer to handle of register shadow
+ *
+ * @attention     Call after a chip reset or a failed write
+ *
+ * @return        None
+ */
+void reg_shadow_invalidate(reg_shadow_t *me);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __REG_SHADOW_H
+
+/* End of file -------------------------------------------------------- */
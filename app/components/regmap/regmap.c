@@ -0,0 +1,137 @@
+/**
+ * @file       regmap.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-24
+ * @author     Hiep Le
+ * @brief      Register map shared by the I2C device drivers
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "regmap.h"
+
+/* Private defines ---------------------------------------------------- */
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "regmap";
+
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+base_status_t regmap_init(regmap_t *me, const char *name, uint8_t slave_addr,
+                          int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len),
+                          int (*i2c_write) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len),
+                          const reg_shadow_def_t *shadow_def, uint8_t shadow_cnt)
+{
+  if ((me == NULL) || (i2c_read == NULL) || (i2c_write == NULL))
+    return BS_ERROR_PARAMS;
+
+  me->name       = name;
+  me->slave_addr = slave_addr;
+  me->i2c_read   = i2c_read;
+  me->i2c_write  = i2c_write;
+
+  reg_shadow_init(&me->shadow, name, shadow_def, (shadow_def == NULL) ? 0 : shadow_cnt);
+
+  return BS_OK;
+}
+
+base_status_t regmap_read(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len)
+{
+  if ((len == 1) && reg_shadow_get(&me->shadow, reg, data))
+    return BS_OK;
+
+  if (0 != me->i2c_read(me->slave_addr, reg, data, len))
+  {
+    ESP_LOGD(TAG, "%s read 0x%02x len %u failed", me->name, reg, len);
+    return BS_ERROR;
+  }
+
+  ESP_LOGV(TAG, "%s read 0x%02x len %u", me->name, reg, len);
+
+  for (uint32_t i = 0; (i < len) && (reg + i <= UINT8_MAX); i++)
+    reg_shadow_load(&me->shadow, reg + i, data[i]);
+
+  return BS_OK;
+}
+
+base_status_t regmap_read_fifo(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len)
+{
+  if (0 != me->i2c_read(me->slave_addr, reg, data, len))
+  {
+    ESP_LOGD(TAG, "%s read fifo 0x%02x len %u failed", me->name, reg, len);
+    return BS_ERROR;
+  }
+
+  ESP_LOGV(TAG, "%s read fifo 0x%02x len %u", me->name, reg, len);
+
+  return BS_OK;
+}
+
+base_status_t regmap_write(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len)
+{
+  if (0 != me->i2c_write(me->slave_addr, reg, data, len))
+  {
+    ESP_LOGD(TAG, "%s write 0x%02x len %u failed", me->name, reg, len);
+    reg_shadow_invalidate(&me->shadow); // Chip state unknown
+    return BS_ERROR;
+  }
+
+  ESP_LOGV(TAG, "%s write 0x%02x len %u", me->name, reg, len);
+
+  for (uint32_t i = 0; (i < len) && (reg + i <= UINT8_MAX); i++)
+    reg_shadow_store(&me->shadow, reg + i, data[i]);
+
+  return BS_OK;
+}
+
+base_status_t regmap_write_byte(regmap_t *me, uint8_t reg, uint8_t value)
+{
+  return regmap_write(me, reg, &value, 1);
+}
+
+base_status_t regmap_update(regmap_t *me, uint8_t reg, uint8_t mask, uint8_t value)
+{
+  uint8_t tmp;
+
+  CHECK_STATUS(regmap_read(me, reg, &tmp, 1));
+
+  tmp = (tmp & ~mask) | (value & mask);
+
+  CHECK_STATUS(regmap_write(me, reg, &tmp, 1));
+
+  return BS_OK;
+}
+
+base_status_t regmap_field_read(regmap_t *me, const regmap_field_t *field, uint8_t *value)
+{
+  uint8_t tmp;
+
+  CHECK_STATUS(regmap_read(me, field->reg, &tmp, 1));
+
+  *value = REGMAP_FIELD_GET(field, tmp);
+
+  return BS_OK;
+}
+
+base_status_t regmap_field_write(regmap_t *me, const regmap_field_t *field, uint8_t value)
+{
+  return regmap_update(me, field->reg, field->mask, REGMAP_FIELD_PREP(field, value));
+}
+
+base_status_t regmap_group_read(regmap_t *me, const regmap_group_t *group, uint8_t *buf)
+{
+  return regmap_read(me, group->reg, buf, group->len);
+}
+
+base_status_t regmap_group_write(regmap_t *me, const regmap_group_t *group, uint8_t *buf)
+{
+  return regmap_write(me, group->reg, buf, group->len);
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,284 @@
+/**
+ * @file       regmap.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-24
+ * @author     Hiep Le
+ * @brief      Register map shared by the I2C device drivers
+ * @note       Drivers describe their registers with compile time tables:
+ *             - REGMAP_FIELD() for a bit field inside a register
+ *             - REGMAP_GROUP() for a contiguous range read or written in one burst
+ *             All register access goes through this module, which keeps the
+ *             register shadow of user-owned registers and is the single place
+ *             for access logging.
+ * @example    static const regmap_field_t FS_SEL = REGMAP_FIELD(0x1B, 4, 3);
+ *             static const regmap_group_t GYRO   = REGMAP_GROUP(0x43, 0x48);
+ *
+ *             regmap_group_read(&me->map, &GYRO, buf);
+ *             regmap_field_write(&me->map, &FS_SEL, 2);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __REGMAP_H
+#define __REGMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "bsp.h"
+#include "reg_shadow.h"
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Register map bit field
+ */
+typedef struct
+{
+  uint8_t reg;
+  uint8_t mask;             // Mask in register position
+  uint8_t shift;
+}
+regmap_field_t;
+
+/**
+ * @brief Register map group of contiguous registers
+ */
+typedef struct
+{
+  uint8_t reg;              // First register
+  uint8_t len;              // Number of registers
+}
+regmap_group_t;
+
+/**
+ * @brief Register map of one device
+ */
+typedef struct
+{
+  const char *name;         // Device name used in logs
+  uint8_t slave_addr;       // I2C device address
+
+  // Read n-bytes from device's internal address <reg_addr> via I2C bus
+  int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+  // Write n-bytes from device's internal address <reg_addr> via I2C bus
+  int (*i2c_write) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+
+  reg_shadow_t shadow;      // Shadow of the user-owned registers
+}
+regmap_t;
+
+/* Public macros ------------------------------------------------------ */
+/**
+ * @brief Bit field of register <reg>, bits <msb> down to <lsb>
+ */
+#define REGMAP_FIELD(_reg, _msb, _lsb)                                             \
+  {                                                                                \
+    .reg   = (_reg),                                                               \
+    .mask  = (uint8_t)(((1u << ((_msb) - (_lsb) + 1)) - 1) << (_lsb)),             \
+    .shift = (_lsb)                                                                \
+  }
+
+/**
+ * @brief Group of registers <first> to <last>
+ */
+#define REGMAP_GROUP(_first, _last)                                                \
+  {                                                                                \
+    .reg = (_first),                                                               \
+    .len = (_last) - (_first) + 1                                                  \
+  }
+
+/**
+ * @brief Extract a field from a register value
+ */
+#define REGMAP_FIELD_GET(_field, _val)    (((_val) & (_field)->mask) >> (_field)->shift)
+
+/**
+ * @brief Place a field value in register position
+ */
+#define REGMAP_FIELD_PREP(_field, _val)   ((uint8_t)((_val) << (_field)->shift) & (_field)->mask)
+
+/**
+ * @brief Extract a field from the buffer of a group read, no bus transaction
+ */
+#define REGMAP_GROUP_FIELD(_group, _buf, _field)  REGMAP_FIELD_GET(_field, (_buf)[(_field)->reg - (_group)->reg])
+
+/**
+ * @brief Big endian 16 bits value at register <reg> of a group buffer
+ */
+#define REGMAP_GROUP_BE16(_group, _buf, _reg)     (((uint16_t)(_buf)[(_reg) - (_group)->reg] << 8) | (_buf)[(_reg) - (_group)->reg + 1])
+
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Register map init
+ *
+ * @param[in]     me            Pointer to handle of register map
+ * @param[in]     name          Device name used in logs
+ * @param[in]     slave_addr    I2C device address
+ * @param[in]     i2c_read      I2C read function
+ * @param[in]     i2c_write     I2C write function
+ * @param[in]     shadow_def    Pointer to shadowed register definitions, NULL for none
+ * @param[in]     shadow_cnt    Number of shadowed registers
+ *
+ * @attention     None
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR_PARAMS
+ */
+base_status_t regmap_init(regmap_t *me, const char *name, uint8_t slave_addr,
+                          int (*i2c_read) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len),
+                          int (*i2c_write) (uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len),
+                          const reg_shadow_def_t *shadow_def, uint8_t shadow_cnt);
+
+/**
+ * @brief         Register map read registers
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     reg       First register
+ * @param[out]    data      Pointer to data
+ * @param[in]     len       Number of registers
+ *
+ * @attention     A single shadowed register is served from the shadow
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_read(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         Register map read a FIFO data port
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     reg       FIFO data register, the device does not increment it
+ * @param[out]    data      Pointer to data
+ * @param[in]     len       Number of bytes
+ *
+ * @attention     Bypasses the shadow
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_read_fifo(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         Register map write registers
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     reg       First register
+ * @param[in]     data      Pointer to data
+ * @param[in]     len       Number of registers
+ *
+ * @attention     A failed write invalidates the shadow
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_write(regmap_t *me, uint8_t reg, uint8_t *data, uint32_t len);
+
+/**
+ * @brief         Register map write one register
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     reg       Register
+ * @param[in]     value     Value
+ *
+ * @attention     None
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_write_byte(regmap_t *me, uint8_t reg, uint8_t value);
+
+/**
+ * @brief         Register map update bits of one register
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     reg       Register
+ * @param[in]     mask      Bits to update
+ * @param[in]     value     New value of the bits, in register position
+ *
+ * @attention     Single write when the register is shadowed
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_update(regmap_t *me, uint8_t reg, uint8_t mask, uint8_t value);
+
+/**
+ * @brief         Register map read a field
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     field     Pointer to field
+ * @param[out]    value     Pointer to field value
+ *
+ * @attention     None
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_field_read(regmap_t *me, const regmap_field_t *field, uint8_t *value);
+
+/**
+ * @brief         Register map write a field
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     field     Pointer to field
+ * @param[in]     value     Field value
+ *
+ * @attention     Other bits of the register are kept
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_field_write(regmap_t *me, const regmap_field_t *field, uint8_t value);
+
+/**
+ * @brief         Register map read a group in one burst
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     group     Pointer to group
+ * @param[out]    buf       Pointer to buffer, group->len bytes
+ *
+ * @attention     Use REGMAP_GROUP_FIELD() to extract fields from the buffer
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_group_read(regmap_t *me, const regmap_group_t *group, uint8_t *buf);
+
+/**
+ * @brief         Register map write a group in one burst
+ *
+ * @param[in]     me        Pointer to handle of register map
+ * @param[in]     group     Pointer to group
+ * @param[in]     buf       Pointer to buffer, group->len bytes
+ *
+ * @attention     None
+ *
+ * @return
+ * - BS_OK
+ * - BS_ERROR
+ */
+base_status_t regmap_group_write(regmap_t *me, const regmap_group_t *group, uint8_t *buf);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __REGMAP_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,164 @@
+/**
+ * @file       sleep_pos.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-26
+ * @author     Hiep Le
+ * @brief      Sleep position classification from gyroscope rates
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "sleep_pos.h"
+
+/* Private defines ---------------------------------------------------- */
+#define SLEEP_POS_SECTOR_MDEG           (45000)   // Half width of a position sector
+#define SLEEP_POS_FULL_TURN_MDEG        (360000)
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+#define ABS(_x)                         (((_x) < 0) ? -(_x) : (_x))
+
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+// Roll of the sector centres, in sleep_pos_position_t order
+static const int32_t m_sleep_pos_centre_mdeg[SLEEP_POS_CNT] = { 0, 90000, -90000, 180000 };
+
+/* Private function prototypes ---------------------------------------- */
+static int32_t m_sleep_pos_wrap(int32_t mdeg);
+static int32_t m_sleep_pos_rate_q8(const sleep_pos_t *me, int32_t mdps);
+static void m_sleep_pos_classify(sleep_pos_t *me);
+
+/* Function definitions ----------------------------------------------- */
+void sleep_pos_init(sleep_pos_t *me, const sleep_pos_config_t *config)
+{
+  memset(me, 0, sizeof(*me));
+  me->config = *config;
+
+  sleep_pos_night_reset(me);
+}
+
+void sleep_pos_night_reset(sleep_pos_t *me)
+{
+  me->position    = SLEEP_POS_SUPINE;
+  me->roll_mdeg   = 0;
+  me->roll_acc    = 0;
+  me->time_acc_us = 0;
+  me->changes     = 0;
+
+  memset(me->time_s, 0, sizeof(me->time_s));
+}
+
+sleep_pos_position_t sleep_pos_update(sleep_pos_t *me, const int16_t rate[3], uint64_t timestamp_us)
+{
+  int32_t roll;
+  int32_t mdeg;
+  int64_t div;
+  uint32_t dt_us;
+
+  if ((me->last_us == 0) || (timestamp_us <= me->last_us) || (timestamp_us - me->last_us > SLEEP_POS_MAX_GAP_US))
+  {
+    me->last_us = timestamp_us;   // First sample or gap, nothing to integrate over
+    return me->position;
+  }
+
+  dt_us       = (uint32_t)(timestamp_us - me->last_us);
+  me->last_us = timestamp_us;
+
+  // Roll integration, counts x microsecond to millidegree keeping the remainder
+  roll = me->config.roll_inverted ? -(int32_t)rate[me->config.roll_axis] : (int32_t)rate[me->config.roll_axis];
+  if (ABS(roll << 8) > m_sleep_pos_rate_q8(me, SLEEP_POS_DEAD_BAND_MDPS))
+  {
+    div           = (int64_t)me->config.sensitivity_x10 * 100;
+    me->roll_acc += (int64_t)roll * dt_us;
+    mdeg          = (int32_t)(me->roll_acc / div);
+    me->roll_acc -= (int64_t)mdeg * div;
+    me->roll_mdeg = m_sleep_pos_wrap(me->roll_mdeg + mdeg);
+  }
+
+  m_sleep_pos_classify(me);
+
+  // Histogram in whole seconds
+  me->time_acc_us += dt_us;
+  while (me->time_acc_us >= 1000000)
+  {
+    me->time_acc_us -= 1000000;
+    me->time_s[me->position]++;
+  }
+
+  return me->position;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Sleep position wrap an angle to -180 to 180 degree
+ *
+ * @param[in]     mdeg      Angle in millidegree, within one turn of the range
+ *
+ * @attention     None
+ *
+ * @return        Wrapped angle
+ */
+static int32_t m_sleep_pos_wrap(int32_t mdeg)
+{
+  if (mdeg > SLEEP_POS_FULL_TURN_MDEG / 2)
+    mdeg -= SLEEP_POS_FULL_TURN_MDEG;
+  else if (mdeg < -SLEEP_POS_FULL_TURN_MDEG / 2)
+    mdeg += SLEEP_POS_FULL_TURN_MDEG;
+
+  return mdeg;
+}
+
+/**
+ * @brief         Sleep position convert a rate to gyro counts
+ *
+ * @param[in]     me        Pointer to handle of sleep position engine
+ * @param[in]     mdps      Rate in millidegree per second
+ *
+ * @attention     None
+ *
+ * @return        Rate in counts, Q8
+ */
+static int32_t m_sleep_pos_rate_q8(const sleep_pos_t *me, int32_t mdps)
+{
+  return (int32_t)(((int64_t)mdps * me->config.sensitivity_x10 * 256) / 10000);
+}
+
+/**
+ * @brief         Sleep position classify the roll with hysteresis
+ *
+ * @param[in]     me        Pointer to handle of sleep position engine
+ *
+ * @attention     The position changes once the roll is past the current sector edge
+ *                by SLEEP_POS_HYSTERESIS_MDEG, it moves to the nearest sector
+ *
+ * @return        None
+ */
+static void m_sleep_pos_classify(sleep_pos_t *me)
+{
+  int32_t dist;
+  int32_t best_dist = SLEEP_POS_FULL_TURN_MDEG;
+  int best = me->position;
+
+  dist = ABS(m_sleep_pos_wrap(me->roll_mdeg - m_sleep_pos_centre_mdeg[me->position]));
+  if (dist <= SLEEP_POS_SECTOR_MDEG + SLEEP_POS_HYSTERESIS_MDEG)
+    return;
+
+  for (int i = 0; i < SLEEP_POS_CNT; i++)
+  {
+    dist = ABS(m_sleep_pos_wrap(me->roll_mdeg - m_sleep_pos_centre_mdeg[i]));
+    if (dist < best_dist)
+    {
+      best_dist = dist;
+      best      = i;
+    }
+  }
+
+  me->position = (sleep_pos_position_t)best;
+  me->changes++;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,127 @@
+/**
+ * @file       sleep_pos.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-26
+ * @author     Hiep Le
+ * @brief      Sleep position classification from gyroscope rates
+ * @note       Integer only and platform agnostic, so recorded traces replay on a host.
+ *             The roll angle around the body axis is integrated from the gyro rates
+ *             and referenced to supine at the start of the night. The rates come
+ *             bias corrected from bsp_gyro, drift is held back by a dead band on
+ *             them. The position changes only when the roll goes past the sector
+ *             edge by the hysteresis.
+ * @example    sleep_pos_init(&pos, &cfg);
+ *
+ *             for each gyro sample:
+ *               sleep_pos_update(&pos, rate, timestamp_us);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SLEEP_POS_H
+#define __SLEEP_POS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define SLEEP_POS_DEAD_BAND_MDPS        (500)     // Roll rate under this is not integrated
+#define SLEEP_POS_HYSTERESIS_MDEG       (10000)   // Roll past the sector edge before a change
+#define SLEEP_POS_MAX_GAP_US            (1000000) // Longer sample gaps are not integrated
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Sleep position
+ */
+typedef enum
+{
+    SLEEP_POS_SUPINE = 0
+  , SLEEP_POS_LEFT
+  , SLEEP_POS_RIGHT
+  , SLEEP_POS_PRONE
+  , SLEEP_POS_CNT
+}
+sleep_pos_position_t;
+
+/**
+ * @brief Sleep position config
+ */
+typedef struct
+{
+  uint8_t roll_axis;        // Gyro axis along the body, 0 = X, 1 = Y, 2 = Z
+  bool roll_inverted;       // Positive roll turns the patient right instead of left
+  uint16_t sensitivity_x10; // Gyro counts per degree per second, times 10
+}
+sleep_pos_config_t;
+
+/**
+ * @brief Sleep position engine
+ */
+typedef struct
+{
+  sleep_pos_config_t config;
+  sleep_pos_position_t position;
+
+  uint64_t last_us;         // Timestamp of the previous sample, 0 before the first one
+
+  int32_t roll_mdeg;        // Roll from supine in millidegree, -180000 to 180000
+  int64_t roll_acc;         // Integration remainder, counts x microsecond
+
+  uint32_t time_s[SLEEP_POS_CNT]; // Per night histogram of the time in each position
+  uint32_t time_acc_us;     // Histogram remainder
+  uint32_t changes;         // Position changes this night
+}
+sleep_pos_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Sleep position init
+ *
+ * @param[in]     me        Pointer to handle of sleep position engine
+ * @param[in]     config    Pointer to config
+ *
+ * @attention     Starts a night
+ *
+ * @return        None
+ */
+void sleep_pos_init(sleep_pos_t *me, const sleep_pos_config_t *config);
+
+/**
+ * @brief         Sleep position start a new night
+ *
+ * @param[in]     me        Pointer to handle of sleep position engine
+ *
+ * @attention     Clears the histogram and takes the current posture as supine
+ *
+ * @return        None
+ */
+void sleep_pos_night_reset(sleep_pos_t *me);
+
+/**
+ * @brief         Sleep position feed one gyro sample
+ *
+ * @param[in]     me            Pointer to handle of sleep position engine
+ * @param[in]     rate          Bias corrected gyro X, Y, Z in counts
+ * @param[in]     timestamp_us  Sample time in microsecond
+ *
+ * @attention     Samples must come in time order
+ *
+ * @return        Current position
+ */
+sleep_pos_position_t sleep_pos_update(sleep_pos_t *me, const int16_t rate[3], uint64_t timestamp_us);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __SLEEP_POS_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,95 @@
+/**
+ * @file       speed_pi.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      PI speed controller with feed forward and anti-windup
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "speed_pi.h"
+
+/* Private defines ---------------------------------------------------- */
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+void speed_pi_init(speed_pi_t *me, const speed_pi_config_t *config)
+{
+  me->config  = *config;
+  me->out_max = config->out_max;
+
+  speed_pi_reset(me);
+}
+
+void speed_pi_reset(speed_pi_t *me)
+{
+  me->integ_q16 = 0;
+  me->out       = 0;
+  me->saturated = false;
+}
+
+void speed_pi_set_limit(speed_pi_t *me, int32_t out_max)
+{
+  int64_t max_q16;
+
+  if (out_max > me->config.out_max)
+    out_max = me->config.out_max;
+  if (out_max < 0)
+    out_max = 0;
+
+  me->out_max = out_max;
+
+  max_q16 = (int64_t)out_max << 16;
+  if (me->integ_q16 > max_q16)
+    me->integ_q16 = max_q16;
+}
+
+int32_t speed_pi_update(speed_pi_t *me, int32_t setpoint, int32_t measured)
+{
+  int64_t err   = (int64_t)setpoint - measured;
+  int64_t base  = (int64_t)me->config.kff_q16 * setpoint + (int64_t)me->config.kp_q16 * err;
+  int64_t integ = me->integ_q16 + (int64_t)me->config.ki_q16 * err * me->config.period_us / 1000000;
+  int64_t max_q16 = (int64_t)me->out_max << 16;
+  int64_t out   = base + integ;
+
+  me->saturated = false;
+
+  // Conditional integration, keep the integral when it would push further into the limit
+  if (out > max_q16)
+  {
+    me->saturated = true;
+    if (err > 0)
+      integ = me->integ_q16;
+    out = max_q16;
+  }
+  else if (out < 0)
+  {
+    me->saturated = true;
+    if (err < 0)
+      integ = me->integ_q16;
+    out = 0;
+  }
+
+  if (integ > max_q16)
+    integ = max_q16;
+  else if (integ < -max_q16)
+    integ = -max_q16;
+
+  me->integ_q16 = integ;
+  me->out       = (int32_t)((out + 0x8000) >> 16);
+
+  if (me->out > me->out_max)
+    me->out = me->out_max;
+
+  return me->out;
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
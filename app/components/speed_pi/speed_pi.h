@@ -0,0 +1,117 @@
+/**
+ * @file       speed_pi.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      PI speed controller with feed forward and anti-windup
+ * @note       Integer only and platform agnostic, so the loop is tuned on the host
+ *             against the rotor model of the virtual I2C bus. Gains are Q16 with the
+ *             speed in millihertz and the output in motor command steps. The
+ *             integrator stops while the output is saturated in the direction of
+ *             the error and is bounded by the output range.
+ * @example    speed_pi_init(&pi, &cfg);
+ *
+ *             every period:
+ *               cmd = speed_pi_update(&pi, setpoint_mhz, measured_mhz);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SPEED_PI_H
+#define __SPEED_PI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief PI speed controller config
+ */
+typedef struct
+{
+  int32_t kp_q16;           // Output per millihertz of error
+  int32_t ki_q16;           // Output per millihertz of error per second
+  int32_t kff_q16;          // Output per millihertz of setpoint
+  uint32_t period_us;       // Update period
+  int32_t out_max;          // Output range is 0 to out_max
+}
+speed_pi_config_t;
+
+/**
+ * @brief PI speed controller
+ */
+typedef struct
+{
+  speed_pi_config_t config;
+  int32_t out_max;          // Output limit in effect, config.out_max or lower when derated
+  int64_t integ_q16;        // Integral term
+  int32_t out;              // Last output
+  bool saturated;           // Last output clamped
+}
+speed_pi_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         PI speed controller init
+ *
+ * @param[in]     me        Pointer to handle of controller
+ * @param[in]     config    Pointer to config
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void speed_pi_init(speed_pi_t *me, const speed_pi_config_t *config);
+
+/**
+ * @brief         PI speed controller clear the integral term and the output
+ *
+ * @param[in]     me        Pointer to handle of controller
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void speed_pi_reset(speed_pi_t *me);
+
+/**
+ * @brief         PI speed controller limit the output
+ *
+ * @param[in]     me        Pointer to handle of controller
+ * @param[in]     out_max   Highest output, capped to config.out_max
+ *
+ * @attention     The integrator follows the new limit, no windup while derated
+ *
+ * @return        None
+ */
+void speed_pi_set_limit(speed_pi_t *me, int32_t out_max);
+
+/**
+ * @brief         PI speed controller update
+ *
+ * @param[in]     me            Pointer to handle of controller
+ * @param[in]     setpoint      Speed setpoint in millihertz
+ * @param[in]     measured      Measured speed in millihertz
+ *
+ * @attention     Call once per config.period_us
+ *
+ * @return        Output, 0 to the output limit
+ */
+int32_t speed_pi_update(speed_pi_t *me, int32_t setpoint, int32_t measured);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __SPEED_PI_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,113 @@
+/**
+ * @file       tacho.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Tachometer from the edge times of a speed feedback output
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "tacho.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TACHO_MHZ_US                    (1000000000UL)  // Millihertz times microseconds
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+void tacho_init(tacho_t *me, const tacho_config_t *config)
+{
+  me->config    = *config;
+  me->edge_us   = 0;
+  me->period_us = 0;
+
+  if (me->config.pulses_per_cycle == 0)
+    me->config.pulses_per_cycle = 1;
+
+  tacho_reset_stats(me);
+}
+
+void tacho_capture(tacho_t *me, uint64_t timestamp_us)
+{
+  uint64_t elapsed;
+  uint32_t period;
+  uint32_t jitter;
+
+  if (me->edge_us == 0)
+  {
+    me->edge_us = timestamp_us;
+    me->stats.edges++;
+    return;
+  }
+
+  elapsed = timestamp_us - me->edge_us;
+  if (elapsed < me->config.min_period_us)
+  {
+    me->stats.glitches++;
+    return;
+  }
+
+  me->edge_us = timestamp_us;
+  me->stats.edges++;
+
+  // First edge after a stop only restarts the measurement
+  if (elapsed >= me->config.timeout_us)
+  {
+    me->period_us = 0;
+    return;
+  }
+
+  period = (uint32_t)elapsed;
+
+  if (me->period_us != 0)
+  {
+    jitter = (period > me->period_us) ? (period - me->period_us) : (me->period_us - period);
+    if (jitter > me->stats.max_jitter_us)
+      me->stats.max_jitter_us = jitter;
+  }
+  if (period < me->stats.min_period_us)
+    me->stats.min_period_us = period;
+  if (period > me->stats.max_period_us)
+    me->stats.max_period_us = period;
+
+  me->period_us = period;
+}
+
+bool tacho_read(tacho_t *me, uint64_t now_us, uint32_t *velocity_mhz)
+{
+  uint64_t elapsed;
+  uint64_t period;
+
+  if (me->period_us == 0)
+    return false;
+
+  elapsed = now_us - me->edge_us;
+  if (elapsed >= me->config.timeout_us)
+    return false;
+
+  // No edge for longer than the last period, the rotor is at most this fast
+  period = (elapsed > me->period_us) ? elapsed : me->period_us;
+
+  *velocity_mhz = (uint32_t)(TACHO_MHZ_US / (period * me->config.pulses_per_cycle));
+
+  return true;
+}
+
+void tacho_reset_stats(tacho_t *me)
+{
+  me->stats.edges         = 0;
+  me->stats.glitches      = 0;
+  me->stats.min_period_us = UINT32_MAX;
+  me->stats.max_period_us = 0;
+  me->stats.max_jitter_us = 0;
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
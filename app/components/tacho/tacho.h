@@ -0,0 +1,134 @@
+/**
+ * @file       tacho.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Tachometer from the edge times of a speed feedback output
+ * @note       Integer only and platform agnostic. Each rising edge closes one period,
+ *             the speed is the inverse of the last period. Periods shorter than
+ *             min_period_us are glitches and dropped. Past the last period without an
+ *             edge, the elapsed time bounds the speed, so a slowing rotor reads lower
+ *             at once. Without an edge for timeout_us the reading is not valid.
+ * @example    tacho_init(&tacho, &cfg);
+ *
+ *             edge interrupt:
+ *               tacho_capture(&tacho, now_us);
+ *
+ *             control loop:
+ *               if (!tacho_read(&tacho, now_us, &velocity_mhz))
+ *                 read the speed elsewhere
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __TACHO_H
+#define __TACHO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Tachometer config
+ */
+typedef struct
+{
+  uint8_t pulses_per_cycle;   // Edges per measured cycle
+  uint32_t min_period_us;     // Shorter periods are glitches
+  uint32_t timeout_us;        // No edge for this long, the reading is not valid
+}
+tacho_config_t;
+
+/**
+ * @brief Tachometer statistics
+ */
+typedef struct
+{
+  uint32_t edges;             // Edges captured, glitches excluded
+  uint32_t glitches;          // Edges dropped for a too short period
+  uint32_t min_period_us;     // UINT32_MAX until two edges
+  uint32_t max_period_us;
+  uint32_t max_jitter_us;     // Period to period difference
+}
+tacho_stats_t;
+
+/**
+ * @brief Tachometer
+ */
+typedef struct
+{
+  tacho_config_t config;
+  uint64_t edge_us;           // Time of the last edge, 0 before the first one
+  uint32_t period_us;         // Last period, 0 until two edges
+  tacho_stats_t stats;
+}
+tacho_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Tachometer init
+ *
+ * @param[in]     me        Pointer to handle of tachometer
+ * @param[in]     config    Pointer to config
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void tacho_init(tacho_t *me, const tacho_config_t *config);
+
+/**
+ * @brief         Tachometer capture an edge
+ *
+ * @param[in]     me            Pointer to handle of tachometer
+ * @param[in]     timestamp_us  Time of the edge
+ *
+ * @attention     Short enough for an interrupt handler, the caller serialises it
+ *                with tacho_read()
+ *
+ * @return        None
+ */
+void tacho_capture(tacho_t *me, uint64_t timestamp_us);
+
+/**
+ * @brief         Tachometer read the speed
+ *
+ * @param[in]     me            Pointer to handle of tachometer
+ * @param[in]     now_us        Current time
+ * @param[out]    velocity_mhz  Pointer to cycle frequency in millihertz
+ *
+ * @attention     None
+ *
+ * @return
+ * - true       Speed measured
+ * - false      Fewer than two edges or none for config.timeout_us
+ */
+bool tacho_read(tacho_t *me, uint64_t now_us, uint32_t *velocity_mhz);
+
+/**
+ * @brief         Tachometer clear the statistics
+ *
+ * @param[in]     me        Pointer to handle of tachometer
+ *
+ * @attention     The speed measurement is kept
+ *
+ * @return        None
+ */
+void tacho_reset_stats(tacho_t *me);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __TACHO_H
+
+/* End of file -------------------------------------------------------- */
@@ -24,6 +24,7 @@
 #include "ble_uds.h"
 #include "ble_bas.h"
 #include "ble_tss.h"
+#include "ble_dgs.h"
 
 /* Private variables -------------------------------------------------- */
 static const char *tag = "BLE CPAP";
@@ -78,6 +79,7 @@ void ble_init(void)
   ble_dss_init();
   ble_uds_init();
   ble_tss_init();
+  ble_dgs_init();
 
   ble_svc_gap_init();
   ble_svc_gatt_init();
@@ -159,6 +161,8 @@ static int ble_gap_event(struct ble_gap_event *event, void *arg)
   case BLE_GAP_EVENT_DISCONNECT:
     MODLOG_DFLT(INFO, "disconnect; reason=%d\n", event->disconnect.reason);
 
+    ble_dgs_on_disconnect(event->disconnect.conn.conn_handle);
+
     ble_advertise(); // Connection terminated; resume advertising
     break;
 
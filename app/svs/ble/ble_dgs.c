@@ -0,0 +1,220 @@
+/**
+ * @file       ble_dgs.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-22
+ * @author     Hiep Le
+ * @brief      Diagnostic service
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <assert.h>
+#include <string.h>
+
+#include "sysinit/sysinit.h"
+#include "syscfg/syscfg.h"
+#include "host/ble_hs.h"
+#include "host/ble_gap.h"
+
+#include "ble_dgs.h"
+#include "bsp_i2c_trace.h"
+
+/* Private defines ---------------------------------------------------- */
+#define DGS_TRACE_RECORDS_PER_READ        (16)
+#define DGS_TRACE_MAX_CONNECTIONS         MYNEWT_VAL(BLE_MAX_CONNECTIONS)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Trace read cursor of one connection
+ */
+typedef struct
+{
+  uint16_t conn_handle;     // BLE_HS_CONN_HANDLE_NONE while the slot is free
+  uint32_t seq;             // Next record wanted, 0 for the oldest one
+}
+ble_dgs_cursor_t;
+
+/* Private variables -------------------------------------------------- */
+// Only touched from the NimBLE host task, so no lock
+static ble_dgs_cursor_t m_ble_dgs_cursor[DGS_TRACE_MAX_CONNECTIONS];
+
+const uint8_t DGS_CHAR_UUID[][16] =
+{
+  { BLE_UUID_DGS_I2C_TRACE_CHARACTERISTIC },
+  { BLE_UUID_DGS_I2C_HIST_CHARACTERISTIC  },
+  { BLE_UUID_DGS_CONTROL_CHARACTERISTIC   }
+};
+
+/* Private function prototypes ---------------------------------------- */
+static int m_ble_dgs_access(uint16_t conn_handle, uint16_t attr_handle,
+                            struct ble_gatt_access_ctxt *ctxt, void *arg);
+static ble_dgs_cursor_t *m_ble_dgs_get_cursor(uint16_t conn_handle);
+
+/* Private service definitions ---------------------------------------- */
+static const struct ble_gatt_svc_def ble_dgs_defs[] =
+{
+  { // Service: Diagnostic Service (DGS)
+    .type = BLE_GATT_SVC_TYPE_PRIMARY,
+    .uuid = BLE_UUID128_DECLARE(BLE_UUID_DGS_SERVICE),
+    .characteristics = (struct ble_gatt_chr_def[])
+    {
+      {
+        .uuid = BLE_UUID128_DECLARE(BLE_UUID_DGS_I2C_TRACE_CHARACTERISTIC),
+        .access_cb = m_ble_dgs_access,
+        .flags = BLE_GATT_CHR_F_READ,
+      },
+      {
+        .uuid = BLE_UUID128_DECLARE(BLE_UUID_DGS_I2C_HIST_CHARACTERISTIC),
+        .access_cb = m_ble_dgs_access,
+        .flags = BLE_GATT_CHR_F_READ,
+      },
+      {
+        .uuid = BLE_UUID128_DECLARE(BLE_UUID_DGS_CONTROL_CHARACTERISTIC),
+        .access_cb = m_ble_dgs_access,
+        .flags = BLE_GATT_CHR_F_WRITE,
+      },
+      {
+        0, // No more characteristics in this service
+      },
+    }
+  },
+  {
+      0, // No more services
+  },
+};
+
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+void ble_dgs_init(void)
+{
+  int rc;
+
+  SYSINIT_ASSERT_ACTIVE(); // Ensure this function only gets called by sysinit
+
+  for (int i = 0; i < DGS_TRACE_MAX_CONNECTIONS; i++)
+    m_ble_dgs_cursor[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+
+  rc = ble_gatts_count_cfg(ble_dgs_defs);
+  SYSINIT_PANIC_ASSERT(rc == 0);
+
+  rc = ble_gatts_add_svcs(ble_dgs_defs);
+  SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+void ble_dgs_on_disconnect(uint16_t conn_handle)
+{
+  for (int i = 0; i < DGS_TRACE_MAX_CONNECTIONS; i++)
+  {
+    if (m_ble_dgs_cursor[i].conn_handle == conn_handle)
+      m_ble_dgs_cursor[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+  }
+}
+
+/* Private function definitions---------------------------------------- */
+static int m_ble_dgs_access(uint16_t conn_handle, uint16_t attr_handle,
+                            struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+  bsp_i2c_trace_rec_t rec[DGS_TRACE_RECORDS_PER_READ];
+  bsp_i2c_trace_hist_t hist[BSP_I2C_TRACE_MAX_DEVICES];
+  ble_dgs_cursor_t *cursor;
+  uint32_t max;
+  uint32_t cnt;
+  uint8_t cmd;
+  int rc;
+
+  if (memcmp(BLE_UUID128(ctxt->chr->uuid)->value, DGS_CHAR_UUID[DGS_I2C_TRACE_CHARACTERISTIC], 16) == 0)
+  {
+    assert(ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR);
+    cursor = m_ble_dgs_get_cursor(conn_handle);
+    if (cursor == NULL)
+      return BLE_ATT_ERR_INSUFFICIENT_RES;
+
+    // Stay below ATT_MTU - 1 so the value fits one Read Response and the
+    // client never follows up with a Read Blob, which would move the cursor again
+    max = (ble_att_mtu(conn_handle) - 2) / sizeof(bsp_i2c_trace_rec_t);
+    if (max > DGS_TRACE_RECORDS_PER_READ)
+      max = DGS_TRACE_RECORDS_PER_READ;
+
+    cnt = bsp_i2c_trace_read(&cursor->seq, rec, max);
+    rc  = os_mbuf_append(ctxt->om, rec, cnt * sizeof(bsp_i2c_trace_rec_t));
+
+    return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  }
+  else if (memcmp(BLE_UUID128(ctxt->chr->uuid)->value, DGS_CHAR_UUID[DGS_I2C_HIST_CHARACTERISTIC], 16) == 0)
+  {
+    assert(ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR);
+    cnt = bsp_i2c_trace_get_hist(hist, BSP_I2C_TRACE_MAX_DEVICES);
+    rc  = os_mbuf_append(ctxt->om, hist, cnt * sizeof(bsp_i2c_trace_hist_t));
+
+    return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
+  }
+  else if (memcmp(BLE_UUID128(ctxt->chr->uuid)->value, DGS_CHAR_UUID[DGS_CONTROL_CHARACTERISTIC], 16) == 0)
+  {
+    assert(ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR);
+    if (OS_MBUF_PKTLEN(ctxt->om) != sizeof(cmd))
+      return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+
+    if (ble_hs_mbuf_to_flat(ctxt->om, &cmd, sizeof(cmd), NULL) != 0)
+      return BLE_ATT_ERR_UNLIKELY;
+
+    cursor = m_ble_dgs_get_cursor(conn_handle);
+    if (cursor == NULL)
+      return BLE_ATT_ERR_INSUFFICIENT_RES;
+
+    switch (cmd)
+    {
+    case DGS_CMD_TRACE_REWIND:
+      cursor->seq = 0;
+      break;
+    case DGS_CMD_TRACE_DUMP:
+      bsp_i2c_trace_dump();
+      break;
+    case DGS_CMD_TRACE_RESET:
+      // Other clients see the sequence restart and resync to the oldest record
+      bsp_i2c_trace_reset();
+      cursor->seq = 0;
+      break;
+    default:
+      return BLE_ATT_ERR_VALUE_NOT_ALLOWED;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief         Get the trace cursor of a connection, claim a free one on first use
+ *
+ * @param[in]     conn_handle   Connection handle
+ *
+ * @attention     A claimed cursor starts at the oldest record
+ *
+ * @return        Pointer to cursor, NULL when all slots are taken
+ */
+static ble_dgs_cursor_t *m_ble_dgs_get_cursor(uint16_t conn_handle)
+{
+  ble_dgs_cursor_t *free_slot = NULL;
+
+  for (int i = 0; i < DGS_TRACE_MAX_CONNECTIONS; i++)
+  {
+    if (m_ble_dgs_cursor[i].conn_handle == conn_handle)
+      return &m_ble_dgs_cursor[i];
+
+    if ((free_slot == NULL) && (m_ble_dgs_cursor[i].conn_handle == BLE_HS_CONN_HANDLE_NONE))
+      free_slot = &m_ble_dgs_cursor[i];
+  }
+
+  if (free_slot != NULL)
+  {
+    free_slot->conn_handle = conn_handle;
+    free_slot->seq         = 0;
+  }
+
+  return free_slot;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,90 @@
+/**
+ * @file       ble_dgs.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-22
+ * @author     Hiep Le
+ * @brief      Diagnostic service
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __BLE_DGS_H
+#define __BLE_DGS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "platform_common.h"
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public defines ----------------------------------------------------- */
+#define DGS_BASE_UUID(uuid) 0x41, 0xEE, 0x68, 0x3A, 0x99, 0x0F, 0x0E, 0x72, 0x85, 0x49, 0x8D, 0xB3, LO_UINT16(uuid), HI_UINT16(uuid), 0x00, 0x00
+
+#define BLE_UUID_DGS_SERVICE                        DGS_BASE_UUID(0x4234)
+#define BLE_UUID_DGS_I2C_TRACE_CHARACTERISTIC       DGS_BASE_UUID(0x4235)
+#define BLE_UUID_DGS_I2C_HIST_CHARACTERISTIC        DGS_BASE_UUID(0x4236)
+#define BLE_UUID_DGS_CONTROL_CHARACTERISTIC         DGS_BASE_UUID(0x4237)
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Diagnostic charateristic enum
+ */
+typedef enum
+{
+   DGS_I2C_TRACE_CHARACTERISTIC
+  ,DGS_I2C_HIST_CHARACTERISTIC
+  ,DGS_CONTROL_CHARACTERISTIC
+}
+ble_dgs_char_t;
+
+/**
+ * @brief Diagnostic control commands, written to the control characteristic
+ */
+typedef enum
+{
+   DGS_CMD_TRACE_REWIND = 0x00  // Next trace read of this connection starts at the oldest record
+  ,DGS_CMD_TRACE_DUMP   = 0x01  // Dump histograms and last records to the console
+  ,DGS_CMD_TRACE_RESET  = 0x02  // Clear records and histograms
+}
+ble_dgs_cmd_t;
+
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         BLE diagnostic service init
+ *
+ * @param[in]     None
+ *
+ * @attention     Each read of the I2C trace characteristic returns the records
+ *                following the previous read of the same connection, as many as
+ *                fit one ATT PDU, an empty value when up to date
+ *
+ * @return        None
+ *
+ */
+void ble_dgs_init(void);
+
+/**
+ * @brief         BLE diagnostic service connection closed
+ *
+ * @param[in]     conn_handle   Connection handle
+ *
+ * @attention     Frees the trace cursor of the connection, call from the GAP event handler
+ *
+ * @return        None
+ *
+ */
+void ble_dgs_on_disconnect(uint16_t conn_handle);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __BLE_DGS_H
+
+/* End of file -------------------------------------------------------- */
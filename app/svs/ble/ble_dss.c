@@ -95,6 +95,16 @@ void ble_dss_init(void)
   SYSINIT_PANIC_ASSERT(rc == 0);
 }
 
+uint8_t *ble_dss_get_pressure(void)
+{
+  return &ble_dss_data.pressure;
+}
+
+uint8_t *ble_dss_get_ramp_time(void)
+{
+  return &ble_dss_data.ramp_time;
+}
+
 /* Private function definitions---------------------------------------- */
 static int m_ble_dss_access(uint16_t conn_handle, uint16_t attr_handle,
                             struct ble_gatt_access_ctxt *ctxt, void *arg)
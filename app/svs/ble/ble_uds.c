@@ -88,6 +88,16 @@ void ble_uds_init(void)
   SYSINIT_PANIC_ASSERT(rc == 0);
 }
 
+uint8_t *ble_uds_get_sleep_position(void)
+{
+  return &ble_uds_data.sleep_position;
+}
+
+void ble_uds_set_sleep_position(uint8_t *value)
+{
+  ble_uds_data.sleep_position = *value;
+}
+
 /* Private function definitions---------------------------------------- */
 static int m_ble_uds_access(uint16_t conn_handle, uint16_t attr_handle,
                             struct ble_gatt_access_ctxt *ctxt, void *arg)
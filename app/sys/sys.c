@@ -14,6 +14,7 @@
 #include "platform_common.h"
 
 #include "bsp_brc.h"
+#include "bsp_brc_ctrl.h"
 #include "bsp_gyro.h"
 #include "bsp_pm.h"
 #include "bsp_rtc.h"
@@ -21,6 +22,10 @@
 #include "bsp.h"
 #include "ble.h"
 #include "sys_damos_ram.h"
+#include "sys_sleep_pos.h"
+#include "sys_energy.h"
+#include "sys_ramp.h"
+#include "esp_timer.h"
 
 /* Private defines ---------------------------------------------------------- */
 /* Private Constants -------------------------------------------------------- */
@@ -31,22 +36,39 @@ uint16_t volt = 0;
 /* Private enumerate/structure ---------------------------------------------- */
 /* Private variables -------------------------------------------------------- */
 /* Public variables --------------------------------------------------------- */
+static int64_t m_sys_boot_us;     // Start of the current boot stage
+
 /* Private function prototypes ---------------------------------------------- */
 void sys_task_create(void);
+static void m_sys_boot_stage(const char *stage);
 
 /* Function definitions ----------------------------------------------------- */
 void sys_boot(void)
 {
+  int64_t boot_us = esp_timer_get_time();
+
+  m_sys_boot_us = boot_us;
+
   bsp_init(); 
+  m_sys_boot_stage("bsp");
 
   bsp_rtc_init();
+  m_sys_boot_stage("rtc");
   bsp_gyro_init();
+  m_sys_boot_stage("gyro");   // Completes in the gyro task, see its ready log
   bsp_pm_init();
+  m_sys_boot_stage("pm");
 
-  // bsp_brc_init();
+  if (BS_OK == bsp_brc_init())
+    bsp_brc_ctrl_init();
+  m_sys_boot_stage("brc");
 
   ble_init();
+  m_sys_boot_stage("ble");
   sys_task_create();
+  m_sys_boot_stage("tasks");
+
+  ESP_LOGI(TAG, "Boot %lld us, %lld us since reset", esp_timer_get_time() - boot_us, esp_timer_get_time());
 
   // bsp_power_startup_indicate();
 
@@ -63,7 +85,27 @@ void sys_run(void)
 void sys_task_create(void) 
 {
   xTaskCreate(&bsp_power_shutdown_device_task, "Shutdown device task", 2048, NULL, 5, NULL );
+  xTaskCreate(&sys_sleep_pos_task, "Sleep position task", 2048, NULL, 4, NULL );
+  xTaskCreate(&sys_energy_task, "Energy task", 3072, NULL, 3, NULL );
+  xTaskCreate(&sys_ramp_task, "Ramp task", 2048, NULL, 4, NULL );
 }
 
 /* Private function --------------------------------------------------------- */
+/**
+ * @brief         Log the time of a boot stage and start the next one
+ *
+ * @param[in]     stage     Stage name
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_sys_boot_stage(const char *stage)
+{
+  int64_t now_us = esp_timer_get_time();
+
+  ESP_LOGI(TAG, "Boot stage %s %lld us", stage, now_us - m_sys_boot_us);
+  m_sys_boot_us = now_us;
+}
+
 /* End of file -------------------------------------------------------- */
\ No newline at end of file
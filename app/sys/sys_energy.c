@@ -0,0 +1,179 @@
+/**
+ * @file       sys_energy.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      System energy ledger, PAC1934 accumulators to per session energy in SPIFFS
+ * @note       The session starts at power on. The chip integrates the power between
+ *             two reads, so one read a minute loses nothing. The ledger is a file of
+ *             SYS_ENERGY_LEDGER_SESSIONS records, session n lives in slot n modulo the
+ *             size, and the current session is rewritten in place.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "sys_energy.h"
+#include "bsp_pm.h"
+#include "bsp_rtc.h"
+#include "esp_timer.h"
+
+/* Private defines ---------------------------------------------------- */
+#define SYS_ENERGY_PERIOD_MS            (60000)
+#define SYS_ENERGY_SAVE_PERIODS         (5)     // Reads between two ledger writes
+#define SYS_ENERGY_LEDGER_PATH          "/spiffs/energy.bin"
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "sys_energy";
+
+static sys_energy_record_t m_energy_session;
+static portMUX_TYPE m_energy_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Private function prototypes ---------------------------------------- */
+static void m_sys_energy_session_start(void);
+static void m_sys_energy_save(const sys_energy_record_t *record);
+
+/* Function definitions ----------------------------------------------- */
+void sys_energy_task(void *param)
+{
+  pac1934_energy_t energy;
+  sys_energy_record_t record;
+  int64_t start_us;
+  uint32_t save_cnt = 0;
+
+  m_sys_energy_session_start();
+  start_us = esp_timer_get_time();
+
+  while (1)
+  {
+    vTaskDelay(pdMS_TO_TICKS(SYS_ENERGY_PERIOD_MS));
+
+    if (BS_OK != bsp_pm_energy_measurement(&energy))
+    {
+      ESP_LOGW(TAG, "Energy read failed");
+      continue;
+    }
+
+    portENTER_CRITICAL(&m_energy_mux);
+    for (uint8_t ch = 0; ch < PAC1934_CHANNEL_CNT; ch++)
+      m_energy_session.energy_uj[ch] += energy.energy_uj[ch];
+    m_energy_session.duration_s = (uint32_t)((esp_timer_get_time() - start_us) / 1000000);
+    record = m_energy_session;
+    portEXIT_CRITICAL(&m_energy_mux);
+
+    if (++save_cnt >= SYS_ENERGY_SAVE_PERIODS)
+    {
+      save_cnt = 0;
+      m_sys_energy_save(&record);
+
+      ESP_LOGI(TAG, "Session %u %u s, %lld/%lld/%lld/%lld mJ", record.session, record.duration_s,
+               record.energy_uj[0] / 1000, record.energy_uj[1] / 1000,
+               record.energy_uj[2] / 1000, record.energy_uj[3] / 1000);
+    }
+  }
+}
+
+void sys_energy_get_session(sys_energy_record_t *record)
+{
+  portENTER_CRITICAL(&m_energy_mux);
+  *record = m_energy_session;
+  portEXIT_CRITICAL(&m_energy_mux);
+}
+
+uint32_t sys_energy_read_ledger(sys_energy_record_t *records, uint32_t max)
+{
+  sys_energy_record_t record;
+  uint32_t count = 0;
+  FILE *f;
+
+  f = fopen(SYS_ENERGY_LEDGER_PATH, "rb");
+  if (f == NULL)
+    return 0;
+
+  while ((count < max) && (fread(&record, sizeof(record), 1, f) == 1))
+  {
+    if (record.session != 0)
+      records[count++] = record;
+  }
+
+  fclose(f);
+
+  return count;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Open the next session of the ledger
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_sys_energy_session_start(void)
+{
+  sys_energy_record_t records[SYS_ENERGY_LEDGER_SESSIONS];
+  uint32_t count;
+  uint32_t last = 0;
+  uint64_t epoch;
+
+  count = sys_energy_read_ledger(records, SYS_ENERGY_LEDGER_SESSIONS);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (records[i].session > last)
+      last = records[i].session;
+  }
+
+  if (BS_OK != bsp_rtc_get_time(&epoch))
+    epoch = 0;
+
+  portENTER_CRITICAL(&m_energy_mux);
+  memset(&m_energy_session, 0, sizeof(m_energy_session));
+  m_energy_session.session     = last + 1;
+  m_energy_session.start_epoch = epoch;
+  portEXIT_CRITICAL(&m_energy_mux);
+
+  ESP_LOGI(TAG, "Session %u, %u in the ledger", m_energy_session.session, count);
+}
+
+/**
+ * @brief         Write a session record to its ledger slot
+ *
+ * @param[in]     record    Pointer to record
+ *
+ * @attention     Creates the ledger on first use
+ *
+ * @return        None
+ */
+static void m_sys_energy_save(const sys_energy_record_t *record)
+{
+  long offset = (long)((record->session % SYS_ENERGY_LEDGER_SESSIONS) * sizeof(*record));
+  sys_energy_record_t empty = { 0 };
+  FILE *f;
+
+  f = fopen(SYS_ENERGY_LEDGER_PATH, "r+b");
+  if (f == NULL)
+  {
+    f = fopen(SYS_ENERGY_LEDGER_PATH, "w+b");
+    if (f == NULL)
+    {
+      ESP_LOGE(TAG, "Ledger open failed");
+      return;
+    }
+
+    for (uint32_t i = 0; i < SYS_ENERGY_LEDGER_SESSIONS; i++)
+      fwrite(&empty, sizeof(empty), 1, f);
+  }
+
+  if ((0 != fseek(f, offset, SEEK_SET)) || (1 != fwrite(record, sizeof(*record), 1, f)))
+    ESP_LOGE(TAG, "Ledger write failed");
+
+  fclose(f);
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,85 @@
+/**
+ * @file       sys_energy.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      System energy ledger, PAC1934 accumulators to per session energy in SPIFFS
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SYS_ENERGY_H
+#define __SYS_ENERGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "platform_common.h"
+#include "pac1934.h"
+
+/* Public defines ----------------------------------------------------- */
+#define SYS_ENERGY_LEDGER_SESSIONS      (16)    // Sessions kept in the ledger, oldest overwritten
+
+/* Public enumerate/structure ----------------------------------------- */
+/**
+ * @brief Energy ledger record of one session
+ */
+typedef struct
+{
+  uint32_t session;                           // Session number, 0 for an empty ledger slot
+  uint32_t duration_s;                        // Time covered by the energy
+  uint64_t start_epoch;                       // RTC time at the session start
+  int64_t energy_uj[PAC1934_CHANNEL_CNT];     // Energy per channel in microjoule
+}
+sys_energy_record_t;
+
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         System energy task
+ *
+ * @param[in]     param     Not used
+ *
+ * @attention     Opens a new session in the ledger, reads the accumulators once per minute
+ *                and saves the session every few minutes
+ *
+ * @return        None
+ */
+void sys_energy_task(void *param);
+
+/**
+ * @brief         System energy get the current session
+ *
+ * @param[out]    record    Pointer to record
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+void sys_energy_get_session(sys_energy_record_t *record);
+
+/**
+ * @brief         System energy read the ledger
+ *
+ * @param[out]    records   Pointer to records, up to SYS_ENERGY_LEDGER_SESSIONS
+ * @param[in]     max       Number of records
+ *
+ * @attention     Records come in ledger slot order, the current session as last saved
+ *
+ * @return        Number of records read
+ */
+uint32_t sys_energy_read_ledger(sys_energy_record_t *records, uint32_t max);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __SYS_ENERGY_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,168 @@
+/**
+ * @file       sys_ramp.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      System therapy ramp, BLE pressure and ramp time to the blower speed
+ * @note       None
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "sys_ramp.h"
+#include "bsp_brc_ctrl.h"
+#include "ble_dss.h"
+
+/* Private defines ---------------------------------------------------- */
+#define SYS_RAMP_POLL_MS                (1000)  // BLE settings check period
+#define SYS_RAMP_TICK_US                (1000)  // Speed loop period, one setpoint per cycle
+#define SYS_RAMP_MIN_MS                 (5000)  // Slew of a change past the ramp time
+#define SYS_RAMP_Q16(_cmh2o)            ((int32_t)(_cmh2o) << 16)
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "sys_ramp";
+
+static const ramp_config_t m_ramp_cfg =
+{
+  .tick_ms = SYS_RAMP_TICK_US / 1000,
+  .min_ms  = SYS_RAMP_MIN_MS
+};
+
+// Nominal blower curve in cmH2O to electrical millihertz, square law with 25 cmH2O
+// at the top speed, until the blower is characterised on the bench
+static const ramp_point_t m_ramp_blower[] =
+{
+  { .x = SYS_RAMP_Q16(0),  .y = 0      },
+  { .x = SYS_RAMP_Q16(4),  .y = 120000 },
+  { .x = SYS_RAMP_Q16(8),  .y = 169706 },
+  { .x = SYS_RAMP_Q16(12), .y = 207846 },
+  { .x = SYS_RAMP_Q16(16), .y = 240000 },
+  { .x = SYS_RAMP_Q16(20), .y = 268328 },
+  { .x = SYS_RAMP_Q16(24), .y = 293939 }
+};
+
+static ramp_t m_ramp;                       // Under m_ramp_mux
+static ramp_curve_t m_ramp_curve;
+static esp_timer_handle_t m_ramp_timer;
+static portMUX_TYPE m_ramp_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Private function prototypes ---------------------------------------- */
+static void m_sys_ramp_timer_cb(void *arg);
+
+/* Function definitions ----------------------------------------------- */
+void sys_ramp_task(void *param)
+{
+  const esp_timer_create_args_t timer_args =
+  {
+    .callback = m_sys_ramp_timer_cb,
+    .name     = "ramp"
+  };
+  uint8_t pressure;
+  uint8_t ramp_time;
+  uint8_t last_pressure  = 0;
+  uint8_t last_ramp_time = 0;
+  bool running = false;
+
+  ramp_curve_init(&m_ramp_curve, m_ramp_blower, sizeof(m_ramp_blower) / sizeof(m_ramp_blower[0]));
+  ramp_init(&m_ramp, &m_ramp_cfg, 0);
+
+  if (ESP_OK != esp_timer_create(&timer_args, &m_ramp_timer))
+  {
+    ESP_LOGE(TAG, "Timer create failed");
+    vTaskDelete(NULL);
+    return;
+  }
+
+  while (1)
+  {
+    pressure  = *ble_dss_get_pressure();
+    ramp_time = *ble_dss_get_ramp_time();
+
+    // No prescription, or therapy stopped, the next one starts a new ramp
+    if (pressure == 0)
+    {
+      if (running)
+      {
+        esp_timer_stop(m_ramp_timer);
+
+        // A tick already dispatched steps a ramp held at 0
+        portENTER_CRITICAL(&m_ramp_mux);
+        ramp_init(&m_ramp, &m_ramp_cfg, 0);
+        portEXIT_CRITICAL(&m_ramp_mux);
+
+        bsp_brc_ctrl_set_speed(0);
+        running = false;
+
+        ESP_LOGI(TAG, "Therapy stopped");
+      }
+
+      vTaskDelay(pdMS_TO_TICKS(SYS_RAMP_POLL_MS));
+      continue;
+    }
+
+    if (pressure < SYS_RAMP_PRESSURE_MIN_CMH2O)
+      pressure = SYS_RAMP_PRESSURE_MIN_CMH2O;
+    if (pressure > SYS_RAMP_PRESSURE_MAX_CMH2O)
+      pressure = SYS_RAMP_PRESSURE_MAX_CMH2O;
+    if (ramp_time > SYS_RAMP_TIME_MAX_MIN)
+      ramp_time = SYS_RAMP_TIME_MAX_MIN;
+
+    if (!running || (pressure != last_pressure) || (ramp_time != last_ramp_time))
+    {
+      portENTER_CRITICAL(&m_ramp_mux);
+      if (!running)
+        ramp_init(&m_ramp, &m_ramp_cfg, SYS_RAMP_Q16((pressure < SYS_RAMP_START_CMH2O) ? pressure : SYS_RAMP_START_CMH2O));
+      ramp_retarget(&m_ramp, SYS_RAMP_Q16(pressure), (uint32_t)ramp_time * 60000);
+      portEXIT_CRITICAL(&m_ramp_mux);
+
+      if (!running)
+        running = (ESP_OK == esp_timer_start_periodic(m_ramp_timer, SYS_RAMP_TICK_US));
+
+      ESP_LOGI(TAG, "Pressure %u cmH2O, ramp %u min", pressure, ramp_time);
+
+      last_pressure  = pressure;
+      last_ramp_time = ramp_time;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(SYS_RAMP_POLL_MS));
+  }
+}
+
+int32_t sys_ramp_get_pressure(void)
+{
+  int32_t value;
+
+  portENTER_CRITICAL(&m_ramp_mux);
+  value = m_ramp.value;
+  portEXIT_CRITICAL(&m_ramp_mux);
+
+  return value;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Ramp tick, one pressure step and the matching speed setpoint
+ *
+ * @param[in]     arg     Not used
+ *
+ * @attention     Runs in the esp_timer task, two additions and a table lookup
+ *
+ * @return        None
+ */
+static void m_sys_ramp_timer_cb(void *arg)
+{
+  int32_t pressure;
+
+  portENTER_CRITICAL(&m_ramp_mux);
+  pressure = ramp_step(&m_ramp);
+  portEXIT_CRITICAL(&m_ramp_mux);
+
+  bsp_brc_ctrl_set_speed((uint32_t)ramp_curve_eval(&m_ramp_curve, pressure));
+}
+
+/* End of file -------------------------------------------------------- */
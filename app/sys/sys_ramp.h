@@ -0,0 +1,68 @@
+/**
+ * @file       sys_ramp.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      System therapy ramp, BLE pressure and ramp time to the blower speed
+ * @note       The night starts at power on. The pressure ramps linearly from
+ *             SYS_RAMP_START_CMH2O to the prescribed pressure over the ramp time,
+ *             one step per control loop period, and holds it afterwards.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SYS_RAMP_H
+#define __SYS_RAMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "platform_common.h"
+#include "ramp.h"
+
+/* Public defines ----------------------------------------------------- */
+#define SYS_RAMP_START_CMH2O            (4)     // Ramp start pressure
+#define SYS_RAMP_PRESSURE_MIN_CMH2O     (4)     // Prescribed pressure range
+#define SYS_RAMP_PRESSURE_MAX_CMH2O     (20)
+#define SYS_RAMP_TIME_MAX_MIN           (45)    // Longest ramp time in minute
+
+/* Public enumerate/structure ----------------------------------------- */
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         System therapy ramp task
+ *
+ * @param[in]     param     Not used
+ *
+ * @attention     Starts the ramp once a pressure is set over BLE and follows the
+ *                pressure and ramp time settings, a change replans from the pressure
+ *                reached so far. A pressure of 0 stops the blower, the next one
+ *                ramps again from SYS_RAMP_START_CMH2O.
+ *
+ * @return        None
+ */
+void sys_ramp_task(void *param);
+
+/**
+ * @brief         System therapy ramp get the pressure setpoint
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Pressure setpoint in cmH2O, Q16
+ */
+int32_t sys_ramp_get_pressure(void);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __SYS_RAMP_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,98 @@
+/**
+ * @file       sys_sleep_pos.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-26
+ * @author     Hiep Le
+ * @brief      System sleep position, gyro samples to the BLE user data service
+ * @note       The night starts at power on, with the patient lying on the back
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "sys_sleep_pos.h"
+#include "bsp_gyro.h"
+#include "ble_uds.h"
+
+/* Private defines ---------------------------------------------------- */
+#define SYS_SLEEP_POS_PERIOD_MS         (1000)
+#define SYS_SLEEP_POS_BATCH             (16)    // Samples taken from the gyro ring per read
+
+/* Private enumerate/structure ---------------------------------------- */
+/* Private macros ----------------------------------------------------- */
+/* Public variables --------------------------------------------------- */
+/* Private variables -------------------------------------------------- */
+static const char *TAG = "sys_sleep_pos";
+
+// Gyro mounted with X along the body, IAM20380_FULLSCALE_1000_DPS set by bsp_gyro_init()
+static const sleep_pos_config_t m_sleep_pos_cfg =
+{
+  .roll_axis       = 0,
+  .roll_inverted   = false,
+  .sensitivity_x10 = 328
+};
+
+static sleep_pos_t m_sleep_pos;                           // Only touched by the sleep position task
+static uint32_t m_sleep_pos_time_s[SLEEP_POS_CNT];        // Copy of m_sleep_pos.time_s for other tasks
+static portMUX_TYPE m_sleep_pos_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* Private function prototypes ---------------------------------------- */
+/* Function definitions ----------------------------------------------- */
+void sys_sleep_pos_task(void *param)
+{
+  iam20380_sample_t samples[SYS_SLEEP_POS_BATCH];
+  int16_t rate[3];
+  uint32_t count;
+  uint8_t position;
+  sleep_pos_position_t last = SLEEP_POS_SUPINE;
+
+  sleep_pos_init(&m_sleep_pos, &m_sleep_pos_cfg);
+
+  position = (uint8_t)last;
+  ble_uds_set_sleep_position(&position);
+
+  while (1)
+  {
+    vTaskDelay(pdMS_TO_TICKS(SYS_SLEEP_POS_PERIOD_MS));
+
+    do
+    {
+      count = bsp_gyro_read_samples(samples, SYS_SLEEP_POS_BATCH);
+
+      for (uint32_t i = 0; i < count; i++)
+      {
+        rate[0] = samples[i].raw.x;
+        rate[1] = samples[i].raw.y;
+        rate[2] = samples[i].raw.z;
+        sleep_pos_update(&m_sleep_pos, rate, samples[i].timestamp_us);
+      }
+    } while (count == SYS_SLEEP_POS_BATCH);
+
+    // Only the copy is done with interrupts masked
+    portENTER_CRITICAL(&m_sleep_pos_mux);
+    memcpy(m_sleep_pos_time_s, m_sleep_pos.time_s, sizeof(m_sleep_pos_time_s));
+    portEXIT_CRITICAL(&m_sleep_pos_mux);
+
+    if (m_sleep_pos.position != last)
+    {
+      last     = m_sleep_pos.position;
+      position = (uint8_t)last;
+      ble_uds_set_sleep_position(&position);
+
+      ESP_LOGI(TAG, "Position %d, night %u/%u/%u/%u s", position,
+               m_sleep_pos.time_s[SLEEP_POS_SUPINE], m_sleep_pos.time_s[SLEEP_POS_LEFT],
+               m_sleep_pos.time_s[SLEEP_POS_RIGHT], m_sleep_pos.time_s[SLEEP_POS_PRONE]);
+    }
+  }
+}
+
+void sys_sleep_pos_get_histogram(uint32_t *time_s)
+{
+  portENTER_CRITICAL(&m_sleep_pos_mux);
+  memcpy(time_s, m_sleep_pos_time_s, sizeof(m_sleep_pos_time_s));
+  portEXIT_CRITICAL(&m_sleep_pos_mux);
+}
+
+/* Private function definitions ---------------------------------------- */
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,58 @@
+/**
+ * @file       sys_sleep_pos.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-26
+ * @author     Hiep Le
+ * @brief      System sleep position, gyro samples to the BLE user data service
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SYS_SLEEP_POS_H
+#define __SYS_SLEEP_POS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include "platform_common.h"
+#include "sleep_pos.h"
+
+/* Public defines ----------------------------------------------------- */
+/* Public enumerate/structure ----------------------------------------- */
+/* Public macros ------------------------------------------------------ */
+/* Public variables --------------------------------------------------- */
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         System sleep position task
+ *
+ * @param[in]     param     Not used
+ *
+ * @attention     Takes the gyro samples once per second and publishes the position
+ *
+ * @return        None
+ */
+void sys_sleep_pos_task(void *param);
+
+/**
+ * @brief         System sleep position get the time in each position this night
+ *
+ * @param[out]    time_s    Pointer to SLEEP_POS_CNT times in second
+ *
+ * @attention     Refreshed by the task once per second
+ *
+ * @return        None
+ */
+void sys_sleep_pos_get_histogram(uint32_t *time_s);
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __SYS_SLEEP_POS_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,399 @@
+/**
+ * @file       freertos_host.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host model of the FreeRTOS tasks, queues and semaphores
+ * @note       Every task is a thread parked on its own condition variable until the
+ *             scheduler hands it the CPU. The lock only guards the model state, the
+ *             running task does not hold it while it runs its own code.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "freertos_host.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private defines ---------------------------------------------------- */
+#define FREERTOS_HOST_MAX_TASKS         (16)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Model task
+ */
+typedef struct
+{
+  pthread_t thread;
+  pthread_cond_t wake;          // Signalled when the task is given the CPU
+  TaskFunction_t code;
+  void *param;
+  const char *name;
+  UBaseType_t priority;
+  bool ready;
+  uint32_t ready_seq;           // Order among the ready tasks of one priority
+  const void *wait_on;          // Queue the task is blocked on
+}
+freertos_host_task_t;
+
+/**
+ * @brief Model queue, a semaphore is a queue of empty items
+ */
+struct QueueDefinition
+{
+  uint8_t *item;
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+  bool is_static;
+};
+
+/* Private variables -------------------------------------------------- */
+static pthread_mutex_t m_host_lock = PTHREAD_MUTEX_INITIALIZER;
+static freertos_host_task_t m_host_task[FREERTOS_HOST_MAX_TASKS];
+static uint32_t m_host_task_cnt;
+static freertos_host_task_t *m_host_running;
+static uint32_t m_host_ready_seq;
+static uint32_t m_host_switches;
+
+_Static_assert(sizeof(struct QueueDefinition) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t too small");
+
+/* Private function prototypes ---------------------------------------- */
+static void *m_freertos_host_entry(void *arg);
+static void m_freertos_host_schedule(void);
+static void m_freertos_host_preempt(void);
+static void m_freertos_host_wake(const void *queue);
+static bool m_freertos_host_wait(const void *queue, TickType_t ticks_to_wait);
+static QueueHandle_t m_freertos_host_queue_init(struct QueueDefinition *queue, UBaseType_t length,
+                                                UBaseType_t item_size, UBaseType_t count);
+
+/* Function definitions ----------------------------------------------- */
+void freertos_host_init(UBaseType_t priority)
+{
+  freertos_host_task_t *task = &m_host_task[0];
+
+  pthread_mutex_lock(&m_host_lock);
+  pthread_cond_init(&task->wake, NULL);
+  task->thread    = pthread_self();
+  task->name      = "main";
+  task->priority  = priority;
+  task->ready     = true;
+  task->ready_seq = m_host_ready_seq++;
+  m_host_task_cnt = 1;
+  m_host_running  = task;
+  pthread_mutex_unlock(&m_host_lock);
+}
+
+uint32_t freertos_host_get_switches(void)
+{
+  return m_host_switches;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+  freertos_host_task_t *task;
+
+  (void)stack_depth;
+
+  pthread_mutex_lock(&m_host_lock);
+  if (m_host_task_cnt >= FREERTOS_HOST_MAX_TASKS)
+  {
+    pthread_mutex_unlock(&m_host_lock);
+    return pdFAIL;
+  }
+
+  task = &m_host_task[m_host_task_cnt++];
+  pthread_cond_init(&task->wake, NULL);
+  task->code      = code;
+  task->param     = param;
+  task->name      = name;
+  task->priority  = priority;
+  task->ready     = true;
+  task->ready_seq = m_host_ready_seq++;
+  if (created != NULL)
+    *created = task;
+
+  pthread_create(&task->thread, NULL, m_freertos_host_entry, task);
+  m_freertos_host_preempt();
+  pthread_mutex_unlock(&m_host_lock);
+
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  return m_host_running;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  return m_freertos_host_queue_init(malloc(sizeof(struct QueueDefinition)), length, item_size, 0);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+  UBaseType_t tail;
+
+  pthread_mutex_lock(&m_host_lock);
+  while (queue->count >= queue->length)
+  {
+    if (!m_freertos_host_wait(queue, ticks_to_wait))
+    {
+      pthread_mutex_unlock(&m_host_lock);
+      return pdFAIL;
+    }
+  }
+
+  tail = (queue->head + queue->count) % queue->length;
+  if (queue->item_size != 0)
+    memcpy(&queue->item[tail * queue->item_size], item, queue->item_size);
+  queue->count++;
+
+  m_freertos_host_wake(queue);
+  m_freertos_host_preempt();
+  pthread_mutex_unlock(&m_host_lock);
+
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+  pthread_mutex_lock(&m_host_lock);
+  while (queue->count == 0)
+  {
+    if (!m_freertos_host_wait(queue, ticks_to_wait))
+    {
+      pthread_mutex_unlock(&m_host_lock);
+      return pdFAIL;
+    }
+  }
+
+  if (queue->item_size != 0)
+    memcpy(buffer, &queue->item[queue->head * queue->item_size], queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+
+  m_freertos_host_wake(queue);
+  m_freertos_host_preempt();
+  pthread_mutex_unlock(&m_host_lock);
+
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  return queue->count;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+  if (queue == NULL)
+    return;
+
+  free(queue->item);
+  if (!queue->is_static)
+    free(queue);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+  return m_freertos_host_queue_init(malloc(sizeof(struct QueueDefinition)), max_count, 0, initial_count);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return m_freertos_host_queue_init(malloc(sizeof(struct QueueDefinition)), 1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer)
+{
+  QueueHandle_t queue = m_freertos_host_queue_init((struct QueueDefinition *)buffer, 1, 0, 0);
+
+  queue->is_static = true;
+
+  return queue;
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Thread of a created task, waits for the CPU before running the task
+ *
+ * @param[in]     arg     Pointer to model task
+ *
+ * @attention     A task that returns is never ready again
+ *
+ * @return        NULL
+ */
+static void *m_freertos_host_entry(void *arg)
+{
+  freertos_host_task_t *task = (freertos_host_task_t *)arg;
+
+  pthread_mutex_lock(&m_host_lock);
+  while (m_host_running != task)
+    pthread_cond_wait(&task->wake, &m_host_lock);
+  pthread_mutex_unlock(&m_host_lock);
+
+  task->code(task->param);
+
+  pthread_mutex_lock(&m_host_lock);
+  task->ready = false;
+  m_freertos_host_schedule();
+  pthread_mutex_unlock(&m_host_lock);
+
+  return NULL;
+}
+
+/**
+ * @brief         Give the CPU to the highest priority ready task, wait for it to come back
+ *
+ * @param[in]     None
+ *
+ * @attention     Call with the lock held from the running task. The running task keeps
+ *                the CPU against ready tasks of its own priority.
+ *
+ * @return        None
+ */
+static void m_freertos_host_schedule(void)
+{
+  freertos_host_task_t *self = m_host_running;
+  freertos_host_task_t *next = self->ready ? self : NULL;
+  freertos_host_task_t *task;
+
+  for (uint32_t i = 0; i < m_host_task_cnt; i++)
+  {
+    task = &m_host_task[i];
+    if (!task->ready || (task == self))
+      continue;
+
+    if ((next == NULL) || (task->priority > next->priority) ||
+        ((task->priority == next->priority) && (next != self) && (task->ready_seq < next->ready_seq)))
+      next = task;
+  }
+
+  if (next == NULL)
+  {
+    fprintf(stderr, "freertos_host: every task blocked, %s last\n", self->name);
+    abort();
+  }
+
+  if (next == self)
+    return;
+
+  m_host_switches++;
+  m_host_running = next;
+  pthread_cond_signal(&next->wake);
+
+  while (m_host_running != self)
+    pthread_cond_wait(&self->wake, &m_host_lock);
+}
+
+/**
+ * @brief         Switch if a task of higher priority than the running one is ready
+ *
+ * @param[in]     None
+ *
+ * @attention     Call with the lock held from the running task
+ *
+ * @return        None
+ */
+static void m_freertos_host_preempt(void)
+{
+  for (uint32_t i = 0; i < m_host_task_cnt; i++)
+  {
+    if (m_host_task[i].ready && (m_host_task[i].priority > m_host_running->priority))
+    {
+      m_freertos_host_schedule();
+      return;
+    }
+  }
+}
+
+/**
+ * @brief         Make every task blocked on a queue ready, they check it again themselves
+ *
+ * @param[in]     queue   Queue that changed
+ *
+ * @attention     Call with the lock held
+ *
+ * @return        None
+ */
+static void m_freertos_host_wake(const void *queue)
+{
+  for (uint32_t i = 0; i < m_host_task_cnt; i++)
+  {
+    if (m_host_task[i].wait_on == queue)
+    {
+      m_host_task[i].wait_on   = NULL;
+      m_host_task[i].ready     = true;
+      m_host_task[i].ready_seq = m_host_ready_seq++;
+    }
+  }
+}
+
+/**
+ * @brief         Block the running task on a queue until it changes
+ *
+ * @param[in]     queue           Queue to wait on
+ * @param[in]     ticks_to_wait   0 to fail at once, any other value waits forever
+ *
+ * @attention     Call with the lock held from the running task
+ *
+ * @return
+ * - true       Queue changed, check it again
+ * - false      No wait allowed
+ */
+static bool m_freertos_host_wait(const void *queue, TickType_t ticks_to_wait)
+{
+  if (ticks_to_wait == 0)
+    return false;
+
+  m_host_running->ready   = false;
+  m_host_running->wait_on = queue;
+  m_freertos_host_schedule();
+
+  return true;
+}
+
+/**
+ * @brief         Set up a queue in the given storage
+ *
+ * @param[in]     queue       Storage of the queue
+ * @param[in]     length      Items the queue holds
+ * @param[in]     item_size   Size of an item, 0 for a semaphore
+ * @param[in]     count       Items already in, semaphore initial count
+ *
+ * @attention     None
+ *
+ * @return        Queue handle, NULL when out of memory
+ */
+static QueueHandle_t m_freertos_host_queue_init(struct QueueDefinition *queue, UBaseType_t length,
+                                                UBaseType_t item_size, UBaseType_t count)
+{
+  if (queue == NULL)
+    return NULL;
+
+  memset(queue, 0, sizeof(*queue));
+  queue->length    = length;
+  queue->item_size = item_size;
+  queue->count     = count;
+
+  if (item_size != 0)
+  {
+    queue->item = calloc(length, item_size);
+    if (queue->item == NULL)
+    {
+      free(queue);
+      return NULL;
+    }
+  }
+
+  return queue;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,52 @@
+/**
+ * @file       freertos_host.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host model of the FreeRTOS tasks, queues and semaphores
+ * @note       One thread per task, but only one of them runs at a time, as on a single
+ *             core. The highest priority ready task runs and keeps the CPU until it
+ *             blocks or a higher priority task gets ready, equal priorities run in the
+ *             order they got ready. There is no tick, a finite timeout waits forever.
+ * @example    freertos_host_init(1);
+ *             xTaskCreate(&task, "Task", 2048, NULL, 10, &handle);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __FREERTOS_HOST_H
+#define __FREERTOS_HOST_H
+
+/* Includes ----------------------------------------------------------- */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Make the calling thread the first task
+ *
+ * @param[in]     priority    Task priority
+ *
+ * @attention     Call once from main() before any other FreeRTOS call
+ *
+ * @return        None
+ */
+void freertos_host_init(UBaseType_t priority);
+
+/**
+ * @brief         Context switches since init
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Count
+ */
+uint32_t freertos_host_get_switches(void);
+
+#endif // __FREERTOS_HOST_H
+
+/* End of file -------------------------------------------------------- */
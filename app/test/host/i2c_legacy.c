@@ -0,0 +1,465 @@
+/**
+ * @file       i2c_legacy.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host model of the legacy IDF I2C master driver
+ * @note       The command link types and the append and consume steps follow the
+ *             driver of IDF v4.3. Also the host side of the mutex, heap, timer and
+ *             GPIO calls that i2c_bus makes.
+ * @example    None
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "driver/i2c.h"
+#include "esp_timer.h"
+#include "rom/ets_sys.h"
+#include "audio_mutex.h"
+#include "audio_mem.h"
+#include "i2c_legacy.h"
+
+/* Private enumerate/structure ---------------------------------------- */
+typedef struct
+{
+  uint8_t byte_num;
+  uint8_t ack_en;
+  uint8_t ack_exp;
+  uint8_t ack_val;
+  uint8_t *data;
+  uint8_t byte_cmd;
+  i2c_opmode_t op_code;
+}
+i2c_cmd_t;
+
+typedef struct i2c_cmd_link
+{
+  i2c_cmd_t cmd;
+  struct i2c_cmd_link *next;
+}
+i2c_cmd_link_t;
+
+typedef struct
+{
+  i2c_cmd_link_t *head;
+  i2c_cmd_link_t *cur;
+  i2c_cmd_link_t *free;
+}
+i2c_cmd_desc_t;
+
+/* Private variables -------------------------------------------------- */
+static uint8_t m_slave_addr;
+static uint8_t m_slave_reg[256];
+static uint8_t m_slave_ptr;
+static uint32_t m_allocs;
+static uint32_t m_transactions;
+static char m_log[I2C_LEGACY_LOG_SIZE];
+static size_t m_log_len;
+
+/* Private function prototypes ---------------------------------------- */
+static esp_err_t m_i2c_cmd_link_append(i2c_cmd_handle_t cmd_handle, const i2c_cmd_t *cmd);
+static void m_i2c_log(const char *fmt, unsigned value);
+
+/* Function definitions ----------------------------------------------- */
+void i2c_legacy_set_slave(uint8_t addr)
+{
+  m_slave_addr = addr & 0xFE;
+  m_slave_ptr  = 0;
+  memset(m_slave_reg, 0, sizeof(m_slave_reg));
+}
+
+uint8_t *i2c_legacy_get_regs(void)
+{
+  return m_slave_reg;
+}
+
+uint32_t i2c_legacy_get_allocs(void)
+{
+  return m_allocs;
+}
+
+const char *i2c_legacy_get_log(void)
+{
+  return m_log;
+}
+
+uint32_t i2c_legacy_get_transactions(void)
+{
+  return m_transactions;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+  m_allocs++;
+
+  return calloc(1, sizeof(i2c_cmd_desc_t));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle)
+{
+  i2c_cmd_desc_t *cmd = (i2c_cmd_desc_t *)cmd_handle;
+  i2c_cmd_link_t *tmp;
+
+  if (cmd == NULL)
+    return;
+
+  while (cmd->free)
+  {
+    tmp       = cmd->free;
+    cmd->free = cmd->free->next;
+    free(tmp);
+  }
+  free(cmd);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle)
+{
+  i2c_cmd_t cmd = { .op_code = I2C_CMD_RESTART };
+
+  return m_i2c_cmd_link_append(cmd_handle, &cmd);
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en)
+{
+  i2c_cmd_t cmd = { .ack_en = ack_en, .byte_num = 1, .op_code = I2C_CMD_WRITE, .data = NULL, .byte_cmd = data };
+
+  return m_i2c_cmd_link_append(cmd_handle, &cmd);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, bool ack_en)
+{
+  i2c_cmd_t cmd = { .ack_en = ack_en, .op_code = I2C_CMD_WRITE };
+  size_t len;
+
+  while (data_len > 0)
+  {
+    len          = (data_len > 0xFF) ? 0xFF : data_len;
+    cmd.byte_num = (uint8_t)len;
+    cmd.data     = data;
+    if (ESP_OK != m_i2c_cmd_link_append(cmd_handle, &cmd))
+      return ESP_ERR_NO_MEM;
+    data     += len;
+    data_len -= len;
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack)
+{
+  i2c_cmd_t cmd = { .op_code = I2C_CMD_READ };
+  size_t len;
+
+  if (data_len == 0)
+    return ESP_ERR_INVALID_ARG;
+
+  // Last byte NACKed on its own command, the rest ACKed in chunks
+  if (ack == I2C_MASTER_LAST_NACK)
+  {
+    if (data_len > 1)
+      i2c_master_read(cmd_handle, data, data_len - 1, I2C_MASTER_ACK);
+    cmd.ack_val  = I2C_MASTER_NACK;
+    cmd.byte_num = 1;
+    cmd.data     = data + data_len - 1;
+
+    return m_i2c_cmd_link_append(cmd_handle, &cmd);
+  }
+
+  cmd.ack_val = ack;
+  while (data_len > 0)
+  {
+    len          = (data_len > 0xFF) ? 0xFF : data_len;
+    cmd.byte_num = (uint8_t)len;
+    cmd.data     = data;
+    if (ESP_OK != m_i2c_cmd_link_append(cmd_handle, &cmd))
+      return ESP_ERR_NO_MEM;
+    data     += len;
+    data_len -= len;
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle)
+{
+  i2c_cmd_t cmd = { .op_code = I2C_CMD_STOP };
+
+  return m_i2c_cmd_link_append(cmd_handle, &cmd);
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait)
+{
+  i2c_cmd_desc_t *desc = (i2c_cmd_desc_t *)cmd_handle;
+  i2c_cmd_link_t *link;
+  bool addressed = false;
+  bool selected  = false;
+  bool reading   = false;
+  bool first     = false;
+  uint8_t byte;
+
+  (void)i2c_num;
+  (void)ticks_to_wait;
+
+  m_transactions++;
+  m_log_len = 0;
+  m_log[0]  = '\0';
+
+  for (link = desc->head; link != NULL; link = link->next)
+  {
+    i2c_cmd_t *cmd = &link->cmd;
+
+    switch (cmd->op_code)
+    {
+    case I2C_CMD_RESTART:
+      m_i2c_log("S", 0);
+      addressed = false;
+      break;
+
+    case I2C_CMD_STOP:
+      m_i2c_log("P", 0);
+      break;
+
+    case I2C_CMD_WRITE:
+      // The ISR walks the payload and leaves the command spent
+      for (uint8_t i = 0; i < cmd->byte_num; i++)
+      {
+        byte = (cmd->data != NULL) ? cmd->data[i] : cmd->byte_cmd;
+        m_i2c_log("w%02X", byte);
+        if (!addressed)
+        {
+          addressed = true;
+          selected  = ((byte & 0xFE) == m_slave_addr);
+          reading   = (byte & 0x01) != 0;
+          first     = true;
+          if (!selected)
+          {
+            m_i2c_log("N", 0);
+            return ESP_FAIL;
+          }
+        }
+        else if (first)
+        {
+          m_slave_ptr = byte;
+          first       = false;
+        }
+        else
+        {
+          m_slave_reg[m_slave_ptr++] = byte;
+        }
+      }
+      if (cmd->data != NULL)
+        cmd->data += cmd->byte_num;
+      cmd->byte_num = 0;
+      break;
+
+    case I2C_CMD_READ:
+      if (!selected || !reading)
+        return ESP_FAIL;
+      for (uint8_t i = 0; i < cmd->byte_num; i++)
+      {
+        cmd->data[i] = m_slave_reg[m_slave_ptr++];
+        m_i2c_log("r%02X", cmd->data[i]);
+      }
+      cmd->data    += cmd->byte_num;
+      cmd->byte_num = 0;
+      break;
+
+    default:
+      return ESP_FAIL;
+    }
+  }
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf)
+{
+  (void)i2c_num;
+  (void)i2c_conf;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len, int intr_alloc_flags)
+{
+  (void)i2c_num;
+  (void)mode;
+  (void)slv_rx_buf_len;
+  (void)slv_tx_buf_len;
+  (void)intr_alloc_flags;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num)
+{
+  (void)i2c_num;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_set_pin(i2c_port_t i2c_num, int sda_io_num, int scl_io_num, bool sda_pullup_en, bool scl_pullup_en, i2c_mode_t mode)
+{
+  (void)i2c_num;
+  (void)sda_io_num;
+  (void)scl_io_num;
+  (void)sda_pullup_en;
+  (void)scl_pullup_en;
+  (void)mode;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_reset_tx_fifo(i2c_port_t i2c_num)
+{
+  (void)i2c_num;
+
+  return ESP_OK;
+}
+
+esp_err_t i2c_reset_rx_fifo(i2c_port_t i2c_num)
+{
+  (void)i2c_num;
+
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+  (void)gpio_num;
+  (void)level;
+
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+  (void)gpio_num;
+
+  return 1;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+  (void)gpio_num;
+  (void)mode;
+
+  return ESP_OK;
+}
+
+void ets_delay_us(uint32_t us)
+{
+  (void)us;
+}
+
+int64_t esp_timer_get_time(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void *mutex_create(void)
+{
+  return malloc(1);
+}
+
+int mutex_destroy(void *mutex)
+{
+  free(mutex);
+
+  return 0;
+}
+
+int mutex_lock(void *mutex)
+{
+  (void)mutex;
+
+  return 0;
+}
+
+int mutex_unlock(void *mutex)
+{
+  (void)mutex;
+
+  return 0;
+}
+
+void *audio_calloc(size_t nmemb, size_t size)
+{
+  return calloc(nmemb, size);
+}
+
+void audio_free(void *ptr)
+{
+  free(ptr);
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Append one command to a link, one heap node each
+ *
+ * @param[in]     cmd_handle    Command link
+ * @param[in]     cmd           Command
+ *
+ * @attention     None
+ *
+ * @return
+ * - ESP_OK
+ * - ESP_ERR_NO_MEM
+ */
+static esp_err_t m_i2c_cmd_link_append(i2c_cmd_handle_t cmd_handle, const i2c_cmd_t *cmd)
+{
+  i2c_cmd_desc_t *desc = (i2c_cmd_desc_t *)cmd_handle;
+  i2c_cmd_link_t *link = calloc(1, sizeof(i2c_cmd_link_t));
+
+  if (link == NULL)
+    return ESP_ERR_NO_MEM;
+  m_allocs++;
+
+  link->cmd = *cmd;
+  if (desc->head == NULL)
+  {
+    desc->head = link;
+    desc->free = link;
+  }
+  else
+  {
+    desc->cur->next = link;
+  }
+  desc->cur = link;
+
+  return ESP_OK;
+}
+
+/**
+ * @brief         Add a token to the log of the run
+ *
+ * @param[in]     fmt       Token format
+ * @param[in]     value     Token value
+ *
+ * @attention     Tokens that do not fit are dropped
+ *
+ * @return        None
+ */
+static void m_i2c_log(const char *fmt, unsigned value)
+{
+  int n;
+
+  if (m_log_len + 8 >= sizeof(m_log))
+    return;
+
+  if (m_log_len > 0)
+    m_log[m_log_len++] = ' ';
+  n = snprintf(&m_log[m_log_len], sizeof(m_log) - m_log_len, fmt, value);
+  m_log_len += (size_t)n;
+}
+
+/* End of file -------------------------------------------------------- */
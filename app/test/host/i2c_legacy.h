@@ -0,0 +1,86 @@
+/**
+ * @file       i2c_legacy.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host model of the legacy IDF I2C master driver
+ * @note       Builds command links the way the driver before v4.4 does, one heap node
+ *             per command, and runs them against a register file slave. Commands are
+ *             consumed as the driver ISR does, so a replayed link only works if its
+ *             owner restores it. Every run is logged as bus conditions and bytes.
+ * @example    i2c_legacy_set_slave(0x78);
+ *             ...
+ *             TEST_CHECK(strcmp(i2c_legacy_get_log(), "S w78 w10 S w79 r00 P") == 0);
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __I2C_LEGACY_H
+#define __I2C_LEGACY_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+
+/* Public defines ----------------------------------------------------- */
+#define I2C_LEGACY_LOG_SIZE             (2048)
+
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Set the slave address and clear its registers
+ *
+ * @param[in]     addr      Address byte with the write bit, 7 bits address shifted left
+ *
+ * @attention     Other addresses NACK
+ *
+ * @return        None
+ */
+void i2c_legacy_set_slave(uint8_t addr);
+
+/**
+ * @brief         Pointer to the 256 registers of the slave
+ *
+ * @param[in]     None
+ *
+ * @attention     The register pointer auto increments and wraps
+ *
+ * @return        Registers
+ */
+uint8_t *i2c_legacy_get_regs(void);
+
+/**
+ * @brief         Heap nodes allocated by command links since start
+ *
+ * @param[in]     None
+ *
+ * @attention     Link descriptors included
+ *
+ * @return        Count
+ */
+uint32_t i2c_legacy_get_allocs(void);
+
+/**
+ * @brief         Log of the last i2c_master_cmd_begin()
+ *
+ * @param[in]     None
+ *
+ * @attention     S START, P STOP, N NACK, wXX byte written, rXX byte read, space separated
+ *
+ * @return        Log string
+ */
+const char *i2c_legacy_get_log(void);
+
+/**
+ * @brief         Number of i2c_master_cmd_begin() calls since start
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Count
+ */
+uint32_t i2c_legacy_get_transactions(void);
+
+#endif // __I2C_LEGACY_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,62 @@
+/**
+ * @file       bsp.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for bsp/bsp.h
+ * @note       Only the status type and check macros the components use, so they
+ *             build without the IDF. Keep in step with bsp/bsp.h.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __BSP_H
+#define __BSP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "esp_log.h"
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef enum
+{
+  BS_OK = 0x00,
+  BS_ERROR_PARAMS,
+  BS_ERROR
+}
+base_status_t;
+
+/* Public macros ------------------------------------------------------ */
+#define CHECK(expr, ret)            \
+  do {                              \
+    if (!(expr)) {                  \
+      return (ret);                 \
+    }                               \
+  } while (0)
+
+#define CHECK_STATUS(expr)          \
+  do {                              \
+    base_status_t ret = (expr);     \
+    if (BS_OK != ret) {             \
+      return (ret);                 \
+    }                               \
+  } while (0)
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __BSP_H
+
+/* End of file -------------------------------------------------------- */
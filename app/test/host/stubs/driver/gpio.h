@@ -0,0 +1,46 @@
+/**
+ * @file       gpio.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for driver/gpio.h
+ * @note       Lines read back high, the bus clear always succeeds
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __GPIO_H
+#define __GPIO_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef int gpio_num_t;
+
+typedef enum
+{
+  GPIO_MODE_INPUT = 1,
+  GPIO_MODE_OUTPUT,
+  GPIO_MODE_INPUT_OUTPUT_OD
+}
+gpio_mode_t;
+
+typedef enum
+{
+  GPIO_PULLUP_DISABLE = 0,
+  GPIO_PULLUP_ENABLE
+}
+gpio_pullup_t;
+
+/* Public function prototypes ----------------------------------------- */
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+
+#endif // __GPIO_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,93 @@
+/**
+ * @file       i2c.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for the legacy IDF I2C master API
+ * @note       Command links as the driver before v4.4 builds them, every command appended
+ *             from the heap. Implemented by i2c_legacy.c over a register file slave.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __I2C_H
+#define __I2C_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef int i2c_port_t;
+
+#define I2C_NUM_0                       (0)
+#define I2C_NUM_1                       (1)
+#define I2C_NUM_MAX                     (2)
+
+typedef enum
+{
+  I2C_MODE_SLAVE = 0,
+  I2C_MODE_MASTER
+}
+i2c_mode_t;
+
+typedef enum
+{
+  I2C_CMD_RESTART = 0,
+  I2C_CMD_WRITE,
+  I2C_CMD_READ,
+  I2C_CMD_STOP,
+  I2C_CMD_END
+}
+i2c_opmode_t;
+
+typedef enum
+{
+  I2C_MASTER_ACK = 0,
+  I2C_MASTER_NACK,
+  I2C_MASTER_LAST_NACK
+}
+i2c_ack_type_t;
+
+typedef struct
+{
+  i2c_mode_t mode;
+  int sda_io_num;
+  int scl_io_num;
+  gpio_pullup_t sda_pullup_en;
+  gpio_pullup_t scl_pullup_en;
+  struct
+  {
+    uint32_t clk_speed;
+  } master;
+}
+i2c_config_t;
+
+typedef void *i2c_cmd_handle_t;
+
+/* Public function prototypes ----------------------------------------- */
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf);
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len, int intr_alloc_flags);
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num);
+esp_err_t i2c_set_pin(i2c_port_t i2c_num, int sda_io_num, int scl_io_num, bool sda_pullup_en, bool scl_pullup_en, i2c_mode_t mode);
+esp_err_t i2c_reset_tx_fifo(i2c_port_t i2c_num);
+esp_err_t i2c_reset_rx_fifo(i2c_port_t i2c_num);
+
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, bool ack_en);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait);
+
+#endif // __I2C_H
+
+/* End of file -------------------------------------------------------- */
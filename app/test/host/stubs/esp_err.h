@@ -0,0 +1,28 @@
+/**
+ * @file       esp_err.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for esp_err.h
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __ESP_ERR_H
+#define __ESP_ERR_H
+
+/* Public defines ----------------------------------------------------- */
+#define ESP_OK                          (0)
+#define ESP_FAIL                        (-1)
+#define ESP_ERR_NO_MEM                  (0x101)
+#define ESP_ERR_INVALID_ARG             (0x102)
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef int esp_err_t;
+
+#endif // __ESP_ERR_H
+
+/* End of file -------------------------------------------------------- */
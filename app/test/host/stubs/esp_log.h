@@ -0,0 +1,54 @@
+/**
+ * @file       esp_log.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for the IDF log macros
+ * @note       Errors and warnings go to stderr, the other levels are dropped
+ *             with their arguments still checked against the format.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __ESP_LOG_H
+#define __ESP_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+#include <stdio.h>
+#include <stdarg.h>
+
+/* Public function prototypes ----------------------------------------- */
+static inline void __attribute__((format(printf, 3, 4))) host_log(int print, const char *tag, const char *fmt, ...)
+{
+  va_list args;
+
+  if (!print)
+    return;
+
+  va_start(args, fmt);
+  fprintf(stderr, "%s: ", tag);
+  vfprintf(stderr, fmt, args);
+  fprintf(stderr, "\n");
+  va_end(args);
+}
+
+/* Public macros ------------------------------------------------------ */
+#define ESP_LOGE(tag, fmt, ...)         host_log(1, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...)         host_log(1, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)         host_log(0, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...)         host_log(0, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...)         host_log(0, tag, fmt, ##__VA_ARGS__)
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // __ESP_LOG_H
+
+/* End of file -------------------------------------------------------- */
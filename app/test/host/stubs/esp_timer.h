@@ -0,0 +1,25 @@
+/**
+ * @file       esp_timer.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for esp_timer.h
+ * @note       Time comes from the host build, see i2c_legacy.c
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __ESP_TIMER_H
+#define __ESP_TIMER_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+
+/* Public function prototypes ----------------------------------------- */
+int64_t esp_timer_get_time(void);
+
+#endif // __ESP_TIMER_H
+
+/* End of file -------------------------------------------------------- */
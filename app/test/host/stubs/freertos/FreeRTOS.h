@@ -0,0 +1,58 @@
+/**
+ * @file       FreeRTOS.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for the FreeRTOS types
+ * @note       Only what the components touch. Tasks, queues and semaphores run on
+ *             the model in freertos_host.c for the tests that link it.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __FREERTOS_H
+#define __FREERTOS_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public defines ----------------------------------------------------- */
+#define portTICK_RATE_MS                (1)
+#define portMAX_DELAY                   (0xFFFFFFFFu)
+
+#define pdFALSE                         (0)
+#define pdTRUE                          (1)
+#define pdFAIL                          (pdFALSE)
+#define pdPASS                          (pdTRUE)
+
+// One task runs at a time on the model, a critical section has nothing to exclude
+#define portMUX_INITIALIZER_UNLOCKED    (0)
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef int portBASE_TYPE;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef int portMUX_TYPE;
+typedef void *xSemaphoreHandle;
+typedef void *SemaphoreHandle_t;
+typedef void *TaskHandle_t;
+typedef struct QueueDefinition *QueueHandle_t;
+
+/**
+ * @brief Storage of a statically allocated semaphore
+ */
+typedef struct
+{
+  void *space[8];
+}
+StaticSemaphore_t;
+
+#endif // __FREERTOS_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,29 @@
+/**
+ * @file       queue.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for freertos/queue.h
+ * @note       Types come from FreeRTOS.h, the calls are implemented by freertos_host.c
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __QUEUE_H
+#define __QUEUE_H
+
+/* Includes ----------------------------------------------------------- */
+#include "freertos/FreeRTOS.h"
+
+/* Public function prototypes ----------------------------------------- */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+
+#endif // __QUEUE_H
+
+/* End of file -------------------------------------------------------- */
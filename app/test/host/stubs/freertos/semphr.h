@@ -0,0 +1,34 @@
+/**
+ * @file       semphr.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for freertos/semphr.h
+ * @note       Types come from FreeRTOS.h. Semaphores are queues of empty items, as
+ *             in FreeRTOS, implemented by freertos_host.c.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __SEMPHR_H
+#define __SEMPHR_H
+
+/* Includes ----------------------------------------------------------- */
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/* Public macros ------------------------------------------------------ */
+#define xSemaphoreGive(sem)             xQueueSend((QueueHandle_t)(sem), NULL, 0)
+#define xSemaphoreTake(sem, ticks)      xQueueReceive((QueueHandle_t)(sem), NULL, (ticks))
+#define vSemaphoreDelete(sem)           vQueueDelete((QueueHandle_t)(sem))
+
+/* Public function prototypes ----------------------------------------- */
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer);
+
+#endif // __SEMPHR_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,30 @@
+/**
+ * @file       task.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for freertos/task.h
+ * @note       Types come from FreeRTOS.h, the calls are implemented by freertos_host.c
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __TASK_H
+#define __TASK_H
+
+/* Includes ----------------------------------------------------------- */
+#include "freertos/FreeRTOS.h"
+
+/* Public enumerate/structure ----------------------------------------- */
+typedef void (*TaskFunction_t)(void *param);
+
+/* Public function prototypes ----------------------------------------- */
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#endif // __TASK_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,52 @@
+/**
+ * @file       platform_common.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for components/platform/platform_common.h
+ * @note       The C library, FreeRTOS and IDF headers the BSP sources use on the host,
+ *             without the Wi-Fi, NVS and SPIFFS ones. Keep in step with the original.
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __PLATFORM_COMMON_H
+#define __PLATFORM_COMMON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ----------------------------------------------------------- */
+// C library
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// FreeRTOS
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+// ESP32
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+
+/* Public defines ----------------------------------------------------- */
+#define HI_UINT16(a) (((a) >> 8) & 0xFF)
+#define LO_UINT16(a) ((a) & 0xFF)
+
+/* -------------------------------------------------------------------------- */
+#ifdef __cplusplus
+} // extern "C" {
+#endif
+
+#endif // __PLATFORM_COMMON_H
+
+/* End of file -------------------------------------------------------- */
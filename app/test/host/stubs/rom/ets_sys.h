@@ -0,0 +1,25 @@
+/**
+ * @file       ets_sys.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host stand-in for rom/ets_sys.h
+ * @note       None
+ * @example    None
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __ETS_SYS_H
+#define __ETS_SYS_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+
+/* Public function prototypes ----------------------------------------- */
+void ets_delay_us(uint32_t us);
+
+#endif // __ETS_SYS_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,276 @@
+/**
+ * @file       test_fixconv.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of the fixed point conversion kernels
+ * @note       Every kernel is swept over its codes against the floating point formula
+ *             the drivers used before, the worst error is reported in the output
+ *             unit. The batch kernels and their float references are then timed in
+ *             nanoseconds and, on x86, in cycles per sample.
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <math.h>
+#include <stdbool.h>
+#include "test_host.h"
+#include "fixconv.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_PAC1934_FSC_MA             (25000)   // 100 mV over 4 mOhm
+#define TEST_BENCH_SAMPLES              (4096)
+#define TEST_BENCH_ROUNDS               (2000)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Benchmark result
+ */
+typedef struct
+{
+  double ns;                // Per sample
+  double cycles;            // Per sample, 0 without a cycle counter
+}
+test_cost_t;
+
+/* Private variables -------------------------------------------------- */
+static const double m_test_gyro_sens[4] = { 131.0, 65.5, 32.8, 16.4 };
+
+static int16_t m_test_raw[TEST_BENCH_SAMPLES];
+static uint16_t m_test_code[TEST_BENCH_SAMPLES];
+static int32_t m_test_mdps[TEST_BENCH_SAMPLES];
+static uint32_t m_test_out[TEST_BENCH_SAMPLES];
+static float m_test_float[TEST_BENCH_SAMPLES];
+
+/* Private function prototypes ---------------------------------------- */
+static void m_test_max(double *max, double value, double ref);
+static void m_test_report(const char *name, test_cost_t fix, test_cost_t ref);
+static test_cost_t m_test_gyro_fix(void);
+static test_cost_t m_test_gyro_float(void);
+static test_cost_t m_test_vsense_fix(void);
+static test_cost_t m_test_vsense_float(void);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  double err;
+  double ref;
+  uint32_t code;
+  bool same;
+
+  // IAM20380 rate, every code at every full scale
+  for (uint8_t fs = 0; fs < 4; fs++)
+  {
+    err = 0;
+    for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++)
+      m_test_max(&err, fixconv_iam20380_rate_mdps((int16_t)raw, fs), raw * 1000.0 / m_test_gyro_sens[fs]);
+    printf("iam20380 rate fs %u: max error %.3f mdps\n", fs, err);
+    TEST_CHECK(err < 1.0);
+  }
+
+  for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++)
+    m_test_raw[i] = (int16_t)(i * 16 - 32768);
+  fixconv_iam20380_rate_mdps_batch(m_test_raw, m_test_mdps, TEST_BENCH_SAMPLES, 2);
+  same = true;
+  for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++)
+    same = same && (m_test_mdps[i] == fixconv_iam20380_rate_mdps(m_test_raw[i], 2));
+  TEST_CHECK(same);
+
+  // DRV10975, exact scales first
+  TEST_CHECK(fixconv_drv10975_velocity_mhz(1500) == 150000);
+  TEST_CHECK(fixconv_drv10975_period_us(65535) == 655350);
+
+  err = 0;
+  for (code = 0; code <= 0xFF; code++)
+    m_test_max(&err, fixconv_drv10975_supply_mv((uint8_t)code), code * 22800.0 / 256.0);
+  printf("drv10975 supply: max error %.3f mV\n", err);
+  TEST_CHECK(err <= 0.5);
+
+  err = 0;
+  for (code = 0x3FF; code <= 0x7FF; code++)
+    m_test_max(&err, fixconv_drv10975_current_ma((uint16_t)code), (code - 0x3FF) * 3000.0 / 2048.0);
+  printf("drv10975 current: max error %.3f mA\n", err);
+  TEST_CHECK(err <= 0.5);
+  TEST_CHECK(fixconv_drv10975_current_ma(0x100) == 0);
+
+  err = 0;
+  for (code = 0; code <= 0x7FF; code++)
+    m_test_max(&err, fixconv_drv10975_kt_uv_hz((uint16_t)code), code * 1000000.0 / 2180.0);
+  printf("drv10975 kt: max error %.3f uV/Hz\n", err);
+  TEST_CHECK(err <= 0.5);
+
+  // PAC1934, every code, negative codes give their magnitude
+  err = 0;
+  for (code = 0; code <= 0xFFFF; code++)
+  {
+    ref = (code >= 0x8000) ? (0x10000 - code) * 32000.0 / 0xFFFF : code * 32000.0 / 0x7FFF;
+    m_test_max(&err, fixconv_pac1934_vbus_mv((uint16_t)code), ref);
+  }
+  printf("pac1934 vbus: max error %.3f mV\n", err);
+  TEST_CHECK(err <= 0.5);
+
+  err = 0;
+  for (code = 0; code <= 0xFFFF; code++)
+  {
+    ref = (code >= 0x8000) ? (0x10000 - code) * (double)TEST_PAC1934_FSC_MA / 0xFFFF : code * (double)TEST_PAC1934_FSC_MA / 0x7FFF;
+    m_test_max(&err, fixconv_pac1934_vsense_ma((uint16_t)code, TEST_PAC1934_FSC_MA), ref);
+  }
+  printf("pac1934 vsense: max error %.3f mA\n", err);
+  TEST_CHECK(err <= 0.5);
+
+  err = 0;
+  for (uint64_t c = 0; c <= 0xFFFFFFFFu; c += 65521)
+  {
+    ref = (c >= 0x80000000u) ? (0x100000000ULL - c) * (TEST_PAC1934_FSC_MA * 32.0) / 0xFFFFFFF0u :
+                               c * (TEST_PAC1934_FSC_MA * 32.0) / 0x7FFFFFF0u;
+    m_test_max(&err, fixconv_pac1934_vpower_mw((uint32_t)c, TEST_PAC1934_FSC_MA), ref);
+  }
+  printf("pac1934 vpower: max error %.3f mW\n", err);
+  TEST_CHECK(err <= 0.51);  // Divisors taken as powers of two, 4 ppb of 800 W on top of the rounding
+
+  // One second at full scale power, 25 A x 32 V
+  TEST_CHECK(fixconv_pac1934_energy_uj((int64_t)1024 << 27, TEST_PAC1934_FSC_MA, 1024) == 800000000);
+  TEST_CHECK(fixconv_pac1934_energy_uj(-((int64_t)1024 << 27), TEST_PAC1934_FSC_MA, 1024) == -800000000);
+
+  // PCF85063 BCD
+  same = true;
+  for (uint8_t bin = 0; bin < 100; bin++)
+    same = same && (fixconv_bcd_to_bin(fixconv_bin_to_bcd(bin)) == bin) && (fixconv_bin_to_bcd(bin) == (((bin / 10) << 4) | (bin % 10)));
+  TEST_CHECK(same);
+
+  // Cost of the batch kernels against the float code they replace
+  for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++)
+    m_test_code[i] = (uint16_t)(i * 16);
+  m_test_report("iam20380 rate", m_test_gyro_fix(), m_test_gyro_float());
+  m_test_report("pac1934 vsense", m_test_vsense_fix(), m_test_vsense_float());
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+static void m_test_max(double *max, double value, double ref)
+{
+  double err = fabs(value - ref);
+
+  if (err > *max)
+    *max = err;
+}
+
+static void m_test_report(const char *name, test_cost_t fix, test_cost_t ref)
+{
+  if (TEST_HAVE_CYCLES)
+    printf("%-16s fixed %5.2f ns %5.2f cycles, float %5.2f ns %5.2f cycles per sample\n", name, fix.ns, fix.cycles, ref.ns, ref.cycles);
+  else
+    printf("%-16s fixed %5.2f ns, float %5.2f ns per sample\n", name, fix.ns, ref.ns);
+}
+
+/**
+ * @brief         Time the batch gyro kernel
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Cost per sample
+ */
+static test_cost_t m_test_gyro_fix(void)
+{
+  uint64_t start_ns = test_now_ns();
+  uint64_t start_cy = test_cycles();
+  uint32_t n = TEST_BENCH_SAMPLES * TEST_BENCH_ROUNDS;
+
+  for (uint32_t r = 0; r < TEST_BENCH_ROUNDS; r++)
+  {
+    fixconv_iam20380_rate_mdps_batch(m_test_raw, m_test_mdps, TEST_BENCH_SAMPLES, (uint8_t)(r & 3));
+    __asm__ volatile("" : : "g"(m_test_mdps) : "memory");
+  }
+
+  return (test_cost_t){ (double)(test_now_ns() - start_ns) / n, (double)(test_cycles() - start_cy) / n };
+}
+
+/**
+ * @brief         Time the former float gyro conversion
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Cost per sample
+ */
+static test_cost_t m_test_gyro_float(void)
+{
+  uint64_t start_ns = test_now_ns();
+  uint64_t start_cy = test_cycles();
+  uint32_t n = TEST_BENCH_SAMPLES * TEST_BENCH_ROUNDS;
+  float sens;
+
+  for (uint32_t r = 0; r < TEST_BENCH_ROUNDS; r++)
+  {
+    sens = (float)m_test_gyro_sens[r & 3];
+    for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++)
+      m_test_float[i] = (float)m_test_raw[i] / sens;
+    __asm__ volatile("" : : "g"(m_test_float) : "memory");
+  }
+
+  return (test_cost_t){ (double)(test_now_ns() - start_ns) / n, (double)(test_cycles() - start_cy) / n };
+}
+
+/**
+ * @brief         Time the batch current kernel
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Cost per sample
+ */
+static test_cost_t m_test_vsense_fix(void)
+{
+  uint64_t start_ns = test_now_ns();
+  uint64_t start_cy = test_cycles();
+  uint32_t n = TEST_BENCH_SAMPLES * TEST_BENCH_ROUNDS;
+
+  for (uint32_t r = 0; r < TEST_BENCH_ROUNDS; r++)
+  {
+    fixconv_pac1934_vsense_ma_batch(m_test_code, m_test_out, TEST_BENCH_SAMPLES, TEST_PAC1934_FSC_MA);
+    __asm__ volatile("" : : "g"(m_test_out) : "memory");
+  }
+
+  return (test_cost_t){ (double)(test_now_ns() - start_ns) / n, (double)(test_cycles() - start_cy) / n };
+}
+
+/**
+ * @brief         Time the former double current conversion
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Cost per sample
+ */
+static test_cost_t m_test_vsense_float(void)
+{
+  uint64_t start_ns = test_now_ns();
+  uint64_t start_cy = test_cycles();
+  uint32_t n = TEST_BENCH_SAMPLES * TEST_BENCH_ROUNDS;
+  uint16_t code;
+
+  for (uint32_t r = 0; r < TEST_BENCH_ROUNDS; r++)
+  {
+    for (uint32_t i = 0; i < TEST_BENCH_SAMPLES; i++)
+    {
+      code = m_test_code[i];
+      if (code >= 0x8000)
+        m_test_float[i] = (float)((TEST_PAC1934_FSC_MA * (double)(uint16_t)(0x10000 - code)) / 0xFFFF);
+      else
+        m_test_float[i] = (float)((TEST_PAC1934_FSC_MA * (double)code) / 0x7FFF);
+    }
+    __asm__ volatile("" : : "g"(m_test_float) : "memory");
+  }
+
+  return (test_cost_t){ (double)(test_now_ns() - start_ns) / n, (double)(test_cycles() - start_cy) / n };
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,97 @@
+/**
+ * @file       test_host.h
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test checks and timing
+ * @note       One test program per file, main() returns test_result()
+ * @example    TEST_CHECK(value == 3);
+ *             return test_result();
+ */
+
+/* Define to prevent recursive inclusion ------------------------------ */
+#ifndef __TEST_HOST_H
+#define __TEST_HOST_H
+
+/* Includes ----------------------------------------------------------- */
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Private variables -------------------------------------------------- */
+static int m_test_checks;
+static int m_test_failures;
+
+/* Public macros ------------------------------------------------------ */
+#define TEST_CHECK(expr)                                                      \
+  do {                                                                        \
+    m_test_checks++;                                                          \
+    if (!(expr)) {                                                            \
+      m_test_failures++;                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr); \
+    }                                                                         \
+  } while (0)
+
+/* Public function prototypes ----------------------------------------- */
+/**
+ * @brief         Monotonic time for the benchmarks
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Time in nanosecond
+ */
+static inline uint64_t test_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief         CPU cycle counter for the benchmarks
+ *
+ * @param[in]     None
+ *
+ * @attention     Time stamp counter on x86, TEST_HAVE_CYCLES is 0 and this returns 0 elsewhere
+ *
+ * @return        Cycles
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define TEST_HAVE_CYCLES                (1)
+static inline uint64_t test_cycles(void)
+{
+  return __builtin_ia32_rdtsc();
+}
+#else
+#define TEST_HAVE_CYCLES                (0)
+static inline uint64_t test_cycles(void)
+{
+  return 0;
+}
+#endif
+
+/**
+ * @brief         Print the summary of the checks
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Exit code, 0 when every check passed
+ */
+static inline int test_result(void)
+{
+  printf("%d checks, %d failed\n", m_test_checks, m_test_failures);
+
+  return (m_test_failures == 0) ? 0 : 1;
+}
+
+#endif // __TEST_HOST_H
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,202 @@
+/**
+ * @file       test_i2c_bus.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of i2c_bus over the legacy IDF command links
+ * @note       Runs the bus against the model of the driver before v4.4, where every
+ *             command of a link comes from the heap. Checks that the static mode reuses
+ *             its links with no allocation in steady state, that the transactions it
+ *             puts on the bus are the same as the heap links, and that a register read
+ *             is one transaction joined by a repeated START.
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <string.h>
+#include "test_host.h"
+#include "i2c_legacy.h"
+#include "i2c_bus.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_SLAVE_ADDR                 (0x3C << 1)
+#define TEST_CYCLES                     (1000)
+#define TEST_LONG_LEN                   (300)     // Over one command, needs a heap link
+
+/* Private variables -------------------------------------------------- */
+static i2c_config_t m_test_conf =
+{
+  .mode             = I2C_MODE_MASTER,
+  .sda_io_num       = 21,
+  .scl_io_num       = 22,
+  .master.clk_speed = 400000
+};
+
+/* Private function prototypes ---------------------------------------- */
+static bool m_test_traffic(i2c_bus_handle_t bus);
+static void m_test_read_is_combined(i2c_bus_handle_t bus);
+static void m_test_bench(const char *name, i2c_bus_handle_t bus);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  i2c_bus_handle_t stat;
+  i2c_bus_handle_t dyn;
+  uint8_t buf[TEST_LONG_LEN];
+  uint8_t reg = 0;
+  uint32_t allocs;
+  uint32_t heap;
+  bool ok;
+
+  i2c_legacy_set_slave(TEST_SLAVE_ADDR);
+
+  stat = i2c_bus_create_with_mode(I2C_NUM_0, &m_test_conf, I2C_BUS_CMD_LINK_STATIC);
+  dyn  = i2c_bus_create(I2C_NUM_1, &m_test_conf);
+  TEST_CHECK((stat != NULL) && (dyn != NULL));
+
+  // Static mode, every transaction shape on the reused links, nothing allocated
+  allocs = i2c_bus_get_alloc_count(stat);
+  heap   = i2c_legacy_get_allocs();
+  ok     = true;
+  for (int i = 0; i < TEST_CYCLES; i++)
+    ok = ok && m_test_traffic(stat);
+  printf("static: %u link allocations, %u heap nodes in %u cycles\n",
+         i2c_bus_get_alloc_count(stat) - allocs, i2c_legacy_get_allocs() - heap, TEST_CYCLES);
+  TEST_CHECK(ok);
+  TEST_CHECK(i2c_bus_get_alloc_count(stat) == allocs);
+  TEST_CHECK(i2c_legacy_get_allocs() == heap);
+
+  // Heap links for comparison, same traffic
+  allocs = i2c_bus_get_alloc_count(dyn);
+  heap   = i2c_legacy_get_allocs();
+  ok     = true;
+  for (int i = 0; i < TEST_CYCLES; i++)
+    ok = ok && m_test_traffic(dyn);
+  printf("dynamic: %u link allocations, %u heap nodes in %u cycles\n",
+         i2c_bus_get_alloc_count(dyn) - allocs, i2c_legacy_get_allocs() - heap, TEST_CYCLES);
+  TEST_CHECK(ok);
+  TEST_CHECK(i2c_bus_get_alloc_count(dyn) - allocs == 4 * TEST_CYCLES);
+
+  // Longer than one command, a heap link once, then back on the reused ones
+  allocs = i2c_bus_get_alloc_count(stat);
+  for (int i = 0; i < TEST_LONG_LEN; i++)
+    i2c_legacy_get_regs()[i & 0xFF] = (uint8_t)i;
+  TEST_CHECK(ESP_OK == i2c_bus_read_bytes(stat, TEST_SLAVE_ADDR, &reg, 1, buf, TEST_LONG_LEN));
+  TEST_CHECK((buf[0] == 0) && (buf[255] == 255) && (buf[256] == 0) && (buf[TEST_LONG_LEN - 1] == (uint8_t)(TEST_LONG_LEN - 1)));
+  TEST_CHECK(i2c_bus_get_alloc_count(stat) == allocs + 1);
+  TEST_CHECK(m_test_traffic(stat));
+  TEST_CHECK(i2c_bus_get_alloc_count(stat) == allocs + 1);
+
+  // A slave that does not answer fails the call and leaves the links usable
+  TEST_CHECK(ESP_OK != i2c_bus_read_bytes(stat, TEST_SLAVE_ADDR + 2, &reg, 1, buf, 2));
+  TEST_CHECK(m_test_traffic(stat));
+
+  m_test_read_is_combined(stat);
+  m_test_read_is_combined(dyn);
+
+  m_test_bench("static", stat);
+  m_test_bench("dynamic", dyn);
+
+  TEST_CHECK(ESP_OK == i2c_bus_delete(stat));
+  TEST_CHECK(ESP_OK == i2c_bus_delete(dyn));
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         One of each transaction shape, checked against the slave registers
+ *
+ * @param[in]     bus       I2C bus handle
+ *
+ * @attention     None
+ *
+ * @return        All transactions done with the expected data
+ */
+static bool m_test_traffic(i2c_bus_handle_t bus)
+{
+  static uint8_t seed;
+  uint8_t *regs = i2c_legacy_get_regs();
+  uint8_t reg   = 0x20;
+  uint8_t out[6];
+  uint8_t in[6];
+  uint8_t raw[3];
+  uint8_t inv;
+  bool ok = true;
+
+  seed += 7;
+  inv   = (uint8_t)~seed;
+  for (int i = 0; i < 6; i++)
+    out[i] = (uint8_t)(seed + i);
+
+  ok = ok && (ESP_OK == i2c_bus_write_bytes(bus, TEST_SLAVE_ADDR, &reg, 1, out, sizeof(out)));
+  ok = ok && (memcmp(&regs[0x20], out, sizeof(out)) == 0);
+
+  raw[0] = 0x30;
+  raw[1] = seed;
+  raw[2] = inv;
+  ok = ok && (ESP_OK == i2c_bus_write_data(bus, TEST_SLAVE_ADDR, raw, sizeof(raw)));
+  ok = ok && (regs[0x30] == seed) && (regs[0x31] == inv);
+
+  ok = ok && (ESP_OK == i2c_bus_read_bytes(bus, TEST_SLAVE_ADDR, &reg, 1, in, sizeof(in)));
+  ok = ok && (memcmp(in, out, sizeof(out)) == 0);
+
+  reg = 0x31;
+  ok = ok && (ESP_OK == i2c_bus_read_bytes(bus, TEST_SLAVE_ADDR, &reg, 1, in, 1));
+  ok = ok && (in[0] == inv);
+
+  return ok;
+}
+
+/**
+ * @brief         Register read, address write and data read in one transaction
+ *
+ * @param[in]     bus       I2C bus handle
+ *
+ * @attention     No STOP before the repeated START, the slave keeps its register pointer
+ *
+ * @return        None
+ */
+static void m_test_read_is_combined(i2c_bus_handle_t bus)
+{
+  uint8_t *regs = i2c_legacy_get_regs();
+  uint8_t reg   = 0x10;
+  uint8_t in[2];
+  uint32_t transactions;
+
+  regs[0x10] = 0xA5;
+  regs[0x11] = 0x5A;
+
+  transactions = i2c_legacy_get_transactions();
+  TEST_CHECK(ESP_OK == i2c_bus_read_bytes(bus, TEST_SLAVE_ADDR, &reg, 1, in, sizeof(in)));
+  TEST_CHECK(i2c_legacy_get_transactions() == transactions + 1);
+  TEST_CHECK(strcmp(i2c_legacy_get_log(), "S w78 w10 S w79 rA5 r5A P") == 0);
+  TEST_CHECK((in[0] == 0xA5) && (in[1] == 0x5A));
+}
+
+/**
+ * @brief         Host cost of a register read
+ *
+ * @param[in]     name      Label
+ * @param[in]     bus       I2C bus handle
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_bench(const char *name, i2c_bus_handle_t bus)
+{
+  uint8_t reg = 0;
+  uint8_t in[6];
+  uint64_t start_ns;
+  uint32_t n = 200000;
+
+  start_ns = test_now_ns();
+  for (uint32_t i = 0; i < n; i++)
+    i2c_bus_read_bytes(bus, TEST_SLAVE_ADDR, &reg, 1, in, sizeof(in));
+  printf("%-8s i2c_bus_read_bytes %.1f ns per call\n", name, (double)(test_now_ns() - start_ns) / n);
+}
+
+/* End of file -------------------------------------------------------- */
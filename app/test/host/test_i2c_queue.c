@@ -0,0 +1,410 @@
+/**
+ * @file       test_i2c_queue.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host benchmark of the synchronous and asynchronous I2C paths of bsp_i2c
+ * @note       bsp_i2c is built with BSP_I2C_USE_SIM and runs its bus task on the FreeRTOS
+ *             model. Time is the virtual bus clock, it only moves with bus traffic, so
+ *             blocked time and latencies are in bus microseconds while host ns is the
+ *             software cost of each path on the host.
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "test_host.h"
+#include "freertos_host.h"
+#include "bsp_i2c.h"
+#include "i2c_sim.h"
+#include "pac1934.h"
+#include "iam20380.h"
+#include "drv10975.h"
+#include "pcf85063.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_MAIN_PRIORITY              (5)     // Application task, below the bus task
+#define TEST_HIGH_PRIORITY              (12)    // Above the bus task, as the speed loop
+#define TEST_BATCH                      (16)    // Transfers per batch, one class queue
+#define TEST_XFERS                      (TEST_BATCH * 1250)
+#define TEST_BURST_PER_CLASS            (4)     // A mixed burst fits in a single queue
+#define TEST_BURST_ROUNDS               (250)
+
+#define TEST_DRV10975_REG_MOTOR_SPEED1  (0x11)
+#define TEST_IAM20380_REG_GYRO_XOUT_H   (0x43)
+#define TEST_PAC1934_REG_VBUS1          (0x07)
+#define TEST_PCF85063_REG_SECONDS       (0x04)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Bus client of the benchmark, one per priority class
+ */
+typedef struct
+{
+  const char *name;
+  uint8_t slave_addr;
+  uint8_t reg_addr;
+  uint32_t len;
+  bsp_i2c_class_t class;
+}
+test_client_t;
+
+/**
+ * @brief Completion latency of a client
+ */
+typedef struct
+{
+  uint32_t count;
+  uint32_t errors;
+  uint64_t total_us;
+  uint32_t max_us;
+}
+test_latency_t;
+
+/**
+ * @brief Result of a streaming run
+ */
+typedef struct
+{
+  uint32_t errors;
+  uint64_t blocked_us;  // Caller time spent in the submitting calls
+  uint64_t bus_us;      // Virtual time of the whole run
+  uint64_t host_ns;
+}
+test_stream_t;
+
+/* Private variables -------------------------------------------------- */
+static const test_client_t m_test_client[BSP_I2C_CLASS_MAX] =
+{
+  { "motor", DRV10975_I2C_ADDR, TEST_DRV10975_REG_MOTOR_SPEED1, 2,  BSP_I2C_CLASS_MOTOR },
+  { "gyro",  IAM20380_I2C_ADDR, TEST_IAM20380_REG_GYRO_XOUT_H,  6,  BSP_I2C_CLASS_GYRO  },
+  { "pm",    PAC1934_I2C_ADDR,  TEST_PAC1934_REG_VBUS1,         16, BSP_I2C_CLASS_PM    },
+  { "rtc",   PCF85063_I2C_ADDR, TEST_PCF85063_REG_SECONDS,      7,  BSP_I2C_CLASS_RTC   }
+};
+
+static SemaphoreHandle_t m_test_go;       // Releases the high priority task
+static SemaphoreHandle_t m_test_idle;     // High priority task finished its job
+static SemaphoreHandle_t m_test_done;     // One give per completed asynchronous transfer
+static void (*m_test_job)(void);
+
+static uint8_t m_test_buf[BSP_I2C_CLASS_MAX][TEST_BURST_PER_CLASS][16];
+static bool m_test_async;
+static test_stream_t m_test_stream;
+static test_latency_t m_test_latency[BSP_I2C_CLASS_MAX];
+static uint64_t m_test_round_us;          // Submission time of the burst in flight
+static uint32_t m_test_errors;            // Asynchronous transfers completed with an error
+
+/* Private function prototypes ---------------------------------------- */
+static void m_test_high_task(void *param);
+static void m_test_run_high(void (*job)(void));
+static void m_test_stream_job(void);
+static void m_test_burst_job(void);
+static void m_test_xfer_done(int result, void *arg);
+static void m_test_burst_done(int result, void *arg);
+static void m_test_stream_run(const char *name, bool async, bool high);
+static void m_test_burst_run(const char *name, bool fifo);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  TaskHandle_t high;
+
+  freertos_host_init(TEST_MAIN_PRIORITY);
+
+  TEST_CHECK(ESP_OK == bsp_i2c_init());
+
+  // bsp_i2c hands esp_timer_get_time() to the sim, which reads the sim itself here
+  i2c_sim_set_time_source(NULL);
+
+  for (int i = 0; i < BSP_I2C_CLASS_MAX; i++)
+    bsp_i2c_register_client(m_test_client[i].slave_addr, m_test_client[i].class);
+
+  m_test_go   = xSemaphoreCreateBinary();
+  m_test_idle = xSemaphoreCreateBinary();
+  m_test_done = xSemaphoreCreateCounting(TEST_BATCH * BSP_I2C_CLASS_MAX, 0);
+  TEST_CHECK(pdPASS == xTaskCreate(&m_test_high_task, "Test task", 2048, NULL, TEST_HIGH_PRIORITY, &high));
+
+  // One client streaming gyro reads, the bus is the limit in bus time either way
+  printf("%-24s %10s %10s %10s %10s\n", "path", "bus us", "blocked us", "xfer/s", "host ns");
+  m_test_stream_run("sync, caller below", false, false);
+  m_test_stream_run("async, caller below", true, false);
+  m_test_stream_run("sync, caller above", false, true);
+  m_test_stream_run("async, caller above", true, true);
+
+  // Mixed bursts, completion latency of each client from the burst submission
+  printf("%-24s %6s %10s %10s\n", "burst", "client", "avg us", "max us");
+  m_test_burst_run("priority classes", false);
+  m_test_burst_run("single fifo", true);
+
+  printf("%u context switches\n", freertos_host_get_switches());
+
+  return test_result();
+}
+
+int64_t esp_timer_get_time(void)
+{
+  return (int64_t)i2c_sim_get_time_us();
+}
+
+void ets_delay_us(uint32_t us)
+{
+  i2c_sim_advance_us(us);
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Task above the bus task priority, runs one job per release
+ *
+ * @param[in]     param   Not used
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_high_task(void *param)
+{
+  (void)param;
+
+  while (1)
+  {
+    xSemaphoreTake(m_test_go, portMAX_DELAY);
+    m_test_job();
+    xSemaphoreGive(m_test_idle);
+  }
+}
+
+/**
+ * @brief         Run a job in the high priority task and wait for it
+ *
+ * @param[in]     job     Job
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_run_high(void (*job)(void))
+{
+  m_test_job = job;
+  xSemaphoreGive(m_test_go);
+  xSemaphoreTake(m_test_idle, portMAX_DELAY);
+}
+
+/**
+ * @brief         Stream gyro reads in batches of one queue length
+ *
+ * @param[in]     None
+ *
+ * @attention     Asynchronous batches are submitted in one go, then collected
+ *
+ * @return        None
+ */
+static void m_test_stream_job(void)
+{
+  const test_client_t *client = &m_test_client[BSP_I2C_CLASS_GYRO];
+  uint64_t start_us = esp_timer_get_time();
+  uint64_t start_ns = test_now_ns();
+  uint64_t call_us;
+
+  m_test_errors = 0;
+  memset(&m_test_stream, 0, sizeof(m_test_stream));
+
+  for (int batch = 0; batch < TEST_XFERS / TEST_BATCH; batch++)
+  {
+    for (int i = 0; i < TEST_BATCH; i++)
+    {
+      call_us = esp_timer_get_time();
+
+      if (m_test_async)
+      {
+        if (0 != bsp_i2c_read_async(client->slave_addr, client->reg_addr, m_test_buf[0][i % TEST_BURST_PER_CLASS],
+                                    client->len, m_test_xfer_done, NULL))
+          m_test_stream.errors++;
+      }
+      else if (0 != bsp_i2c_read(client->slave_addr, client->reg_addr, m_test_buf[0][0], client->len))
+      {
+        m_test_stream.errors++;
+      }
+
+      m_test_stream.blocked_us += esp_timer_get_time() - call_us;
+    }
+
+    if (m_test_async)
+    {
+      for (int i = 0; i < TEST_BATCH; i++)
+        xSemaphoreTake(m_test_done, portMAX_DELAY);
+    }
+  }
+
+  m_test_stream.errors += m_test_errors;
+  m_test_stream.bus_us  = esp_timer_get_time() - start_us;
+  m_test_stream.host_ns = test_now_ns() - start_ns;
+}
+
+/**
+ * @brief         Submit mixed bursts, the same number of reads for every client
+ *
+ * @param[in]     None
+ *
+ * @attention     Runs above the bus task, so the whole burst is queued before the
+ *                first transfer starts
+ *
+ * @return        None
+ */
+static void m_test_burst_job(void)
+{
+  const test_client_t *client;
+
+  for (int round = 0; round < TEST_BURST_ROUNDS; round++)
+  {
+    m_test_round_us = esp_timer_get_time();
+
+    for (int i = 0; i < TEST_BURST_PER_CLASS; i++)
+    {
+      for (int c = 0; c < BSP_I2C_CLASS_MAX; c++)
+      {
+        client = &m_test_client[c];
+        if (0 != bsp_i2c_read_async(client->slave_addr, client->reg_addr, m_test_buf[c][i], client->len,
+                                    m_test_burst_done, &m_test_latency[c]))
+          m_test_latency[c].errors++;
+      }
+    }
+
+    for (int i = 0; i < TEST_BURST_PER_CLASS * BSP_I2C_CLASS_MAX; i++)
+      xSemaphoreTake(m_test_done, portMAX_DELAY);
+  }
+}
+
+/**
+ * @brief         Completion of a streamed transfer
+ *
+ * @param[in]     result  Transfer result
+ * @param[in]     arg     Not used
+ *
+ * @attention     Runs in the bus task
+ *
+ * @return        None
+ */
+static void m_test_xfer_done(int result, void *arg)
+{
+  (void)arg;
+
+  if (result != 0)
+    m_test_errors++;
+
+  xSemaphoreGive(m_test_done);
+}
+
+/**
+ * @brief         Completion of a burst transfer, takes the latency from the burst start
+ *
+ * @param[in]     result  Transfer result
+ * @param[in]     arg     Pointer to latency of the client
+ *
+ * @attention     Runs in the bus task
+ *
+ * @return        None
+ */
+static void m_test_burst_done(int result, void *arg)
+{
+  test_latency_t *latency = (test_latency_t *)arg;
+  uint32_t us = (uint32_t)(esp_timer_get_time() - m_test_round_us);
+
+  latency->count++;
+  latency->total_us += us;
+  if (us > latency->max_us)
+    latency->max_us = us;
+  if (result != 0)
+    latency->errors++;
+
+  xSemaphoreGive(m_test_done);
+}
+
+/**
+ * @brief         Stream reads on one path and print its cost
+ *
+ * @param[in]     name    Row name
+ * @param[in]     async   Asynchronous path
+ * @param[in]     high    Caller above the bus task priority
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_stream_run(const char *name, bool async, bool high)
+{
+  double bus_us;
+  double blocked_us;
+
+  m_test_async = async;
+  if (high)
+    m_test_run_high(m_test_stream_job);
+  else
+    m_test_stream_job();
+
+  bus_us     = (double)m_test_stream.bus_us / TEST_XFERS;
+  blocked_us = (double)m_test_stream.blocked_us / TEST_XFERS;
+
+  printf("%-24s %10.1f %10.1f %10.0f %10.1f\n", name, bus_us, blocked_us,
+         TEST_XFERS * 1e9 / (double)m_test_stream.host_ns, (double)m_test_stream.host_ns / TEST_XFERS);
+
+  TEST_CHECK(m_test_stream.errors == 0);
+
+  // Synchronous calls and submissions that preempt into the bus task wait out the bus,
+  // a caller above the bus task only queues the request
+  if (async && high)
+    TEST_CHECK(m_test_stream.blocked_us == 0);
+  else
+    TEST_CHECK(m_test_stream.blocked_us == m_test_stream.bus_us);
+}
+
+/**
+ * @brief         Run the mixed bursts and print the latency of each client
+ *
+ * @param[in]     name    Row name
+ * @param[in]     fifo    All clients in one class, served in submission order
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_burst_run(const char *name, bool fifo)
+{
+  static uint32_t motor_max_us[2];
+  bsp_i2c_class_stats_t stats;
+
+  for (int c = 0; c < BSP_I2C_CLASS_MAX; c++)
+    bsp_i2c_register_client(m_test_client[c].slave_addr, fifo ? BSP_I2C_CLASS_RTC : m_test_client[c].class);
+
+  memset(m_test_latency, 0, sizeof(m_test_latency));
+  bsp_i2c_reset_class_stats();
+
+  m_test_run_high(m_test_burst_job);
+
+  for (int c = 0; c < BSP_I2C_CLASS_MAX; c++)
+  {
+    printf("%-24s %6s %10.1f %10u\n", (c == 0) ? name : "", m_test_client[c].name,
+           (double)m_test_latency[c].total_us / m_test_latency[c].count, m_test_latency[c].max_us);
+
+    TEST_CHECK(m_test_latency[c].count == TEST_BURST_ROUNDS * TEST_BURST_PER_CLASS);
+    TEST_CHECK(m_test_latency[c].errors == 0);
+
+    TEST_CHECK(0 == bsp_i2c_get_class_stats(m_test_client[c].class, &stats));
+    if (!fifo)
+    {
+      TEST_CHECK(stats.count == TEST_BURST_ROUNDS * TEST_BURST_PER_CLASS);
+
+      // Each class waits for every transfer of the classes above it
+      if (c > 0)
+        TEST_CHECK(m_test_latency[c].total_us > m_test_latency[c - 1].total_us);
+    }
+  }
+
+  motor_max_us[fifo ? 1 : 0] = m_test_latency[BSP_I2C_CLASS_MOTOR].max_us;
+
+  // The motor reads jump the queue only with the priority classes
+  if (fifo)
+    TEST_CHECK(motor_max_us[0] < motor_max_us[1]);
+}
+
+/* End of file -------------------------------------------------------- */
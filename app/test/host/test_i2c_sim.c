@@ -0,0 +1,235 @@
+/**
+ * @file       test_i2c_sim.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of the drivers against the virtual I2C bus
+ * @note       Brings up the four chips, checks the readings against the model
+ *             inputs and reports the bus traffic and host cost of the driver calls
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "test_host.h"
+#include "i2c_sim.h"
+#include "pac1934.h"
+#include "iam20380.h"
+#include "drv10975.h"
+#include "pcf85063.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_CLK_SPEED                  (400000)
+#define TEST_OVERHEAD_US                (30)    // Software cost per transaction on target
+#define TEST_BENCH_CALLS                (100000)
+
+/* Private variables -------------------------------------------------- */
+static pac1934_t m_pac =
+{
+  .device_address = PAC1934_I2C_ADDR,
+  .i2c_read       = i2c_sim_read,
+  .i2c_write      = i2c_sim_write,
+  .i2c_write_data = i2c_sim_write_data,
+  .delay_ms       = i2c_sim_delay_ms
+};
+
+static iam20380_t m_gyro =
+{
+  .device_address = IAM20380_I2C_ADDR,
+  .i2c_read       = i2c_sim_read,
+  .i2c_write      = i2c_sim_write,
+  .delay_ms       = i2c_sim_delay_ms,
+  .config         = { .digi_low_pass_filter = IAM20380_DLPF1_NBW177 }   // 1 kHz internal rate, as the model
+};
+
+static drv10975_t m_drv;
+
+static pcf85063_t m_rtc =
+{
+  .device_address = PCF85063_I2C_ADDR,
+  .i2c_read       = i2c_sim_read,
+  .i2c_write      = i2c_sim_write
+};
+
+/* Private function prototypes ---------------------------------------- */
+static uint32_t m_test_now_ms(void);
+static void m_test_gpio_write(uint8_t pin, uint8_t state);
+static void m_test_bench(const char *name, uint8_t slave_addr, base_status_t (*call)(void));
+static base_status_t m_test_pac_snapshot(void);
+static base_status_t m_test_gyro_sample(void);
+static base_status_t m_test_drv_velocity(void);
+static base_status_t m_test_rtc_time(void);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  pac1934_snapshot_t snap;
+  uint64_t epoch;
+  int fails;
+
+  i2c_sim_init(TEST_CLK_SPEED, TEST_OVERHEAD_US);
+
+  // PAC1934, channel 1 at 12 V and 2 A
+  i2c_sim_pac1934_set_channel(0, 12000, 2000);
+  TEST_CHECK(BS_OK == pac1934_init(&m_pac));
+  while (!pac1934_refresh_ready(&m_pac, m_test_now_ms()))
+    i2c_sim_delay_ms(1);
+  TEST_CHECK(BS_OK == pac1934_refresh_start(&m_pac, false, m_test_now_ms()));
+  TEST_CHECK(!pac1934_refresh_ready(&m_pac, m_test_now_ms()));
+  i2c_sim_delay_ms(2);
+  TEST_CHECK(pac1934_refresh_ready(&m_pac, m_test_now_ms()));
+  TEST_CHECK(BS_OK == pac1934_snapshot(&m_pac, i2c_sim_get_time_us(), &snap));
+  TEST_CHECK((snap.volt_mv[0] >= 11990) && (snap.volt_mv[0] <= 12010));
+  TEST_CHECK((snap.current_ma[0] >= 1990) && (snap.current_ma[0] <= 2010));
+
+  // IAM20380, 10 dps on X
+  i2c_sim_iam20380_set_rate(10000, -5000, 0);
+  TEST_CHECK(BS_OK == iam20380_init(&m_gyro));
+  i2c_sim_delay_ms(20);
+  TEST_CHECK(BS_OK == iam20380_get_gyro_angle(&m_gyro));
+  TEST_CHECK((m_gyro.data.rate.x > 9800) && (m_gyro.data.rate.x < 10200));
+  TEST_CHECK((m_gyro.data.rate.y > -5200) && (m_gyro.data.rate.y < -4800));
+  TEST_CHECK(m_gyro.data.sensitivity_x10 == 1310);
+
+  // 1000 periods of 1 ms at 10 dps, 10 degree
+  fails = 0;
+  for (int i = 1; i < 1000; i++)
+  {
+    i2c_sim_advance_us(1000);
+    if (BS_OK != iam20380_get_gyro_angle(&m_gyro))
+      fails++;
+  }
+  TEST_CHECK(fails == 0);
+  TEST_CHECK((m_gyro.data.angle.x > 9800) && (m_gyro.data.angle.x < 10200));
+  TEST_CHECK((m_gyro.data.angle.y > -5100) && (m_gyro.data.angle.y < -4900));
+
+  // DRV10975, EEPROM programmed once, rotor follows the command
+  m_drv.device_address = DRV10975_I2C_ADDR;
+  m_drv.i2c_read       = i2c_sim_read;
+  m_drv.i2c_write      = i2c_sim_write;
+  m_drv.delay_ms       = i2c_sim_delay_ms;
+  m_drv.gpio_write     = m_test_gpio_write;
+  TEST_CHECK(BS_OK == drv10975_init(&m_drv));
+  TEST_CHECK(BS_OK == drv10975_init(&m_drv));
+  TEST_CHECK(i2c_sim_drv10975_get_eeprom_writes() == 1);
+  TEST_CHECK(BS_OK == drv10975_set_motor_speed(&m_drv, 50));
+  i2c_sim_delay_ms(2000);
+  TEST_CHECK(BS_OK == drv10975_get_motor_velocity(&m_drv));
+  TEST_CHECK(BS_OK == drv10975_get_motor_supply_voltage(&m_drv));
+  TEST_CHECK(m_drv.value.velocity_mhz > 0);
+  TEST_CHECK((m_drv.value.supply_mv >= 11800) && (m_drv.value.supply_mv <= 12200));
+
+  // PCF85063, one day later
+  TEST_CHECK(BS_OK == pcf85063_init(&m_rtc));
+  TEST_CHECK(BS_OK == pcf85063_set_time(&m_rtc, 1700000000ULL));
+  i2c_sim_delay_ms(86400500);
+  TEST_CHECK(BS_OK == pcf85063_get_time(&m_rtc, &epoch));
+  TEST_CHECK(epoch == 1700000000ULL + 86400);
+
+  // Bus errors surface as driver errors
+  i2c_sim_inject_error(PAC1934_I2C_ADDR, 1);
+  TEST_CHECK(BS_OK != pac1934_snapshot(&m_pac, i2c_sim_get_time_us(), &snap));
+  TEST_CHECK(BS_OK == pac1934_snapshot(&m_pac, i2c_sim_get_time_us(), &snap));
+
+  printf("%-24s %8s %8s %10s %10s\n", "call", "reads", "writes", "bus us", "host ns");
+  m_test_bench("pac1934 snapshot", PAC1934_I2C_ADDR, m_test_pac_snapshot);
+  m_test_bench("iam20380 read sample", IAM20380_I2C_ADDR, m_test_gyro_sample);
+  m_test_bench("drv10975 velocity", DRV10975_I2C_ADDR, m_test_drv_velocity);
+  m_test_bench("pcf85063 get time", PCF85063_I2C_ADDR, m_test_rtc_time);
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Virtual bus time for the PAC1934 refresh schedule
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        Time in millisecond
+ */
+static uint32_t m_test_now_ms(void)
+{
+  return (uint32_t)(i2c_sim_get_time_us() / 1000);
+}
+
+/**
+ * @brief         Direction pin, not modelled
+ *
+ * @param[in]     pin       Pin
+ * @param[in]     state     Level
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_gpio_write(uint8_t pin, uint8_t state)
+{
+  (void)pin;
+  (void)state;
+}
+
+/**
+ * @brief         Run a driver call repeatedly, print its bus traffic and host cost per call
+ *
+ * @param[in]     name          Name printed
+ * @param[in]     slave_addr    Device the call talks to
+ * @param[in]     call          Driver call
+ *
+ * @attention     Bus time is the timing model at TEST_CLK_SPEED, host time is the
+ *                driver and model code only
+ *
+ * @return        None
+ */
+static void m_test_bench(const char *name, uint8_t slave_addr, base_status_t (*call)(void))
+{
+  i2c_sim_stats_t stats;
+  uint64_t start_ns;
+  uint64_t host_ns;
+  int errors = 0;
+
+  i2c_sim_reset_stats();
+
+  start_ns = test_now_ns();
+  for (int i = 0; i < TEST_BENCH_CALLS; i++)
+    errors += (BS_OK != call());
+  host_ns = test_now_ns() - start_ns;
+
+  TEST_CHECK(errors == 0);
+  TEST_CHECK(0 == i2c_sim_get_stats(slave_addr, &stats));
+
+  printf("%-24s %8.2f %8.2f %10.1f %10.1f\n", name,
+         (double)stats.reads / TEST_BENCH_CALLS, (double)stats.writes / TEST_BENCH_CALLS,
+         (double)stats.bus_us / TEST_BENCH_CALLS, (double)host_ns / TEST_BENCH_CALLS);
+}
+
+static base_status_t m_test_pac_snapshot(void)
+{
+  pac1934_snapshot_t snap;
+
+  return pac1934_snapshot(&m_pac, i2c_sim_get_time_us(), &snap);
+}
+
+static base_status_t m_test_gyro_sample(void)
+{
+  iam20380_sample_t sample;
+
+  return iam20380_read_sample(&m_gyro, i2c_sim_get_time_us(), &sample);
+}
+
+static base_status_t m_test_drv_velocity(void)
+{
+  return drv10975_get_motor_velocity(&m_drv);
+}
+
+static base_status_t m_test_rtc_time(void)
+{
+  uint64_t epoch;
+
+  return pcf85063_get_time(&m_rtc, &epoch);
+}
+
+/* End of file -------------------------------------------------------- */
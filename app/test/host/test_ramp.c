@@ -0,0 +1,231 @@
+/**
+ * @file       test_ramp.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of the pressure ramp and the blower curve
+ * @note       Steps the ramp at the 1 ms tick of sys_ramp in Q16 cmH2O, checks the
+ *             trajectory against the ideal line, the replans and the end points,
+ *             the curve against exact interpolation, and reports the host cost
+ *             of a tick and of a retarget.
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <math.h>
+#include "test_host.h"
+#include "ramp.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_Q16(_cmh2o)                ((int32_t)(_cmh2o) << 16)
+#define TEST_MIN_MS(_min)               ((uint32_t)(_min) * 60000)
+
+/* Private variables -------------------------------------------------- */
+// Config and blower curve of sys_ramp
+static const ramp_config_t m_test_cfg =
+{
+  .tick_ms = 1,
+  .min_ms  = 5000
+};
+
+static const ramp_point_t m_test_blower[] =
+{
+  { .x = TEST_Q16(0),  .y = 0      },
+  { .x = TEST_Q16(4),  .y = 120000 },
+  { .x = TEST_Q16(8),  .y = 169706 },
+  { .x = TEST_Q16(12), .y = 207846 },
+  { .x = TEST_Q16(16), .y = 240000 },
+  { .x = TEST_Q16(20), .y = 268328 },
+  { .x = TEST_Q16(24), .y = 293939 }
+};
+
+#define TEST_BLOWER_CNT                 (sizeof(m_test_blower) / sizeof(m_test_blower[0]))
+
+/* Private function prototypes ---------------------------------------- */
+static uint32_t m_test_finish(ramp_t *ramp);
+static double m_test_curve_ideal(int32_t x);
+static void m_test_bench(const ramp_curve_t *curve);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  ramp_t ramp;
+  ramp_curve_t curve;
+  double ideal;
+  double err;
+  double err_max;
+  int32_t prev;
+  int32_t value;
+  uint32_t n;
+  bool monotonic;
+
+  // 4 to 17 cmH2O over 30 min, on the ideal line and exactly on the target
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(4));
+  ramp_retarget(&ramp, TEST_Q16(17), TEST_MIN_MS(30));
+  err_max   = 0;
+  monotonic = true;
+  prev      = ramp.value;
+  n         = 0;
+  while (!ramp_done(&ramp))
+  {
+    value = ramp_step(&ramp);
+    n++;
+    ideal = TEST_Q16(4) + (double)(TEST_Q16(17) - TEST_Q16(4)) * n / TEST_MIN_MS(30);
+    err   = fabs(value - ideal);
+    if (err > err_max)
+      err_max = err;
+    if (value < prev)
+      monotonic = false;
+    prev = value;
+  }
+  printf("ramp: %u ticks, max error %.3f LSB\n", n, err_max);
+  TEST_CHECK(n == TEST_MIN_MS(30));
+  TEST_CHECK(ramp.value == TEST_Q16(17));
+  TEST_CHECK(err_max <= 1.0);
+  TEST_CHECK(monotonic);
+
+  // 17 to 12 cmH2O at 10 min, no jump and still done at 30 min
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(4));
+  ramp_retarget(&ramp, TEST_Q16(17), TEST_MIN_MS(30));
+  for (n = 0; n < TEST_MIN_MS(10); n++)
+    ramp_step(&ramp);
+  prev = ramp.value;
+  ramp_retarget(&ramp, TEST_Q16(12), TEST_MIN_MS(30));
+  value = ramp_step(&ramp);
+  n     = 1 + m_test_finish(&ramp);
+  printf("retarget: jump %d LSB, done at %u ms\n", value - prev, ramp.elapsed_ms);
+  TEST_CHECK((value - prev >= 0) && (value - prev <= (TEST_Q16(12) - prev) / (int32_t)TEST_MIN_MS(20) + 1));
+  TEST_CHECK(ramp.elapsed_ms == TEST_MIN_MS(30));
+  TEST_CHECK(ramp.value == TEST_Q16(12));
+
+  // Past the ramp time, slewed over the shortest replan
+  ramp_retarget(&ramp, TEST_Q16(15), TEST_MIN_MS(30));
+  n = m_test_finish(&ramp);
+  printf("late change: %u ms\n", n);
+  TEST_CHECK(n == m_test_cfg.min_ms);
+  TEST_CHECK(ramp.value == TEST_Q16(15));
+
+  // No ramp time
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(4));
+  ramp_retarget(&ramp, TEST_Q16(10), 0);
+  n = m_test_finish(&ramp);
+  printf("no ramp time: %u ms\n", n);
+  TEST_CHECK(n == m_test_cfg.min_ms);
+  TEST_CHECK(ramp.value == TEST_Q16(10));
+
+  // Down, to a target off the unit grid
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(20));
+  ramp_retarget(&ramp, TEST_Q16(4) + 123, 7777);
+  n = m_test_finish(&ramp);
+  TEST_CHECK(n == 7777);
+  TEST_CHECK(ramp.value == TEST_Q16(4) + 123);
+
+  // Stopped at 0 then a new prescription, as sys_ramp restarts the night
+  ramp_init(&ramp, &m_test_cfg, 0);
+  TEST_CHECK(ramp_done(&ramp) && (ramp_step(&ramp) == 0));
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(4));
+  ramp_retarget(&ramp, TEST_Q16(8), TEST_MIN_MS(1));
+  TEST_CHECK((ramp_step(&ramp) - TEST_Q16(4)) <= (TEST_Q16(4) / (int32_t)TEST_MIN_MS(1)) + 1);
+
+  // Blower curve
+  TEST_CHECK(!ramp_curve_init(&curve, m_test_blower, 1));
+  TEST_CHECK(ramp_curve_init(&curve, m_test_blower, TEST_BLOWER_CNT));
+  err_max = 0;
+  for (int32_t x = 0; x <= TEST_Q16(24); x += 97)
+  {
+    err = fabs(ramp_curve_eval(&curve, x) - m_test_curve_ideal(x));
+    if (err > err_max)
+      err_max = err;
+  }
+  printf("curve: max error %.3f mHz\n", err_max);
+  TEST_CHECK(err_max < 4.0);
+  TEST_CHECK(ramp_curve_eval(&curve, TEST_Q16(4)) == 120000);
+  TEST_CHECK(ramp_curve_eval(&curve, -1) == 0);
+  TEST_CHECK(ramp_curve_eval(&curve, TEST_Q16(30)) == 293939);
+
+  m_test_bench(&curve);
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Step the ramp to its target
+ *
+ * @param[in]     ramp      Pointer to handle of ramp
+ *
+ * @attention     None
+ *
+ * @return        Number of ticks
+ */
+static uint32_t m_test_finish(ramp_t *ramp)
+{
+  uint32_t n = 0;
+
+  while (!ramp_done(ramp))
+  {
+    ramp_step(ramp);
+    n++;
+  }
+
+  return n;
+}
+
+/**
+ * @brief         Blower curve by exact interpolation
+ *
+ * @param[in]     x         Pressure in Q16 cmH2O, inside the table
+ *
+ * @attention     None
+ *
+ * @return        Speed in millihertz
+ */
+static double m_test_curve_ideal(int32_t x)
+{
+  uint32_t i = 0;
+
+  while ((i + 2 < TEST_BLOWER_CNT) && (x > m_test_blower[i + 1].x))
+    i++;
+
+  return m_test_blower[i].y + (double)(m_test_blower[i + 1].y - m_test_blower[i].y) *
+         (x - m_test_blower[i].x) / (m_test_blower[i + 1].x - m_test_blower[i].x);
+}
+
+/**
+ * @brief         Host cost of a tick, step and curve, and of a retarget
+ *
+ * @param[in]     curve     Pointer to handle of curve
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_bench(const ramp_curve_t *curve)
+{
+  ramp_t ramp;
+  volatile int64_t sink = 0;
+  uint64_t start_ns;
+  uint32_t n = TEST_MIN_MS(45);
+
+  ramp_init(&ramp, &m_test_cfg, TEST_Q16(4));
+  ramp_retarget(&ramp, TEST_Q16(20), TEST_MIN_MS(45));
+
+  start_ns = test_now_ns();
+  for (uint32_t i = 0; i < n; i++)
+    sink += ramp_curve_eval(curve, ramp_step(&ramp));
+  printf("ramp_step and ramp_curve_eval %.1f ns per tick\n", (double)(test_now_ns() - start_ns) / n);
+
+  n = 1000000;
+  start_ns = test_now_ns();
+  for (uint32_t i = 0; i < n; i++)
+  {
+    ramp_retarget(&ramp, TEST_Q16(4 + (i & 15)), TEST_MIN_MS(45));
+    sink += ramp.inc;
+  }
+  printf("ramp_retarget %.1f ns per call\n", (double)(test_now_ns() - start_ns) / n);
+  (void)sink;
+}
+
+/* End of file -------------------------------------------------------- */
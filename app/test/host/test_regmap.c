@@ -0,0 +1,276 @@
+/**
+ * @file       test_regmap.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of the register map field and group helpers
+ * @note       Runs against a plain register file that counts transactions,
+ *             then against the PAC1934 model on the virtual bus
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "test_host.h"
+#include "regmap.h"
+#include "i2c_sim.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_SLAVE_ADDR                 (0x42)
+#define TEST_REG_CTRL                   (0x10)
+#define TEST_REG_STATUS                 (0x11)
+#define TEST_REG_OUT_H                  (0x20)
+#define TEST_REG_OUT_L                  (0x21)
+#define TEST_REG_OUT_FLAGS              (0x22)
+
+#define TEST_PAC1934_ADDR               (0x11 << 1)
+#define TEST_PAC1934_REG_PRODUCT_ID     (0xFD)
+#define TEST_PAC1934_REG_REVISION_ID    (0xFF)
+
+/* Private variables -------------------------------------------------- */
+static const regmap_field_t TEST_MODE  = REGMAP_FIELD(TEST_REG_CTRL, 6, 4);
+static const regmap_field_t TEST_EN    = REGMAP_FIELD(TEST_REG_CTRL, 0, 0);
+static const regmap_field_t TEST_FULL  = REGMAP_FIELD(TEST_REG_CTRL, 7, 0);
+static const regmap_field_t TEST_OVF   = REGMAP_FIELD(TEST_REG_OUT_FLAGS, 3, 2);
+static const regmap_group_t TEST_OUT   = REGMAP_GROUP(TEST_REG_OUT_H, TEST_REG_OUT_FLAGS);
+
+static const reg_shadow_def_t m_test_shadow[] =
+{
+  { .reg = TEST_REG_CTRL, .mask = 0xFF }
+};
+
+static uint8_t m_test_reg[256];
+static uint32_t m_test_reads;
+static uint32_t m_test_writes;
+static uint32_t m_test_fail;        // Transactions left to fail
+
+/* Private function prototypes ---------------------------------------- */
+static int m_test_i2c_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+static int m_test_i2c_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len);
+static void m_test_macros(void);
+static void m_test_fields(void);
+static void m_test_groups(void);
+static void m_test_virtual_bus(void);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  m_test_macros();
+  m_test_fields();
+  m_test_groups();
+  m_test_virtual_bus();
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Compile time tables and the buffer helpers, no bus
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_macros(void)
+{
+  uint8_t buf[3] = { 0x12, 0x34, 0x0C };
+
+  TEST_CHECK(TEST_MODE.reg == TEST_REG_CTRL);
+  TEST_CHECK(TEST_MODE.mask == 0x70);
+  TEST_CHECK(TEST_MODE.shift == 4);
+  TEST_CHECK(TEST_EN.mask == 0x01);
+  TEST_CHECK(TEST_FULL.mask == 0xFF);
+  TEST_CHECK(TEST_FULL.shift == 0);
+
+  TEST_CHECK(TEST_OUT.reg == TEST_REG_OUT_H);
+  TEST_CHECK(TEST_OUT.len == 3);
+
+  // Field get ignores the bits around it, prep drops value bits past the field
+  TEST_CHECK(REGMAP_FIELD_GET(&TEST_MODE, 0xFF) == 7);
+  TEST_CHECK(REGMAP_FIELD_GET(&TEST_MODE, 0x8F) == 0);
+  TEST_CHECK(REGMAP_FIELD_GET(&TEST_MODE, 0x50) == 5);
+  TEST_CHECK(REGMAP_FIELD_PREP(&TEST_MODE, 5) == 0x50);
+  TEST_CHECK(REGMAP_FIELD_PREP(&TEST_MODE, 0x0F) == 0x70);
+  TEST_CHECK(REGMAP_FIELD_PREP(&TEST_FULL, 0xA5) == 0xA5);
+
+  // Group offsets are relative to the first register of the group
+  TEST_CHECK(REGMAP_GROUP_BE16(&TEST_OUT, buf, TEST_REG_OUT_H) == 0x1234);
+  TEST_CHECK(REGMAP_GROUP_FIELD(&TEST_OUT, buf, &TEST_OVF) == 3);
+}
+
+/**
+ * @brief         Field read and write keep the other bits, shadowed writes skip the read
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_fields(void)
+{
+  regmap_t map;
+  uint8_t value;
+
+  memset(m_test_reg, 0, sizeof(m_test_reg));
+  m_test_reg[TEST_REG_CTRL]   = 0x8E;
+  m_test_reg[TEST_REG_STATUS] = 0x5A;
+
+  TEST_CHECK(BS_OK == regmap_init(&map, "test", TEST_SLAVE_ADDR, m_test_i2c_read, m_test_i2c_write, NULL, 0));
+
+  m_test_reads = m_test_writes = 0;
+  TEST_CHECK(BS_OK == regmap_field_write(&map, &TEST_MODE, 3));
+  TEST_CHECK(m_test_reg[TEST_REG_CTRL] == 0xBE);
+  TEST_CHECK(m_test_reg[TEST_REG_STATUS] == 0x5A);
+  TEST_CHECK((m_test_reads == 1) && (m_test_writes == 1));
+
+  TEST_CHECK(BS_OK == regmap_field_read(&map, &TEST_MODE, &value));
+  TEST_CHECK(value == 3);
+  TEST_CHECK(BS_OK == regmap_field_read(&map, &TEST_EN, &value));
+  TEST_CHECK(value == 0);
+
+  // Shadowed register, read once at the first update then written only
+  TEST_CHECK(BS_OK == regmap_init(&map, "test", TEST_SLAVE_ADDR, m_test_i2c_read, m_test_i2c_write,
+                                  m_test_shadow, sizeof(m_test_shadow) / sizeof(m_test_shadow[0])));
+  m_test_reads = m_test_writes = 0;
+  TEST_CHECK(BS_OK == regmap_field_write(&map, &TEST_EN, 1));
+  TEST_CHECK(BS_OK == regmap_field_write(&map, &TEST_MODE, 1));
+  TEST_CHECK(BS_OK == regmap_field_read(&map, &TEST_MODE, &value));
+  TEST_CHECK(value == 1);
+  TEST_CHECK(m_test_reg[TEST_REG_CTRL] == 0x9F);
+  TEST_CHECK((m_test_reads == 1) && (m_test_writes == 2));
+
+  // A failed write leaves the shadow unused until read again
+  m_test_fail = 1;
+  TEST_CHECK(BS_OK != regmap_field_write(&map, &TEST_MODE, 2));
+  m_test_reg[TEST_REG_CTRL] = 0x0F;
+  m_test_reads = 0;
+  TEST_CHECK(BS_OK == regmap_field_read(&map, &TEST_EN, &value));
+  TEST_CHECK(value == 1);
+  TEST_CHECK(m_test_reads == 1);
+  TEST_CHECK(BS_OK == regmap_field_read(&map, &TEST_MODE, &value));
+  TEST_CHECK(value == 0);
+}
+
+/**
+ * @brief         Group read and write are single bursts at the group offsets
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_groups(void)
+{
+  regmap_t map;
+  uint8_t buf[3];
+  uint8_t out[3] = { 0xCA, 0xFE, 0x08 };
+
+  memset(m_test_reg, 0, sizeof(m_test_reg));
+  m_test_reg[TEST_REG_OUT_H]     = 0x80;
+  m_test_reg[TEST_REG_OUT_L]     = 0x01;
+  m_test_reg[TEST_REG_OUT_FLAGS] = 0xF4;
+  m_test_reg[TEST_REG_OUT_FLAGS + 1] = 0xEE;   // Past the group, never touched
+
+  TEST_CHECK(BS_OK == regmap_init(&map, "test", TEST_SLAVE_ADDR, m_test_i2c_read, m_test_i2c_write, NULL, 0));
+
+  m_test_reads = m_test_writes = 0;
+  TEST_CHECK(BS_OK == regmap_group_read(&map, &TEST_OUT, buf));
+  TEST_CHECK(m_test_reads == 1);
+  TEST_CHECK(REGMAP_GROUP_BE16(&TEST_OUT, buf, TEST_REG_OUT_H) == 0x8001);
+  TEST_CHECK(REGMAP_GROUP_FIELD(&TEST_OUT, buf, &TEST_OVF) == 1);
+
+  TEST_CHECK(BS_OK == regmap_group_write(&map, &TEST_OUT, out));
+  TEST_CHECK(m_test_writes == 1);
+  TEST_CHECK(m_test_reg[TEST_REG_OUT_H] == 0xCA);
+  TEST_CHECK(m_test_reg[TEST_REG_OUT_FLAGS] == 0x08);
+  TEST_CHECK(m_test_reg[TEST_REG_OUT_FLAGS + 1] == 0xEE);
+
+  m_test_fail = 1;
+  TEST_CHECK(BS_OK != regmap_group_read(&map, &TEST_OUT, buf));
+}
+
+/**
+ * @brief         Group read of the PAC1934 ID registers on the virtual bus
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_virtual_bus(void)
+{
+  static const regmap_group_t ID = REGMAP_GROUP(TEST_PAC1934_REG_PRODUCT_ID, TEST_PAC1934_REG_REVISION_ID);
+  i2c_sim_stats_t stats;
+  regmap_t map;
+  uint8_t buf[3];
+
+  i2c_sim_init(400000, 30);
+  TEST_CHECK(BS_OK == regmap_init(&map, "pac1934", TEST_PAC1934_ADDR, i2c_sim_read, i2c_sim_write, NULL, 0));
+  TEST_CHECK(BS_OK == regmap_group_read(&map, &ID, buf));
+  TEST_CHECK(buf[0] == 0x5B);   // Product ID of the PAC1934
+  TEST_CHECK(buf[1] == 0x5D);   // Manufacturer ID
+  TEST_CHECK(0 == i2c_sim_get_stats(TEST_PAC1934_ADDR, &stats));
+  TEST_CHECK((stats.reads == 1) && (stats.bytes > 3));
+}
+
+/**
+ * @brief         Register file read, auto increment
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      First register
+ * @param[out]    data          Pointer to data
+ * @param[in]     len           Number of registers
+ *
+ * @attention     None
+ *
+ * @return        0 on success
+ */
+static int m_test_i2c_read(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+  if (m_test_fail != 0)
+  {
+    m_test_fail--;
+    return -1;
+  }
+
+  m_test_reads++;
+  for (uint32_t i = 0; i < len; i++)
+    data[i] = m_test_reg[(uint8_t)(reg_addr + i)];
+
+  return (slave_addr == TEST_SLAVE_ADDR) ? 0 : -1;
+}
+
+/**
+ * @brief         Register file write, auto increment
+ *
+ * @param[in]     slave_addr    Slave address
+ * @param[in]     reg_addr      First register
+ * @param[in]     data          Pointer to data
+ * @param[in]     len           Number of registers
+ *
+ * @attention     None
+ *
+ * @return        0 on success
+ */
+static int m_test_i2c_write(uint8_t slave_addr, uint8_t reg_addr, uint8_t *data, uint32_t len)
+{
+  if (m_test_fail != 0)
+  {
+    m_test_fail--;
+    return -1;
+  }
+
+  m_test_writes++;
+  for (uint32_t i = 0; i < len; i++)
+    m_test_reg[(uint8_t)(reg_addr + i)] = data[i];
+
+  return (slave_addr == TEST_SLAVE_ADDR) ? 0 : -1;
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,252 @@
+/**
+ * @file       test_sleep_pos.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host replay harness of the sleep position engine
+ * @note       A trace is one gyro sample per line, "timestamp_us,x,y,z" in bias
+ *             corrected counts as bsp_gyro hands them out. Given a file the trace
+ *             is replayed and the positions printed. Without one, a synthetic night
+ *             is written as a trace, replayed and checked against its script.
+ * @example    build/test_sleep_pos night.csv
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include <stdlib.h>
+#include "test_host.h"
+#include "sleep_pos.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_SENSITIVITY_X10            (328)   // IAM20380_FULLSCALE_1000_DPS
+#define TEST_SAMPLE_HZ                  (10)
+#define TEST_NOISE_COUNTS               (10)    // Under the dead band
+#define TEST_ROLL_TOLERANCE_MDEG        (2000)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Step of the synthetic night, turn at a rate then lie still
+ */
+typedef struct
+{
+  int32_t rate_mdps;        // Roll rate while turning
+  uint32_t turn_ms;
+  uint32_t still_s;
+  sleep_pos_position_t expect;
+}
+test_step_t;
+
+/* Private variables -------------------------------------------------- */
+static const char *m_test_pos_name[SLEEP_POS_CNT] = { "supine", "left", "right", "prone" };
+
+static const sleep_pos_config_t m_test_cfg =
+{
+  .roll_axis       = 0,
+  .roll_inverted   = false,
+  .sensitivity_x10 = TEST_SENSITIVITY_X10
+};
+
+// Left, back, right, on to the front the long way round, then 2 h still
+static const test_step_t m_test_night[] =
+{
+  { .rate_mdps = 0,      .turn_ms = 0,    .still_s = 60,   .expect = SLEEP_POS_SUPINE },
+  { .rate_mdps = 45000,  .turn_ms = 2000, .still_s = 600,  .expect = SLEEP_POS_LEFT   },
+  { .rate_mdps = -45000, .turn_ms = 2000, .still_s = 300,  .expect = SLEEP_POS_SUPINE },
+  { .rate_mdps = -45000, .turn_ms = 2000, .still_s = 600,  .expect = SLEEP_POS_RIGHT  },
+  { .rate_mdps = -30000, .turn_ms = 3000, .still_s = 300,  .expect = SLEEP_POS_PRONE  },
+  { .rate_mdps = 0,      .turn_ms = 0,    .still_s = 7200, .expect = SLEEP_POS_PRONE  }
+};
+
+/* Private function prototypes ---------------------------------------- */
+static uint32_t m_test_replay(FILE *trace, sleep_pos_t *pos, bool verbose);
+static void m_test_write_night(FILE *trace, int32_t *roll_mdeg, uint32_t *time_s);
+static void m_test_bench(void);
+
+/* Function definitions ----------------------------------------------- */
+int main(int argc, char *argv[])
+{
+  sleep_pos_t pos;
+  FILE *trace;
+  uint32_t samples;
+  uint32_t time_s[SLEEP_POS_CNT] = { 0 };
+  int32_t roll_mdeg[sizeof(m_test_night) / sizeof(m_test_night[0])];
+  int32_t err;
+
+  // Recorded trace
+  if (argc > 1)
+  {
+    trace = fopen(argv[1], "r");
+    if (trace == NULL)
+    {
+      perror(argv[1]);
+      return 2;
+    }
+
+    sleep_pos_init(&pos, &m_test_cfg);
+    samples = m_test_replay(trace, &pos, true);
+    fclose(trace);
+
+    printf("%u samples, %u changes\n", samples, pos.changes);
+    for (int i = 0; i < SLEEP_POS_CNT; i++)
+      printf("%-8s %6u s\n", m_test_pos_name[i], pos.time_s[i]);
+
+    return 0;
+  }
+
+  // Synthetic night, step by step through the same replay
+  trace = tmpfile();
+  TEST_CHECK(trace != NULL);
+  if (trace == NULL)
+    return test_result();
+
+  m_test_write_night(trace, roll_mdeg, time_s);
+  rewind(trace);
+
+  sleep_pos_init(&pos, &m_test_cfg);
+  samples = 0;
+  for (uint32_t i = 0; i < sizeof(m_test_night) / sizeof(m_test_night[0]); i++)
+  {
+    samples += m_test_replay(trace, &pos, false);
+    err = pos.roll_mdeg - roll_mdeg[i];
+    if (err > 180000)
+      err -= 360000;
+    else if (err < -180000)
+      err += 360000;
+    printf("step %u: %-6s roll %7d mdeg, error %5d mdeg\n", i, m_test_pos_name[pos.position], pos.roll_mdeg, err);
+
+    TEST_CHECK(pos.position == m_test_night[i].expect);
+    TEST_CHECK((err > -TEST_ROLL_TOLERANCE_MDEG) && (err < TEST_ROLL_TOLERANCE_MDEG));
+  }
+  fclose(trace);
+
+  TEST_CHECK(pos.changes == 4);
+  for (int i = 0; i < SLEEP_POS_CNT; i++)
+  {
+    printf("%-8s %6u s, expected %6u s\n", m_test_pos_name[i], pos.time_s[i], time_s[i]);
+    TEST_CHECK((pos.time_s[i] + 5 >= time_s[i]) && (pos.time_s[i] <= time_s[i] + 5));
+  }
+
+  // A night reset keeps the engine running from the current posture
+  sleep_pos_night_reset(&pos);
+  TEST_CHECK((pos.position == SLEEP_POS_SUPINE) && (pos.roll_mdeg == 0) && (pos.time_s[SLEEP_POS_PRONE] == 0));
+
+  m_test_bench();
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+/**
+ * @brief         Feed a trace to the engine, up to an empty line or the end of the file
+ *
+ * @param[in]     trace     Trace file
+ * @param[in]     pos       Pointer to handle of sleep position engine
+ * @param[in]     verbose   Print every position change
+ *
+ * @attention     Lines that do not parse are skipped
+ *
+ * @return        Number of samples fed
+ */
+static uint32_t m_test_replay(FILE *trace, sleep_pos_t *pos, bool verbose)
+{
+  char line[96];
+  unsigned long long timestamp_us;
+  int x, y, z;
+  int16_t rate[3];
+  sleep_pos_position_t last = pos->position;
+  uint32_t samples = 0;
+
+  while (fgets(line, sizeof(line), trace) != NULL)
+  {
+    if (line[0] == '\n')
+      break;
+
+    if (sscanf(line, "%llu,%d,%d,%d", &timestamp_us, &x, &y, &z) != 4)
+      continue;
+
+    rate[0] = (int16_t)x;
+    rate[1] = (int16_t)y;
+    rate[2] = (int16_t)z;
+    sleep_pos_update(pos, rate, timestamp_us);
+    samples++;
+
+    if (verbose && (pos->position != last))
+    {
+      last = pos->position;
+      printf("%10.1f s  %-6s roll %7d mdeg\n", timestamp_us / 1e6, m_test_pos_name[last], pos->roll_mdeg);
+    }
+  }
+
+  return samples;
+}
+
+/**
+ * @brief         Write the synthetic night as a trace, one block per step
+ *
+ * @param[in]     trace         Trace file
+ * @param[out]    roll_mdeg     True roll at the end of each step, unwrapped
+ * @param[out]    time_s        True time in each position
+ *
+ * @attention     Sample times jitter by up to 1 ms, rates carry noise under the dead band
+ *
+ * @return        None
+ */
+static void m_test_write_night(FILE *trace, int32_t *roll_mdeg, uint32_t *time_s)
+{
+  uint64_t timestamp_us = 1000;
+  int64_t roll_udeg = 0;
+  uint32_t period_us = 1000000 / TEST_SAMPLE_HZ;
+  uint32_t n;
+  int32_t rate_mdps;
+  int32_t x;
+
+  srand(1);
+
+  for (uint32_t i = 0; i < sizeof(m_test_night) / sizeof(m_test_night[0]); i++)
+  {
+    n = (m_test_night[i].turn_ms + m_test_night[i].still_s * 1000) * TEST_SAMPLE_HZ / 1000;
+    for (uint32_t k = 0; k < n; k++)
+    {
+      rate_mdps     = (k < m_test_night[i].turn_ms * TEST_SAMPLE_HZ / 1000) ? m_test_night[i].rate_mdps : 0;
+      timestamp_us += period_us + (rand() % 2000) - 1000;
+      roll_udeg    += (int64_t)rate_mdps * period_us / 1000;
+
+      x = rate_mdps * TEST_SENSITIVITY_X10 / 10000 + (rand() % (2 * TEST_NOISE_COUNTS + 1)) - TEST_NOISE_COUNTS;
+      fprintf(trace, "%llu,%d,%d,%d\n", (unsigned long long)timestamp_us, x,
+              (rand() % (2 * TEST_NOISE_COUNTS + 1)) - TEST_NOISE_COUNTS,
+              (rand() % (2 * TEST_NOISE_COUNTS + 1)) - TEST_NOISE_COUNTS);
+    }
+    fprintf(trace, "\n");
+
+    roll_mdeg[i] = (int32_t)(roll_udeg / 1000);
+    time_s[m_test_night[i].expect] += m_test_night[i].still_s + m_test_night[i].turn_ms / 1000;
+  }
+}
+
+/**
+ * @brief         Host cost of one sample, turning so the integration runs
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_bench(void)
+{
+  sleep_pos_t pos;
+  int16_t rate[3] = { 1000, 0, 0 };
+  uint64_t start_ns;
+  uint32_t n = 10000000;
+
+  sleep_pos_init(&pos, &m_test_cfg);
+
+  start_ns = test_now_ns();
+  for (uint32_t i = 1; i <= n; i++)
+    sleep_pos_update(&pos, rate, (uint64_t)i * 5000);
+
+  printf("sleep_pos_update %.1f ns per sample\n", (double)(test_now_ns() - start_ns) / n);
+}
+
+/* End of file -------------------------------------------------------- */
@@ -0,0 +1,218 @@
+/**
+ * @file       test_speed_pi.c
+ * @copyright  Copyright (C) 2020 Hydratech. All rights reserved.
+ * @license    This project is released under the Hydratech License.
+ * @version    1.0.0
+ * @date       2021-11-30
+ * @author     Hiep Le
+ * @brief      Host test of the blower speed loop against the rotor model
+ * @note       Runs the bsp_brc_ctrl cycle at 1 kHz on simulated time, velocity read,
+ *             speed_pi_update and speed command write through the DRV10975 driver,
+ *             with the gains of bsp_brc_ctrl. Checks the step response, the load
+ *             step recovery and the derating limit, and reports the bus time per
+ *             cycle and the host cost of the controller.
+ * @example    make -C app/test/host test
+ */
+
+/* Includes ----------------------------------------------------------- */
+#include "test_host.h"
+#include "i2c_sim.h"
+#include "drv10975.h"
+#include "speed_pi.h"
+
+/* Private defines ---------------------------------------------------- */
+#define TEST_CLK_SPEED                  (400000)
+#define TEST_OVERHEAD_US                (30)    // Software cost per transaction on target
+#define TEST_PERIOD_US                  (1000)
+
+// Gains of bsp_brc_ctrl
+#define TEST_KFF_Q16                    (112)
+#define TEST_KP_Q16                     (560)
+#define TEST_KI_Q16                     (2234)
+
+#define TEST_SETPOINT_MHZ               (150000)
+#define TEST_BAND_MHZ                   (TEST_SETPOINT_MHZ / 50)    // 2 %
+#define TEST_DERATE_CMD                 (DRV10975_SPEED_CMD_MAX / 4)
+
+/* Private enumerate/structure ---------------------------------------- */
+/**
+ * @brief Response of one run of the loop
+ */
+typedef struct
+{
+  int32_t settle_ms;        // Last entry into the 2 % band, -1 if never
+  int32_t peak_mhz;         // Highest speed
+  int32_t cmd_max;          // Highest command written
+  uint32_t writes;          // Speed command writes
+  uint32_t errors;          // Failed bus transactions
+  uint64_t bus_max_us;      // Worst bus time of a cycle
+}
+test_run_t;
+
+/* Private variables -------------------------------------------------- */
+static drv10975_t m_drv;
+static speed_pi_t m_pi;
+
+static const speed_pi_config_t m_test_cfg =
+{
+  .kp_q16    = TEST_KP_Q16,
+  .ki_q16    = TEST_KI_Q16,
+  .kff_q16   = TEST_KFF_Q16,
+  .period_us = TEST_PERIOD_US,
+  .out_max   = DRV10975_SPEED_CMD_MAX
+};
+
+/* Private function prototypes ---------------------------------------- */
+static void m_test_gpio_write(uint8_t pin, uint8_t state);
+static void m_test_run(uint32_t cycles, test_run_t *run);
+static void m_test_bench(void);
+
+/* Function definitions ----------------------------------------------- */
+int main(void)
+{
+  test_run_t run;
+
+  i2c_sim_init(TEST_CLK_SPEED, TEST_OVERHEAD_US);
+  i2c_sim_power_cycle();
+
+  m_drv.device_address = DRV10975_I2C_ADDR;
+  m_drv.i2c_read       = i2c_sim_read;
+  m_drv.i2c_write      = i2c_sim_write;
+  m_drv.delay_ms       = i2c_sim_delay_ms;
+  m_drv.gpio_write     = m_test_gpio_write;
+  TEST_CHECK(BS_OK == drv10975_init(&m_drv));
+  speed_pi_init(&m_pi, &m_test_cfg);
+
+  // From rest to the setpoint
+  m_test_run(2000, &run);
+  printf("step: settled (2 %%) in %d ms, overshoot %d mHz, worst bus %llu us per cycle\n",
+         run.settle_ms, run.peak_mhz - TEST_SETPOINT_MHZ, (unsigned long long)run.bus_max_us);
+  TEST_CHECK((run.settle_ms >= 0) && (run.settle_ms <= 300));
+  TEST_CHECK(run.peak_mhz - TEST_SETPOINT_MHZ <= TEST_SETPOINT_MHZ / 20);
+  TEST_CHECK(run.bus_max_us < TEST_PERIOD_US / 2);
+
+  TEST_CHECK(run.errors == 0);
+
+  // Steady state, the command only dithers on the velocity resolution
+  m_test_run(1000, &run);
+  printf("steady: %u writes in 1000 cycles\n", run.writes);
+  TEST_CHECK(run.settle_ms == 0);
+  TEST_CHECK(run.writes <= 200);
+
+  // 20 % more load
+  i2c_sim_drv10975_set_load(20);
+  m_test_run(2000, &run);
+  printf("load step: recovered in %d ms\n", run.settle_ms);
+  TEST_CHECK((run.settle_ms >= 0) && (run.settle_ms <= 500));
+
+  // Derated, the command stays under the limit and the integrator does not wind up
+  speed_pi_set_limit(&m_pi, TEST_DERATE_CMD);
+  m_test_run(2000, &run);
+  printf("derated: command at most %d, speed %d mHz\n", run.cmd_max, m_drv.value.velocity_mhz);
+  TEST_CHECK(run.cmd_max <= TEST_DERATE_CMD);
+  TEST_CHECK(m_drv.value.velocity_mhz < TEST_SETPOINT_MHZ - TEST_BAND_MHZ);
+
+  speed_pi_set_limit(&m_pi, DRV10975_SPEED_CMD_MAX);
+  m_test_run(2000, &run);
+  printf("restored: settled (2 %%) in %d ms, overshoot %d mHz\n", run.settle_ms, run.peak_mhz - TEST_SETPOINT_MHZ);
+  TEST_CHECK((run.settle_ms >= 0) && (run.settle_ms <= 500));
+  TEST_CHECK(run.peak_mhz - TEST_SETPOINT_MHZ <= TEST_SETPOINT_MHZ / 20);
+
+  m_test_bench();
+
+  return test_result();
+}
+
+/* Private function definitions ---------------------------------------- */
+static void m_test_gpio_write(uint8_t pin, uint8_t state)
+{
+  (void)pin;
+  (void)state;
+}
+
+/**
+ * @brief         Run the control cycle of bsp_brc_ctrl at the setpoint
+ *
+ * @param[in]     cycles    Number of periods
+ * @param[out]    run       Response of the run
+ *
+ * @attention     Simulated time advances one period per cycle, bus time included
+ *
+ * @return        None
+ */
+static void m_test_run(uint32_t cycles, test_run_t *run)
+{
+  uint64_t start_us;
+  uint64_t bus_us;
+  int32_t speed;
+  int32_t err;
+  int32_t cmd;
+
+  run->settle_ms  = -1;
+  run->peak_mhz   = 0;
+  run->cmd_max    = 0;
+  run->writes     = 0;
+  run->errors     = 0;
+  run->bus_max_us = 0;
+
+  for (uint32_t k = 0; k < cycles; k++)
+  {
+    start_us = i2c_sim_get_time_us();
+
+    if (BS_OK != drv10975_get_motor_velocity(&m_drv))
+      run->errors++;
+    speed = (int32_t)m_drv.value.velocity_mhz;
+    cmd   = speed_pi_update(&m_pi, TEST_SETPOINT_MHZ, speed);
+    if (cmd != (int32_t)m_drv.value.speed)
+    {
+      if (BS_OK != drv10975_set_speed_cmd(&m_drv, (uint16_t)cmd))
+        run->errors++;
+      run->writes++;
+    }
+
+    bus_us = i2c_sim_get_time_us() - start_us;
+    if (bus_us > run->bus_max_us)
+      run->bus_max_us = bus_us;
+    if (speed > run->peak_mhz)
+      run->peak_mhz = speed;
+    if (cmd > run->cmd_max)
+      run->cmd_max = cmd;
+
+    err = speed - TEST_SETPOINT_MHZ;
+    if ((err > TEST_BAND_MHZ) || (err < -TEST_BAND_MHZ))
+      run->settle_ms = -1;
+    else if (run->settle_ms < 0)
+      run->settle_ms = (int32_t)(k * TEST_PERIOD_US / 1000);
+
+    if (bus_us < TEST_PERIOD_US)
+      i2c_sim_advance_us(TEST_PERIOD_US - bus_us);
+  }
+}
+
+/**
+ * @brief         Host cost of one controller update
+ *
+ * @param[in]     None
+ *
+ * @attention     None
+ *
+ * @return        None
+ */
+static void m_test_bench(void)
+{
+  speed_pi_t pi;
+  volatile int32_t sink = 0;
+  uint64_t start_ns;
+  uint32_t n = 10000000;
+
+  speed_pi_init(&pi, &m_test_cfg);
+
+  start_ns = test_now_ns();
+  for (uint32_t i = 0; i < n; i++)
+    sink += speed_pi_update(&pi, TEST_SETPOINT_MHZ, TEST_SETPOINT_MHZ - 10000 + (int32_t)(i & 8191));
+
+  printf("speed_pi_update %.1f ns per call\n", (double)(test_now_ns() - start_ns) / n);
+  (void)sink;
+}
+
+/* End of file -------------------------------------------------------- */